@@ -1,11 +1,14 @@
 #include "BluetoothBms.h"
+#include "BmsGattLink.h"
 #include "../config.h"
 #include "../DalyBms/DalyBms.h"
 #include "../JbdBms/JbdBms.h"
 #include "../JkBms/JkBms.h"
+#include "../Power/Power.h"
 #include "../Settings/Settings.h"
+#include "../Telemetry/Telemetry.h"
+#include "../Throttle/Throttle.h"
 #include "../Xctod/Xctod.h"
-#include <BLEAdvertisedDevice.h>
 #include <BLEClient.h>
 #include <BLEDevice.h>
 
@@ -13,164 +16,375 @@ namespace {
 constexpr char JBD_SCAN_SERVICE_UUID[]  = "0000ff00-0000-1000-8000-00805f9b34fb";
 constexpr char DALY_SCAN_SERVICE_UUID[] = "0000fff0-0000-1000-8000-00805f9b34fb";
 constexpr char JK_SCAN_SERVICE_UUID[]   = "0000ffe0-0000-1000-8000-00805f9b34fb";
-constexpr uint32_t WEB_SCAN_DURATION_SECONDS = 5;
+// Web scan: passive, a 40 ms window every 160 ms (a quarter of the radio),
+// in 1 s bursts with room between them for the drivers' connects. Long
+// enough overall to hear a BMS that advertises every second or two a few
+// times over.
+constexpr uint32_t WEB_SCAN_DURATION_MS = 10000;
+constexpr uint32_t SCAN_BURST_SECONDS = 1;       // esp_ble_gap_start_scanning()'s unit
+constexpr uint32_t SCAN_BURST_GAP_MS = 500;
+constexpr uint32_t SCAN_BURST_TIMEOUT_MS = 3000; // a burst whose end never came is stopped
+constexpr uint16_t SCAN_INTERVAL = 0x100;        // 160 ms, in 0.625 ms units
+constexpr uint16_t SCAN_WINDOW = 0x40;           // 40 ms
+// Poll level re-evaluated this often; well under the fastest request interval
+constexpr uint32_t POLL_EVAL_INTERVAL_MS = 100;
+constexpr char TREND_NVS_NAMESPACE[] = "bmstrend";
+constexpr char TREND_NVS_KEY[] = "sag";
+// A flight with fewer ΔV/ΔI samples than this leaves the baseline alone
+constexpr uint16_t TREND_MIN_SESSION_SAMPLES = 10;
+constexpr uint32_t TREND_WRITER_STACK_SIZE = 3072;
+constexpr UBaseType_t TREND_WRITER_PRIORITY = 1;
 } // namespace
 
+// One dispatch table per driver object: each protocol has one per pack.
+#define BMS_DRIVER_TABLE(table, bmsType, object)                                           \
+    static void table##Init() { object.init(); }                                          \
+    static void table##Update() { object.update(); }                                      \
+    static void table##SetEnabled(bool enabled) { object.setEnabled(enabled); }           \
+    static void table##SetMacAddress(const String& mac) { object.setMacAddress(mac); }    \
+    static bool table##IsConnected() { return object.isConnected(); }                     \
+    static const char* table##GetStateName() { return object.getStateName(); }            \
+    static bool table##HasData() { return object.hasData(); }                             \
+    static bool table##HasCellData() { return object.hasCellData(); }                     \
+    static bool table##ReadSnapshot(BmsSnapshot& out) { return object.readSnapshot(out); } \
+    static void table##SetPollLevel(uint8_t level) { object.setPollLevel(level); }        \
+    static const BmsDriver table = {                                                      \
+        bmsType, table##Init, table##Update, table##SetEnabled, table##SetMacAddress,     \
+        table##IsConnected, table##GetStateName, table##HasData, table##HasCellData,      \
+        table##ReadSnapshot, table##SetPollLevel                                          \
+    };
+
+BMS_DRIVER_TABLE(s_jbdDriver, BmsTypeJbd, jbdBms)
+BMS_DRIVER_TABLE(s_dalyDriver, BmsTypeDaly, dalyBms)
+BMS_DRIVER_TABLE(s_jkDriver, BmsTypeJk, jkBms)
+BMS_DRIVER_TABLE(s_jbdDriver2, BmsTypeJbd, jbdBms2)
+BMS_DRIVER_TABLE(s_dalyDriver2, BmsTypeDaly, dalyBms2)
+BMS_DRIVER_TABLE(s_jkDriver2, BmsTypeJk, jkBms2)
+
+#undef BMS_DRIVER_TABLE
+
+static const uint8_t kDriverTypes = 3;
+static const BmsDriver* const s_drivers[kMaxBmsPacks][kDriverTypes] = {
+    { &s_jbdDriver, &s_dalyDriver, &s_jkDriver },
+    { &s_jbdDriver2, &s_dalyDriver2, &s_jkDriver2 },
+};
+
+static const BmsDriver* driverForType(uint8_t pack, uint8_t type) {
+    for (const BmsDriver* driver : s_drivers[pack]) {
+        if (driver->type == type) return driver;
+    }
+    return nullptr;
+}
+
+static void disableAllDrivers() {
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        for (const BmsDriver* driver : s_drivers[pack]) {
+            driver->setEnabled(false);
+        }
+    }
+}
+
+static_assert((int)BmsScanJbd == (int)BmsTypeJbd && (int)BmsScanDaly == (int)BmsTypeDaly
+              && (int)BmsScanJk == (int)BmsTypeJk,
+              "scan results report Settings BMS types");
+
 void BluetoothBms::init() {
+    bmsGattLink.begin();
+    trendPrefs_.begin(TREND_NVS_NAMESPACE, false);
+    uint8_t blob[BmsCellTrendStore::kSerializedMax];
+    const size_t len = trendPrefs_.getBytes(TREND_NVS_KEY, blob, sizeof(blob));
+    if (len > 0) {
+        portENTER_CRITICAL(&trendLock_);
+        cellTrends_.deserialize(blob, len);
+        portEXIT_CRITICAL(&trendLock_);
+    }
+    // Without it the baselines still update, for this boot only
+    if (xTaskCreate(trendWriterTask, "bms_trend", TREND_WRITER_STACK_SIZE, this, TREND_WRITER_PRIORITY,
+                    &trendWriterTask_) != pdPASS) {
+        Serial.println("BluetoothBms: trend writer task create failed");
+        trendWriterTask_ = nullptr;
+    }
+    BLEDevice::setCustomGapHandler(onGapEvent);
     clearWebScanResults();
 }
 
 void BluetoothBms::update() {
     if (isWebScanBusy()) {
-        return;
+        updateWebScan();
     }
 
-    const uint8_t activeType = getActiveType();
-    const String mac = settings.getBmsMac();
-
-    // Lazy-init the selected backend exactly once (init() is idempotent).
-    if (activeType == BmsTypeJbd) {
-        jbdBms.init();
-    } else if (activeType == BmsTypeDaly) {
-        dalyBms.init();
-    } else if (activeType == BmsTypeJk) {
-        jkBms.init();
+    // Settings are only read (under their mutex) when they changed.
+    const uint32_t revision = settings.getBmsRevision();
+    if (driversStale_ || revision != appliedRevision_) {
+        driversStale_ = false;
+        appliedRevision_ = revision;
+        applySettings();
     }
 
-    // setEnabled() and update() are no-ops on uninitialized backends.
-    jbdBms.setMacAddress(mac);
-    jbdBms.setEnabled(activeType == BmsTypeJbd);
+    bool pollEvaluated = false;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver != nullptr) {
+            if (!pollEvaluated) {
+                pollEvaluated = true;
+                updatePollLevel();
+            }
+            driver->setPollLevel(pollPolicy_.level());
+            driver->update();
+        }
 
-    dalyBms.setMacAddress(mac);
-    dalyBms.setEnabled(activeType == BmsTypeDaly);
+        // The drivers connect from their own tasks; edges are seen here.
+        const bool connected = driver != nullptr && driver->isConnected();
+        if (connected != wasConnected_[pack]) {
+            wasConnected_[pack] = connected;
+            eventJournal.record(connected ? EventJournalFormat::EventBmsConnected
+                                          : EventJournalFormat::EventBmsDisconnected,
+                                driver != nullptr ? driver->type : (uint8_t)BmsTypeNone, pack);
+        }
+    }
 
-    jkBms.setMacAddress(mac);
-    jkBms.setEnabled(activeType == BmsTypeJk);
+    updateCellTrackers();
+}
+
+// ---------------------------------------------------------------------------
+// updateCellTrackers — each pack's new cell frame into its tracker; the
+// flight's results are published for the web server. Arming starts the
+// trackers over (the MAC and its baseline stay); a disarm folds the
+// flight's sag into the MAC's baseline.
+// ---------------------------------------------------------------------------
+void BluetoothBms::updateCellTrackers() {
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver == nullptr || !driver->hasCellData()) continue;
+        BmsSnapshot snapshot;
+        if (!driver->readSnapshot(snapshot) || snapshot.cellMillis == trackedCellMillis_[pack]) continue;
+        trackedCellMillis_[pack] = snapshot.cellMillis;
+
+        BmsCellTracker& tracker = cellTrackers_[pack];
+        tracker.observe(snapshot);
+        portENTER_CRITICAL(&trendLock_);
+        tracker.report(cellReports_[pack]);
+        portEXIT_CRITICAL(&trendLock_);
+    }
 
-    if (activeType == BmsTypeJbd) {
-        jbdBms.update();
-    } else if (activeType == BmsTypeDaly) {
-        dalyBms.update();
-    } else if (activeType == BmsTypeJk) {
-        jkBms.update();
+    const bool armed = throttle.isArmed();
+    if (!wasArmed_ && armed) {
+        for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+            BmsCellTracker& tracker = cellTrackers_[pack];
+            tracker.reset();
+            portENTER_CRITICAL(&trendLock_);
+            tracker.report(cellReports_[pack]);
+            portEXIT_CRITICAL(&trendLock_);
+        }
+    } else if (wasArmed_ && !armed) {
+        commitCellTrends();
+    }
+    wasArmed_ = armed;
+}
+
+// Once per flight: the trackers start over on the next arming. NVS (slow)
+// is left to the writer task.
+void BluetoothBms::commitCellTrends() {
+    bool changed = false;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsCellTracker& tracker = cellTrackers_[pack];
+        if (tracker.samples() < TREND_MIN_SESSION_SAMPLES) continue;
+        portENTER_CRITICAL(&trendLock_);
+        if (trackedMacValid_[pack]) {
+            cellTrends_.record(trackedMac_[pack], tracker.cellCount(), tracker.sagUohm());
+            changed = true;
+        }
+        portEXIT_CRITICAL(&trendLock_);
+    }
+    if (changed && trendWriterTask_ != nullptr) {
+        xTaskNotifyGive(trendWriterTask_);
     }
 }
 
-bool BluetoothBms::isConnected() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.isConnected();
-    if (activeType == BmsTypeDaly) return dalyBms.isConnected();
-    if (activeType == BmsTypeJk)   return jkBms.isConnected();
-    return false;
+// Commits close together (a bounce on the arm switch) are one write.
+void BluetoothBms::trendWriterTask(void* arg) {
+    BluetoothBms* self = static_cast<BluetoothBms*>(arg);
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        self->writeCellTrends();
+    }
 }
 
-bool BluetoothBms::hasData() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.hasData();
-    if (activeType == BmsTypeDaly) return dalyBms.hasData();
-    if (activeType == BmsTypeJk)   return jkBms.hasData();
-    return false;
+// Writer task: serialised under the lock, written to NVS outside it
+void BluetoothBms::writeCellTrends() {
+    uint8_t blob[BmsCellTrendStore::kSerializedMax];
+    portENTER_CRITICAL(&trendLock_);
+    const size_t len = cellTrends_.serialize(blob, sizeof(blob));
+    portEXIT_CRITICAL(&trendLock_);
+    if (len > 0) trendPrefs_.putBytes(TREND_NVS_KEY, blob, len);
+    DEBUG_PRINTLN("[BMS] Cell sag baselines updated");
 }
 
-const char* BluetoothBms::getConnectionState() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJk) return jkBms.getStateName();
-    if (activeType == BmsTypeJbd || activeType == BmsTypeDaly) {
-        return isConnected() ? "connected" : "connecting";
+bool BluetoothBms::getPackCellTrend(uint8_t pack, BmsCellTrendReport& out) const {
+    memset(&out, 0, sizeof(out));
+    if (pack >= kMaxBmsPacks || active_[pack] == nullptr) return false;
+    portENTER_CRITICAL(&trendLock_);
+    out = cellReports_[pack];
+    if (trackedMacValid_[pack] && out.cellCount > 0) {
+        cellTrends_.lookup(trackedMac_[pack], out.cellCount, out);
+    }
+    portEXIT_CRITICAL(&trendLock_);
+    return out.cellCount > 0;
+}
+
+// ---------------------------------------------------------------------------
+// updatePollLevel — how hard the driver polls: backed off on the ground,
+// fastest when the pack is loaded or near the limiter's floor. Fed from the
+// same voltage/current the battery limiter uses (ESC telemetry, BMS fallback).
+// ---------------------------------------------------------------------------
+void BluetoothBms::updatePollLevel() {
+    const uint32_t now = millis();
+    if (now - lastPollEvalMillis_ < POLL_EVAL_INTERVAL_MS) {
+        return;
+    }
+    lastPollEvalMillis_ = now;
+
+    BmsPollInputs in;
+    in.armed = throttle.isArmed();
+    in.batteryLimited = (power.getActiveLimitCauses() & POWER_LIMIT_BATTERY) != 0;
+    in.currentMilliAmps = in.armed ? telemetry.getBatteryCurrentMilliAmps() : 0;
+    in.voltageMilliVolts = in.armed ? telemetry.getBatteryVoltageMilliVolts() : 0;
+    in.minVoltageMv = settings.getBatteryMinVoltage();
+    in.maxVoltageMv = settings.getBatteryMaxVoltage();
+    in.capacityMah = settings.getBatteryCapacityMah();
+
+    const uint8_t previous = pollPolicy_.level();
+    const uint8_t level = pollPolicy_.update(in, now);
+    if (level != previous) {
+        DEBUG_PRINT("[BMS] Poll level: ");
+        DEBUG_PRINTLN(bmsPollLevelName(level));
     }
-    return "none";
 }
 
-bool BluetoothBms::hasCellData() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.hasCellData();
-    if (activeType == BmsTypeDaly) return dalyBms.hasCellData();
-    if (activeType == BmsTypeJk)   return jkBms.hasCellData();
-    return false;
+void BluetoothBms::applySettings() {
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* next = driverForType(pack, settings.getBmsType(pack));
+        const String mac = settings.getBmsMac(pack);
+
+        // Lazy-init the selected backend exactly once (init() is idempotent).
+        if (next != nullptr) {
+            next->init();
+        }
+
+        // setEnabled() is a no-op on uninitialized backends.
+        for (const BmsDriver* driver : s_drivers[pack]) {
+            driver->setMacAddress(mac);
+            driver->setEnabled(driver == next);
+        }
+        active_[pack] = next;
+
+        // Another BMS on this pack: its session starts over
+        uint8_t addr[6] = {};
+        const bool macValid = next != nullptr && BmsGattCache::parseMac(mac.c_str(), addr);
+        if (macValid != trackedMacValid_[pack] || memcmp(addr, trackedMac_[pack], 6) != 0) {
+            cellTrackers_[pack].reset();
+            trackedCellMillis_[pack] = 0;
+            portENTER_CRITICAL(&trendLock_);
+            memcpy(trackedMac_[pack], addr, 6);
+            trackedMacValid_[pack] = macValid;
+            memset(&cellReports_[pack], 0, sizeof(cellReports_[pack]));
+            portEXIT_CRITICAL(&trendLock_);
+        }
+    }
 }
 
-uint32_t BluetoothBms::getPackVoltageMilliVolts() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getPackVoltageMilliVolts();
-    if (activeType == BmsTypeDaly) return dalyBms.getPackVoltageMilliVolts();
-    if (activeType == BmsTypeJk)   return jkBms.getPackVoltageMilliVolts();
-    return 0;
+uint8_t BluetoothBms::getPackCount() const {
+    uint8_t count = 0;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        if (active_[pack] != nullptr) count++;
+    }
+    return count;
 }
 
-int32_t BluetoothBms::getPackCurrentMilliAmps() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getPackCurrentMilliAmps();
-    if (activeType == BmsTypeDaly) return dalyBms.getPackCurrentMilliAmps();
-    if (activeType == BmsTypeJk)   return jkBms.getPackCurrentMilliAmps();
-    return 0;
+// Every selected pack: with one of two packs down, half the battery is
+// not being watched.
+bool BluetoothBms::isConnected() const {
+    bool any = false;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver == nullptr) continue;
+        if (!driver->isConnected()) return false;
+        any = true;
+    }
+    return any;
 }
 
-uint8_t BluetoothBms::getSoCPercent() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getSoCPercent();
-    if (activeType == BmsTypeDaly) return dalyBms.getSoCPercent();
-    if (activeType == BmsTypeJk)   return jkBms.getSoCPercent();
-    return 0;
+bool BluetoothBms::hasData() const {
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        if (packHasData(pack)) return true;
+    }
+    return false;
 }
 
-uint8_t BluetoothBms::getCellCount() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getCellCount();
-    if (activeType == BmsTypeDaly) return dalyBms.getCellCount();
-    if (activeType == BmsTypeJk)   return jkBms.getCellCount();
-    return 0;
+bool BluetoothBms::hasCellData() const {
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver != nullptr && driver->hasCellData()) return true;
+    }
+    return false;
 }
 
-uint8_t BluetoothBms::getTempCount() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getNtcCount();
-    if (activeType == BmsTypeDaly) return dalyBms.getTempCount();
-    if (activeType == BmsTypeJk)   return jkBms.getTempCount();
-    return 0;
+// "none" without a pack, else the first pack not connected, else "connected"
+const char* BluetoothBms::getConnectionState() const {
+    const char* state = "none";
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver == nullptr) continue;
+        if (!driver->isConnected()) return driver->getStateName();
+        state = driver->getStateName();
+    }
+    return state;
 }
 
-int16_t BluetoothBms::getTempCelsius(uint8_t index) const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getNtcTempCelsius(index);
-    if (activeType == BmsTypeDaly) return dalyBms.getTempCelsius(index);
-    if (activeType == BmsTypeJk)   return jkBms.getTempCelsius(index);
-    return 0;
+bool BluetoothBms::getSnapshot(BmsSnapshot& out) const {
+    BmsSnapshot packs[kMaxBmsPacks];
+    uint8_t count = 0;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const BmsDriver* driver = active_[pack];
+        if (driver != nullptr && driver->readSnapshot(packs[count])) {
+            count++;
+        }
+    }
+    if (count == 1) {
+        out = packs[0];
+    } else {
+        BmsSnapshot::combineParallel(packs, count, out);
+    }
+    return out.hasData;
 }
 
-uint16_t BluetoothBms::getCellVoltageMilliVolts(uint8_t index) const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getCellVoltageMilliVolts(index);
-    if (activeType == BmsTypeDaly) return dalyBms.getCellVoltageMilliVolts(index);
-    if (activeType == BmsTypeJk)   return jkBms.getCellVoltageMilliVolts(index);
-    return 0;
+uint8_t BluetoothBms::getPackType(uint8_t pack) const {
+    const BmsDriver* driver = pack < kMaxBmsPacks ? active_[pack] : nullptr;
+    return driver != nullptr ? driver->type : (uint8_t)BmsTypeNone;
 }
 
-uint16_t BluetoothBms::getCellMinMilliVolts() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getCellMinMilliVolts();
-    if (activeType == BmsTypeDaly) return dalyBms.getCellMinMilliVolts();
-    if (activeType == BmsTypeJk)   return jkBms.getCellMinMilliVolts();
-    return 0;
+bool BluetoothBms::isPackConnected(uint8_t pack) const {
+    const BmsDriver* driver = pack < kMaxBmsPacks ? active_[pack] : nullptr;
+    return driver != nullptr && driver->isConnected();
 }
 
-uint16_t BluetoothBms::getCellMaxMilliVolts() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getCellMaxMilliVolts();
-    if (activeType == BmsTypeDaly) return dalyBms.getCellMaxMilliVolts();
-    if (activeType == BmsTypeJk)   return jkBms.getCellMaxMilliVolts();
-    return 0;
+bool BluetoothBms::packHasData(uint8_t pack) const {
+    const BmsDriver* driver = pack < kMaxBmsPacks ? active_[pack] : nullptr;
+    return driver != nullptr && driver->hasData();
 }
 
-uint16_t BluetoothBms::getCellDeltaMilliVolts() const {
-    const uint8_t activeType = getActiveType();
-    if (activeType == BmsTypeJbd)  return jbdBms.getCellDeltaMilliVolts();
-    if (activeType == BmsTypeDaly) return dalyBms.getCellDeltaMilliVolts();
-    if (activeType == BmsTypeJk)   return jkBms.getCellDeltaMilliVolts();
-    return 0;
+const char* BluetoothBms::getPackState(uint8_t pack) const {
+    const BmsDriver* driver = pack < kMaxBmsPacks ? active_[pack] : nullptr;
+    return driver != nullptr ? driver->getStateName() : "none";
 }
 
-uint8_t BluetoothBms::getActiveType() const {
-    return settings.getBmsType();
+bool BluetoothBms::getPackSnapshot(uint8_t pack, BmsSnapshot& out) const {
+    const BmsDriver* driver = pack < kMaxBmsPacks ? active_[pack] : nullptr;
+    if (driver == nullptr) {
+        out.clear();
+        return false;
+    }
+    return driver->readSnapshot(out);
 }
 
 bool BluetoothBms::startWebScan() {
@@ -185,40 +399,112 @@ bool BluetoothBms::startWebScan() {
     }
 
     clearWebScanResults();
-    webScanStatus_ = BluetoothBmsScanScanning;
+    const uint32_t now = millis();
+    webScanEndMillis_ = now + WEB_SCAN_DURATION_MS;
+    nextBurstMillis_ = now;
+    webScanStatus_ = BluetoothBmsScanScanning;   // last: update() picks it up from here
+    return true;
+}
 
-    jbdBms.setEnabled(false);
-    dalyBms.setEnabled(false);
-    jkBms.setEnabled(false);
-    pauseTelemetryAdvertisingForScan();
+void BluetoothBms::clearWebScanResults() {
+    portENTER_CRITICAL(&scanLock_);
+    scanTable_.clear();
+    portEXIT_CRITICAL(&scanLock_);
+    resetWebScanState(BluetoothBmsScanIdle);
+}
 
-    BLEScan* scan = BLEDevice::getScan();
-    scan->stop();
-    scan->clearResults();
-    scan->setActiveScan(true);
-    scan->setInterval(100);
-    scan->setWindow(99);
+// ---------------------------------------------------------------------------
+// updateWebScan — from the loop while a web scan runs: one burst at a time,
+// each holding the connect turn, so a driver's connect waits for the burst
+// (at most ~1 s) and a burst waits for a connect. Connected BMS links and
+// the Xctod advertising carry on throughout.
+// ---------------------------------------------------------------------------
+void BluetoothBms::updateWebScan() {
+    const uint32_t now = millis();
+    if (burstRunning_) {
+        if (burstScanning_ && now - burstStartMillis_ < SCAN_BURST_TIMEOUT_MS) {
+            return;
+        }
+        endScanBurst();
+        nextBurstMillis_ = now + SCAN_BURST_GAP_MS;
+        if (burstFailed_) {
+            resetWebScanState(BluetoothBmsScanError);
+            strlcpy(webScanError_, "Failed to start BLE scan", sizeof(webScanError_));
+            return;
+        }
+    }
 
-    if (!scan->start(WEB_SCAN_DURATION_SECONDS, BluetoothBms::onWebScanComplete, false)) {
-        resetWebScanState(BluetoothBmsScanError);
-        strlcpy(webScanError_, "Failed to start BLE scan", sizeof(webScanError_));
-        resumeTelemetryAdvertisingAfterScan();
-        return false;
+    if ((int32_t)(now - webScanEndMillis_) >= 0) {
+        webScanStatus_ = BluetoothBmsScanComplete;
+        return;
+    }
+    if ((int32_t)(now - nextBurstMillis_) < 0 || !bmsGattLink.tryTakeConnectTurn()) {
+        return;   // a driver connecting has the radio: next pass
     }
 
-    return true;
+    esp_ble_scan_params_t params = {};
+    params.scan_type = BLE_SCAN_TYPE_PASSIVE;
+    params.own_addr_type = BLE_ADDR_TYPE_PUBLIC;
+    params.scan_filter_policy = BLE_SCAN_FILTER_ALLOW_ALL;
+    params.scan_interval = SCAN_INTERVAL;
+    params.scan_window = SCAN_WINDOW;
+    params.scan_duplicate = BLE_SCAN_DUPLICATE_DISABLE;   // every report, for the RSSI smoothing
+
+    burstRunning_ = true;
+    burstFailed_ = false;
+    burstStartMillis_ = now;
+    burstScanning_ = true;   // the GAP handler starts scanning once the parameters are set
+    if (esp_ble_gap_set_scan_params(&params) != ESP_OK) {
+        burstScanning_ = false;
+        burstFailed_ = true;
+    }
 }
 
-void BluetoothBms::clearWebScanResults() {
-    for (uint8_t i = 0; i < MAX_WEB_SCAN_RESULTS; i++) {
-        webScanResults_[i].mac = "";
-        webScanResults_[i].name = "";
-        webScanResults_[i].rssi = 0;
-        webScanResults_[i].detectedType = BmsTypeNone;
-        webScanResults_[i].advertisedServices = "";
-    }
-    webScanResultCount_ = 0;
-    resetWebScanState(BluetoothBmsScanIdle);
+void BluetoothBms::endScanBurst() {
+    if (burstScanning_) {   // timed out
+        burstScanning_ = false;
+        esp_ble_gap_stop_scanning();
+    }
+    burstRunning_ = false;
+    bmsGattLink.giveConnectTurn();
+}
+
+// BLE host task. Only the scanner's own bursts: outside them BLEScan and
+// the rest of the stack see these events as before.
+void BluetoothBms::onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param) {
+    BluetoothBms& self = bluetoothBms;
+    if (!self.burstScanning_ || param == nullptr) {
+        return;
+    }
+
+    switch (event) {
+        case ESP_GAP_BLE_SCAN_PARAM_SET_COMPLETE_EVT:
+            if (param->scan_param_cmpl.status != ESP_BT_STATUS_SUCCESS
+                || esp_ble_gap_start_scanning(SCAN_BURST_SECONDS) != ESP_OK) {
+                self.burstFailed_ = true;
+                self.burstScanning_ = false;
+            }
+            break;
+        case ESP_GAP_BLE_SCAN_START_COMPLETE_EVT:
+            if (param->scan_start_cmpl.status != ESP_BT_STATUS_SUCCESS) {
+                self.burstFailed_ = true;
+                self.burstScanning_ = false;
+            }
+            break;
+        case ESP_GAP_BLE_SCAN_RESULT_EVT:
+            if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_RES_EVT) {
+                const size_t len = (size_t)param->scan_rst.adv_data_len + param->scan_rst.scan_rsp_len;
+                portENTER_CRITICAL(&self.scanLock_);
+                self.scanTable_.observe(param->scan_rst.bda, (int8_t)param->scan_rst.rssi,
+                                        param->scan_rst.ble_adv, len, millis());
+                portEXIT_CRITICAL(&self.scanLock_);
+            } else if (param->scan_rst.search_evt == ESP_GAP_SEARCH_INQ_CMPL_EVT) {
+                self.burstScanning_ = false;   // the loop gives the turn back
+            }
+            break;
+        default:
+            break;
+    }
 }
 
 uint8_t BluetoothBms::getWebScanStatus() const {
@@ -229,12 +515,11 @@ const char* BluetoothBms::getWebScanError() const {
     return webScanError_;
 }
 
-uint8_t BluetoothBms::getWebScanResultCount() const {
-    return webScanResultCount_;
-}
-
-const BluetoothBmsScanResult* BluetoothBms::getWebScanResults() const {
-    return webScanResults_;
+uint8_t BluetoothBms::copyWebScanResults(BmsScanEntry* out, uint8_t cap) const {
+    portENTER_CRITICAL(&scanLock_);
+    const uint8_t count = scanTable_.copyTo(out, cap);
+    portEXIT_CRITICAL(&scanLock_);
+    return count;
 }
 
 bool BluetoothBms::isWebScanBusy() const {
@@ -249,9 +534,7 @@ uint8_t BluetoothBms::detectBmsTypeByMac(const String& macAddress) {
         return BmsTypeNone;
     }
 
-    jbdBms.setEnabled(false);
-    dalyBms.setEnabled(false);
-    jkBms.setEnabled(false);
+    disableAllDrivers();
     pauseTelemetryAdvertisingForScan();
 
     uint8_t detectedType = BmsTypeNone;
@@ -272,6 +555,7 @@ uint8_t BluetoothBms::detectBmsTypeByMac(const String& macAddress) {
     }
 
     resumeTelemetryAdvertisingAfterScan();
+    driversStale_ = true;   // update() re-enables the selected driver
     return detectedType;
 }
 
@@ -293,73 +577,6 @@ void BluetoothBms::resumeTelemetryAdvertisingAfterScan() {
     xctod.setAdvertisingEnabled(true);
 }
 
-void BluetoothBms::completeWebScan() {
-    BLEScan* scan = BLEDevice::getScan();
-    BLEScanResults results = scan->getResults();
-
-    for (int i = 0; i < results.getCount(); i++) {
-        BLEAdvertisedDevice device = results.getDevice(i);
-        uint8_t detectedType = BmsTypeNone;
-        String advertisedServices = "";
-
-        const int serviceUuidCount = device.getServiceUUIDCount();
-        for (int serviceIndex = 0; serviceIndex < serviceUuidCount; serviceIndex++) {
-            const String serviceUuid = String(device.getServiceUUID(serviceIndex).toString().c_str());
-            if (advertisedServices.length() > 0) {
-                advertisedServices += ", ";
-            }
-            advertisedServices += serviceUuid;
-        }
-
-        if (device.isAdvertisingService(BLEUUID(JBD_SCAN_SERVICE_UUID))) {
-            detectedType = BmsTypeJbd;
-        } else if (device.isAdvertisingService(BLEUUID(DALY_SCAN_SERVICE_UUID))) {
-            detectedType = BmsTypeDaly;
-        } else if (device.isAdvertisingService(BLEUUID(JK_SCAN_SERVICE_UUID))) {
-            detectedType = BmsTypeJk;
-        }
-
-        const String mac = String(device.getAddress().toString().c_str());
-        const String name = device.haveName() ? String(device.getName().c_str()) : "";
-        tryStoreScanResult(mac, name, device.getRSSI(), detectedType, advertisedServices);
-    }
-
-    scan->clearResults();
-    webScanStatus_ = BluetoothBmsScanComplete;
-    resumeTelemetryAdvertisingAfterScan();
-}
-
-void BluetoothBms::onWebScanComplete(BLEScanResults scanResults) {
-    (void)scanResults;
-    bluetoothBms.completeWebScan();
-}
-
-bool BluetoothBms::tryStoreScanResult(const String& mac, const String& name, int rssi, uint8_t detectedType, const String& advertisedServices) {
-    for (uint8_t i = 0; i < webScanResultCount_; i++) {
-        if (webScanResults_[i].mac == mac) {
-            if (rssi > webScanResults_[i].rssi) {
-                webScanResults_[i].name = name;
-                webScanResults_[i].rssi = rssi;
-                webScanResults_[i].detectedType = detectedType;
-                webScanResults_[i].advertisedServices = advertisedServices;
-            }
-            return true;
-        }
-    }
-
-    if (webScanResultCount_ >= MAX_WEB_SCAN_RESULTS) {
-        return false;
-    }
-
-    webScanResults_[webScanResultCount_].mac = mac;
-    webScanResults_[webScanResultCount_].name = name;
-    webScanResults_[webScanResultCount_].rssi = rssi;
-    webScanResults_[webScanResultCount_].detectedType = detectedType;
-    webScanResults_[webScanResultCount_].advertisedServices = advertisedServices;
-    webScanResultCount_++;
-    return true;
-}
-
 bool BluetoothBms::isValidMacAddress(const String& macAddress) const {
     if (macAddress.length() != 17) {
         return false;
@@ -2,9 +2,14 @@
 #define BLUETOOTH_BMS_H
 
 #include <Arduino.h>
+#include <Preferences.h>
 #include <stdint.h>
-
-class BLEScanResults;
+#include <freertos/FreeRTOS.h>
+#include <esp_gap_ble_api.h>
+#include "BmsCellTracker.h"
+#include "BmsDriver.h"
+#include "BmsScanTable.h"
+#include "../Settings/Settings.h"
 
 enum BluetoothBmsScanStatus : uint8_t {
     BluetoothBmsScanIdle = 0,
@@ -13,61 +18,108 @@ enum BluetoothBmsScanStatus : uint8_t {
     BluetoothBmsScanError = 3
 };
 
-struct BluetoothBmsScanResult {
-    String mac;
-    String name;
-    int rssi;
-    uint8_t detectedType;
-    String advertisedServices;
-};
-
+/**
+ * The Bluetooth BMSs as the rest of the firmware sees them: up to
+ * kMaxBmsPacks packs flown in parallel, each with its own driver (any mix
+ * of protocols). The battery-wide getters combine the packs; the getPack*
+ * ones read one.
+ *
+ * Each pack's cell frames also feed a BmsCellTracker (per-cell sag and
+ * minimum this flight, reset on arming); every disarm folds the flight's
+ * sag into a baseline per BMS MAC, kept in NVS ("bmstrend") by a writer
+ * task, so a cell degrading across flights stands out.
+ *
+ * The config page's scan runs alongside: passive, in short bursts between
+ * the drivers' connects (BmsGattLink::ConnectTurn), with advertising and
+ * the BMS links left up, reports collected into a BmsScanTable.
+ */
 class BluetoothBms {
 public:
     void init();
     void update();
 
+    // Every selected pack connected / any pack has data
     bool isConnected() const;
     bool hasData() const;
     bool hasCellData() const;
     const char* getConnectionState() const;
 
-    uint32_t getPackVoltageMilliVolts() const;
-    int32_t getPackCurrentMilliAmps() const;
-    uint8_t getSoCPercent() const;
-    uint8_t getCellCount() const;
-    uint8_t getTempCount() const;
-    int16_t getTempCelsius(uint8_t index) const;
+    // Any task. Copies the selected drivers' last published readings (pack,
+    // cells, temperatures and their min/max) so every field comes from the
+    // same frame; with two packs they are combined as parallel packs
+    // (BmsSnapshot::combineParallel). Returns out.hasData; cleared when no
+    // BMS is selected.
+    bool getSnapshot(BmsSnapshot& out) const;
 
-    uint16_t getCellVoltageMilliVolts(uint8_t index) const;
-    uint16_t getCellMinMilliVolts() const;
-    uint16_t getCellMaxMilliVolts() const;
-    uint16_t getCellDeltaMilliVolts() const;
+    // Packs with a BMS selected
+    uint8_t getPackCount() const;
+    // Per pack (0 .. kMaxBmsPacks-1); an unselected pack reads as BmsTypeNone,
+    // "none", no data.
+    uint8_t getPackType(uint8_t pack) const;
+    bool isPackConnected(uint8_t pack) const;
+    bool packHasData(uint8_t pack) const;
+    const char* getPackState(uint8_t pack) const;
+    bool getPackSnapshot(uint8_t pack, BmsSnapshot& out) const;
+    // Any task: the pack's sag and cell minimums this flight, with the stored
+    // baseline for its MAC. False before the flight's first cell frame.
+    bool getPackCellTrend(uint8_t pack, BmsCellTrendReport& out) const;
+    // BmsPollLevel the active driver polls at
+    uint8_t getPollLevel() const { return pollPolicy_.level(); }
 
     bool startWebScan();
     void clearWebScanResults();
     uint8_t getWebScanStatus() const;
     const char* getWebScanError() const;
-    uint8_t getWebScanResultCount() const;
-    const BluetoothBmsScanResult* getWebScanResults() const;
+    // Any task: copies the devices heard so far (the scan keeps adding to
+    // them while it runs); returns how many.
+    uint8_t copyWebScanResults(BmsScanEntry* out, uint8_t cap) const;
     bool isWebScanBusy() const;
     uint8_t detectBmsTypeByMac(const String& macAddress);
 
 private:
-    static const uint8_t MAX_WEB_SCAN_RESULTS = 16;
-
-    uint8_t getActiveType() const;
+    void applySettings();
+    void updatePollLevel();
+    void updateCellTrackers();
+    void commitCellTrends();
+    static void trendWriterTask(void* arg);
+    void writeCellTrends();
+    void updateWebScan();
+    void endScanBurst();
     void resetWebScanState(uint8_t status);
     void pauseTelemetryAdvertisingForScan();
     void resumeTelemetryAdvertisingAfterScan();
-    void completeWebScan();
-    static void onWebScanComplete(BLEScanResults scanResults);
-    bool tryStoreScanResult(const String& mac, const String& name, int rssi, uint8_t detectedType, const String& advertisedServices);
+    static void onGapEvent(esp_gap_ble_cb_event_t event, esp_ble_gap_cb_param_t* param);
     bool isValidMacAddress(const String& macAddress) const;
 
+    // Swapped by the loop when the BMS settings change; read by any task.
+    // The drivers are globals, so a stale pointer is still a valid one.
+    const BmsDriver* volatile active_[kMaxBmsPacks] = {};
+    uint32_t appliedRevision_ = 0;          // Settings::getBmsRevision() last applied
+    volatile bool driversStale_ = true;     // re-apply on the next update() (boot, after a type probe)
+    bool wasConnected_[kMaxBmsPacks] = {};   // for the event journal's link edges
+    BmsPollPolicy pollPolicy_;
+    BmsCellTracker cellTrackers_[kMaxBmsPacks];      // loop only
+    uint32_t trackedCellMillis_[kMaxBmsPacks] = {};  // cellMillis last fed to the tracker
+    bool wasArmed_ = false;                          // arming resets the trackers, a disarm commits them
+    Preferences trendPrefs_;                         // init, then the writer task only
+    TaskHandle_t trendWriterTask_ = nullptr;         // notified when cellTrends_ changed
+    // Under trendLock_: the loop writes, the web server reads
+    BmsCellTrendReport cellReports_[kMaxBmsPacks] = {};  // flight part, as of the last cell frame
+    uint8_t trackedMac_[kMaxBmsPacks][6] = {};
+    bool trackedMacValid_[kMaxBmsPacks] = {};
+    BmsCellTrendStore cellTrends_;
+    mutable portMUX_TYPE trendLock_ = portMUX_INITIALIZER_UNLOCKED;
+    uint32_t lastPollEvalMillis_ = 0;
     uint8_t webScanStatus_ = BluetoothBmsScanIdle;
     char webScanError_[64] = {0};
-    BluetoothBmsScanResult webScanResults_[MAX_WEB_SCAN_RESULTS];
-    uint8_t webScanResultCount_ = 0;
+    uint32_t webScanEndMillis_ = 0;
+    uint32_t nextBurstMillis_ = 0;
+    uint32_t burstStartMillis_ = 0;
+    bool burstRunning_ = false;             // loop: holds the connect turn
+    volatile bool burstScanning_ = false;   // set by the loop, cleared by the GAP handler
+    volatile bool burstFailed_ = false;
+    BmsScanTable scanTable_;                // under scanLock_: BLE host task writes, web reads
+    mutable portMUX_TYPE scanLock_ = portMUX_INITIALIZER_UNLOCKED;
     bool telemetryAdvertisingPausedForScan_ = false;
 };
 
@@ -0,0 +1,292 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include "BmsSnapshot.h"
+
+// Per-cell health from the BMS cell frames -- no Arduino deps, host-testable.
+//
+// A snapshot only says how the cells stand now; a cell that degrades over
+// weeks shows first as more sag than its neighbours under the same current.
+// BmsCellTracker follows one pack through a session (a flight: the owner
+// resets it on arming), one cell frame at a time: each cell's sag as ΔV/ΔI
+// between consecutive frames (its internal resistance, smoothed) and its
+// lowest voltage. BmsCellTrendStore keeps a baseline of that sag per BMS
+// MAC across sessions, folded in once per flight. Fixed memory throughout:
+// no frame is stored beyond the last one.
+
+// A session's view of one pack, plus the stored baseline, as the web
+// server reads it.
+struct BmsCellTrendReport {
+    uint8_t  cellCount;            // 0: no cell frame yet
+    uint16_t samples;              // ΔV/ΔI pairs taken this session
+    uint16_t sessions;             // sessions in the baseline, 0 without one
+    uint16_t maxDeltaMv;           // widest cell spread this session
+    uint16_t sagUohm[BmsSnapshot::kMaxCells];       // this session, µΩ
+    uint16_t baselineUohm[BmsSnapshot::kMaxCells];  // across sessions, µΩ
+    uint16_t minMv[BmsSnapshot::kMaxCells];         // this session, 0 = never reported
+
+    // The cell that sags the most, BmsSnapshot::kNoCell before any sample.
+    uint8_t weakestCell() const {
+        if (samples == 0) return BmsSnapshot::kNoCell;
+        uint8_t weakest = BmsSnapshot::kNoCell;
+        for (uint8_t i = 0; i < cellCount && i < BmsSnapshot::kMaxCells; i++) {
+            if (weakest == BmsSnapshot::kNoCell || sagUohm[i] > sagUohm[weakest]) weakest = i;
+        }
+        return weakest;
+    }
+};
+
+class BmsCellTracker {
+public:
+    static const uint8_t kMaxCells = BmsSnapshot::kMaxCells;
+    // A current step smaller than this is mostly measurement noise
+    static const int32_t kMinStepMilliAmps = 5000;
+    // Frames further apart than this: the SoC moved as well, not only the load
+    static const uint32_t kMaxGapMs = 5000;
+    // The current must come from (about) the moment the cells were read
+    static const uint32_t kMaxSkewMs = 1000;
+    // Per-sample clamp; a cell past 60 mΩ is flagged either way
+    static const uint16_t kMaxSagUohm = 60000;
+    // Each sample moves a cell's sag an eighth of the way to its own
+    static const uint8_t kSagWeight = 8;
+
+    BmsCellTracker() { reset(); }
+
+    void reset() { memset(this, 0, sizeof(*this)); }
+
+    // One published snapshot with new cell voltages (a new cellMillis).
+    // Returns true if it gave a ΔV/ΔI sample. A change in the cell count
+    // (another pack) starts the session over.
+    bool observe(const BmsSnapshot& s) {
+        if (!s.hasData || !s.hasCellData) return false;
+        const uint8_t cells = s.cellCount < kMaxCells ? s.cellCount : kMaxCells;
+        if (cells == 0) return false;
+        if (cells != cellCount_) {
+            reset();
+            cellCount_ = cells;
+        }
+
+        for (uint8_t i = 0; i < cells; i++) {
+            const uint16_t v = s.cellVoltagesMv[i];
+            if (v != 0 && (minMv_[i] == 0 || v < minMv_[i])) minMv_[i] = v;
+        }
+        if (s.cellDeltaMv > maxDeltaMv_) maxDeltaMv_ = s.cellDeltaMv;
+
+        const int32_t skew = (int32_t)(s.cellMillis - s.dataMillis);
+        const bool inStep = skew <= (int32_t)kMaxSkewMs && skew >= -(int32_t)kMaxSkewMs;
+        bool sampled = false;
+        if (inStep && havePrevious_ && (uint32_t)(s.cellMillis - prevMillis_) <= kMaxGapMs) {
+            const int32_t deltaMa = s.packCurrentMilliAmps - prevCurrentMa_;
+            if (deltaMa >= kMinStepMilliAmps || deltaMa <= -kMinStepMilliAmps) {
+                addSample(s.cellVoltagesMv, deltaMa);
+                sampled = true;
+            }
+        }
+
+        // Out of step, the frame's current is not the cells' current: no
+        // pair starts from it
+        havePrevious_ = inStep;
+        if (inStep) {
+            memcpy(prevMv_, s.cellVoltagesMv, sizeof(prevMv_));
+            prevCurrentMa_ = s.packCurrentMilliAmps;
+            prevMillis_ = s.cellMillis;
+        }
+        return sampled;
+    }
+
+    uint8_t cellCount() const { return cellCount_; }
+    uint16_t samples() const { return samples_; }
+    const uint16_t* sagUohm() const { return sagUohm_; }
+
+    // Fills the session part; the baseline is BmsCellTrendStore's.
+    void report(BmsCellTrendReport& out) const {
+        out.cellCount = cellCount_;
+        out.samples = samples_;
+        out.maxDeltaMv = maxDeltaMv_;
+        memcpy(out.sagUohm, sagUohm_, sizeof(out.sagUohm));
+        memcpy(out.minMv, minMv_, sizeof(out.minMv));
+    }
+
+private:
+    // R = ΔV/ΔI per cell: both go down together as the discharge grows
+    // (the current is negative then), so a healthy cell reads positive.
+    // Noise can push one sample below 0; it is clamped, not dropped, so
+    // the smoothing stays unbiased towards the weaker cells.
+    void addSample(const uint16_t* cellMv, int32_t deltaMa) {
+        for (uint8_t i = 0; i < cellCount_; i++) {
+            if (cellMv[i] == 0 || prevMv_[i] == 0) continue;
+            const int64_t deltaMv = (int64_t)cellMv[i] - prevMv_[i];
+            int64_t uohm = deltaMv * 1000000 / deltaMa;
+            if (uohm < 0) uohm = 0;
+            if (uohm > kMaxSagUohm) uohm = kMaxSagUohm;
+            if (samples_ == 0) {
+                sagUohm_[i] = (uint16_t)uohm;
+            } else {
+                sagUohm_[i] = (uint16_t)(sagUohm_[i] + ((int32_t)uohm - sagUohm_[i]) / kSagWeight);
+            }
+        }
+        if (samples_ < UINT16_MAX) samples_++;
+    }
+
+    uint8_t  cellCount_;
+    bool     havePrevious_;
+    uint16_t samples_;
+    uint16_t maxDeltaMv_;
+    int32_t  prevCurrentMa_;
+    uint32_t prevMillis_;
+    uint16_t prevMv_[kMaxCells];
+    uint16_t sagUohm_[kMaxCells];
+    uint16_t minMv_[kMaxCells];
+};
+
+// Sag baselines keyed by MAC and cell count, least recently recorded
+// replaced. Not thread-safe: BluetoothBms serialises access and mirrors it
+// to NVS with serialize()/deserialize(), as BmsGattCache does for handles.
+class BmsCellTrendStore {
+public:
+    static const size_t kEntries = 4;
+    static const uint8_t kVersion = 1;
+    static const uint8_t kMaxCells = BmsSnapshot::kMaxCells;
+    // Each session moves the baseline a quarter of the way to its own sag
+    static const uint8_t kBaselineWeight = 4;
+    static const size_t kEntryBytes = 6 + 1 + 2 + kMaxCells * 2;
+    static const size_t kSerializedMax = 2 + kEntries * kEntryBytes;
+
+    BmsCellTrendStore() { clear(); }
+
+    void clear() {
+        memset(entries_, 0, sizeof(entries_));
+        clock_ = 0;
+    }
+
+    // Fills out's baseline and sessions (zeroed without an entry).
+    bool lookup(const uint8_t mac[6], uint8_t cellCount, BmsCellTrendReport& out) const {
+        const Entry* e = find(mac, cellCount);
+        memset(out.baselineUohm, 0, sizeof(out.baselineUohm));
+        out.sessions = 0;
+        if (e == nullptr) return false;
+        memcpy(out.baselineUohm, e->baselineUohm, sizeof(out.baselineUohm));
+        out.sessions = e->sessions;
+        return true;
+    }
+
+    // Folds one session's sag into the pack's baseline; the first session
+    // of a pack is its baseline.
+    void record(const uint8_t mac[6], uint8_t cellCount, const uint16_t* sagUohm) {
+        if (cellCount == 0 || cellCount > kMaxCells) return;
+        Entry* e = find(mac, cellCount);
+        if (e == nullptr) {
+            e = &entries_[0];
+            for (Entry& candidate : entries_) {
+                if (!candidate.used) { e = &candidate; break; }
+                if (candidate.lastUse < e->lastUse) e = &candidate;
+            }
+            memset(e, 0, sizeof(*e));
+            memcpy(e->mac, mac, 6);
+            e->cellCount = cellCount;
+            e->used = true;
+        }
+        for (uint8_t i = 0; i < cellCount; i++) {
+            if (e->sessions == 0) {
+                e->baselineUohm[i] = sagUohm[i];
+            } else {
+                e->baselineUohm[i] = (uint16_t)(e->baselineUohm[i]
+                    + ((int32_t)sagUohm[i] - e->baselineUohm[i]) / kBaselineWeight);
+            }
+        }
+        if (e->sessions < UINT16_MAX) e->sessions++;
+        e->lastUse = ++clock_;
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        for (const Entry& e : entries_) n += e.used ? 1 : 0;
+        return n;
+    }
+
+    // Version, count, then the entries most recently recorded first.
+    // Returns the bytes written, 0 if `cap` is short.
+    size_t serialize(uint8_t* out, size_t cap) const {
+        if (cap < kSerializedMax) return 0;
+        const Entry* order[kEntries];
+        size_t n = 0;
+        for (const Entry& e : entries_) {
+            if (!e.used) continue;
+            size_t at = n++;
+            while (at > 0 && order[at - 1]->lastUse < e.lastUse) {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = &e;
+        }
+        out[0] = kVersion;
+        out[1] = (uint8_t)n;
+        uint8_t* p = out + 2;
+        for (size_t i = 0; i < n; i++) {
+            const Entry& e = *order[i];
+            memcpy(p, e.mac, 6);
+            p[6] = e.cellCount;
+            putLE16(p + 7, e.sessions);
+            for (uint8_t c = 0; c < kMaxCells; c++) putLE16(p + 9 + c * 2, e.baselineUohm[c]);
+            p += kEntryBytes;
+        }
+        return (size_t)(p - out);
+    }
+
+    // Replaces the contents; false (and left empty) on a blob of another
+    // version or a truncated one.
+    bool deserialize(const uint8_t* in, size_t len) {
+        clear();
+        if (len < 2 || in[0] != kVersion || in[1] > kEntries) return false;
+        const size_t n = in[1];
+        if (len < 2 + n * kEntryBytes) return false;
+        const uint8_t* p = in + 2;
+        for (size_t i = 0; i < n; i++, p += kEntryBytes) {
+            Entry& e = entries_[i];
+            memcpy(e.mac, p, 6);
+            e.cellCount = p[6];
+            e.sessions = getLE16(p + 7);
+            for (uint8_t c = 0; c < kMaxCells; c++) e.baselineUohm[c] = getLE16(p + 9 + c * 2);
+            e.used = e.cellCount > 0 && e.cellCount <= kMaxCells && e.sessions > 0;
+            e.lastUse = (uint32_t)(n - i);
+        }
+        clock_ = (uint32_t)n;
+        return true;
+    }
+
+private:
+    struct Entry {
+        uint8_t mac[6];
+        uint8_t cellCount;
+        bool used;
+        uint16_t sessions;
+        uint32_t lastUse;
+        uint16_t baselineUohm[kMaxCells];
+    };
+
+    Entry entries_[kEntries];
+    uint32_t clock_;
+
+    const Entry* find(const uint8_t mac[6], uint8_t cellCount) const {
+        for (const Entry& e : entries_) {
+            if (e.used && e.cellCount == cellCount && memcmp(e.mac, mac, 6) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    Entry* find(const uint8_t mac[6], uint8_t cellCount) {
+        return const_cast<Entry*>(static_cast<const BmsCellTrendStore*>(this)->find(mac, cellCount));
+    }
+
+    static void putLE16(uint8_t* p, uint16_t v) {
+        p[0] = (uint8_t)(v & 0xFF);
+        p[1] = (uint8_t)(v >> 8);
+    }
+
+    static uint16_t getLE16(const uint8_t* p) {
+        return (uint16_t)(p[0] | (uint16_t)p[1] << 8);
+    }
+};
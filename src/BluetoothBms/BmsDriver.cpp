@@ -0,0 +1,21 @@
+#include "BmsDriver.h"
+
+BmsSnapshotSlot::BmsSnapshotSlot() {
+    snapshot_.clear();
+    portMUX_INITIALIZE(&lock_);
+}
+
+void BmsSnapshotSlot::publish(BmsSnapshot& frame, bool cellsParsed) {
+    frame.updateDerived(cellsParsed);
+    portENTER_CRITICAL(&lock_);
+    frame.updateLoadMin(snapshot_, cellsParsed);
+    snapshot_ = frame;
+    portEXIT_CRITICAL(&lock_);
+}
+
+bool BmsSnapshotSlot::read(BmsSnapshot& out) const {
+    portENTER_CRITICAL(&lock_);
+    out = snapshot_;
+    portEXIT_CRITICAL(&lock_);
+    return out.hasData;
+}
@@ -0,0 +1,54 @@
+#ifndef BMS_DRIVER_H
+#define BMS_DRIVER_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include "BmsPollPolicy.h"
+#include "BmsSnapshot.h"
+
+/**
+ * BLE BMS driver interface: function pointers for runtime dispatch, one
+ * table per protocol (JBD, Daly, JK) in BluetoothBms.cpp. BluetoothBms
+ * keeps a pointer to the selected one and only swaps it when the BMS
+ * settings change.
+ */
+struct BmsDriver {
+    uint8_t type;                            // Settings BmsType*
+    void (*init)(void);                      // idempotent
+    void (*update)(void);                    // loop only
+    void (*setEnabled)(bool enabled);
+    void (*setMacAddress)(const String& macAddress);
+    bool (*isConnected)(void);
+    const char* (*getStateName)(void);       // "idle", "connecting", "connected"
+    bool (*hasData)(void);
+    bool (*hasCellData)(void);
+    bool (*readSnapshot)(BmsSnapshot& out);  // any task; returns out.hasData
+    void (*setPollLevel)(uint8_t level);     // BmsPollLevel, loop only
+};
+
+/**
+ * The snapshot a driver last published. The driver publishes after every
+ * parsed frame (from the loop, or from its connect task on a reset); the
+ * web server reads it: copied whole under a spinlock.
+ */
+class BmsSnapshotSlot {
+public:
+    BmsSnapshotSlot();
+
+    /** Derives the cell/temperature summary of `frame` and carries the
+     *  cells' load-min history over to it, then stores it. `cellsParsed`:
+     *  false for a frame without new cell voltages, which keeps the cell
+     *  statistics of the last one. */
+    void publish(BmsSnapshot& frame, bool cellsParsed = true);
+    /** Any task. Returns out.hasData. */
+    bool read(BmsSnapshot& out) const;
+
+    bool hasData() const { return snapshot_.hasData; }
+    bool hasCellData() const { return snapshot_.hasCellData; }
+
+private:
+    BmsSnapshot snapshot_;
+    mutable portMUX_TYPE lock_;
+};
+
+#endif // BMS_DRIVER_H
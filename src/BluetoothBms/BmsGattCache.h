@@ -0,0 +1,196 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// What a BMS's first full GATT discovery found, kept per MAC so a
+// reconnect can subscribe and write straight away -- no Arduino deps,
+// host-testable. The BLE modules in these BMSs have a fixed attribute
+// table, so the handles hold across connections and reboots of either
+// side; BmsGattLink drops an entry that stops producing frames.
+struct BmsGattHandles {
+    uint16_t rxHandle;    // notify characteristic value
+    uint16_t txHandle;    // write characteristic value (== rxHandle on JK)
+    uint16_t cccdHandle;  // 0x2902 of rxHandle, 0 if the BMS has none
+    uint16_t mtu;         // ATT MTU the link settled on
+    uint8_t  addrType;    // esp_ble_addr_type_t the connect succeeded with
+
+    bool valid() const { return rxHandle != 0 && txHandle != 0; }
+};
+
+// A few entries keyed by MAC and BMS type (a MAC re-selected as another
+// type must not reuse handles), least recently used replaced. Not
+// thread-safe: BmsGattLink serialises access and mirrors it to NVS with
+// serialize()/deserialize().
+class BmsGattCache {
+public:
+    static const size_t kEntries = 4;
+    static const uint8_t kVersion = 1;
+    static const size_t kEntryBytes = 6 + 1 + 1 + 4 * 2;
+    static const size_t kSerializedMax = 2 + kEntries * kEntryBytes;
+
+    BmsGattCache() { clear(); }
+
+    void clear() {
+        memset(entries_, 0, sizeof(entries_));
+        clock_ = 0;
+    }
+
+    // "AA:BB:CC:DD:EE:FF", either case; false for anything else.
+    static bool parseMac(const char* text, uint8_t out[6]) {
+        if (text == nullptr || strlen(text) != 17) return false;
+        for (int i = 0; i < 6; i++) {
+            const char* p = text + i * 3;
+            const int hi = hexValue(p[0]);
+            const int lo = hexValue(p[1]);
+            if (hi < 0 || lo < 0 || (i < 5 && p[2] != ':')) return false;
+            out[i] = (uint8_t)(hi << 4 | lo);
+        }
+        return true;
+    }
+
+    // Copies the entry to `out` and marks it recently used.
+    bool lookup(const uint8_t mac[6], uint8_t bmsType, BmsGattHandles& out) {
+        Entry* e = find(mac, bmsType);
+        if (e == nullptr) return false;
+        e->lastUse = ++clock_;
+        out = e->handles;
+        return true;
+    }
+
+    // True if the cache changed (new entry or different handles), i.e.
+    // worth persisting. Invalid handles are not stored.
+    bool store(const uint8_t mac[6], uint8_t bmsType, const BmsGattHandles& handles) {
+        if (!handles.valid()) return false;
+        Entry* e = find(mac, bmsType);
+        if (e != nullptr) {
+            e->lastUse = ++clock_;
+            if (sameHandles(e->handles, handles)) return false;
+            e->handles = handles;
+            return true;
+        }
+        e = &entries_[0];
+        for (Entry& candidate : entries_) {
+            if (!candidate.used) { e = &candidate; break; }
+            if (candidate.lastUse < e->lastUse) e = &candidate;
+        }
+        memcpy(e->mac, mac, 6);
+        e->bmsType = bmsType;
+        e->handles = handles;
+        e->used = true;
+        e->lastUse = ++clock_;
+        return true;
+    }
+
+    // Drops the entry; true if there was one.
+    bool forget(const uint8_t mac[6], uint8_t bmsType) {
+        Entry* e = find(mac, bmsType);
+        if (e == nullptr) return false;
+        memset(e, 0, sizeof(*e));
+        return true;
+    }
+
+    size_t count() const {
+        size_t n = 0;
+        for (const Entry& e : entries_) n += e.used ? 1 : 0;
+        return n;
+    }
+
+    // Version, count, then the entries most recently used first, so the
+    // order survives a reload. Returns the bytes written, 0 if `cap` is short.
+    size_t serialize(uint8_t* out, size_t cap) const {
+        if (cap < kSerializedMax) return 0;
+        const Entry* order[kEntries];
+        size_t n = 0;
+        for (const Entry& e : entries_) {
+            if (!e.used) continue;
+            size_t at = n++;
+            while (at > 0 && order[at - 1]->lastUse < e.lastUse) {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = &e;
+        }
+        out[0] = kVersion;
+        out[1] = (uint8_t)n;
+        uint8_t* p = out + 2;
+        for (size_t i = 0; i < n; i++) {
+            const Entry& e = *order[i];
+            memcpy(p, e.mac, 6);
+            p[6] = e.bmsType;
+            p[7] = e.handles.addrType;
+            putLE16(p + 8, e.handles.rxHandle);
+            putLE16(p + 10, e.handles.txHandle);
+            putLE16(p + 12, e.handles.cccdHandle);
+            putLE16(p + 14, e.handles.mtu);
+            p += kEntryBytes;
+        }
+        return (size_t)(p - out);
+    }
+
+    // Replaces the contents; false (and left empty) on a blob of another
+    // version or a truncated one.
+    bool deserialize(const uint8_t* in, size_t len) {
+        clear();
+        if (len < 2 || in[0] != kVersion || in[1] > kEntries) return false;
+        const size_t n = in[1];
+        if (len < 2 + n * kEntryBytes) return false;
+        const uint8_t* p = in + 2;
+        for (size_t i = 0; i < n; i++, p += kEntryBytes) {
+            Entry& e = entries_[i];
+            memcpy(e.mac, p, 6);
+            e.bmsType = p[6];
+            e.handles.addrType = p[7];
+            e.handles.rxHandle = getLE16(p + 8);
+            e.handles.txHandle = getLE16(p + 10);
+            e.handles.cccdHandle = getLE16(p + 12);
+            e.handles.mtu = getLE16(p + 14);
+            e.used = e.handles.valid();
+            e.lastUse = (uint32_t)(n - i);
+        }
+        clock_ = (uint32_t)n;
+        return true;
+    }
+
+private:
+    struct Entry {
+        uint8_t mac[6];
+        uint8_t bmsType;
+        bool used;
+        uint32_t lastUse;
+        BmsGattHandles handles;
+    };
+
+    Entry entries_[kEntries];
+    uint32_t clock_;
+
+    Entry* find(const uint8_t mac[6], uint8_t bmsType) {
+        for (Entry& e : entries_) {
+            if (e.used && e.bmsType == bmsType && memcmp(e.mac, mac, 6) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    static bool sameHandles(const BmsGattHandles& a, const BmsGattHandles& b) {
+        return a.rxHandle == b.rxHandle && a.txHandle == b.txHandle && a.cccdHandle == b.cccdHandle
+            && a.mtu == b.mtu && a.addrType == b.addrType;
+    }
+
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static void putLE16(uint8_t* p, uint16_t v) {
+        p[0] = (uint8_t)(v & 0xFF);
+        p[1] = (uint8_t)(v >> 8);
+    }
+
+    static uint16_t getLE16(const uint8_t* p) {
+        return (uint16_t)(p[0] | (uint16_t)p[1] << 8);
+    }
+};
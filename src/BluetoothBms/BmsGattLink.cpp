@@ -0,0 +1,212 @@
+#include "BmsGattLink.h"
+#include "../config.h"
+#include <BLEClient.h>
+#include <BLEDevice.h>
+#include <cstring>
+
+namespace {
+constexpr char NVS_NAMESPACE[] = "bmsgatt";
+constexpr char NVS_KEY[] = "handles";
+constexpr uint16_t CCCD_UUID = 0x2902;
+} // namespace
+
+BmsGattLink::BmsGattLink() : begun_(false), connectMutex_(nullptr) {
+    memset(subs_, 0, sizeof(subs_));
+    portMUX_INITIALIZE(&lock_);
+}
+
+void BmsGattLink::begin() {
+    if (begun_) return;
+    begun_ = true;
+    connectMutex_ = xSemaphoreCreateMutex();
+    prefs_.begin(NVS_NAMESPACE, false);
+    uint8_t blob[BmsGattCache::kSerializedMax];
+    const size_t len = prefs_.getBytes(NVS_KEY, blob, sizeof(blob));
+    portENTER_CRITICAL(&lock_);
+    const bool loaded = len > 0 && cache_.deserialize(blob, len);
+    const size_t count = cache_.count();
+    portEXIT_CRITICAL(&lock_);
+    if (loaded) {
+        DEBUG_PRINT("[BMS] GATT handle cache loaded, entries: ");
+        DEBUG_PRINTLN(count);
+    }
+    (void)count;
+    BLEDevice::setCustomGattcHandler(onGattcEvent);
+}
+
+// ---------------------------------------------------------------------------
+// ConnectTurn — a BLE connect plus discovery keeps the radio busy for up to
+// seconds; two at once only slow each other down
+// ---------------------------------------------------------------------------
+BmsGattLink::ConnectTurn::ConnectTurn() {
+    if (bmsGattLink.connectMutex_ != nullptr) {
+        xSemaphoreTake(bmsGattLink.connectMutex_, portMAX_DELAY);
+    }
+}
+
+BmsGattLink::ConnectTurn::~ConnectTurn() {
+    if (bmsGattLink.connectMutex_ != nullptr) {
+        xSemaphoreGive(bmsGattLink.connectMutex_);
+    }
+}
+
+bool BmsGattLink::tryTakeConnectTurn() {
+    return connectMutex_ != nullptr && xSemaphoreTake(connectMutex_, 0) == pdTRUE;
+}
+
+void BmsGattLink::giveConnectTurn() {
+    if (connectMutex_ != nullptr) {
+        xSemaphoreGive(connectMutex_);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// discover — full ATT discovery, slow (hundreds of ms to seconds); connect tasks only
+// ---------------------------------------------------------------------------
+BmsGattLink::DiscoverResult BmsGattLink::discover(BLEClient* client, const char* serviceUuid,
+                                                  const char* rxUuid, const char* txUuid,
+                                                  BmsGattHandles& out) {
+    memset(&out, 0, sizeof(out));
+    BLERemoteService* service = client->getService(serviceUuid);
+    if (service == nullptr) return DiscoverNoService;
+
+    BLERemoteCharacteristic* rx = service->getCharacteristic(rxUuid);
+    BLERemoteCharacteristic* tx = strcmp(rxUuid, txUuid) == 0 ? rx : service->getCharacteristic(txUuid);
+    if (rx == nullptr || tx == nullptr) return DiscoverNoCharacteristic;
+
+    BLERemoteDescriptor* cccd = rx->getDescriptor(BLEUUID(CCCD_UUID));
+    out.rxHandle = rx->getHandle();
+    out.txHandle = tx->getHandle();
+    out.cccdHandle = cccd != nullptr ? cccd->getHandle() : 0;
+    out.mtu = client->getMTU();
+    return DiscoverOk;
+}
+
+// ---------------------------------------------------------------------------
+// Handle cache
+// ---------------------------------------------------------------------------
+bool BmsGattLink::lookup(const char* mac, uint8_t bmsType, BmsGattHandles& out) {
+    uint8_t addr[6];
+    if (!BmsGattCache::parseMac(mac, addr)) return false;
+    portENTER_CRITICAL(&lock_);
+    const bool found = cache_.lookup(addr, bmsType, out);
+    portEXIT_CRITICAL(&lock_);
+    return found;
+}
+
+bool BmsGattLink::has(const char* mac, uint8_t bmsType) {
+    BmsGattHandles unused;
+    return lookup(mac, bmsType, unused);
+}
+
+void BmsGattLink::remember(const char* mac, uint8_t bmsType, const BmsGattHandles& handles) {
+    uint8_t addr[6];
+    if (!BmsGattCache::parseMac(mac, addr)) return;
+    portENTER_CRITICAL(&lock_);
+    const bool changed = cache_.store(addr, bmsType, handles);
+    portEXIT_CRITICAL(&lock_);
+    if (changed) persist();
+}
+
+void BmsGattLink::forget(const char* mac, uint8_t bmsType) {
+    uint8_t addr[6];
+    if (!BmsGattCache::parseMac(mac, addr)) return;
+    portENTER_CRITICAL(&lock_);
+    const bool changed = cache_.forget(addr, bmsType);
+    portEXIT_CRITICAL(&lock_);
+    if (changed) persist();
+}
+
+// Serialised under the lock, written to NVS (slow) outside it
+void BmsGattLink::persist() {
+    if (!begun_) return;
+    uint8_t blob[BmsGattCache::kSerializedMax];
+    portENTER_CRITICAL(&lock_);
+    const size_t len = cache_.serialize(blob, sizeof(blob));
+    portEXIT_CRITICAL(&lock_);
+    if (len > 0) prefs_.putBytes(NVS_KEY, blob, len);
+}
+
+// ---------------------------------------------------------------------------
+// subscribe — register for notifications and enable them in the CCCD.
+// Both are queued in the BLE stack, nothing here waits for the BMS.
+// ---------------------------------------------------------------------------
+bool BmsGattLink::subscribe(BLEClient* client, const BmsGattHandles& handles, NotifyFn onNotify, void* ctx) {
+    if (client == nullptr || !handles.valid()) return false;
+    BLEAddress peerAddress = client->getPeerAddress();
+    esp_bd_addr_t peer;
+    memcpy(peer, *peerAddress.getNative(), sizeof(peer));
+
+    // Routed before the CCCD write, so the first notification finds it
+    bool added = false;
+    portENTER_CRITICAL(&lock_);
+    Subscription* slot = nullptr;
+    for (Subscription& s : subs_) {
+        if (s.ctx == ctx) { slot = &s; break; }
+        if (slot == nullptr && s.ctx == nullptr) slot = &s;
+    }
+    if (slot != nullptr) {
+        slot->ctx = ctx;
+        slot->onNotify = onNotify;
+        memcpy(slot->peer, peer, sizeof(peer));
+        slot->rxHandle = handles.rxHandle;
+        added = true;
+    }
+    portEXIT_CRITICAL(&lock_);
+    if (!added) return false;
+
+    const esp_gatt_if_t gattcIf = client->getGattcIf();
+    bool ok = esp_ble_gattc_register_for_notify(gattcIf, peer, handles.rxHandle) == ESP_OK;
+    if (ok && handles.cccdHandle != 0) {
+        uint8_t notifyOn[2] = {0x01, 0x00};
+        ok = esp_ble_gattc_write_char_descr(gattcIf, client->getConnId(), handles.cccdHandle,
+                                            sizeof(notifyOn), notifyOn,
+                                            ESP_GATT_WRITE_TYPE_RSP, ESP_GATT_AUTH_REQ_NONE) == ESP_OK;
+    }
+    if (!ok) unsubscribe(ctx);
+    return ok;
+}
+
+void BmsGattLink::unsubscribe(void* ctx) {
+    portENTER_CRITICAL(&lock_);
+    for (Subscription& s : subs_) {
+        if (s.ctx == ctx) memset(&s, 0, sizeof(s));
+    }
+    portEXIT_CRITICAL(&lock_);
+}
+
+bool BmsGattLink::write(BLEClient* client, uint16_t handle, const uint8_t* data, size_t len) {
+    if (client == nullptr || handle == 0 || !client->isConnected()) return false;
+    return esp_ble_gattc_write_char(client->getGattcIf(), client->getConnId(), handle, (uint16_t)len,
+                                    const_cast<uint8_t*>(data), ESP_GATT_WRITE_TYPE_NO_RSP,
+                                    ESP_GATT_AUTH_REQ_NONE) == ESP_OK;
+}
+
+// ---------------------------------------------------------------------------
+// GATTC events — BLE host task, after BLEDevice has dispatched them to its clients
+// ---------------------------------------------------------------------------
+void BmsGattLink::onGattcEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t* param) {
+    (void)gattcIf;
+    if (event == ESP_GATTC_NOTIFY_EVT && param != nullptr) {
+        bmsGattLink.dispatchNotify(param);
+    }
+}
+
+void BmsGattLink::dispatchNotify(const esp_ble_gattc_cb_param_t* param) {
+    if (param->notify.value == nullptr || param->notify.value_len == 0) return;
+    NotifyFn onNotify = nullptr;
+    void* ctx = nullptr;
+    portENTER_CRITICAL(&lock_);
+    for (const Subscription& s : subs_) {
+        if (s.ctx != nullptr && s.rxHandle == param->notify.handle
+            && memcmp(s.peer, param->notify.remote_bda, sizeof(s.peer)) == 0) {
+            onNotify = s.onNotify;
+            ctx = s.ctx;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock_);
+    if (onNotify != nullptr) {
+        onNotify(ctx, param->notify.value, param->notify.value_len);
+    }
+}
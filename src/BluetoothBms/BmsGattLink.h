@@ -0,0 +1,104 @@
+#ifndef BMS_GATT_LINK_H
+#define BMS_GATT_LINK_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include <esp_gattc_api.h>
+#include "BmsGattCache.h"
+
+class BLEClient;
+
+/**
+ * GATT plumbing shared by the BLE BMS drivers, by attribute handle instead
+ * of through BLERemoteCharacteristic objects: those only exist after a full
+ * service discovery, handles can come from the cache.
+ *
+ * - discover(): the usual getService/getCharacteristic/getDescriptor walk,
+ *   reduced to BmsGattHandles.
+ * - lookup()/remember()/forget(): handles per MAC and BMS type, in RAM and
+ *   in NVS ("bmsgatt"), so a reconnect -- even the first after a reboot --
+ *   subscribes without discovery.
+ * - subscribe()/write(): notification routing and writes on raw handles.
+ *   Notifications are taken from a custom GATTC handler and passed to the
+ *   subscriber's callback on the BLE host task; it must not block.
+ * - ConnectTurn: with two packs, their connect tasks take turns, so the one
+ *   radio runs a single connect and discovery at a time; scan bursts take a
+ *   turn too.
+ */
+class BmsGattLink {
+public:
+    typedef void (*NotifyFn)(void* ctx, uint8_t* data, size_t len);
+
+    enum DiscoverResult : uint8_t {
+        DiscoverOk,
+        DiscoverNoService,
+        DiscoverNoCharacteristic
+    };
+
+    /** Held by a connect task for one attempt (connect, discovery,
+     *  subscribe): blocks until no other driver is connecting. */
+    class ConnectTurn {
+    public:
+        ConnectTurn();
+        ~ConnectTurn();
+    private:
+        ConnectTurn(const ConnectTurn&);
+        ConnectTurn& operator=(const ConnectTurn&);
+    };
+
+    BmsGattLink();
+
+    /** ConnectTurn for a holder that spans several loop passes (the BMS
+     *  scanner's bursts): never blocks. Given back from the same task. */
+    bool tryTakeConnectTurn();
+    void giveConnectTurn();
+
+    /** Loads the NVS cache and hooks the GATTC handler. Idempotent. */
+    void begin();
+
+    /** Connected client: walks the service for the rx (notify) and tx (write)
+     *  characteristics; rxUuid == txUuid for a single bidirectional one. */
+    DiscoverResult discover(BLEClient* client, const char* serviceUuid,
+                            const char* rxUuid, const char* txUuid, BmsGattHandles& out);
+
+    bool lookup(const char* mac, uint8_t bmsType, BmsGattHandles& out);
+    bool has(const char* mac, uint8_t bmsType);
+    /** Stores and, if it changed anything, persists. Call from a task that may block. */
+    void remember(const char* mac, uint8_t bmsType, const BmsGattHandles& handles);
+    void forget(const char* mac, uint8_t bmsType);
+
+    /** Routes rxHandle notifications from the client's peer to onNotify(ctx, ...)
+     *  and writes the CCCD. One subscription per ctx; a new one replaces it. */
+    bool subscribe(BLEClient* client, const BmsGattHandles& handles, NotifyFn onNotify, void* ctx);
+    void unsubscribe(void* ctx);
+
+    /** Write without response, returns once queued in the BLE stack. */
+    bool write(BLEClient* client, uint16_t handle, const uint8_t* data, size_t len);
+
+private:
+    // One per BMS driver that can be connected at the same time
+    // (Settings kMaxBmsPacks)
+    static const size_t kMaxSubscriptions = 2;
+
+    struct Subscription {
+        void* ctx;
+        NotifyFn onNotify;
+        esp_bd_addr_t peer;
+        uint16_t rxHandle;
+    };
+
+    static void onGattcEvent(esp_gattc_cb_event_t event, esp_gatt_if_t gattcIf, esp_ble_gattc_cb_param_t* param);
+    void dispatchNotify(const esp_ble_gattc_cb_param_t* param);
+    void persist();
+
+    bool begun_;
+    SemaphoreHandle_t connectMutex_;        // ConnectTurn
+    Preferences prefs_;
+    BmsGattCache cache_;                    // under lock_
+    Subscription subs_[kMaxSubscriptions];  // under lock_
+    mutable portMUX_TYPE lock_;
+};
+
+#endif // BMS_GATT_LINK_H
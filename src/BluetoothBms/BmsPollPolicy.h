@@ -0,0 +1,162 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// How often the BMS drivers ask for data -- no Arduino deps,
+// host-testable. Times are millis(), wrap-safe.
+//
+// BmsPollPolicy picks a level from the flight state: Idle while disarmed,
+// Cruise when armed, High when the pack is working hard or close to the
+// limiter's floor -- that is when the limiter needs fresh sag data.
+// BluetoothBms evaluates it from the loop and hands the level to the
+// active driver, which spaces its requests with a BmsPollSchedule.
+enum BmsPollLevel : uint8_t {
+    BmsPollIdle = 0,
+    BmsPollCruise = 1,
+    BmsPollHigh = 2
+};
+
+inline const char* bmsPollLevelName(uint8_t level) {
+    switch (level) {
+        case BmsPollCruise: return "cruise";
+        case BmsPollHigh:   return "high";
+        default:            return "idle";
+    }
+}
+
+struct BmsPollInputs {
+    bool     armed;
+    bool     batteryLimited;   // Power's battery limiter is cutting power
+    uint32_t currentMilliAmps; // magnitude, 0 if unknown
+    uint32_t voltageMilliVolts;// pack, 0 if unknown
+    uint16_t minVoltageMv;     // Settings battery range
+    uint16_t maxVoltageMv;
+    uint16_t capacityMah;      // 0 disables the load criterion
+};
+
+class BmsPollPolicy {
+public:
+    // High load: at or above this many C
+    static const uint32_t kHighLoadC = 2;
+    // Near the floor: within this share of the min..max range above min
+    static const uint32_t kNearFloorPercent = 20;
+    // High is held this long after its cause went away, so a pumping
+    // throttle does not flip the rate on every request
+    static const uint32_t kHoldMs = 3000;
+
+    BmsPollPolicy() { reset(); }
+
+    void reset() {
+        level_ = BmsPollIdle;
+        highSinceMs_ = 0;
+        hasHigh_ = false;
+    }
+
+    // The level the inputs call for, without hysteresis.
+    static BmsPollLevel levelFor(const BmsPollInputs& in) {
+        if (!in.armed) return BmsPollIdle;
+        if (in.batteryLimited) return BmsPollHigh;
+        if (in.capacityMah > 0 && in.currentMilliAmps >= (uint32_t)in.capacityMah * kHighLoadC) {
+            return BmsPollHigh;
+        }
+        if (in.voltageMilliVolts > 0 && in.maxVoltageMv > in.minVoltageMv) {
+            const uint32_t margin = (uint32_t)(in.maxVoltageMv - in.minVoltageMv) * kNearFloorPercent / 100;
+            if (in.voltageMilliVolts <= in.minVoltageMv + margin) return BmsPollHigh;
+        }
+        return BmsPollCruise;
+    }
+
+    // Rises at once, drops out of High only after kHoldMs without a cause
+    // (a disarm drops straight to Idle).
+    BmsPollLevel update(const BmsPollInputs& in, uint32_t nowMs) {
+        const BmsPollLevel wanted = levelFor(in);
+        if (wanted == BmsPollHigh) {
+            hasHigh_ = true;
+            highSinceMs_ = nowMs;
+            level_ = BmsPollHigh;
+        } else if (level_ != BmsPollHigh || wanted == BmsPollIdle
+                   || !hasHigh_ || (uint32_t)(nowMs - highSinceMs_) >= kHoldMs) {
+            level_ = wanted;
+        }
+        return level_;
+    }
+
+    BmsPollLevel level() const { return level_; }
+
+private:
+    BmsPollLevel level_;
+    bool hasHigh_;
+    uint32_t highSinceMs_;   // last time a High cause was seen
+};
+
+// Request spacing for one driver. A request-response BMS has up to two
+// kinds of request: Pack (voltage, current, SoC) and Cells (per-cell
+// voltages); a BMS that answers both in one frame only uses Pack.
+class BmsPollSchedule {
+public:
+    enum Field : uint8_t { Pack = 0, Cells = 1, kFields = 2 };
+
+    // Between any two requests, so the BMS's answer to one is in before
+    // the next goes out
+    static const uint32_t kMinGapMs = 250;
+
+    // Per level: Idle, Cruise, High.
+    static uint32_t intervalMs(uint8_t level, Field field) {
+        static const uint32_t kPack[] = { 5000, 2000, 500 };
+        static const uint32_t kCells[] = { 10000, 4000, 1000 };
+        const uint8_t l = level <= BmsPollHigh ? level : (uint8_t)BmsPollHigh;
+        return field == Cells ? kCells[l] : kPack[l];
+    }
+
+    // A streaming BMS (JK) is only re-kicked after this long without a frame.
+    static uint32_t streamStallMs(uint8_t level) {
+        static const uint32_t kStall[] = { 5000, 3000, 1500 };
+        return kStall[level <= BmsPollHigh ? level : (uint8_t)BmsPollHigh];
+    }
+
+    explicit BmsPollSchedule(bool withCells = true) : withCells_(withCells) { reset(); }
+
+    // New link: everything is due at once.
+    void reset() {
+        for (uint8_t f = 0; f < kFields; f++) {
+            requested_[f] = false;
+            lastMs_[f] = 0;
+        }
+        anyRequested_ = false;
+        lastAnyMs_ = 0;
+    }
+
+    // The field to request now, or -1. Of the due fields the most overdue
+    // goes first, so neither starves when the interval is short.
+    int next(uint8_t level, uint32_t nowMs) const {
+        if (anyRequested_ && (uint32_t)(nowMs - lastAnyMs_) < kMinGapMs) return -1;
+        int best = -1;
+        int32_t bestOverdue = 0;
+        const uint8_t fields = withCells_ ? kFields : 1;
+        for (uint8_t f = 0; f < fields; f++) {
+            if (!requested_[f]) return f;
+            const int32_t overdue = (int32_t)(nowMs - lastMs_[f] - intervalMs(level, (Field)f));
+            if (overdue >= 0 && (best < 0 || overdue > bestOverdue)) {
+                best = f;
+                bestOverdue = overdue;
+            }
+        }
+        return best;
+    }
+
+    void onRequested(uint8_t field, uint32_t nowMs) {
+        if (field >= kFields) return;
+        requested_[field] = true;
+        lastMs_[field] = nowMs;
+        anyRequested_ = true;
+        lastAnyMs_ = nowMs;
+    }
+
+private:
+    bool withCells_;
+    bool requested_[kFields];
+    uint32_t lastMs_[kFields];
+    bool anyRequested_;
+    uint32_t lastAnyMs_;
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// When a BMS driver may start its next connect attempt -- no Arduino
+// deps, host-testable. Times are millis(), wrap-safe.
+//
+// A link that was up and dropped is retried at once, then after 250 ms,
+// 500 ms, 1 s ... doubling up to kMaxDelayMs: a BMS that moved out of
+// range for a moment is usually back within the first few tries. A BMS
+// never reached since the last reset() (off, wrong MAC) starts at
+// kColdFirstDelayMs and doubles to the same cap, so an absent pack does
+// not keep the radio busy.
+class BmsReconnectPolicy {
+public:
+    static const uint32_t kFastFirstDelayMs = 250;
+    static const uint32_t kColdFirstDelayMs = 2000;
+    static const uint32_t kMaxDelayMs = 10000;
+
+    BmsReconnectPolicy() { reset(); }
+
+    // New MAC, BMS disabled: forget the history, next attempt at once.
+    void reset() {
+        linkWasUp_ = false;
+        failures_ = 0;
+        hasLastEvent_ = false;
+        lastEventMs_ = 0;
+    }
+
+    // The driver subscribed: the next drop gets the fast schedule.
+    void onLinkUp() {
+        linkWasUp_ = true;
+        failures_ = 0;
+    }
+
+    // An established link dropped (or was dropped on purpose to retry).
+    void onLinkLost(uint32_t nowMs) {
+        failures_ = 0;
+        hasLastEvent_ = true;
+        lastEventMs_ = nowMs;
+    }
+
+    void onAttemptFailed(uint32_t nowMs) {
+        if (failures_ < 0xFF) failures_++;
+        hasLastEvent_ = true;
+        lastEventMs_ = nowMs;
+    }
+
+    uint32_t delayMs() const {
+        if (!hasLastEvent_ || failures_ == 0) return 0;
+        const uint32_t first = linkWasUp_ ? kFastFirstDelayMs : kColdFirstDelayMs;
+        uint32_t delay = first;
+        for (uint8_t i = 1; i < failures_ && delay < kMaxDelayMs; i++) delay <<= 1;
+        return delay < kMaxDelayMs ? delay : kMaxDelayMs;
+    }
+
+    bool due(uint32_t nowMs) const {
+        return !hasLastEvent_ || (uint32_t)(nowMs - lastEventMs_) >= delayMs();
+    }
+
+    uint8_t failures() const { return failures_; }
+    bool linkWasUp() const { return linkWasUp_; }
+
+private:
+    bool linkWasUp_;
+    uint8_t failures_;
+    bool hasLastEvent_;
+    uint32_t lastEventMs_;
+};
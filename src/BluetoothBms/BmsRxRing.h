@@ -0,0 +1,79 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// Byte ring between a BMS driver's BLE notify callback (producer, the BLE
+// host task) and its frame parser (consumer, the loop) -- no Arduino deps,
+// host-testable.
+//
+// Single producer, single consumer, wait-free on both sides: each side
+// owns one free-running index and only reads the other's, so the BLE host
+// task never waits for the loop. A notification that does not fit is
+// dropped whole and counted, and the bytes already queued -- a partial
+// frame among them -- stay intact for the parser.
+template <size_t Capacity>
+class BmsRxRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "capacity must be a power of two");
+
+public:
+    static const size_t kCapacity = Capacity;
+
+    BmsRxRing() : head_(0), tail_(0), dropped_(0) {}
+
+    // ---- producer (one task) ----
+
+    // All or nothing: false (and counted) if `len` bytes do not fit.
+    bool push(const uint8_t* data, size_t len) {
+        const uint32_t head = head_.load(std::memory_order_relaxed);
+        const uint32_t tail = tail_.load(std::memory_order_acquire);
+        if (len > Capacity - (head - tail)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        const size_t at = head & (Capacity - 1);
+        const size_t first = len < Capacity - at ? len : Capacity - at;
+        memcpy(buf_ + at, data, first);
+        memcpy(buf_, data + first, len - first);
+        head_.store(head + (uint32_t)len, std::memory_order_release);
+        return true;
+    }
+
+    // ---- consumer (one task) ----
+
+    // Moves up to `cap` of the oldest bytes to `out`; returns how many.
+    size_t pop(uint8_t* out, size_t cap) {
+        const uint32_t tail = tail_.load(std::memory_order_relaxed);
+        const uint32_t head = head_.load(std::memory_order_acquire);
+        size_t n = head - tail;
+        if (n > cap) n = cap;
+        const size_t at = tail & (Capacity - 1);
+        const size_t first = n < Capacity - at ? n : Capacity - at;
+        memcpy(out, buf_ + at, first);
+        memcpy(out + first, buf_, n - first);
+        tail_.store(tail + (uint32_t)n, std::memory_order_release);
+        return n;
+    }
+
+    // Drops everything queued so far (a new connection).
+    void clear() { tail_.store(head_.load(std::memory_order_acquire), std::memory_order_release); }
+
+    size_t size() const {
+        return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_relaxed);
+    }
+    bool empty() const { return size() == 0; }
+
+    // ---- either side ----
+
+    // Notifications dropped because the ring was full.
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    uint8_t buf_[Capacity];
+    std::atomic<uint32_t> head_;       // producer-owned: bytes ever pushed
+    std::atomic<uint32_t> tail_;       // consumer-owned: bytes ever popped
+    std::atomic<uint32_t> dropped_;
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// What the BMS scanner has heard -- no Arduino deps, host-testable.
+//
+// BluetoothBms runs a passive scan and hands every advertising report
+// (address, RSSI, raw AD structures) to BmsScanTable::observe() on the BLE
+// host task. A device is one entry however often it advertises: its RSSI
+// is smoothed over the reports and its protocol told by the service UUID
+// its BLE module advertises. No heap and no String: the table is all the
+// memory a scan takes.
+
+// Same values as Settings' BmsType.
+enum BmsScanProtocol : uint8_t {
+    BmsScanUnknown = 0,
+    BmsScanJbd = 1,
+    BmsScanDaly = 2,
+    BmsScanJk = 3
+};
+
+// The parts of one report's AD structures (advertising data, then scan
+// response if any) the scanner keeps.
+struct BmsAdvertisement {
+    static const uint8_t kNameMax = 24;    // NUL included; longer names are cut
+    static const uint8_t kMaxUuids = 6;
+
+    char     name[kNameMax];   // "" when the report has none
+    uint16_t uuids[kMaxUuids]; // 16-bit, and 128-bit ones on the Bluetooth base UUID
+    uint8_t  uuidCount;
+    uint8_t  otherUuids;       // 128-bit ones off the base UUID, or past kMaxUuids
+
+    // A malformed structure ends the parse; what came before it is kept.
+    static void parse(const uint8_t* data, size_t len, BmsAdvertisement& out) {
+        memset(&out, 0, sizeof(out));
+        // 0000xxxx-0000-1000-8000-00805F9B34FB, least significant byte
+        // first, without the 16-bit part and its two zero bytes
+        static const uint8_t kBaseUuidTail[12] = {
+            0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00
+        };
+        bool completeName = false;
+        size_t pos = 0;
+        while (pos < len) {
+            const uint8_t fieldLen = data[pos];
+            if (fieldLen == 0) break;                       // padding up to the end
+            if (pos + 1 + fieldLen > len) break;
+            const uint8_t type = data[pos + 1];
+            const uint8_t* value = data + pos + 2;
+            const size_t valueLen = fieldLen - 1;
+            switch (type) {
+                case 0x02:   // incomplete / complete list of 16-bit UUIDs
+                case 0x03:
+                    for (size_t i = 0; i + 2 <= valueLen; i += 2) {
+                        out.addUuid((uint16_t)(value[i] | value[i + 1] << 8));
+                    }
+                    break;
+                case 0x06:   // incomplete / complete list of 128-bit UUIDs
+                case 0x07:
+                    for (size_t i = 0; i + 16 <= valueLen; i += 16) {
+                        if (memcmp(value + i, kBaseUuidTail, sizeof(kBaseUuidTail)) == 0
+                            && value[i + 14] == 0 && value[i + 15] == 0) {
+                            out.addUuid((uint16_t)(value[i + 12] | value[i + 13] << 8));
+                        } else if (out.otherUuids < UINT8_MAX) {
+                            out.otherUuids++;
+                        }
+                    }
+                    break;
+                case 0x08:   // shortened / complete local name
+                case 0x09:
+                    if (type == 0x09 || !completeName) {
+                        const size_t n = valueLen < kNameMax - 1 ? valueLen : kNameMax - 1;
+                        memcpy(out.name, value, n);
+                        out.name[n] = '\0';
+                        completeName = type == 0x09;
+                    }
+                    break;
+                default:
+                    break;
+            }
+            pos += 1 + fieldLen;
+        }
+    }
+
+    // The BMS protocol the advertised services point to, in the order the
+    // config page has always checked them.
+    uint8_t protocol() const {
+        static const uint16_t kServices[] = { 0xFF00, 0xFFF0, 0xFFE0 };
+        static const uint8_t kProtocols[] = { BmsScanJbd, BmsScanDaly, BmsScanJk };
+        for (uint8_t p = 0; p < sizeof(kServices) / sizeof(kServices[0]); p++) {
+            for (uint8_t i = 0; i < uuidCount; i++) {
+                if (uuids[i] == kServices[p]) return kProtocols[p];
+            }
+        }
+        return BmsScanUnknown;
+    }
+
+private:
+    void addUuid(uint16_t uuid) {
+        for (uint8_t i = 0; i < uuidCount; i++) {
+            if (uuids[i] == uuid) return;
+        }
+        if (uuidCount < kMaxUuids) {
+            uuids[uuidCount++] = uuid;
+        } else if (otherUuids < UINT8_MAX) {
+            otherUuids++;
+        }
+    }
+};
+
+struct BmsScanEntry {
+    uint8_t  addr[6];
+    char     mac[18];          // "AA:BB:CC:DD:EE:FF"
+    char     name[BmsAdvertisement::kNameMax];
+    int8_t   rssi;             // smoothed, dBm
+    uint8_t  protocol;         // BmsScanProtocol
+    uint16_t uuids[BmsAdvertisement::kMaxUuids];
+    uint8_t  uuidCount;
+    uint8_t  otherUuids;
+    uint16_t reports;          // saturates
+    uint32_t lastSeenMs;
+    int16_t  rssiX16;          // the smoothing's state, 1/16 dBm
+
+    // "0xff00, 0x180f +1" (the +N being UUIDs not listed); "" without any.
+    // Returns the length; cut short if `cap` is too small.
+    size_t formatServices(char* out, size_t cap) const {
+        if (cap == 0) return 0;
+        size_t used = 0;
+        out[0] = '\0';
+        for (uint8_t i = 0; i < uuidCount; i++) {
+            const int n = snprintf(out + used, cap - used, "%s0x%04x", i > 0 ? ", " : "", uuids[i]);
+            if (n < 0 || (size_t)n >= cap - used) {
+                out[used] = '\0';   // no half-written UUID
+                return used;
+            }
+            used += (size_t)n;
+        }
+        if (otherUuids > 0) {
+            const int n = snprintf(out + used, cap - used, "%s+%u", used > 0 ? " " : "", otherUuids);
+            if (n > 0 && (size_t)n < cap - used) {
+                used += (size_t)n;
+            } else {
+                out[used] = '\0';
+            }
+        }
+        return used;
+    }
+};
+
+// One scan's devices. Not thread-safe: BluetoothBms fills it from the BLE
+// host task and copies it out for the web server under its own spinlock,
+// so observe() stays short (no formatting; formatServices() runs on a copy).
+class BmsScanTable {
+public:
+    static const uint8_t kEntries = 16;
+    // Each report moves the smoothed RSSI a quarter of the way to its own
+    static const uint8_t kRssiWeight = 4;
+    // A full table only gives a device's place to a newcomer once the device
+    // has not been heard for this long -- except that a BMS always takes
+    // the place of an unknown device
+    static const uint32_t kStaleMs = 3000;
+
+    BmsScanTable() { clear(); }
+
+    void clear() {
+        memset(entries_, 0, sizeof(entries_));
+        count_ = 0;
+    }
+
+    // One advertising report. False when the table is full and the device
+    // did not earn a place.
+    bool observe(const uint8_t addr[6], int8_t rssi, const uint8_t* adv, size_t advLen, uint32_t nowMs) {
+        BmsAdvertisement parsed;
+        BmsAdvertisement::parse(adv, advLen, parsed);
+        const uint8_t protocol = parsed.protocol();
+
+        BmsScanEntry* e = find(addr);
+        if (e == nullptr) {
+            e = place(protocol, nowMs);
+            if (e == nullptr) return false;
+            memset(e, 0, sizeof(*e));
+            memcpy(e->addr, addr, 6);
+            formatMac(addr, e->mac);
+            e->rssiX16 = (int16_t)(rssi * 16);
+        } else {
+            e->rssiX16 = (int16_t)(e->rssiX16 + (rssi * 16 - e->rssiX16) / kRssiWeight);
+        }
+        e->rssi = (int8_t)((e->rssiX16 + (e->rssiX16 < 0 ? -8 : 8)) / 16);
+        e->lastSeenMs = nowMs;
+        if (e->reports < UINT16_MAX) e->reports++;
+
+        // Advertising packets and scan responses carry different parts:
+        // keep what is known until a report says otherwise
+        if (parsed.name[0] != '\0') memcpy(e->name, parsed.name, sizeof(e->name));
+        if (parsed.uuidCount > 0 || parsed.otherUuids > 0) {
+            memcpy(e->uuids, parsed.uuids, sizeof(e->uuids));
+            e->uuidCount = parsed.uuidCount;
+            e->otherUuids = parsed.otherUuids;
+        }
+        if (protocol != BmsScanUnknown) e->protocol = protocol;
+        return true;
+    }
+
+    uint8_t count() const { return count_; }
+    const BmsScanEntry& entry(uint8_t index) const { return entries_[index < kEntries ? index : 0]; }
+
+    // Copies up to `cap` entries; returns how many.
+    uint8_t copyTo(BmsScanEntry* out, uint8_t cap) const {
+        const uint8_t n = count_ < cap ? count_ : cap;
+        memcpy(out, entries_, n * sizeof(BmsScanEntry));
+        return n;
+    }
+
+private:
+    // By hand: observe() runs under a spinlock, where snprintf() is too slow
+    static void formatMac(const uint8_t addr[6], char out[18]) {
+        static const char kHex[] = "0123456789ABCDEF";
+        for (uint8_t i = 0; i < 6; i++) {
+            out[i * 3] = kHex[addr[i] >> 4];
+            out[i * 3 + 1] = kHex[addr[i] & 0x0F];
+            out[i * 3 + 2] = i < 5 ? ':' : '\0';
+        }
+    }
+
+    BmsScanEntry* find(const uint8_t addr[6]) {
+        for (uint8_t i = 0; i < count_; i++) {
+            if (memcmp(entries_[i].addr, addr, 6) == 0) return &entries_[i];
+        }
+        return nullptr;
+    }
+
+    // A free entry, or the one a device of `protocol` may take: unknown
+    // devices before BMSs, then the longest unheard.
+    BmsScanEntry* place(uint8_t protocol, uint32_t nowMs) {
+        if (count_ < kEntries) return &entries_[count_++];
+        BmsScanEntry* victim = nullptr;
+        for (BmsScanEntry& e : entries_) {
+            if (victim == nullptr) { victim = &e; continue; }
+            const bool eUnknown = e.protocol == BmsScanUnknown;
+            const bool victimUnknown = victim->protocol == BmsScanUnknown;
+            if (eUnknown != victimUnknown) {
+                if (eUnknown) victim = &e;
+            } else if ((int32_t)(e.lastSeenMs - victim->lastSeenMs) < 0) {
+                victim = &e;
+            }
+        }
+        const bool bmsOverUnknown = protocol != BmsScanUnknown && victim->protocol == BmsScanUnknown;
+        if (!bmsOverUnknown && (uint32_t)(nowMs - victim->lastSeenMs) < kStaleMs) return nullptr;
+        return victim;
+    }
+
+    BmsScanEntry entries_[kEntries];
+    uint8_t count_;
+};
@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+
+// One BMS reading as the rest of the firmware sees it, whatever the
+// protocol -- no Arduino deps, host-testable.
+//
+// A driver fills its own copy as frames are parsed and publishes it whole
+// (BmsDriver::publishSnapshot()); consumers copy the published one out and
+// read every field from the same frame. The cell statistics and the hottest
+// sensor are derived once, at publish, not per read -- the cell ones only
+// when a cell frame came in, so they always go with cellMillis.
+struct BmsSnapshot {
+    static const uint8_t kMaxCells = 32;
+    static const uint8_t kMaxTemps = 8;
+    static const uint8_t kNoCell = 0xFF;
+    // Discharging at least this hard counts as under load (cellLoadMinMv)
+    static const int32_t kLoadMilliAmps = 10000;
+
+    bool     hasData;              // a pack (voltage/current/SoC) frame was parsed
+    bool     hasCellData;          // a cell-voltage frame was parsed
+    uint32_t packVoltageMilliVolts;
+    int32_t  packCurrentMilliAmps;
+    uint8_t  socPercent;
+    uint8_t  cellCount;
+    uint8_t  tempCount;
+    int16_t  tempsCelsius[kMaxTemps];
+    uint16_t cellVoltagesMv[kMaxCells];
+    uint32_t dataMillis;           // millis() when the pack fields were parsed
+    uint32_t cellMillis;           // millis() when the cell voltages were parsed
+
+    // Derived by updateDerived().
+    int16_t  tempMaxCelsius;       // 0 without sensors
+    uint16_t cellMinMv;            // 0 without cell data
+    uint16_t cellMaxMv;
+    uint16_t cellDeltaMv;
+    uint32_t cellSumMv;            // of the reported cells
+    uint16_t cellAvgMv;
+    uint8_t  cellsReported;        // cells with a voltage
+    uint8_t  cellWeakest;          // index of the lowest cell, kNoCell without cell data
+
+    // Carried from one published snapshot to the next by updateLoadMin():
+    // each cell's lowest voltage seen under load, 0 until it has been.
+    uint16_t cellLoadMinMv[kMaxCells];
+    uint8_t  cellLoadMinCount;     // cellCount the history was taken with
+
+    void clear() {
+        memset(this, 0, sizeof(*this));
+        cellWeakest = kNoCell;
+    }
+
+    uint16_t cellVoltageMv(uint8_t index) const {
+        return index < cellCount && index < kMaxCells ? cellVoltagesMv[index] : 0;
+    }
+
+    int16_t tempCelsius(uint8_t index) const {
+        return index < tempCount && index < kMaxTemps ? tempsCelsius[index] : 0;
+    }
+
+    // `cellsParsed`: false when only the pack fields changed since the last
+    // publish, which keeps the cell statistics of the last cell frame.
+    void updateDerived(bool cellsParsed = true) {
+        const uint8_t temps = tempCount < kMaxTemps ? tempCount : kMaxTemps;
+        tempMaxCelsius = 0;
+        for (uint8_t i = 0; i < temps; i++) {
+            if (i == 0 || tempsCelsius[i] > tempMaxCelsius) tempMaxCelsius = tempsCelsius[i];
+        }
+        if (cellsParsed) updateCellStats();
+    }
+
+    // A 0 mV cell is a slot the BMS has not reported (JBD counts cells in
+    // one register and reads them in another), so it is left out of the
+    // statistics rather than shown as a dead cell. Masks instead of
+    // branches: one pass over up to 32 cells on every cell frame, with
+    // nothing for the predictor to miss. Ties keep the first cell.
+    void updateCellStats() {
+        cellMinMv = 0;
+        cellMaxMv = 0;
+        cellDeltaMv = 0;
+        cellSumMv = 0;
+        cellAvgMv = 0;
+        cellsReported = 0;
+        cellWeakest = kNoCell;
+        if (!hasCellData) return;
+        const uint8_t cells = cellCount < kMaxCells ? cellCount : kMaxCells;
+        uint32_t minMv = UINT32_MAX;
+        uint32_t maxMv = 0;
+        uint32_t weakest = kNoCell;
+        uint32_t sum = 0;
+        uint32_t reported = 0;
+        for (uint8_t i = 0; i < cells; i++) {
+            const uint32_t v = cellVoltagesMv[i];
+            const uint32_t present = v != 0;
+            const uint32_t candidate = v | (present - 1);          // UINT32_MAX when not reported
+            const uint32_t lower = 0u - (uint32_t)(candidate < minMv);
+            minMv = (candidate & lower) | (minMv & ~lower);
+            weakest = (i & lower) | (weakest & ~lower);
+            const uint32_t higher = 0u - (uint32_t)(v > maxMv);
+            maxMv = (v & higher) | (maxMv & ~higher);
+            sum += v;
+            reported += present;
+        }
+        if (reported == 0) return;
+        cellMinMv = (uint16_t)minMv;
+        cellMaxMv = (uint16_t)maxMv;
+        cellDeltaMv = (uint16_t)(maxMv - minMv);
+        cellSumMv = sum;
+        cellAvgMv = (uint16_t)(sum / reported);
+        cellsReported = (uint8_t)reported;
+        cellWeakest = (uint8_t)weakest;
+    }
+
+    // Takes the load-min history over from `previous`, this BMS's last
+    // published snapshot, then folds in this frame's cells if they are new
+    // and the pack is discharging at kLoadMilliAmps or more. The history
+    // starts over when the cell count changes (another pack on the same
+    // slot) and outlives a snapshot without cells (a reconnect).
+    void updateLoadMin(const BmsSnapshot& previous, bool cellsParsed) {
+        const uint8_t cells = cellCount < kMaxCells ? cellCount : kMaxCells;
+        if (cells == 0 || cells == previous.cellLoadMinCount) {
+            memcpy(cellLoadMinMv, previous.cellLoadMinMv, sizeof(cellLoadMinMv));
+            cellLoadMinCount = previous.cellLoadMinCount;
+        } else {
+            memset(cellLoadMinMv, 0, sizeof(cellLoadMinMv));
+            cellLoadMinCount = cells;
+        }
+        if (!cellsParsed || !hasData || !hasCellData || packCurrentMilliAmps > -kLoadMilliAmps) return;
+        for (uint8_t i = 0; i < cells; i++) {
+            const uint16_t v = cellVoltagesMv[i];
+            if (v != 0 && (cellLoadMinMv[i] == 0 || v < cellLoadMinMv[i])) cellLoadMinMv[i] = v;
+        }
+    }
+
+    // Packs flown in parallel, seen as one battery: the currents add up,
+    // voltage and SoC are the lowest pack's (what the limiter must respect),
+    // the cell and temperature extremes are the worst across packs and the
+    // times the oldest, so an age covers every pack. Cells and sensors are
+    // listed pack after pack as far as they fit; the extremes, sum and
+    // average still cover the ones that do not (the weakest cell's index is
+    // kNoCell then). `packs` must have their derived fields set (any
+    // published snapshot does); packs without data are skipped.
+    static void combineParallel(const BmsSnapshot* packs, uint8_t count, BmsSnapshot& out) {
+        out.clear();
+        bool anyTemp = false;
+        for (uint8_t p = 0; p < count; p++) {
+            const BmsSnapshot& pack = packs[p];
+            if (pack.hasData) {
+                if (!out.hasData || pack.packVoltageMilliVolts < out.packVoltageMilliVolts) {
+                    out.packVoltageMilliVolts = pack.packVoltageMilliVolts;
+                }
+                if (!out.hasData || pack.socPercent < out.socPercent) out.socPercent = pack.socPercent;
+                if (!out.hasData || olderThan(pack.dataMillis, out.dataMillis)) out.dataMillis = pack.dataMillis;
+                out.packCurrentMilliAmps += pack.packCurrentMilliAmps;
+                out.hasData = true;
+            }
+
+            const uint8_t temps = pack.tempCount < kMaxTemps ? pack.tempCount : kMaxTemps;
+            for (uint8_t i = 0; i < temps && out.tempCount < kMaxTemps; i++) {
+                out.tempsCelsius[out.tempCount++] = pack.tempsCelsius[i];
+            }
+            if (temps > 0 && (!anyTemp || pack.tempMaxCelsius > out.tempMaxCelsius)) {
+                out.tempMaxCelsius = pack.tempMaxCelsius;
+                anyTemp = true;
+            }
+
+            if (!pack.hasCellData) {
+                continue;
+            }
+            const uint8_t cells = pack.cellCount < kMaxCells ? pack.cellCount : kMaxCells;
+            const uint8_t firstCell = out.cellCount;
+            for (uint8_t i = 0; i < cells && out.cellCount < kMaxCells; i++) {
+                out.cellLoadMinMv[out.cellCount] = pack.cellLoadMinMv[i];
+                out.cellVoltagesMv[out.cellCount++] = pack.cellVoltagesMv[i];
+            }
+            if (!out.hasCellData || olderThan(pack.cellMillis, out.cellMillis)) out.cellMillis = pack.cellMillis;
+            if (pack.cellsReported > 0) {
+                if (out.cellsReported == 0 || pack.cellMinMv < out.cellMinMv) {
+                    out.cellMinMv = pack.cellMinMv;
+                    out.cellWeakest = pack.cellWeakest < cells && firstCell + pack.cellWeakest < out.cellCount
+                                          ? (uint8_t)(firstCell + pack.cellWeakest) : kNoCell;
+                }
+                if (pack.cellMaxMv > out.cellMaxMv) out.cellMaxMv = pack.cellMaxMv;
+                out.cellSumMv += pack.cellSumMv;
+                out.cellsReported += pack.cellsReported;
+            }
+            out.hasCellData = true;
+        }
+        out.cellDeltaMv = out.cellMaxMv - out.cellMinMv;
+        if (out.cellsReported > 0) out.cellAvgMv = (uint16_t)(out.cellSumMv / out.cellsReported);
+        out.cellLoadMinCount = out.cellCount;
+    }
+
+private:
+    // millis() order, wrap-safe
+    static bool olderThan(uint32_t a, uint32_t b) { return (int32_t)(a - b) < 0; }
+};
@@ -26,6 +26,11 @@ void Canbus::handleBusRecovery() {
         // which by now is full of RawCommand frames nobody ever acknowledged.
         DEBUG_PRINTLN("[Canbus] Bus-off detected — initiating recovery");
         twai_initiate_recovery();
+        // Once per episode: with the cable out this cycles every few
+        // hundred ms, see above.
+        if (!busRecovering) {
+            eventJournal.record(EventJournalFormat::EventCanBusOff, 0, (uint16_t)status.tx_error_counter);
+        }
         busRecovering = true;
         break;
 
@@ -47,6 +52,9 @@ void Canbus::handleBusRecovery() {
         break;
 
     case TWAI_STATE_RUNNING:
+        if (busRecovering) {
+            eventJournal.record(EventJournalFormat::EventCanRecovered);
+        }
         busRecovering = false;
         break;
     }
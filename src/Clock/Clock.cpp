@@ -0,0 +1,30 @@
+#include "Clock.h"
+#include <esp_timer.h>
+#include <sys/time.h>
+
+// The anchor is two 64-bit words written by the web server and read by
+// the loop and the journal: copied whole under a spinlock.
+static ClockAnchor anchor;
+static portMUX_TYPE anchorLock = portMUX_INITIALIZER_UNLOCKED;
+
+uint64_t Clock::nowUs() {
+    return (uint64_t)esp_timer_get_time();
+}
+
+void Clock::setWallClock(int64_t epochMs) {
+    struct timeval tv;
+    tv.tv_sec  = (time_t)(epochMs / 1000);
+    tv.tv_usec = (suseconds_t)((epochMs % 1000) * 1000);
+    const uint64_t monoUs = nowUs();
+    settimeofday(&tv, nullptr);
+    portENTER_CRITICAL(&anchorLock);
+    anchor.set(monoUs, (uint64_t)epochMs * 1000);
+    portEXIT_CRITICAL(&anchorLock);
+}
+
+bool Clock::epochUsAt(uint64_t monoUs, uint64_t& epochUs) {
+    portENTER_CRITICAL(&anchorLock);
+    const ClockAnchor copy = anchor;
+    portEXIT_CRITICAL(&anchorLock);
+    return copy.epochUsAt(monoUs, epochUs);
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <Arduino.h>
+#include "ClockAnchor.h"
+
+/**
+ * Time base for flight logs, the event journal and telemetry: esp_timer's
+ * 64-bit microsecond count since boot, which neither wraps nor jumps.
+ * Wall-clock time comes from the anchor /api/settime records.
+ */
+namespace Clock {
+
+/** Any task. Monotonic µs since boot. */
+uint64_t nowUs();
+
+/** Any task. Sets the system clock and the anchor from epoch ms. */
+void setWallClock(int64_t epochMs);
+
+/** Any task. Wall-clock µs at `monoUs`; false until the clock was set. */
+bool epochUsAt(uint64_t monoUs, uint64_t& epochUs);
+
+} // namespace Clock
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pairs the monotonic microsecond clock with wall-clock time at one
+// instant -- no Arduino deps, host-testable.
+//
+// Timestamps are taken on the monotonic clock, which never jumps; wall
+// time is derived from the anchor when it is needed (once per log file,
+// once per event), so setting the clock later never reorders samples.
+struct ClockAnchor {
+    ClockAnchor() : monoUs(0), epochUs(0), valid(false) {}
+
+    uint64_t monoUs;
+    uint64_t epochUs;
+    bool     valid;
+
+    void set(uint64_t atMonoUs, uint64_t atEpochUs) {
+        monoUs = atMonoUs;
+        epochUs = atEpochUs;
+        valid = true;
+    }
+
+    // Wall-clock µs at `atMonoUs`, before or after the anchor; false until set.
+    bool epochUsAt(uint64_t atMonoUs, uint64_t& out) const {
+        if (!valid) return false;
+        out = epochUs + (atMonoUs - monoUs);   // modulo 2^64: earlier instants subtract
+        return true;
+    }
+};
@@ -7,42 +7,32 @@
 #include <BLEUtils.h>
 #include <cstring>
 #include <esp_gap_ble_api.h>
+#include "../BluetoothBms/BmsGattLink.h"
 
 #define DALY_SERVICE_UUID "0000fff0-0000-1000-8000-00805f9b34fb"
 #define DALY_CHAR_UUID_RX "0000fff1-0000-1000-8000-00805f9b34fb"
 #define DALY_CHAR_UUID_TX "0000fff2-0000-1000-8000-00805f9b34fb"
 
-static const uint8_t DALY_READ_FN = 0x03;
-static const uint8_t DALY_STATUS_REG_COUNT_62 = 62;
-static const uint8_t DALY_STATUS_DATA_LEN_62 = DALY_STATUS_REG_COUNT_62 * 2;
-
-static DalyBms* s_dalyBms = nullptr;
-
-static void onDalyNotifyCallback(BLERemoteCharacteristic* pChar, uint8_t* pData, size_t length, bool isNotify) {
-    (void)pChar;
-    (void)isNotify;
-    if (s_dalyBms != nullptr && pData != nullptr && length > 0) {
-        s_dalyBms->onNotify(pData, length);
-    }
+// Notifications, routed by bmsGattLink (BLE host task)
+void DalyBms::onGattNotify(void* ctx, uint8_t* data, size_t len) {
+    static_cast<DalyBms*>(ctx)->onNotify(data, len);
 }
 
 DalyBms::DalyBms()
-    : pClient_(nullptr), pCharRx_(nullptr), pCharTx_(nullptr),
+    : pClient_(nullptr), txHandle_(0),
       connectQueue_(nullptr), connectTaskHandle_(nullptr), stateMutex_(nullptr),
       connectSessionId_(0),
-      state_(Idle), initialized_(false), enabled_(false), connected_(false), hasData_(false), hasCellData_(false),
-      lastConnectAttempt_(0), lastRequestMillis_(0), rxLen_(0),
-      packVoltageMilliVolts_(0), packCurrentMilliAmps_(0), socPercent_(0),
-      remainingCapacityMilliAh_(0), cycleCount_(0), cellCount_(0), tempCount_(0),
+      state_(Idle), initialized_(false), enabled_(false), connected_(false),
+      subscribedMillis_(0), poll_(false), pollLevel_(BmsPollIdle),
+      connectCached_(false), viaCache_(false), frameSeen_(false), cacheStale_(false),
+      rxDropsSeen_(0), rxRejectsSeen_(0),
+      remainingCapacityMilliAh_(0), cycleCount_(0),
       balanceEnabled_(false), chargeEnabled_(false), dischargeEnabled_(false) {
-    memset(rxBuffer_, 0, sizeof(rxBuffer_));
-    memset(tempsCelsius_, 0, sizeof(tempsCelsius_));
-    memset(cellVoltagesMv_, 0, sizeof(cellVoltagesMv_));
+    frame_.clear();
 }
 
 void DalyBms::init() {
     if (initialized_) return;
-    s_dalyBms = this;
     stateMutex_ = xSemaphoreCreateMutex();
     connectQueue_ = xQueueCreate(1, sizeof(uint8_t));
     if (stateMutex_ == nullptr || connectQueue_ == nullptr) {
@@ -63,26 +53,31 @@ void DalyBms::setEnabled(bool enabled) {
     enabled_ = enabled;
     if (!enabled_) {
         resetConnection();
+        retry_.reset();
     }
 }
 
 void DalyBms::setMacAddress(const String& macAddress) {
-    macAddress_ = macAddress;
-    macAddress_.trim();
+    String mac = macAddress;
+    mac.trim();
+    if (mac != macAddress_) {
+        retry_.reset();
+    }
+    macAddress_ = mac;
 }
 
 void DalyBms::update() {
     if (!initialized_) return;
     switch (state_) {
         case Idle:
-            if (!enabled_ || macAddress_.length() < 17 || throttle.isArmed()) {
+            if (!enabled_ || macAddress_.length() < 17 || !retry_.due(millis())) {
                 break;
             }
-            {
-                const unsigned long now = millis();
-                if (lastConnectAttempt_ != 0 && (now - lastConnectAttempt_) < CONNECT_RETRY_MS) {
-                    break;
-                }
+            // While the motor is armed, only reconnect on cached handles:
+            // no service discovery in flight.
+            connectCached_ = bmsGattLink.has(macAddress_.c_str(), BmsTypeDaly);
+            if (throttle.isArmed() && !connectCached_) {
+                break;
             }
             if (connectQueue_ == nullptr) {
                 break;
@@ -100,7 +95,7 @@ void DalyBms::update() {
             break;
 
         case Connecting:
-            if (!enabled_ || macAddress_.length() < 17 || throttle.isArmed()) {
+            if (!enabled_ || macAddress_.length() < 17 || (throttle.isArmed() && !connectCached_)) {
                 resetConnection();
                 break;
             }
@@ -112,65 +107,30 @@ void DalyBms::update() {
             if (pClient_ == nullptr || !pClient_->isConnected()) {
                 DEBUG_PRINTLN("[Daly] Unexpectedly disconnected");
                 resetConnection();
+                retry_.onLinkLost(millis());
                 break;
             }
             processRxBuffer();
-            if (millis() - lastRequestMillis_ >= REQUEST_INTERVAL_MS) {
-                lastRequestMillis_ = millis();
+            // Cached handles that bring no answer are stale (new BMS firmware,
+            // another device on this MAC): drop them and rediscover.
+            if (viaCache_ && !frameSeen_ && millis() - subscribedMillis_ >= GATT_CACHE_PROBE_MS) {
+                DEBUG_PRINTLN("[Daly] No answer on cached GATT handles, rediscovering");
+                resetConnection();
+                cacheStale_ = true;
+                retry_.onLinkLost(millis());
+                break;
+            }
+            if (poll_.next(pollLevel_, millis()) == BmsPollSchedule::Pack) {
+                poll_.onRequested(BmsPollSchedule::Pack, millis());
                 sendStatusRequest();
             }
             break;
     }
 }
 
-int16_t DalyBms::getTempCelsius(uint8_t index) const {
-    if (index >= MAX_TEMPS || index >= tempCount_) return 0;
-    return tempsCelsius_[index];
-}
-
-uint16_t DalyBms::getCellVoltageMilliVolts(uint8_t index) const {
-    if (index >= MAX_CELLS || index >= cellCount_) return 0;
-    return cellVoltagesMv_[index];
-}
-
-uint16_t DalyBms::getCellMinMilliVolts() const {
-    if (!hasCellData_ || cellCount_ == 0) return 0;
-    uint16_t minMv = 0xFFFF;
-    for (uint8_t i = 0; i < cellCount_ && i < MAX_CELLS; i++) {
-        if (cellVoltagesMv_[i] > 0 && cellVoltagesMv_[i] < minMv) {
-            minMv = cellVoltagesMv_[i];
-        }
-    }
-    return minMv == 0xFFFF ? 0 : minMv;
-}
-
-uint16_t DalyBms::getCellMaxMilliVolts() const {
-    if (!hasCellData_ || cellCount_ == 0) return 0;
-    uint16_t maxMv = 0;
-    for (uint8_t i = 0; i < cellCount_ && i < MAX_CELLS; i++) {
-        if (cellVoltagesMv_[i] > maxMv) {
-            maxMv = cellVoltagesMv_[i];
-        }
-    }
-    return maxMv;
-}
-
-uint16_t DalyBms::getCellDeltaMilliVolts() const {
-    if (!hasCellData_) return 0;
-    uint16_t minMv = getCellMinMilliVolts();
-    uint16_t maxMv = getCellMaxMilliVolts();
-    return maxMv >= minMv ? (maxMv - minMv) : 0;
-}
-
+// BLE host task: never blocks, drops the notification whole if the ring is full
 void DalyBms::onNotify(uint8_t* data, size_t len) {
-    xSemaphoreTake(stateMutex_, portMAX_DELAY);
-    if (rxLen_ + len > RX_BUFFER_SIZE) {
-        rxLen_ = 0;
-        DEBUG_PRINTLN("[Daly] RX buffer overflow, discarding");
-    }
-    memcpy(rxBuffer_ + rxLen_, data, len);
-    rxLen_ += len;
-    xSemaphoreGive(stateMutex_);
+    rxRing_.push(data, len);
 }
 
 void DalyBms::resetConnection() {
@@ -187,17 +147,20 @@ void DalyBms::applyResetConnectionLocked() {
     if (pClient_ != nullptr && pClient_->isConnected()) {
         pClient_->disconnect();
     }
+    bmsGattLink.unsubscribe(this);
     connected_ = false;
-    pCharRx_ = nullptr;
-    pCharTx_ = nullptr;
-    rxLen_ = 0;
+    txHandle_ = 0;
+    viaCache_ = false;
+    rxRing_.clear();
+    rxParser_.reset();
     state_ = Idle;
 }
 
 // connectTask — runs BLEClient::connect AND service discovery off the main loop.
 // Both phases block for several seconds when the BMS is far/absent or when the
 // ATT layer is busy; running them here keeps the main loop responsive (and the
-// system-start beep can complete on time).
+// system-start beep can complete on time). Discovery is skipped when
+// bmsGattLink has this MAC's handles — the only reconnect allowed while armed.
 void DalyBms::connectTask(void* arg) {
     DalyBms* self = static_cast<DalyBms*>(arg);
     uint8_t cmd = 0;
@@ -205,11 +168,14 @@ void DalyBms::connectTask(void* arg) {
         if (xQueueReceive(self->connectQueue_, &cmd, portMAX_DELAY) != pdTRUE) {
             continue;
         }
+        // Until the end of this attempt, the other pack's driver waits
+        BmsGattLink::ConnectTurn turn;
 
         char mac[18];
         mac[0] = '\0';
         uint32_t session = 0;
-        bool okToConnect = false;
+        bool enabled = false;
+        bool cacheStale = false;
 
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         session = self->connectSessionId_;
@@ -217,16 +183,19 @@ void DalyBms::connectTask(void* arg) {
             strncpy(mac, self->macAddress_.c_str(), 18);
             mac[17] = '\0';
         }
-        okToConnect = self->enabled_ && !throttle.isArmed() && strlen(mac) == 17;
+        enabled = self->enabled_;
+        cacheStale = self->cacheStale_;
+        self->cacheStale_ = false;
         xSemaphoreGive(self->stateMutex_);
 
-        if (!okToConnect) {
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+        if (cacheStale) {
+            bmsGattLink.forget(mac, BmsTypeDaly);
+        }
+        BmsGattHandles handles;
+        const bool cached = bmsGattLink.lookup(mac, BmsTypeDaly, handles);
+
+        if (!enabled || strlen(mac) != 17 || (throttle.isArmed() && !cached)) {
+            self->abandonConnectAttempt(session);
             continue;
         }
 
@@ -240,12 +209,7 @@ void DalyBms::connectTask(void* arg) {
 
         if (!connectedOk) {
             DEBUG_PRINTLN("[Daly] Connection failed, retrying...");
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
 
@@ -253,231 +217,163 @@ void DalyBms::connectTask(void* arg) {
         // BMS or armed the motor while we were connecting.
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool stillValid = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         xSemaphoreGive(self->stateMutex_);
 
         if (!stillValid) {
-            if (self->pClient_->isConnected()) {
-                self->pClient_->disconnect();
-            }
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
 
-        // ----- Phase 2: ATT service discovery (also slow, also off main loop) -----
-        BLERemoteService* pService = self->pClient_->getService(DALY_SERVICE_UUID);
-        if (pService == nullptr) {
-            DEBUG_PRINTLN("[Daly] Service FFF0 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+        // ----- Phase 2: ATT service discovery, unless the handles are cached -----
+        if (cached) {
+            DEBUG_PRINTLN("[Daly] Cached GATT handles, discovery skipped");
+        } else {
+            const BmsGattLink::DiscoverResult found = bmsGattLink.discover(
+                self->pClient_, DALY_SERVICE_UUID, DALY_CHAR_UUID_RX, DALY_CHAR_UUID_TX, handles);
+            if (found != BmsGattLink::DiscoverOk) {
+                DEBUG_PRINTLN(found == BmsGattLink::DiscoverNoService
+                    ? "[Daly] Service FFF0 not found" : "[Daly] Characteristics FFF1/FFF2 not found");
+                self->abandonConnectAttempt(session);
+                continue;
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
-        }
-        DEBUG_PRINTLN("[Daly] Service FFF0 found");
-
-        BLERemoteCharacteristic* charRx = pService->getCharacteristic(DALY_CHAR_UUID_RX);
-        BLERemoteCharacteristic* charTx = pService->getCharacteristic(DALY_CHAR_UUID_TX);
-        if (charRx == nullptr || charTx == nullptr) {
-            DEBUG_PRINTLN("[Daly] Characteristics FFF1/FFF2 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+            DEBUG_PRINTLN("[Daly] Characteristics FFF1/FFF2 found");
+            if (handles.cccdHandle == 0) {
+                DEBUG_PRINTLN("[Daly] WARNING: descriptor 0x2902 not found — notify may not work");
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
+            handles.addrType = BLE_ADDR_TYPE_PUBLIC;
         }
-        DEBUG_PRINTLN("[Daly] Characteristics FFF1/FFF2 found");
-
-        charRx->registerForNotify(onDalyNotifyCallback);
-        BLERemoteDescriptor* pCccd = charRx->getDescriptor(BLEUUID((uint16_t)0x2902));
-        if (pCccd != nullptr) {
-            uint8_t notifyOn[2] = {0x01, 0x00};
-            pCccd->writeValue(notifyOn, 2, true);
-            DEBUG_PRINTLN("[Daly] CCCD written manually (0x0100)");
-        } else {
-            DEBUG_PRINTLN("[Daly] WARNING: descriptor 0x2902 not found — notify may not work");
+
+        if (!bmsGattLink.subscribe(self->pClient_, handles, onGattNotify, self)) {
+            DEBUG_PRINTLN("[Daly] Notification subscribe failed");
+            self->abandonConnectAttempt(session);
+            continue;
         }
 
         // ----- Phase 3: commit shared state under mutex -----
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool sessionStillCurrent = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         if (!sessionStillCurrent) {
             xSemaphoreGive(self->stateMutex_);
-            if (self->pClient_->isConnected()) {
-                self->pClient_->disconnect();
-            }
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
-        self->pCharRx_           = charRx;
-        self->pCharTx_           = charTx;
+        self->txHandle_          = handles.txHandle;
         self->connected_         = true;
-        self->rxLen_             = 0;
-        self->lastRequestMillis_ = 0; // force immediate request
+        self->rxRing_.clear();
+        self->rxParser_.reset();
+        self->poll_.reset();          // first request at once
+        self->viaCache_          = cached;
+        self->frameSeen_         = false;
+        self->subscribedMillis_  = millis();
+        self->retry_.onLinkUp();
         self->state_             = Subscribed;
         xSemaphoreGive(self->stateMutex_);
         DEBUG_PRINTLN("[Daly] Subscribed, ready for reads");
+
+        if (!cached) {
+            bmsGattLink.remember(mac, BmsTypeDaly, handles);
+        }
+    }
+}
+
+// connectTask failure path: drops the link and, if the attempt is still the
+// current one, goes back to Idle and backs off.
+void DalyBms::abandonConnectAttempt(uint32_t session) {
+    bmsGattLink.unsubscribe(this);
+    if (pClient_ != nullptr && pClient_->isConnected()) {
+        pClient_->disconnect();
+    }
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    if (session == connectSessionId_) {
+        applyResetConnectionLocked();
+        retry_.onAttemptFailed(millis());
     }
+    xSemaphoreGive(stateMutex_);
 }
 
 void DalyBms::sendStatusRequest() {
-    if (pCharTx_ == nullptr || pClient_ == nullptr || !pClient_->isConnected()) {
+    if (txHandle_ == 0 || pClient_ == nullptr || !pClient_->isConnected()) {
         return;
     }
 
-    uint8_t frame[8] = {0xD2, DALY_READ_FN, 0x00, 0x00, 0x00, DALY_STATUS_REG_COUNT_62, 0x00, 0x00};
-    uint16_t crc = crc16Modbus(frame, 6);
-    frame[6] = (uint8_t)(crc & 0xFF);
-    frame[7] = (uint8_t)(crc >> 8);
+    uint8_t frame[DALY_STATUS_REQUEST_LEN];
+    dalyBuildStatusRequest(frame);
     DEBUG_PRINT("[Daly] TX: ");
     printFrameHex(frame, sizeof(frame));
-    pCharTx_->writeValue(frame, sizeof(frame), false);
+    bmsGattLink.write(pClient_, txHandle_, frame, sizeof(frame));
 }
 
+// Notifications queued by onNotify() go through rxParser_ (DalyFrameParser.h),
+// which hands over each frame with a good CRC whatever the chunking.
 void DalyBms::processRxBuffer() {
     xSemaphoreTake(stateMutex_, portMAX_DELAY);
 
-    bool done = false;
-    while (!done && rxLen_ >= 5) {
-        if (rxBuffer_[0] != 0xD2) {
-            size_t skip = 0;
-            while (skip < rxLen_ && rxBuffer_[skip] != 0xD2) skip++;
-            if (skip >= rxLen_) {
-                DEBUG_PRINTLN("[Daly] Discarding RX buffer while searching for 0xD2");
-                rxLen_ = 0;
-                done = true;
-                continue;
-            }
-            DEBUG_PRINT("[Daly] Resyncing RX buffer, skipped bytes: ");
-            DEBUG_PRINTLN(skip);
-            memmove(rxBuffer_, rxBuffer_ + skip, rxLen_ - skip);
-            rxLen_ -= skip;
-            continue;
-        }
-
-        uint8_t dataLen = rxBuffer_[2];
-        size_t frameLen = (size_t)3 + dataLen + 2;
-        if (frameLen > RX_BUFFER_SIZE) {
-            DEBUG_PRINT("[Daly] Invalid frame length: ");
-            DEBUG_PRINTLN(frameLen);
-            rxLen_ = 0;
-            done = true;
-            continue;
-        }
-        if (rxLen_ < frameLen) {
-            done = true;
-            continue;
-        }
-
-        DEBUG_PRINT("[Daly] RX: ");
-        printFrameHex(rxBuffer_, frameLen);
+    if (rxRing_.dropped() != rxDropsSeen_) {
+        rxDropsSeen_ = rxRing_.dropped();
+        DEBUG_PRINT("[Daly] RX ring full, notifications dropped: ");
+        DEBUG_PRINTLN(rxDropsSeen_);
+    }
 
-        uint16_t expectedCrc = crc16Modbus(rxBuffer_, frameLen - 2);
-        uint16_t receivedCrc = (uint16_t)rxBuffer_[frameLen - 2] | ((uint16_t)rxBuffer_[frameLen - 1] << 8);
-        if (expectedCrc == receivedCrc) {
-            parseStatusFrame(rxBuffer_, frameLen);
-            memmove(rxBuffer_, rxBuffer_ + frameLen, rxLen_ - frameLen);
-            rxLen_ -= frameLen;
-            continue;
-        }
+    uint8_t chunk[64];
+    size_t n;
+    while ((n = rxRing_.pop(chunk, sizeof(chunk))) > 0) {
+        rxParser_.feed(chunk, n, [this](const DalyFrame& frame) {
+            frameSeen_ = true;
+            DEBUG_PRINT("[Daly] RX: ");
+            printFrameHex(frame.raw, frame.rawLen);
+            parseStatusFrame(frame.raw, frame.rawLen);
+        });
+    }
 
-        DEBUG_PRINT("[Daly] Invalid CRC exp=0x");
-        DEBUG_PRINT_HEX(expectedCrc, HEX);
-        DEBUG_PRINT(" got=0x");
-        DEBUG_PRINT_HEX(receivedCrc, HEX);
-        DEBUG_PRINTLN();
-        memmove(rxBuffer_, rxBuffer_ + 1, rxLen_ - 1);
-        rxLen_ -= 1;
+    if (rxParser_.rejected() != rxRejectsSeen_) {
+        rxRejectsSeen_ = rxParser_.rejected();
+        DEBUG_PRINT("[Daly] Invalid CRC, frames rejected: ");
+        DEBUG_PRINTLN(rxRejectsSeen_);
     }
 
     xSemaphoreGive(stateMutex_);
 }
 
 void DalyBms::parseStatusFrame(const uint8_t* frame, size_t frameLen) {
-    if (frameLen < (size_t)3 + DALY_STATUS_DATA_LEN_62 + 2) {
-        DEBUG_PRINT("[Daly] Frame too short: ");
+    static_assert(DALY_MAX_CELLS <= BmsSnapshot::kMaxCells && DALY_MAX_TEMPS <= BmsSnapshot::kMaxTemps,
+                  "Daly readings must fit the snapshot");
+    DalyStatus status;
+    if (!dalyParseStatusFrame(frame, frameLen, &status)) {
+        DEBUG_PRINT("[Daly] Not a status frame: fn=0x");
+        DEBUG_PRINT_HEX(frameLen > 1 ? frame[1] : 0, HEX);
+        DEBUG_PRINT(" len=");
         DEBUG_PRINTLN(frameLen);
         return;
     }
-    if (frame[1] != DALY_READ_FN) {
-        DEBUG_PRINT("[Daly] Unexpected function: 0x");
-        DEBUG_PRINT_HEX(frame[1], HEX);
-        DEBUG_PRINTLN();
-        return;
-    }
-    if (frame[2] < DALY_STATUS_DATA_LEN_62) {
-        DEBUG_PRINT("[Daly] Payload too short: ");
-        DEBUG_PRINTLN(frame[2]);
-        return;
-    }
 
-    auto get16 = [&](size_t index) -> uint16_t {
-        if (index + 1 >= frameLen) return 0;
-        return (uint16_t(frame[index]) << 8) | uint16_t(frame[index + 1]);
-    };
-
-    uint8_t decodedCellCount = (uint8_t)min<uint16_t>(get16(101), MAX_CELLS);
-    uint8_t decodedTempCount = (uint8_t)min<uint16_t>(get16(103), MAX_TEMPS);
-
-    packVoltageMilliVolts_ = (uint32_t)get16(83) * 100UL;
-    packCurrentMilliAmps_ = ((int32_t)get16(85) - 30000) * 100L;
-    socPercent_ = (uint8_t)((get16(87) + 5) / 10);
-    remainingCapacityMilliAh_ = (uint32_t)get16(99) * 100UL;
-    cycleCount_ = get16(105);
-    cellCount_ = decodedCellCount;
-    tempCount_ = decodedTempCount;
-    balanceEnabled_ = (get16(107) == 0x0001);
-    chargeEnabled_ = (get16(109) == 0x0001);
-    dischargeEnabled_ = (get16(111) == 0x0001);
-
-    memset(cellVoltagesMv_, 0, sizeof(cellVoltagesMv_));
-    memset(tempsCelsius_, 0, sizeof(tempsCelsius_));
-
-    for (uint8_t i = 0; i < cellCount_; i++) {
-        cellVoltagesMv_[i] = get16(3 + (i * 2));
-    }
-    for (uint8_t i = 0; i < tempCount_; i++) {
-        tempsCelsius_[i] = (int16_t)get16(67 + (i * 2)) - 40;
-    }
-
-    hasData_ = true;
-    hasCellData_ = (cellCount_ > 0);
+    frame_.packVoltageMilliVolts = status.packVoltageMilliVolts;
+    frame_.packCurrentMilliAmps = status.packCurrentMilliAmps;
+    frame_.socPercent = status.socPercent;
+    remainingCapacityMilliAh_ = status.remainingCapacityMilliAh;
+    cycleCount_ = status.cycleCount;
+    frame_.cellCount = status.cellCount;
+    frame_.tempCount = status.tempCount;
+    balanceEnabled_ = status.balanceEnabled;
+    chargeEnabled_ = status.chargeEnabled;
+    dischargeEnabled_ = status.dischargeEnabled;
+
+    memset(frame_.cellVoltagesMv, 0, sizeof(frame_.cellVoltagesMv));
+    memset(frame_.tempsCelsius, 0, sizeof(frame_.tempsCelsius));
+    memcpy(frame_.cellVoltagesMv, status.cellVoltagesMv, sizeof(status.cellVoltagesMv));
+    memcpy(frame_.tempsCelsius, status.tempsCelsius, sizeof(status.tempsCelsius));
+
+    // One status frame carries the pack and the cells
+    frame_.hasData = true;
+    frame_.hasCellData = (frame_.cellCount > 0);
+    frame_.dataMillis = millis();
+    frame_.cellMillis = frame_.dataMillis;
+    published_.publish(frame_);
     printStatusSummary();
     printCellVoltages();
 }
 
-uint16_t DalyBms::crc16Modbus(const uint8_t* data, size_t len) {
-    uint16_t crc = 0xFFFF;
-    for (size_t i = 0; i < len; i++) {
-        crc ^= data[i];
-        for (uint8_t bit = 0; bit < 8; bit++) {
-            if ((crc & 0x0001U) != 0U) {
-                crc = (crc >> 1) ^ 0xA001U;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    return crc;
-}
-
 void DalyBms::printFrameHex(const uint8_t* data, size_t len) const {
     DEBUG_PRINT("[Daly] ");
     for (size_t i = 0; i < len; i++) {
@@ -491,23 +387,23 @@ void DalyBms::printFrameHex(const uint8_t* data, size_t len) const {
 void DalyBms::printStatusSummary() const {
     DEBUG_PRINTLN("[Daly] ===== Status =====");
     DEBUG_PRINT("[Daly] Voltage: ");
-    DEBUG_PRINT(packVoltageMilliVolts_ / 1000);
+    DEBUG_PRINT(frame_.packVoltageMilliVolts / 1000);
     DEBUG_PRINT(".");
-    uint16_t voltageFraction = packVoltageMilliVolts_ % 1000;
+    uint16_t voltageFraction = frame_.packVoltageMilliVolts % 1000;
     if (voltageFraction < 100) { DEBUG_PRINT("0"); }
     if (voltageFraction < 10)  { DEBUG_PRINT("0"); }
     DEBUG_PRINT(voltageFraction);
     DEBUG_PRINTLN(" V");
     DEBUG_PRINT("[Daly] Current: ");
-    DEBUG_PRINT(packCurrentMilliAmps_);
+    DEBUG_PRINT(frame_.packCurrentMilliAmps);
     DEBUG_PRINTLN(" mA");
     DEBUG_PRINT("[Daly] SoC: ");
-    DEBUG_PRINT(socPercent_);
+    DEBUG_PRINT(frame_.socPercent);
     DEBUG_PRINTLN(" %");
     DEBUG_PRINT("[Daly] Cells: ");
-    DEBUG_PRINTLN(cellCount_);
+    DEBUG_PRINTLN(frame_.cellCount);
     DEBUG_PRINT("[Daly] Temps: ");
-    DEBUG_PRINTLN(tempCount_);
+    DEBUG_PRINTLN(frame_.tempCount);
     DEBUG_PRINT("[Daly] Cycles: ");
     DEBUG_PRINTLN(cycleCount_);
     DEBUG_PRINT("[Daly] Remaining cap: ");
@@ -519,27 +415,27 @@ void DalyBms::printStatusSummary() const {
     DEBUG_PRINT(chargeEnabled_ ? "ON" : "OFF");
     DEBUG_PRINT(" DSG=");
     DEBUG_PRINTLN(dischargeEnabled_ ? "ON" : "OFF");
-    for (uint8_t i = 0; i < tempCount_ && i < MAX_TEMPS; i++) {
+    for (uint8_t i = 0; i < frame_.tempCount && i < MAX_TEMPS; i++) {
         DEBUG_PRINT("[Daly] Temp");
         DEBUG_PRINT(i);
         DEBUG_PRINT(": ");
-        DEBUG_PRINT(tempsCelsius_[i]);
+        DEBUG_PRINT(frame_.tempsCelsius[i]);
         DEBUG_PRINTLN(" C");
     }
     DEBUG_PRINT("[Daly] Min: ");
-    DEBUG_PRINT(getCellMinMilliVolts());
+    DEBUG_PRINT(frame_.cellMinMv);
     DEBUG_PRINT(" mV  Max: ");
-    DEBUG_PRINT(getCellMaxMilliVolts());
+    DEBUG_PRINT(frame_.cellMaxMv);
     DEBUG_PRINT(" mV  Delta: ");
-    DEBUG_PRINT(getCellDeltaMilliVolts());
+    DEBUG_PRINT(frame_.cellDeltaMv);
     DEBUG_PRINTLN(" mV");
     DEBUG_PRINTLN("[Daly] ===================");
 }
 
 void DalyBms::printCellVoltages() const {
     DEBUG_PRINTLN("[Daly] ===== Cell Voltages =====");
-    for (uint8_t i = 0; i < cellCount_ && i < MAX_CELLS; i++) {
-        uint16_t v = cellVoltagesMv_[i];
+    for (uint8_t i = 0; i < frame_.cellCount && i < MAX_CELLS; i++) {
+        uint16_t v = frame_.cellVoltagesMv[i];
         DEBUG_PRINT("[Daly] C");
         if (i + 1 < 10) { DEBUG_PRINT("0"); }
         DEBUG_PRINT(i + 1);
@@ -7,9 +7,13 @@
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include "../BluetoothBms/BmsDriver.h"
+#include "../BluetoothBms/BmsReconnectPolicy.h"
+#include "../BluetoothBms/BmsRxRing.h"
+#include "DalyFrameParser.h"
+#include "DalyBmsParser.h"
 
 class BLEClient;
-class BLERemoteCharacteristic;
 
 class DalyBms {
 public:
@@ -22,21 +26,16 @@ public:
     void setMacAddress(const String& macAddress);
 
     bool isConnected() const { return connected_; }
-    bool hasData() const { return hasData_; }
-    bool hasCellData() const { return hasCellData_; }
+    const char* getStateName() const { return connected_ ? "connected" : "connecting"; }
+    bool hasData() const { return published_.hasData(); }
+    bool hasCellData() const { return published_.hasCellData(); }
+    // Any task: pack, cells and temperatures of the last parsed frame
+    bool readSnapshot(BmsSnapshot& out) const { return published_.read(out); }
+    // Loop: BmsPollLevel, sets the status request rate
+    void setPollLevel(uint8_t level) { pollLevel_ = level; }
 
-    uint32_t getPackVoltageMilliVolts() const { return packVoltageMilliVolts_; }
-    int32_t getPackCurrentMilliAmps() const { return packCurrentMilliAmps_; }
-    uint8_t getSoCPercent() const { return socPercent_; }
     uint32_t getRemainingCapacityMilliAh() const { return remainingCapacityMilliAh_; }
     uint16_t getCycleCount() const { return cycleCount_; }
-    uint8_t getCellCount() const { return cellCount_; }
-    uint8_t getTempCount() const { return tempCount_; }
-    int16_t getTempCelsius(uint8_t index) const;
-    uint16_t getCellVoltageMilliVolts(uint8_t index) const;
-    uint16_t getCellMinMilliVolts() const;
-    uint16_t getCellMaxMilliVolts() const;
-    uint16_t getCellDeltaMilliVolts() const;
     bool isBalanceEnabled() const { return balanceEnabled_; }
     bool isChargeEnabled() const { return chargeEnabled_; }
     bool isDischargeEnabled() const { return dischargeEnabled_; }
@@ -46,25 +45,26 @@ public:
 private:
     // State machine: Idle → Connecting → Subscribed.
     // The connectTask now performs BLEClient::connect() AND service discovery
-    // (getService / getCharacteristic / registerForNotify / CCCD writeValue),
+    // (getService / getCharacteristic / getDescriptor, then the CCCD write),
     // all of which can block for several seconds. The main loop never sees a
     // "Connected, awaiting discovery" state — it only sees Subscribed once
-    // the worker has fully wired the characteristics.
+    // the worker has fully wired the characteristics. Discovery is skipped
+    // when bmsGattLink has this MAC's handles.
     enum State {
         Idle,
         Connecting,
         Subscribed
     };
 
-    static const uint8_t MAX_CELLS = 32;
-    static const uint8_t MAX_TEMPS = 8;
-    static const size_t RX_BUFFER_SIZE = 192;
-    static const unsigned long CONNECT_RETRY_MS = 10000;
-    static const unsigned long REQUEST_INTERVAL_MS = 2000;
+    static const uint8_t MAX_CELLS = DALY_MAX_CELLS;
+    static const uint8_t MAX_TEMPS = DALY_MAX_TEMPS;
+    static const size_t RX_RING_SIZE = 256;
+    // Cached handles must answer the first request within this; it goes
+    // out right after subscribing, whatever the poll level
+    static const unsigned long GATT_CACHE_PROBE_MS = 5000;
 
     BLEClient* pClient_;
-    BLERemoteCharacteristic* pCharRx_;
-    BLERemoteCharacteristic* pCharTx_;
+    uint16_t txHandle_;   // FFF2, 0 when not subscribed
     QueueHandle_t connectQueue_;
     TaskHandle_t connectTaskHandle_;
     SemaphoreHandle_t stateMutex_;
@@ -73,38 +73,43 @@ private:
     bool initialized_;
     bool enabled_;
     bool connected_;
-    bool hasData_;
-    bool hasCellData_;
     String macAddress_;
-    unsigned long lastConnectAttempt_;
-    unsigned long lastRequestMillis_;
+    unsigned long subscribedMillis_;
+    // One status frame carries pack and cells: the Pack field only
+    BmsPollSchedule poll_;
+    uint8_t pollLevel_;
+    BmsReconnectPolicy retry_;   // when Idle may queue the next connect
+    bool connectCached_;         // the queued attempt has cached handles (allowed while armed)
+    bool viaCache_;              // subscribed on cached handles, not yet answered through them
+    bool frameSeen_;             // a valid frame since Subscribed
+    bool cacheStale_;            // cached handles went unanswered: connectTask forgets them
 
-    uint8_t rxBuffer_[RX_BUFFER_SIZE];
-    size_t rxLen_;
+    // onNotify() only pushes to rxRing_; the loop feeds it to rxParser_.
+    // Ring consumer side and the parser are under stateMutex_.
+    BmsRxRing<RX_RING_SIZE> rxRing_;
+    DalyFrameParser rxParser_;
+    uint32_t rxDropsSeen_;
+    uint32_t rxRejectsSeen_;
 
-    uint32_t packVoltageMilliVolts_;
-    int32_t packCurrentMilliAmps_;
-    uint8_t socPercent_;
+    BmsSnapshot frame_;
+    BmsSnapshotSlot published_;
     uint32_t remainingCapacityMilliAh_;
     uint16_t cycleCount_;
-    uint8_t cellCount_;
-    uint8_t tempCount_;
-    int16_t tempsCelsius_[MAX_TEMPS];
-    uint16_t cellVoltagesMv_[MAX_CELLS];
     bool balanceEnabled_;
     bool chargeEnabled_;
     bool dischargeEnabled_;
 
     void resetConnection();
     void applyResetConnectionLocked(); // caller must hold stateMutex_
+    void abandonConnectAttempt(uint32_t session);
     static void connectTask(void* arg);
+    static void onGattNotify(void* ctx, uint8_t* data, size_t len);
     void sendStatusRequest();
     void processRxBuffer();
     void parseStatusFrame(const uint8_t* frame, size_t frameLen);
     void printFrameHex(const uint8_t* data, size_t len) const;
     void printStatusSummary() const;
     void printCellVoltages() const;
-    static uint16_t crc16Modbus(const uint8_t* data, size_t len);
 };
 
 #endif // DALY_BMS_H
@@ -0,0 +1,113 @@
+#ifndef DALY_BMS_PARSER_H
+#define DALY_BMS_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "DalyFrameParser.h"
+
+// ── Frame constants ───────────────────────────────────────────────────────────
+
+// Request:  D2 | 03 | 00 00 (first register) | 00 3E (count) | CRC_L | CRC_H
+// Response: D2 | 03 | LEN | DATA[LEN] | CRC_L | CRC_H
+// Framing and CRC: DalyFrameParser.h. This header builds the request and
+// decodes the response.
+#define DALY_READ_FN             0x03
+#define DALY_STATUS_REG_COUNT_62 62
+#define DALY_STATUS_DATA_LEN_62  (DALY_STATUS_REG_COUNT_62 * 2)
+#define DALY_STATUS_FRAME_LEN_62 (3 + DALY_STATUS_DATA_LEN_62 + 2)
+#define DALY_STATUS_REQUEST_LEN  8
+static_assert(DALY_READ_FN == DalyFrameParser::kFunction && DALY_STATUS_DATA_LEN_62 == DalyFrameParser::kDataLen,
+              "the framer only takes replies to the status read");
+
+// ── Limits ────────────────────────────────────────────────────────────────────
+
+#define DALY_MAX_CELLS 32
+#define DALY_MAX_TEMPS 8
+
+// ── Field offsets (big-endian registers, relative to frame[0]) ───────────────
+
+#define DALY_CELL_BASE_OFFSET   3     // + i*2, mV
+#define DALY_TEMP_BASE_OFFSET   67    // + i*2, °C + 40
+#define DALY_PACK_VOLTAGE_OFFSET 83   // 100 mV
+#define DALY_PACK_CURRENT_OFFSET 85   // 100 mA, offset 30000
+#define DALY_SOC_OFFSET         87    // 0.1 %
+#define DALY_REMAINING_OFFSET   99    // 100 mAh
+#define DALY_CELL_COUNT_OFFSET  101
+#define DALY_TEMP_COUNT_OFFSET  103
+#define DALY_CYCLES_OFFSET      105
+#define DALY_BALANCE_OFFSET     107   // 0x0001 = on
+#define DALY_CHARGE_FET_OFFSET  109
+#define DALY_DISCHARGE_FET_OFFSET 111
+
+// ── Types ─────────────────────────────────────────────────────────────────────
+
+struct DalyStatus {
+    uint32_t packVoltageMilliVolts;
+    int32_t  packCurrentMilliAmps;    // negative = discharge
+    uint8_t  socPercent;
+    uint32_t remainingCapacityMilliAh;
+    uint16_t cycleCount;
+    uint8_t  cellCount;               // clamped to DALY_MAX_CELLS
+    uint8_t  tempCount;               // clamped to DALY_MAX_TEMPS
+    bool     balanceEnabled;
+    bool     chargeEnabled;
+    bool     dischargeEnabled;
+    uint16_t cellVoltagesMv[DALY_MAX_CELLS];
+    int16_t  tempsCelsius[DALY_MAX_TEMPS];
+};
+
+// ── Command building ──────────────────────────────────────────────────────────
+
+// Read the 62 status registers from 0.
+static inline void dalyBuildStatusRequest(uint8_t out[DALY_STATUS_REQUEST_LEN]) {
+    out[0] = DalyFrameParser::kStart;
+    out[1] = DALY_READ_FN;
+    out[2] = 0x00;
+    out[3] = 0x00;
+    out[4] = 0x00;
+    out[5] = DALY_STATUS_REG_COUNT_62;
+    const uint16_t crc = dalyCrc16Modbus(out, 6);
+    out[6] = (uint8_t)(crc & 0xFF);
+    out[7] = (uint8_t)(crc >> 8);
+}
+
+// ── Status parsing ────────────────────────────────────────────────────────────
+
+static inline uint16_t dalyGet16BE(const uint8_t* frame, size_t frameLen, size_t offset) {
+    if (offset + 1 >= frameLen) return 0;
+    return (uint16_t)((uint16_t)frame[offset] << 8 | frame[offset + 1]);
+}
+
+// Parse a complete, CRC-validated response to the status request. Returns
+// false if it is not one: another function, or fewer than 62 registers.
+static inline bool dalyParseStatusFrame(const uint8_t* frame, size_t frameLen, DalyStatus* out) {
+    if (frameLen < DALY_STATUS_FRAME_LEN_62) return false;
+    if (frame[1] != DALY_READ_FN) return false;
+    if (frame[2] < DALY_STATUS_DATA_LEN_62) return false;
+    memset(out, 0, sizeof(*out));
+
+    uint16_t cells = dalyGet16BE(frame, frameLen, DALY_CELL_COUNT_OFFSET);
+    uint16_t temps = dalyGet16BE(frame, frameLen, DALY_TEMP_COUNT_OFFSET);
+    out->cellCount = (uint8_t)(cells < DALY_MAX_CELLS ? cells : DALY_MAX_CELLS);
+    out->tempCount = (uint8_t)(temps < DALY_MAX_TEMPS ? temps : DALY_MAX_TEMPS);
+
+    out->packVoltageMilliVolts    = (uint32_t)dalyGet16BE(frame, frameLen, DALY_PACK_VOLTAGE_OFFSET) * 100UL;
+    out->packCurrentMilliAmps     = ((int32_t)dalyGet16BE(frame, frameLen, DALY_PACK_CURRENT_OFFSET) - 30000) * 100L;
+    out->socPercent               = (uint8_t)((dalyGet16BE(frame, frameLen, DALY_SOC_OFFSET) + 5) / 10);
+    out->remainingCapacityMilliAh = (uint32_t)dalyGet16BE(frame, frameLen, DALY_REMAINING_OFFSET) * 100UL;
+    out->cycleCount               = dalyGet16BE(frame, frameLen, DALY_CYCLES_OFFSET);
+    out->balanceEnabled           = dalyGet16BE(frame, frameLen, DALY_BALANCE_OFFSET) == 0x0001;
+    out->chargeEnabled            = dalyGet16BE(frame, frameLen, DALY_CHARGE_FET_OFFSET) == 0x0001;
+    out->dischargeEnabled         = dalyGet16BE(frame, frameLen, DALY_DISCHARGE_FET_OFFSET) == 0x0001;
+
+    for (uint8_t i = 0; i < out->cellCount; i++) {
+        out->cellVoltagesMv[i] = dalyGet16BE(frame, frameLen, DALY_CELL_BASE_OFFSET + (size_t)i * 2);
+    }
+    for (uint8_t i = 0; i < out->tempCount; i++) {
+        out->tempsCelsius[i] = (int16_t)dalyGet16BE(frame, frameLen, DALY_TEMP_BASE_OFFSET + (size_t)i * 2) - 40;
+    }
+    return true;
+}
+
+#endif // DALY_BMS_PARSER_H
@@ -0,0 +1,188 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// Incremental Daly (Modbus-over-BLE) response framer -- no Arduino deps,
+// host-testable.
+//
+//   D2 | FN | LEN | DATA[LEN] | CRC_L | CRC_H
+//   CRC-16/Modbus over D2..DATA, little-endian
+//
+// Same contract as JbdFrameParser: bytes in any chunking, validated frames
+// out through the callback, a false D2 dropped at the first header byte
+// that does not fit, a candidate that fails its CRC rescanned from its next
+// D2 and nothing else rescanned. The driver only ever sends the status
+// read (DalyBmsParser.h), so a reply is FN kFunction with LEN kDataLen. The
+// CRC is folded in per byte, so a frame is checked when its last byte
+// arrives.
+struct DalyFrame {
+    uint8_t        function;
+    uint8_t        dataLen;
+    const uint8_t* data;
+    const uint8_t* raw;        // D2..CRC_H
+    size_t         rawLen;
+};
+
+// Reflected polynomial 0xA001, four bits per step: a 32-byte table instead
+// of eight shifts per byte.
+inline uint16_t dalyCrc16ModbusUpdate(uint16_t crc, uint8_t b) {
+    static const uint16_t kNibble[16] = {
+        0x0000, 0xCC01, 0xD801, 0x1400, 0xF001, 0x3C00, 0x2800, 0xE401,
+        0xA001, 0x6C00, 0x7800, 0xB401, 0x5000, 0x9C01, 0x8801, 0x4400,
+    };
+    crc = (uint16_t)((crc >> 4) ^ kNibble[(crc ^ b) & 0x0F]);
+    crc = (uint16_t)((crc >> 4) ^ kNibble[(crc ^ (b >> 4)) & 0x0F]);
+    return crc;
+}
+
+inline uint16_t dalyCrc16Modbus(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) crc = dalyCrc16ModbusUpdate(crc, data[i]);
+    return crc;
+}
+
+class DalyFrameParser {
+public:
+    static const uint8_t kStart = 0xD2;         // device address
+    static const uint8_t kFunction = 0x03;      // read holding registers
+    static const uint8_t kDataLen = 62 * 2;     // the 62 status registers
+    static const size_t  kMaxFrameLen = 3 + kDataLen + 2;
+
+    DalyFrameParser() : state_(Sync), rawLen_(0), crc_(0xFFFF), frames_(0), rejected_(0) {}
+
+    // onFrame(const DalyFrame&) runs for every frame with a good CRC; the
+    // frame points into the parser and is only valid during the call.
+    template <class OnFrame>
+    void feed(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        size_t i = 0;
+        while (i < len) {
+            if (state_ == Sync) {
+                // Between frames: straight to the next D2
+                const void* at = memchr(data + i, kStart, len - i);
+                if (at == nullptr) return;
+                i = (size_t)((const uint8_t*)at - data);
+            } else if (state_ == Data) {
+                // Payload: whatever of it this chunk holds, in one go
+                size_t n = 3u + raw_[2] - rawLen_;
+                if (n > len - i) n = len - i;
+                memcpy(raw_ + rawLen_, data + i, n);
+                for (size_t k = 0; k < n; k++) crc_ = dalyCrc16ModbusUpdate(crc_, data[i + k]);
+                rawLen_ += n;
+                i += n;
+                if (rawLen_ == 3u + raw_[2]) state_ = CrcLo;
+                continue;
+            }
+            if (step(data[i++], onFrame) == Rejected) rescan(onFrame);
+        }
+    }
+
+    // Drops a partial frame (a new connection).
+    void reset() {
+        state_ = Sync;
+        rawLen_ = 0;
+    }
+
+    uint32_t frames() const { return frames_; }
+    uint32_t rejected() const { return rejected_; }   // CRC failed
+
+private:
+    enum State { Sync, Function, Len, Data, CrcLo, CrcHi };
+    enum Step { Idle, Started, InFrame, Emitted, Rejected };
+
+    // Drops the candidate; b starts the next one if it is a D2.
+    Step start(uint8_t b) {
+        reset();
+        if (b != kStart) return Idle;
+        raw_[0] = b;
+        rawLen_ = 1;
+        crc_ = dalyCrc16ModbusUpdate(0xFFFF, b);
+        state_ = Function;
+        return Started;
+    }
+
+    bool headerFits(uint8_t b) const {
+        switch (state_) {
+            case Function: return b == kFunction;
+            case Len:      return b == kDataLen;
+            default:       return true;
+        }
+    }
+
+    template <class OnFrame>
+    Step step(uint8_t b, OnFrame& onFrame) {
+        if (state_ == Sync || !headerFits(b)) return start(b);
+        raw_[rawLen_++] = b;
+        switch (state_) {
+            case Function:
+                crc_ = dalyCrc16ModbusUpdate(crc_, b);
+                state_ = Len;
+                break;
+            case Len:
+                crc_ = dalyCrc16ModbusUpdate(crc_, b);
+                state_ = b == 0 ? CrcLo : Data;
+                break;
+            case Data:
+                crc_ = dalyCrc16ModbusUpdate(crc_, b);
+                if (rawLen_ == 3u + raw_[2]) state_ = CrcLo;
+                break;
+            case CrcLo:
+                state_ = CrcHi;
+                break;
+            case CrcHi: {
+                const uint16_t received = (uint16_t)(raw_[rawLen_ - 2] | (b << 8));
+                if (received != crc_) {
+                    rejected_++;
+                    return Rejected;
+                }
+                DalyFrame frame;
+                frame.function = raw_[1];
+                frame.dataLen = raw_[2];
+                frame.data = raw_ + 3;
+                frame.raw = raw_;
+                frame.rawLen = rawLen_;
+                frames_++;
+                onFrame(frame);
+                reset();
+                return Emitted;
+            }
+            default:
+                break;
+        }
+        return InFrame;
+    }
+
+    // See JbdFrameParser::rescan().
+    template <class OnFrame>
+    void rescan(OnFrame& onFrame) {
+        uint8_t pending[kMaxFrameLen];
+        const size_t n = rawLen_;
+        memcpy(pending, raw_, n);
+        reset();
+        size_t from = 0;
+        size_t i = 1;
+        while (i < n) {
+            if (state_ == Sync) {
+                const void* at = memchr(pending + i, kStart, n - i);
+                if (at == nullptr) return;
+                i = (size_t)((const uint8_t*)at - pending);
+            }
+            const Step s = step(pending[i], onFrame);
+            if (s == Started) from = i;
+            if (s == Rejected) {
+                reset();
+                i = from + 1;
+                continue;
+            }
+            i++;
+        }
+    }
+
+    State    state_;
+    uint8_t  raw_[kMaxFrameLen];
+    size_t   rawLen_;
+    uint16_t crc_;
+    uint32_t frames_;
+    uint32_t rejected_;
+};
@@ -0,0 +1,137 @@
+#include "EventJournal.h"
+#include "../Clock/Clock.h"
+#include <LittleFS.h>
+#include <esp_system.h>
+
+static const char JOURNAL_PATH[] = "/events.jnl";
+static const char JOURNAL_OLD_PATH[] = "/events.old";
+
+EventJournal::EventJournal()
+    : queue_(nullptr),
+      fileMutex_(nullptr),
+      writerTask_(nullptr),
+      dropped_(0) {}
+
+void EventJournal::init() {
+    fileMutex_ = xSemaphoreCreateMutex();
+    queue_ = xQueueCreate(QUEUE_DEPTH, EventJournalFormat::kRecordSize);
+    if (fileMutex_ == nullptr || queue_ == nullptr) {
+        Serial.println("EventJournal: queue or mutex create failed");
+        queue_ = nullptr;
+        return;
+    }
+    if (xTaskCreate(writerTask, "event_journal", WRITER_STACK_SIZE, this, WRITER_PRIORITY, &writerTask_) != pdPASS) {
+        Serial.println("EventJournal: writer task create failed");
+        queue_ = nullptr;
+        return;
+    }
+    record(EventJournalFormat::EventBoot, (uint8_t)esp_reset_reason());
+}
+
+void EventJournal::record(EventJournalFormat::EventId id, uint8_t arg, uint16_t value) {
+    if (queue_ == nullptr) {
+        dropped_++;
+        return;
+    }
+    EventJournalFormat::Event e;
+    e.uptimeUs = Clock::nowUs();
+    uint64_t epochUs;
+    e.epochS = Clock::epochUsAt(e.uptimeUs, epochUs) ? (uint32_t)(epochUs / 1000000) : 0;
+    e.id = id;
+    e.arg = arg;
+    e.value = value;
+    uint8_t encoded[EventJournalFormat::kRecordSize];
+    EventJournalFormat::encodeEvent(e, encoded);
+    if (xQueueSend(queue_, encoded, 0) != pdTRUE) {
+        dropped_++;
+    }
+}
+
+// Waits for one event, then takes whatever else is queued: a burst (a
+// fault disarm and the signal loss behind it) is one write.
+void EventJournal::writerTask(void* arg) {
+    EventJournal* self = static_cast<EventJournal*>(arg);
+    uint8_t batch[QUEUE_DEPTH * EventJournalFormat::kRecordSize];
+    for (;;) {
+        if (xQueueReceive(self->queue_, batch, portMAX_DELAY) != pdTRUE) continue;
+        size_t len = EventJournalFormat::kRecordSize;
+        while (len < sizeof(batch) && xQueueReceive(self->queue_, batch + len, 0) == pdTRUE) {
+            len += EventJournalFormat::kRecordSize;
+        }
+        self->append(batch, len);
+    }
+}
+
+void EventJournal::append(const uint8_t* records, size_t len) {
+    xSemaphoreTake(fileMutex_, portMAX_DELAY);
+    uint32_t size = 0;
+    bool otherLayout = false;
+    if (LittleFS.exists(JOURNAL_PATH)) {
+        File probe = LittleFS.open(JOURNAL_PATH, "r");
+        if (probe) {
+            uint8_t head[EventJournalFormat::kHeaderSize];
+            const size_t got = probe.read(head, sizeof(head));
+            uint8_t version = 0;
+            const size_t recordSize = EventJournalFormat::decodeHeader(head, got, version);
+            // Not a journal (torn header): start over. Another firmware's
+            // layout: set it aside, where it stays readable.
+            size = recordSize != 0 ? probe.size() : 0;
+            otherLayout = recordSize != 0
+                && (recordSize != EventJournalFormat::kRecordSize || version != EventJournalFormat::kVersion);
+            probe.close();
+        }
+    }
+    if (otherLayout || EventJournalFormat::shouldRotate(size, len)) {
+        LittleFS.remove(JOURNAL_OLD_PATH);
+        LittleFS.rename(JOURNAL_PATH, JOURNAL_OLD_PATH);
+        size = 0;
+    }
+
+    File file = LittleFS.open(JOURNAL_PATH, size == 0 ? "w" : "a");
+    bool ok = (bool)file;
+    if (ok && size == 0) {
+        uint8_t head[EventJournalFormat::kHeaderSize];
+        EventJournalFormat::encodeHeader(head);
+        ok = file.write(head, sizeof(head)) == sizeof(head);
+    }
+    ok = ok && file.write(records, len) == len;
+    if (file) file.close();
+    xSemaphoreGive(fileMutex_);
+    if (!ok) {
+        Serial.println("EventJournal: write failed");
+        dropped_ += len / EventJournalFormat::kRecordSize;
+    }
+}
+
+// Records are fixed-size, so the newest are found from the file size
+// without reading the rest.
+size_t EventJournal::readFileBackwards(const char* path, EventJournalFormat::Event* out, size_t max) {
+    if (max == 0 || !LittleFS.exists(path)) return 0;
+    File file = LittleFS.open(path, "r");
+    if (!file) return 0;
+    uint8_t buf[UINT8_MAX];
+    uint8_t version = 0;
+    const size_t recordSize = EventJournalFormat::decodeHeader(buf, file.read(buf, EventJournalFormat::kHeaderSize), version);
+    if (recordSize == 0) {
+        file.close();
+        return 0;
+    }
+    const size_t count = (file.size() - EventJournalFormat::kHeaderSize) / recordSize;
+    size_t n = 0;
+    for (size_t i = count; i > 0 && n < max; i--) {
+        file.seek(EventJournalFormat::kHeaderSize + (i - 1) * recordSize);
+        if (file.read(buf, recordSize) != recordSize) break;
+        EventJournalFormat::decodeEvent(buf, out[n++], version);
+    }
+    file.close();
+    return n;
+}
+
+size_t EventJournal::readLatest(EventJournalFormat::Event* out, size_t max) {
+    if (fileMutex_ == nullptr) return 0;
+    xSemaphoreTake(fileMutex_, portMAX_DELAY);
+    size_t n = readFileBackwards(JOURNAL_PATH, out, max);
+    n += readFileBackwards(JOURNAL_OLD_PATH, out + n, max - n);
+    xSemaphoreGive(fileMutex_);
+    return n;
+}
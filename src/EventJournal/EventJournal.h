@@ -0,0 +1,49 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "EventJournalFormat.h"
+
+/**
+ * Append-only journal of faults and state transitions (disarm reasons,
+ * signal-loss trips, CAN bus-off, BMS link, power-limit changes), kept on
+ * LittleFS across reboots, separate from the flight logs.
+ *
+ * record() may be called from any task: it stamps the event and queues it
+ * without waiting, so the caller never touches flash. A low-priority task
+ * appends whatever is queued in one write and rotates the file at
+ * EventJournalFormat::kMaxFileBytes, keeping the previous one.
+ */
+class EventJournal {
+public:
+    EventJournal();
+    /** After LittleFS is mounted (Logger::init()). Records EventBoot. */
+    void init();
+    /** Any task. Counted as dropped when the queue is full or before init(). */
+    void record(EventJournalFormat::EventId id, uint8_t arg = 0, uint16_t value = 0);
+
+    /**
+     * Copies up to `max` of the latest events, newest first; returns how
+     * many. Reads the files under a lock the writer also takes: web server
+     * only, never the loop.
+     */
+    size_t readLatest(EventJournalFormat::Event* out, size_t max);
+
+    uint32_t getDropped() const { return dropped_; }
+
+private:
+    static const size_t QUEUE_DEPTH = 16;
+    static const uint32_t WRITER_STACK_SIZE = 3072;
+    static const UBaseType_t WRITER_PRIORITY = 1;
+
+    QueueHandle_t queue_;
+    SemaphoreHandle_t fileMutex_;   // writer appending/rotating vs web readers
+    TaskHandle_t writerTask_;
+    volatile uint32_t dropped_;
+
+    static void writerTask(void* arg);
+    void append(const uint8_t* records, size_t len);
+    size_t readFileBackwards(const char* path, EventJournalFormat::Event* out, size_t max);
+};
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Binary event journal: faults and state transitions, one fixed-size
+// record each -- no Arduino deps, host-testable.
+//
+// File: kHeaderSize bytes -- magic "FEVJ", version u8, recordSize u8, two
+// reserved bytes -- then records, all little-endian:
+//   uptimeUs u64 | epochS u32 (0 = clock not set) | id u8 | arg u8 | value u16
+// uptimeUs is Clock::nowUs(), the clock flight log records are stamped
+// with. Version 1 records were uptimeMs u32 | epochS | id | arg | value.
+// A reader skips the trailing bytes of a record longer than it knows, and
+// stops at a torn last record.
+//
+// The journal is two files: the current one and, once it reaches
+// kMaxFileBytes, the previous one. It never touches the flight logs' space
+// budget and survives their rotation.
+namespace EventJournalFormat {
+
+static const uint8_t kVersion = 2;
+static const size_t  kHeaderSize = 8;
+static const size_t  kRecordSize = 16;
+static const size_t  kRecordSizeV1 = 12;
+static const char    kMagic[4] = {'F', 'E', 'V', 'J'};
+static const uint32_t kMaxFileBytes = 6 * 1024;   // ~380 events per file
+
+// Ids are stored: append only, never renumber.
+enum EventId : uint8_t {
+    EventBoot            = 1,   // arg: esp_reset_reason()
+    EventArmed           = 2,
+    EventDisarmed        = 3,   // arg: DisarmReason
+    EventSignalLost      = 4,   // arg: SignalLost*; the contract that tripped
+    EventCanBusOff       = 5,
+    EventCanRecovered    = 6,
+    EventBmsConnected    = 7,   // arg: BMS type (Settings BmsType*), value: pack index
+    EventBmsDisconnected = 8,   // arg: BMS type, value: pack index
+    EventPowerLimit      = 9,   // arg: active limit causes, 0 when cleared
+};
+
+enum SignalLostArg : uint8_t {
+    SignalLostMotorTemp      = 1,
+    SignalLostEscTemp        = 2,
+    SignalLostBatteryVoltage = 3,
+};
+
+struct Event {
+    uint64_t uptimeUs;
+    uint32_t epochS;
+    uint8_t  id;
+    uint8_t  arg;
+    uint16_t value;
+};
+
+// Short stable code for the JSON API and the logs page.
+inline const char* eventCode(uint8_t id) {
+    switch (id) {
+        case EventBoot:            return "BOOT";
+        case EventArmed:           return "ARM";
+        case EventDisarmed:        return "DISARM";
+        case EventSignalLost:      return "SIGNAL_LOST";
+        case EventCanBusOff:       return "CAN_BUS_OFF";
+        case EventCanRecovered:    return "CAN_RECOVERED";
+        case EventBmsConnected:    return "BMS_CONNECTED";
+        case EventBmsDisconnected: return "BMS_DISCONNECTED";
+        case EventPowerLimit:      return "POWER_LIMIT";
+    }
+    return "UNKNOWN";
+}
+
+inline void encodeHeader(uint8_t* out) {
+    memcpy(out, kMagic, sizeof(kMagic));
+    out[4] = kVersion;
+    out[5] = (uint8_t)kRecordSize;
+    out[6] = 0;
+    out[7] = 0;
+}
+
+// Record size of the file, or 0 if this is not a journal. `version` is
+// what decodeEvent() needs to read its records.
+inline size_t decodeHeader(const uint8_t* in, size_t len, uint8_t& version) {
+    if (len < kHeaderSize || memcmp(in, kMagic, sizeof(kMagic)) != 0) return 0;
+    version = in[4];
+    if (version == 0 || in[5] < (version == 1 ? kRecordSizeV1 : kRecordSize)) return 0;
+    return in[5];
+}
+
+inline void encodeEvent(const Event& e, uint8_t* out) {
+    for (uint8_t i = 0; i < 8; i++) out[i] = (uint8_t)(e.uptimeUs >> (8 * i));
+    for (uint8_t i = 0; i < 4; i++) out[8 + i] = (uint8_t)(e.epochS >> (8 * i));
+    out[12] = e.id;
+    out[13] = e.arg;
+    out[14] = (uint8_t)e.value;
+    out[15] = (uint8_t)(e.value >> 8);
+}
+
+inline void decodeEvent(const uint8_t* in, Event& e, uint8_t version = kVersion) {
+    e.uptimeUs = 0;
+    e.epochS = 0;
+    if (version == 1) {
+        for (uint8_t i = 0; i < 4; i++) e.uptimeUs |= (uint64_t)in[i] << (8 * i);
+        e.uptimeUs *= 1000;
+        in += 4;
+    } else {
+        for (uint8_t i = 0; i < 8; i++) e.uptimeUs |= (uint64_t)in[i] << (8 * i);
+        in += 8;
+    }
+    for (uint8_t i = 0; i < 4; i++) e.epochS |= (uint32_t)in[i] << (8 * i);
+    e.id = in[4];
+    e.arg = in[5];
+    e.value = (uint16_t)(in[6] | (in[7] << 8));
+}
+
+// Whether appending `adding` bytes to a file of `size` bytes should first
+// move it aside and start a new one.
+inline bool shouldRotate(uint32_t size, uint32_t adding) {
+    return size > kHeaderSize && size + adding > kMaxFileBytes;
+}
+
+} // namespace EventJournalFormat
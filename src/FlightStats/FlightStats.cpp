@@ -0,0 +1,111 @@
+#include "FlightStats.h"
+#include "../config.h"
+#include "../Telemetry/TelemetryAvailability.h"
+#include "../Logger/Logger.h"
+
+extern Logger logger;
+
+FlightStats::FlightStats()
+    : hasPublished_(false),
+      publishedInFlight_(false),
+      stateMutex_(nullptr),
+      wasArmed_(false),
+      lastPublishMs_(0),
+      lastSaveMs_(0) {
+    memset(&published_, 0, sizeof(published_));
+    logPath_[0] = '\0';
+}
+
+void FlightStats::init() {
+    stateMutex_ = xSemaphoreCreateMutex();
+}
+
+void FlightStats::handle(bool isArmed) {
+    const unsigned long now = millis();
+
+    if (isArmed && !wasArmed_) {
+        acc_.reset(now);
+        logPath_[0] = '\0';
+        lastSaveMs_ = now;
+    }
+
+    if (isArmed) {
+        acc_.addSample(takeSample(now));
+
+        // The logger's writer task creates the file shortly after arm;
+        // remember it so the summary still lands next to it after the
+        // logger lets go.
+        if (logPath_[0] == '\0') {
+            logger.getCurrentFileName(logPath_, sizeof(logPath_));
+        }
+
+        if (now - lastPublishMs_ >= PUBLISH_INTERVAL_MS) {
+            lastPublishMs_ = now;
+            publish(true);
+        }
+        if (now - lastSaveMs_ >= SAVE_INTERVAL_MS) {
+            lastSaveMs_ = now;
+            saveSummary();
+        }
+    } else if (wasArmed_) {
+        publish(false);
+        saveSummary();
+    }
+
+    wasArmed_ = isArmed;
+}
+
+bool FlightStats::getSummary(FlightSummary& out, bool& inFlight) const {
+    if (stateMutex_ == nullptr) return false;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    const bool has = hasPublished_;
+    out = published_;
+    inFlight = publishedInFlight_;
+    xSemaphoreGive(stateMutex_);
+    return has;
+}
+
+FlightStatsSample FlightStats::takeSample(unsigned long nowMs) const {
+    FlightStatsSample s;
+    memset(&s, 0, sizeof(s));
+    s.nowMs = nowMs;
+    s.hasBatteryVoltage = telemetry.isBatteryVoltageValid();
+    s.batteryVoltageMv = telemetry.getBatteryVoltageMilliVolts();
+    s.hasCurrent = isCurrentAvailable();
+    s.currentMa = telemetry.getBatteryCurrentMilliAmps();
+    s.hasMotorTemp = telemetry.isMotorTempValid();
+    s.motorTempMc = telemetry.getMotorTempMilliCelsius();
+    s.hasEscTemp = telemetry.isEscTempValid();
+    s.escTempMc = telemetry.getEscTempMilliCelsius();
+    BmsSnapshot bms;
+    bluetoothBms.getSnapshot(bms);
+    s.hasCells = bms.hasCellData;
+    if (s.hasCells) {
+        s.cellMinMv = bms.cellMinMv;
+        s.cellMaxMv = bms.cellMaxMv;
+    }
+    s.limitCauses = power.getActiveLimitCauses();
+    return s;
+}
+
+void FlightStats::publish(bool inFlight) {
+    if (stateMutex_ == nullptr) return;
+    FlightSummary summary;
+    acc_.getSummary(summary);
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    published_ = summary;
+    publishedInFlight_ = inFlight;
+    hasPublished_ = true;
+    xSemaphoreGive(stateMutex_);
+}
+
+// Only a RAM copy here: the logger's writer task writes the .sum file.
+void FlightStats::saveSummary() {
+    if (logPath_[0] == '\0') return;
+    FlightSummary summary;
+    acc_.getSummary(summary);
+    uint8_t record[FlightSummaryCodec::kEncodedSize];
+    const size_t len = FlightSummaryCodec::encode(summary, record, sizeof(record));
+    if (len == 0) return;
+    logger.setLogSummary(logPath_, record, len);
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+#include "FlightStatsLogic.h"
+
+// Per-flight summary (peaks, minima, means, energy, time limited), reset on
+// arm. The accumulator is loop-owned; the web server reads the copy
+// published under stateMutex_. On disarm -- and periodically while armed,
+// so a power loss keeps most of the flight -- the summary is handed to the
+// logger, whose writer task saves it next to the flight's log file (see
+// FlightSummaryCodec::summaryPathFor()); the loop never touches flash.
+class FlightStats {
+public:
+    FlightStats();
+    void init();
+    void handle(bool isArmed);
+
+    // Latest summary: the flight in progress, or the last one since boot.
+    // Returns false if there has been no flight since boot.
+    bool getSummary(FlightSummary& out, bool& inFlight) const;
+
+private:
+    static const unsigned long PUBLISH_INTERVAL_MS = 500;
+    static const unsigned long SAVE_INTERVAL_MS = 30000;
+    static const size_t LOG_PATH_SIZE = 32;
+
+    FlightStatsAccumulator acc_;
+    FlightSummary published_;
+    bool hasPublished_;
+    bool publishedInFlight_;
+    SemaphoreHandle_t stateMutex_;
+    bool wasArmed_;
+    unsigned long lastPublishMs_;
+    unsigned long lastSaveMs_;
+    char logPath_[LOG_PATH_SIZE];
+
+    FlightStatsSample takeSample(unsigned long nowMs) const;
+    void publish(bool inFlight);
+    void saveSummary();
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Pure per-flight statistics -- no Arduino deps, host-testable.
+//
+// One FlightStatsSample per loop tick goes into FlightStatsAccumulator, which
+// keeps running peaks/minima and time integrals in O(1) per sample. Nothing
+// is buffered, so a two-hour flight costs the same RAM as a two-second one.
+//
+// Time weighting is zero-order hold: each sample's values are held until the
+// next sample arrives, so a 5 ms tick and a 300 ms loop stall weigh
+// correctly. A gap longer than kMaxSampleGapMs (debugger halt, a blocking
+// flash erase) is clipped so one frozen value cannot dominate the means.
+//
+// Power-limit time uses the PowerLimitCause bits from Power/Power.h
+// (battery=1, motorTemp=2, escTemp=4), held the same way.
+
+// Inputs for one tick. Each has* flag says whether the value is trustworthy
+// this tick; unavailable values are neither held nor folded into peaks.
+struct FlightStatsSample {
+    uint32_t nowMs;
+    bool     hasBatteryVoltage;
+    uint16_t batteryVoltageMv;
+    bool     hasCurrent;
+    uint32_t currentMa;
+    bool     hasMotorTemp;
+    int32_t  motorTempMc;
+    bool     hasEscTemp;
+    int32_t  escTempMc;
+    bool     hasCells;
+    uint16_t cellMinMv;
+    uint16_t cellMaxMv;
+    uint8_t  limitCauses;
+};
+
+enum FlightSummaryFlag : uint8_t {
+    FlightSummaryHasBatteryVoltage = 1 << 0,
+    FlightSummaryHasCurrent        = 1 << 1,   // current, power, mAh and Wh
+    FlightSummaryHasMotorTemp      = 1 << 2,
+    FlightSummaryHasEscTemp        = 1 << 3,
+    FlightSummaryHasCells          = 1 << 4,
+};
+
+// Index into FlightSummary::limitMs, matching PowerLimitCause bit order.
+enum FlightLimitIndex : uint8_t {
+    FlightLimitBattery = 0,
+    FlightLimitMotorTemp,
+    FlightLimitEscTemp,
+    FlightLimitCount
+};
+
+// Snapshot of one flight, as shown in /api/telemetry and persisted next to
+// the log file. Fields whose flag is clear in `flags` are meaningless.
+struct FlightSummary {
+    uint8_t  flags;
+    uint32_t durationMs;
+    uint16_t minBatteryVoltageMv;
+    uint32_t maxCurrentMa;
+    uint32_t meanCurrentMa;
+    uint32_t maxPowerW;
+    uint32_t meanPowerW;
+    uint32_t usedMah;
+    uint32_t usedWhX10;            // Wh x10 (123 => 12.3 Wh), like powerKwX10
+    int32_t  maxMotorTempMc;
+    int32_t  meanMotorTempMc;
+    int32_t  maxEscTempMc;
+    int32_t  meanEscTempMc;
+    uint16_t minCellMv;
+    uint16_t maxCellDeltaMv;
+    uint32_t limitMs[FlightLimitCount];
+
+    bool has(FlightSummaryFlag flag) const { return (flags & flag) != 0; }
+};
+
+class FlightStatsAccumulator {
+public:
+    static const uint32_t kMaxSampleGapMs = 1000;
+
+    FlightStatsAccumulator() { reset(0); }
+
+    // Starts a new flight at nowMs (called on arm).
+    void reset(uint32_t nowMs) {
+        memset(&acc_, 0, sizeof(acc_));
+        memset(&held_, 0, sizeof(held_));
+        startMs_ = nowMs;
+        lastMs_ = nowMs;
+        hasHeld_ = false;
+        currentMaMs_ = 0;
+        powerMwMs_ = 0;
+        currentTimeMs_ = 0;
+        powerTimeMs_ = 0;
+        motorTempMcMs_ = 0;
+        motorTempTimeMs_ = 0;
+        escTempMcMs_ = 0;
+        escTempTimeMs_ = 0;
+    }
+
+    void addSample(const FlightStatsSample& s) {
+        if (hasHeld_) {
+            uint32_t dt = s.nowMs - lastMs_;
+            if (dt > kMaxSampleGapMs) dt = kMaxSampleGapMs;
+            integrate(dt);
+            acc_.durationMs += dt;
+        }
+        lastMs_ = s.nowMs;
+        held_ = s;
+        hasHeld_ = true;
+
+        if (s.hasBatteryVoltage) {
+            if (!(acc_.flags & FlightSummaryHasBatteryVoltage) || s.batteryVoltageMv < acc_.minBatteryVoltageMv) {
+                acc_.minBatteryVoltageMv = s.batteryVoltageMv;
+            }
+            acc_.flags |= FlightSummaryHasBatteryVoltage;
+        }
+        if (s.hasCurrent) {
+            if (s.currentMa > acc_.maxCurrentMa) acc_.maxCurrentMa = s.currentMa;
+            if (s.hasBatteryVoltage) {
+                const uint32_t powerW = (uint32_t)(((uint64_t)s.batteryVoltageMv * s.currentMa) / 1000000ULL);
+                if (powerW > acc_.maxPowerW) acc_.maxPowerW = powerW;
+            }
+            acc_.flags |= FlightSummaryHasCurrent;
+        }
+        if (s.hasMotorTemp) {
+            if (!(acc_.flags & FlightSummaryHasMotorTemp) || s.motorTempMc > acc_.maxMotorTempMc) {
+                acc_.maxMotorTempMc = s.motorTempMc;
+            }
+            acc_.flags |= FlightSummaryHasMotorTemp;
+        }
+        if (s.hasEscTemp) {
+            if (!(acc_.flags & FlightSummaryHasEscTemp) || s.escTempMc > acc_.maxEscTempMc) {
+                acc_.maxEscTempMc = s.escTempMc;
+            }
+            acc_.flags |= FlightSummaryHasEscTemp;
+        }
+        if (s.hasCells && s.cellMinMv > 0 && s.cellMaxMv >= s.cellMinMv) {
+            if (!(acc_.flags & FlightSummaryHasCells) || s.cellMinMv < acc_.minCellMv) {
+                acc_.minCellMv = s.cellMinMv;
+            }
+            const uint16_t delta = (uint16_t)(s.cellMaxMv - s.cellMinMv);
+            if (delta > acc_.maxCellDeltaMv) acc_.maxCellDeltaMv = delta;
+            acc_.flags |= FlightSummaryHasCells;
+        }
+    }
+
+    void getSummary(FlightSummary& out) const {
+        out = acc_;
+        out.meanCurrentMa   = currentTimeMs_ ? (uint32_t)(currentMaMs_ / currentTimeMs_) : 0;
+        out.meanPowerW      = powerTimeMs_ ? (uint32_t)(powerMwMs_ / powerTimeMs_ / 1000) : 0;
+        out.usedMah         = (uint32_t)(currentMaMs_ / 3600000ULL);
+        out.usedWhX10       = (uint32_t)(powerMwMs_ / 360000000ULL);
+        out.meanMotorTempMc = motorTempTimeMs_ ? (int32_t)(motorTempMcMs_ / (int64_t)motorTempTimeMs_) : 0;
+        out.meanEscTempMc   = escTempTimeMs_ ? (int32_t)(escTempMcMs_ / (int64_t)escTempTimeMs_) : 0;
+    }
+
+    uint32_t getStartMs() const { return startMs_; }
+
+private:
+    FlightSummary     acc_;
+    FlightStatsSample held_;
+    bool     hasHeld_;
+    uint32_t startMs_;
+    uint32_t lastMs_;
+
+    // Time integrals of the held values, and how long each was available.
+    // mA*ms and mW*ms stay below 2^63 for far longer than any battery lasts.
+    uint64_t currentMaMs_;
+    uint64_t powerMwMs_;
+    uint32_t currentTimeMs_;
+    uint32_t powerTimeMs_;
+    int64_t  motorTempMcMs_;
+    uint32_t motorTempTimeMs_;
+    int64_t  escTempMcMs_;
+    uint32_t escTempTimeMs_;
+
+    void integrate(uint32_t dt) {
+        if (held_.hasCurrent) {
+            currentMaMs_ += (uint64_t)held_.currentMa * dt;
+            currentTimeMs_ += dt;
+            if (held_.hasBatteryVoltage) {
+                const uint64_t powerMw = ((uint64_t)held_.batteryVoltageMv * held_.currentMa) / 1000;
+                powerMwMs_ += powerMw * dt;
+                powerTimeMs_ += dt;
+            }
+        }
+        if (held_.hasMotorTemp) {
+            motorTempMcMs_ += (int64_t)held_.motorTempMc * dt;
+            motorTempTimeMs_ += dt;
+        }
+        if (held_.hasEscTemp) {
+            escTempMcMs_ += (int64_t)held_.escTempMc * dt;
+            escTempTimeMs_ += dt;
+        }
+        for (uint8_t i = 0; i < FlightLimitCount; i++) {
+            if (held_.limitCauses & (1u << i)) acc_.limitMs[i] += dt;
+        }
+    }
+};
+
+// Fixed little-endian record for the per-log summary file, so the logs page
+// can show a flight without reading the CSV. Bump kVersion on any layout
+// change; decode() rejects anything it does not know.
+namespace FlightSummaryCodec {
+
+static const uint8_t kMagic0 = 'F';
+static const uint8_t kMagic1 = 'S';
+static const uint8_t kVersion = 1;
+static const size_t  kEncodedSize = 3 + 1 + 4 + 2 + 4 * 6 + 4 * 4 + 2 + 2 + 4 * FlightLimitCount;
+
+inline void putU16(uint8_t*& p, uint16_t v) { *p++ = (uint8_t)v; *p++ = (uint8_t)(v >> 8); }
+inline void putU32(uint8_t*& p, uint32_t v) { for (uint8_t i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i)); }
+inline uint16_t getU16(const uint8_t*& p) { uint16_t v = (uint16_t)(p[0] | (p[1] << 8)); p += 2; return v; }
+inline uint32_t getU32(const uint8_t*& p) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    p += 4;
+    return v;
+}
+
+// Returns kEncodedSize, or 0 if cap is too small.
+inline size_t encode(const FlightSummary& s, uint8_t* out, size_t cap) {
+    if (cap < kEncodedSize) return 0;
+    uint8_t* p = out;
+    *p++ = kMagic0;
+    *p++ = kMagic1;
+    *p++ = kVersion;
+    *p++ = s.flags;
+    putU32(p, s.durationMs);
+    putU16(p, s.minBatteryVoltageMv);
+    putU32(p, s.maxCurrentMa);
+    putU32(p, s.meanCurrentMa);
+    putU32(p, s.maxPowerW);
+    putU32(p, s.meanPowerW);
+    putU32(p, s.usedMah);
+    putU32(p, s.usedWhX10);
+    putU32(p, (uint32_t)s.maxMotorTempMc);
+    putU32(p, (uint32_t)s.meanMotorTempMc);
+    putU32(p, (uint32_t)s.maxEscTempMc);
+    putU32(p, (uint32_t)s.meanEscTempMc);
+    putU16(p, s.minCellMv);
+    putU16(p, s.maxCellDeltaMv);
+    for (uint8_t i = 0; i < FlightLimitCount; i++) putU32(p, s.limitMs[i]);
+    return (size_t)(p - out);
+}
+
+inline bool decode(const uint8_t* in, size_t len, FlightSummary& s) {
+    if (len != kEncodedSize || in[0] != kMagic0 || in[1] != kMagic1 || in[2] != kVersion) return false;
+    const uint8_t* p = in + 3;
+    s.flags = *p++;
+    s.durationMs = getU32(p);
+    s.minBatteryVoltageMv = getU16(p);
+    s.maxCurrentMa = getU32(p);
+    s.meanCurrentMa = getU32(p);
+    s.maxPowerW = getU32(p);
+    s.meanPowerW = getU32(p);
+    s.usedMah = getU32(p);
+    s.usedWhX10 = getU32(p);
+    s.maxMotorTempMc = (int32_t)getU32(p);
+    s.meanMotorTempMc = (int32_t)getU32(p);
+    s.maxEscTempMc = (int32_t)getU32(p);
+    s.meanEscTempMc = (int32_t)getU32(p);
+    s.minCellMv = getU16(p);
+    s.maxCellDeltaMv = getU16(p);
+    for (uint8_t i = 0; i < FlightLimitCount; i++) s.limitMs[i] = getU32(p);
+    return true;
+}
+
+// "/20250419_003.csv" -> "/20250419_003.sum". Returns false if the result
+// does not fit or the log path has no extension.
+inline bool summaryPathFor(const char* logPath, char* out, size_t cap) {
+    const char* dot = strrchr(logPath, '.');
+    if (dot == nullptr || dot == logPath) return false;
+    const size_t stem = (size_t)(dot - logPath);
+    if (stem + 5 > cap) return false;   // ".sum" + NUL
+    memcpy(out, logPath, stem);
+    memcpy(out + stem, ".sum", 5);
+    return true;
+}
+
+} // namespace FlightSummaryCodec
@@ -7,42 +7,37 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 #include <esp_gap_ble_api.h>
+#include "../BluetoothBms/BmsGattLink.h"
 
 struct BleFrame {
     uint8_t data[16];
     size_t  len;
 };
 
-static JbdBms* s_jbdBms = nullptr;
-
 // ---------------------------------------------------------------------------
-// Global notify callback
+// Notifications, routed by bmsGattLink (BLE host task)
 // ---------------------------------------------------------------------------
-void onNotifyCallback(BLERemoteCharacteristic* pChar, uint8_t* pData, size_t length, bool isNotify) {
-    if (s_jbdBms && pData && length > 0) {
-        s_jbdBms->onNotify(pData, length);
-    }
+void JbdBms::onGattNotify(void* ctx, uint8_t* data, size_t len) {
+    static_cast<JbdBms*>(ctx)->onNotify(data, len);
 }
 
 // ---------------------------------------------------------------------------
 // Constructor
 // ---------------------------------------------------------------------------
 JbdBms::JbdBms()
-    : pClient_(nullptr), pCharRx_(nullptr), pCharTx_(nullptr),
+    : pClient_(nullptr), txHandle_(0),
       txQueue_(nullptr), txTaskHandle_(nullptr),
       connectQueue_(nullptr), connectTaskHandle_(nullptr), stateMutex_(nullptr),
       connectSessionId_(0),
-      state_(Idle), initialized_(false), enabled_(false), connected_(false), hasData_(false),
-      lastConnectAttempt_(0), lastRequestMillis_(0), rxLen_(0),
-      packVoltageMilliVolts_(0), packCurrentMilliAmps_(0), socPercent_(0),
-      cellCount_(0), ntcCount_(0), cycleCount_(0),
-      designCapacityMahl_(0), balanceCapacityMahl_(0),
+      state_(Idle), initialized_(false), enabled_(false), connected_(false),
+      subscribedMillis_(0),
+      connectCached_(false), viaCache_(false), frameSeen_(false), cacheStale_(false),
+      rxDropsSeen_(0), rxRejectsSeen_(0),
+      cycleCount_(0), designCapacityMahl_(0), balanceCapacityMahl_(0),
       chgFetEnabled_(0), dsgFetEnabled_(0), currentErrors_(0),
-      hasCellData_(false), requestCells_(false)
+      pollLevel_(BmsPollIdle)
 {
-    memset(ntcTempsCelsius_, 0, sizeof(ntcTempsCelsius_));
-    memset(cellVoltagesMv_,  0, sizeof(cellVoltagesMv_));
-    memset(rxBuffer_, 0, sizeof(rxBuffer_));
+    frame_.clear();
 }
 
 // ---------------------------------------------------------------------------
@@ -50,7 +45,6 @@ JbdBms::JbdBms()
 // ---------------------------------------------------------------------------
 void JbdBms::init() {
     if (initialized_) return;
-    s_jbdBms = this;
     stateMutex_ = xSemaphoreCreateMutex();
     connectQueue_ = xQueueCreate(1, sizeof(uint8_t));
     if (stateMutex_ == nullptr || connectQueue_ == nullptr) {
@@ -73,12 +67,17 @@ void JbdBms::setEnabled(bool enabled) {
     enabled_ = enabled;
     if (!enabled_) {
         resetConnection();
+        retry_.reset();
     }
 }
 
 void JbdBms::setMacAddress(const String& macAddress) {
-    macAddress_ = macAddress;
-    macAddress_.trim();
+    String mac = macAddress;
+    mac.trim();
+    if (mac != macAddress_) {
+        retry_.reset();
+    }
+    macAddress_ = mac;
 }
 
 // ---------------------------------------------------------------------------
@@ -104,10 +103,12 @@ void JbdBms::applyResetConnectionLocked() {
     if (txQueue_ != nullptr) {
         xQueueReset(txQueue_);
     }
+    bmsGattLink.unsubscribe(this);
     connected_ = false;
-    pCharRx_   = nullptr;
-    pCharTx_   = nullptr;
-    rxLen_     = 0;
+    txHandle_  = 0;
+    viaCache_  = false;
+    rxRing_.clear();
+    rxParser_.reset();
     state_     = Idle;
 }
 
@@ -116,6 +117,10 @@ void JbdBms::applyResetConnectionLocked() {
 // Both phases block for several seconds when the BMS is far/absent or when the
 // ATT layer is busy; running them here keeps the main loop responsive (and the
 // system-start beep can complete on time).
+//
+// Discovery only runs the first time a BMS is seen: its handles are then kept
+// by bmsGattLink (RAM + NVS), and a reconnect subscribes on them right after
+// BLEClient::connect. That is also the only reconnect allowed while armed.
 // ---------------------------------------------------------------------------
 void JbdBms::connectTask(void* arg) {
     JbdBms* self = static_cast<JbdBms*>(arg);
@@ -124,11 +129,14 @@ void JbdBms::connectTask(void* arg) {
         if (xQueueReceive(self->connectQueue_, &cmd, portMAX_DELAY) != pdTRUE) {
             continue;
         }
+        // Until the end of this attempt, the other pack's driver waits
+        BmsGattLink::ConnectTurn turn;
 
         char mac[18];
         mac[0] = '\0';
         uint32_t session = 0;
-        bool okToConnect = false;
+        bool enabled = false;
+        bool cacheStale = false;
 
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         session = self->connectSessionId_;
@@ -136,16 +144,19 @@ void JbdBms::connectTask(void* arg) {
             strncpy(mac, self->macAddress_.c_str(), 18);
             mac[17] = '\0';
         }
-        okToConnect = self->enabled_ && !throttle.isArmed() && strlen(mac) == 17;
+        enabled = self->enabled_;
+        cacheStale = self->cacheStale_;
+        self->cacheStale_ = false;
         xSemaphoreGive(self->stateMutex_);
 
-        if (!okToConnect) {
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+        if (cacheStale) {
+            bmsGattLink.forget(mac, BmsTypeJbd);
+        }
+        BmsGattHandles handles;
+        const bool cached = bmsGattLink.lookup(mac, BmsTypeJbd, handles);
+
+        if (!enabled || strlen(mac) != 17 || (throttle.isArmed() && !cached)) {
+            self->abandonConnectAttempt(session);
             continue;
         }
 
@@ -161,12 +172,7 @@ void JbdBms::connectTask(void* arg) {
 
         if (!connectedOk) {
             DEBUG_PRINTLN("[JBD] Connection failed, retrying...");
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
 
@@ -174,91 +180,85 @@ void JbdBms::connectTask(void* arg) {
         // BMS or armed the motor while we were connecting.
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool stillValid = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         xSemaphoreGive(self->stateMutex_);
 
         if (!stillValid) {
-            if (self->pClient_->isConnected()) {
-                self->pClient_->disconnect();
-            }
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
 
-        // ----- Phase 2: ATT service discovery (also slow, also off main loop) -----
-        BLERemoteService* pService = self->pClient_->getService(JBD_SERVICE_UUID);
-        if (!pService) {
-            DEBUG_PRINTLN("[JBD] Service FF00 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+        // ----- Phase 2: ATT service discovery, unless the handles are cached -----
+        if (cached) {
+            DEBUG_PRINTLN("[JBD] Cached GATT handles, discovery skipped");
+        } else {
+            const BmsGattLink::DiscoverResult found = bmsGattLink.discover(
+                self->pClient_, JBD_SERVICE_UUID, JBD_CHAR_UUID_RX, JBD_CHAR_UUID_TX, handles);
+            if (found != BmsGattLink::DiscoverOk) {
+                DEBUG_PRINTLN(found == BmsGattLink::DiscoverNoService
+                    ? "[JBD] Service FF00 not found" : "[JBD] Characteristics FF01/FF02 not found");
+                self->abandonConnectAttempt(session);
+                continue;
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
-        }
-
-        BLERemoteCharacteristic* charRx = pService->getCharacteristic(JBD_CHAR_UUID_RX); // FF01 notify
-        BLERemoteCharacteristic* charTx = pService->getCharacteristic(JBD_CHAR_UUID_TX); // FF02 write
-        if (!charRx || !charTx) {
-            DEBUG_PRINTLN("[JBD] Characteristics FF01/FF02 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+            if (handles.cccdHandle == 0) {
+                DEBUG_PRINTLN("[JBD] WARNING: descriptor 0x2902 not found — notify may not work");
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
+            handles.addrType = BLE_ADDR_TYPE_PUBLIC;
         }
 
-        charRx->registerForNotify(onNotifyCallback);
-
-        // ESP32-C3 needs the CCCD (0x2902) written explicitly to enable notifications;
-        // this is an ATT Write Request and can also block for hundreds of ms.
-        BLERemoteDescriptor* pCccd = charRx->getDescriptor(BLEUUID((uint16_t)0x2902));
-        if (pCccd) {
-            uint8_t notifyOn[2] = {0x01, 0x00};
-            pCccd->writeValue(notifyOn, 2, true);
-            DEBUG_PRINTLN("[JBD] CCCD written manually (0x0100)");
-        } else {
-            DEBUG_PRINTLN("[JBD] WARNING: descriptor 0x2902 not found — notify may not work");
+        // ESP32-C3 needs the CCCD (0x2902) written explicitly to enable
+        // notifications; subscribe() does it on the cached handle.
+        if (!bmsGattLink.subscribe(self->pClient_, handles, onGattNotify, self)) {
+            DEBUG_PRINTLN("[JBD] Notification subscribe failed");
+            self->abandonConnectAttempt(session);
+            continue;
         }
 
         // ----- Phase 3: commit shared state under mutex -----
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool sessionStillCurrent = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         if (!sessionStillCurrent) {
             xSemaphoreGive(self->stateMutex_);
-            if (self->pClient_->isConnected()) {
-                self->pClient_->disconnect();
-            }
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
-        self->pCharRx_           = charRx;
-        self->pCharTx_           = charTx;
+        self->txHandle_          = handles.txHandle;
         self->connected_         = true;
-        self->rxLen_             = 0;
-        self->lastRequestMillis_ = 0; // force immediate request
+        self->rxRing_.clear();
+        self->rxParser_.reset();
+        self->poll_.reset();          // both registers requested at once
+        self->viaCache_          = cached;
+        self->frameSeen_         = false;
+        self->subscribedMillis_  = millis();
+        self->retry_.onLinkUp();
         self->state_             = Subscribed;
         xSemaphoreGive(self->stateMutex_);
         DEBUG_PRINTLN("[JBD] Subscribed, ready for reads");
+
+        if (!cached) {
+            bmsGattLink.remember(mac, BmsTypeJbd, handles);
+        }
     }
 }
 
+// ---------------------------------------------------------------------------
+// abandonConnectAttempt — connectTask failure path: drops the link and, if the
+// attempt is still the current one, goes back to Idle and backs off.
+// ---------------------------------------------------------------------------
+void JbdBms::abandonConnectAttempt(uint32_t session) {
+    bmsGattLink.unsubscribe(this);
+    if (pClient_ != nullptr && pClient_->isConnected()) {
+        pClient_->disconnect();
+    }
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    if (session == connectSessionId_) {
+        applyResetConnectionLocked();
+        retry_.onAttemptFailed(millis());
+    }
+    xSemaphoreGive(stateMutex_);
+}
+
 // ---------------------------------------------------------------------------
 // txTask — FreeRTOS task that performs BLE writes (avoids blocking the main loop)
 // ---------------------------------------------------------------------------
@@ -267,8 +267,8 @@ void JbdBms::txTask(void* arg) {
     BleFrame frame;
     for (;;) {
         if (xQueueReceive(self->txQueue_, &frame, portMAX_DELAY)) {
-            if (self->pCharTx_ && self->pClient_ && self->pClient_->isConnected()) {
-                self->pCharTx_->writeValue(frame.data, frame.len, false);
+            if (self->txHandle_ != 0 && self->pClient_ && self->pClient_->isConnected()) {
+                bmsGattLink.write(self->pClient_, self->txHandle_, frame.data, frame.len);
             }
         }
     }
@@ -286,14 +286,14 @@ void JbdBms::update() {
             if (!enabled_ || macAddress_.length() < 17) {
                 break;  // Do not attempt connection
             }
-            if (throttle.isArmed()) {
-                break;  // Do not attempt connection while motor is armed
+            if (!retry_.due(millis())) {
+                break;
             }
-            {
-                const unsigned long now = millis();
-                if (lastConnectAttempt_ != 0 && (now - lastConnectAttempt_) < CONNECT_RETRY_MS) {
-                    break;
-                }
+            // While the motor is armed, only reconnect on cached handles:
+            // no service discovery in flight.
+            connectCached_ = bmsGattLink.has(macAddress_.c_str(), BmsTypeJbd);
+            if (throttle.isArmed() && !connectCached_) {
+                break;
             }
             if (connectQueue_ == nullptr) {
                 break;
@@ -311,7 +311,7 @@ void JbdBms::update() {
 
         // ------------------------------------------------------------------
         case Connecting: {
-            if (!enabled_ || macAddress_.length() < 17 || throttle.isArmed()) {
+            if (!enabled_ || macAddress_.length() < 17 || (throttle.isArmed() && !connectCached_)) {
                 resetConnection();
                 break;
             }
@@ -325,21 +325,35 @@ void JbdBms::update() {
             if (!pClient_->isConnected()) {
                 DEBUG_PRINTLN("[JBD] Unexpectedly disconnected");
                 resetConnection();
+                retry_.onLinkLost(millis());
                 break;
             }
 
             // Process frames accumulated in RX buffer
             processRxBuffer();
 
-            // Send alternating requests: 0x03 (basic) and 0x04 (cells)
-            if (millis() - lastRequestMillis_ >= REQUEST_INTERVAL_MS) {
-                lastRequestMillis_ = millis();
-                if (requestCells_) {
-                    sendCellVoltageRequest();
-                } else {
+            // Cached handles that bring no answer are stale (new BMS firmware,
+            // another device on this MAC): drop them and rediscover.
+            if (viaCache_ && !frameSeen_ && millis() - subscribedMillis_ >= GATT_CACHE_PROBE_MS) {
+                DEBUG_PRINTLN("[JBD] No answer on cached GATT handles, rediscovering");
+                resetConnection();
+                cacheStale_ = true;
+                retry_.onLinkLost(millis());
+                break;
+            }
+
+            // 0x03 (basic) and 0x04 (cells), each at the poll level's rate
+            {
+                const unsigned long now = millis();
+                const int field = poll_.next(pollLevel_, now);
+                if (field == BmsPollSchedule::Pack) {
                     sendBasicInfoRequest();
+                } else if (field == BmsPollSchedule::Cells) {
+                    sendCellVoltageRequest();
+                }
+                if (field >= 0) {
+                    poll_.onRequested((uint8_t)field, now);
                 }
-                requestCells_ = !requestCells_;
             }
             break;
     }
@@ -349,117 +363,66 @@ void JbdBms::update() {
 // onNotify — called by BLE stack ISR-like callback
 // ---------------------------------------------------------------------------
 void JbdBms::onNotify(uint8_t* data, size_t len) {
-    xSemaphoreTake(stateMutex_, portMAX_DELAY);
-    if (rxLen_ + len > JBD_RX_BUFFER_SIZE) {
-        // Overflow: discard buffer to avoid garbage accumulation
-        DEBUG_PRINTLN("[JBD] RX buffer overflow, discarding");
-        rxLen_ = 0;
-    }
-    memcpy(rxBuffer_ + rxLen_, data, len);
-    rxLen_ += len;
-    xSemaphoreGive(stateMutex_);
+    // Wait-free: a notification that does not fit is dropped whole and
+    // counted; processRxBuffer() reports it.
+    rxRing_.push(data, len);
 }
 
 // ---------------------------------------------------------------------------
-// processRxBuffer — extract and validate JBD frames from accumulated buffer
+// processRxBuffer — feed queued notifications to the frame parser
 //
 // This BMS (SP14S004 V1.0) sends responses with "FF AA" wrapper before DD frame:
 //   FF AA | DD | REG | STATUS | LEN | DATA[LEN] | CHK_H | CHK_L | 77
 //
 // BLE limits 20 bytes per packet, so the response may arrive in multiple chunks.
-// onNotify() accumulates all in rxBuffer_ and here we assemble the full frame.
-//
-// Checksum (reception): 0x10000 - (STATUS + LEN + DATA[...])
+// onNotify() queues them in rxRing_; rxParser_ assembles and validates the
+// frame byte by byte (JbdFrameParser.h), whatever the chunking.
 // ---------------------------------------------------------------------------
 void JbdBms::processRxBuffer() {
     xSemaphoreTake(stateMutex_, portMAX_DELAY);
 
-    bool done = false;
-    while (!done && rxLen_ > 0) {
-
-        // --- Discard FF AA wrapper if present at start ---
-        if (rxLen_ >= 2 && rxBuffer_[0] == 0xFF && rxBuffer_[1] == 0xAA) {
-            memmove(rxBuffer_, rxBuffer_ + 2, rxLen_ - 2);
-            rxLen_ -= 2;
-            continue;
-        }
-
-        // --- Look for start byte 0xDD ---
-        if (rxBuffer_[0] != JBD_FRAME_START) {
-            size_t skip = 0;
-            while (skip < rxLen_ && rxBuffer_[skip] != JBD_FRAME_START) skip++;
-            if (skip >= rxLen_) { rxLen_ = 0; done = true; continue; }
-            memmove(rxBuffer_, rxBuffer_ + skip, rxLen_ - skip);
-            rxLen_ -= skip;
-            continue;
-        }
-
-        // --- Need at least 4 bytes to read LEN ---
-        if (rxLen_ < 4) { done = true; continue; }
-
-        uint8_t reg     = rxBuffer_[1];
-        uint8_t status  = rxBuffer_[2];
-        uint8_t dataLen = rxBuffer_[3];
-
-        // Frame completo: DD(1) + REG(1) + STATUS(1) + LEN(1) + DATA(N) + CHK_H(1) + CHK_L(1) + 77(1)
-        size_t frameLen = (size_t)dataLen + 7;
-
-        // Wait for full frame to arrive (may come in multiple BLE packets)
-        if (rxLen_ < frameLen) { done = true; continue; }
+    if (rxRing_.dropped() != rxDropsSeen_) {
+        rxDropsSeen_ = rxRing_.dropped();
+        DEBUG_PRINT("[JBD] RX ring full, notifications dropped: ");
+        DEBUG_PRINTLN(rxDropsSeen_);
+    }
 
-        // --- Verify end byte 0x77 ---
-        if (rxBuffer_[frameLen - 1] != JBD_FRAME_END) {
-            DEBUG_PRINTLN("[JBD] Invalid frame end, resyncing...");
-            memmove(rxBuffer_, rxBuffer_ + 1, rxLen_ - 1);
-            rxLen_ -= 1;
-            continue;
-        }
+    uint8_t chunk[64];
+    size_t n;
+    while ((n = rxRing_.pop(chunk, sizeof(chunk))) > 0) {
+        rxParser_.feed(chunk, n, [this](const JbdFrame& frame) { handleFrame(frame); });
+    }
 
-        // --- Raw frame log ---
-        DEBUG_PRINT("[JBD] RX: ");
-        printFrameHex(rxBuffer_, frameLen);
-
-        // --- Valida checksum: 0x10000 - (STATUS + LEN + DATA[...]) ---
-        uint32_t sum = (uint32_t)status + dataLen;
-        for (size_t i = 0; i < (size_t)dataLen; i++) sum += rxBuffer_[4 + i];
-        uint16_t recvChk = ((uint16_t)rxBuffer_[4 + dataLen] << 8) | rxBuffer_[5 + dataLen];
-
-        if (((sum + recvChk) & 0xFFFF) != 0) {
-            DEBUG_PRINT("[JBD] Invalid checksum sum=0x");
-            DEBUG_PRINT_HEX((uint16_t)(sum & 0xFFFF), HEX);
-            DEBUG_PRINT(" chk=0x");
-            DEBUG_PRINT_HEX(recvChk, HEX);
-            DEBUG_PRINTLN();
-            memmove(rxBuffer_, rxBuffer_ + 1, rxLen_ - 1);
-            rxLen_ -= 1;
-            continue;
-        }
+    if (rxParser_.rejected() != rxRejectsSeen_) {
+        rxRejectsSeen_ = rxParser_.rejected();
+        DEBUG_PRINT("[JBD] Invalid frames (end byte or checksum): ");
+        DEBUG_PRINTLN(rxRejectsSeen_);
+    }
 
-        // --- Valid frame: process ---
-        const uint8_t* dataPayload = rxBuffer_ + 4;
+    xSemaphoreGive(stateMutex_);
+}
 
-        if (status == 0x00) {
-            if (reg == JBD_REG_BASIC_INFO) {
-                parseBasicInfo(dataPayload, dataLen);
-                printBasicInfo();
-            } else if (reg == JBD_REG_CELL_VOLTAGES) {
-                parseCellVoltages(dataPayload, dataLen);
-                printCellVoltages();
-            }
-        } else {
-            DEBUG_PRINT("[JBD] BMS error: reg=0x");
-            DEBUG_PRINT_HEX(reg, HEX);
-            DEBUG_PRINT(" status=0x");
-            DEBUG_PRINT_HEX(status, HEX);
-            DEBUG_PRINTLN();
+// handleFrame — one validated frame; caller holds stateMutex_
+void JbdBms::handleFrame(const JbdFrame& frame) {
+    frameSeen_ = true;
+    DEBUG_PRINT("[JBD] RX: ");
+    printFrameHex(frame.raw, frame.rawLen);
+
+    if (frame.status == 0x00) {
+        if (frame.reg == JBD_REG_BASIC_INFO) {
+            parseBasicInfo(frame.data, frame.dataLen);
+            printBasicInfo();
+        } else if (frame.reg == JBD_REG_CELL_VOLTAGES) {
+            parseCellVoltages(frame.data, frame.dataLen);
+            printCellVoltages();
         }
-
-        // Consume frame from buffer
-        memmove(rxBuffer_, rxBuffer_ + frameLen, rxLen_ - frameLen);
-        rxLen_ -= frameLen;
+    } else {
+        DEBUG_PRINT("[JBD] BMS error: reg=0x");
+        DEBUG_PRINT_HEX(frame.reg, HEX);
+        DEBUG_PRINT(" status=0x");
+        DEBUG_PRINT_HEX(frame.status, HEX);
+        DEBUG_PRINTLN();
     }
-
-    xSemaphoreGive(stateMutex_);
 }
 
 // ---------------------------------------------------------------------------
@@ -510,14 +473,14 @@ void JbdBms::buildWriteFrame(uint8_t reg, const uint8_t* data, uint8_t dataLen,
 // Required on some firmwares before accepting reads
 // ---------------------------------------------------------------------------
 void JbdBms::sendLoginRequest() {
-    if (!pCharTx_) return;
+    if (txHandle_ == 0) return;
     uint8_t password[4] = {0x00, 0x00, 0x00, 0x00};
     uint8_t frame[16];
     size_t  frameLen;
     buildWriteFrame(JBD_REG_LOGIN, password, 4, frame, &frameLen);
     DEBUG_PRINT("[JBD] LOGIN TX: ");
     printFrameHex(frame, frameLen);
-    pCharTx_->writeValue(frame, frameLen, false);
+    bmsGattLink.write(pClient_, txHandle_, frame, frameLen);
 }
 
 
@@ -543,82 +506,58 @@ void JbdBms::sendCellVoltageRequest() {
     xQueueSend(txQueue_, &frame, 0);
 }
 
-// Decode register 0x03 (Basic Info)
-//
-// JBD standard protocol, offset within DATA field:
-//   0-1   Total voltage         (unit: 10mV)
-//   2-3   Current               (unit: 10mA, signed)
-//   4-5   Remaining capacity     (unit: 10mAh)
-//   6-7   Nominal capacity       (unit: 10mAh)
-//   8-9   Charge cycles
-//  10-11  Production date (BCD YYYYMMDD packed)
-//  12-13  Balance bitmask (cells 1-16)
-//  14-15  Balance bitmask (cells 17-32)
-//  16-17  Protection/error flags
-//    18   Software version
-//    19   SoC (%)
-//    20   FET status (bit0=CHG, bit1=DSG)
-//    21   Number of cells in series
-//    22   Number of NTCs
-//  23+    NTC temperature (2 bytes each, Kelvin*10, big-endian)
+// parseBasicInfo — register 0x03, decoded by jbdParseBasicInfo()
+// (JbdBmsParser.h, field layout there)
 // ---------------------------------------------------------------------------
 void JbdBms::parseBasicInfo(const uint8_t* d, size_t dataLen) {
-    if (dataLen < 23) {
+    static_assert(JBD_MAX_CELLS <= BmsSnapshot::kMaxCells && JBD_MAX_NTC <= BmsSnapshot::kMaxTemps,
+                  "JBD readings must fit the snapshot");
+    JbdBasicInfo info;
+    if (!jbdParseBasicInfo(d, dataLen, &info)) {
         DEBUG_PRINT("[JBD] dataLen too short: ");
         DEBUG_PRINTLN(dataLen);
         return;
     }
 
-    packVoltageMilliVolts_ = ((uint32_t)d[0] << 8 | d[1]) * 10;
-    packCurrentMilliAmps_  = (int32_t)(int16_t)((uint16_t)d[2] << 8 | d[3]) * 10;
-    balanceCapacityMahl_   = ((uint32_t)d[4] << 8 | d[5]) * 10;
-    designCapacityMahl_    = ((uint32_t)d[6] << 8 | d[7]) * 10;
-    cycleCount_            = (uint16_t)d[8] << 8 | d[9];
-    currentErrors_         = (uint16_t)d[16] << 8 | d[17];
-    socPercent_            = d[19];
-    chgFetEnabled_         = (d[20] >> 0) & 1;
-    dsgFetEnabled_         = (d[20] >> 1) & 1;
-    cellCount_             = d[21];
-    ntcCount_              = d[22];
-
-    for (uint8_t i = 0; i < ntcCount_ && i < JBD_MAX_NTC; i++) {
-        size_t off = 23 + i * 2;
-        if (off + 1 >= dataLen) break;
-        uint16_t raw = (uint16_t)d[off] << 8 | d[off + 1];
-        ntcTempsCelsius_[i] = (int16_t)((int32_t)raw - 2731) / 10;
-    }
-
-    hasData_ = true;
+    frame_.packVoltageMilliVolts = info.packVoltageMilliVolts;
+    frame_.packCurrentMilliAmps  = info.packCurrentMilliAmps;
+    balanceCapacityMahl_   = info.balanceCapacityMahl;
+    designCapacityMahl_    = info.designCapacityMahl;
+    cycleCount_            = info.cycleCount;
+    currentErrors_         = info.currentErrors;
+    frame_.socPercent      = info.socPercent;
+    chgFetEnabled_         = info.chgFetEnabled;
+    dsgFetEnabled_         = info.dsgFetEnabled;
+    frame_.cellCount       = info.cellCount;
+    frame_.tempCount       = info.tempCount;
+    memcpy(frame_.tempsCelsius, info.tempsCelsius, sizeof(info.tempsCelsius));
+
+    frame_.hasData = true;
+    frame_.dataMillis = millis();
+    // The cell statistics stay those of the last 0x04 frame
+    published_.publish(frame_, false);
 }
 
 // ---------------------------------------------------------------------------
-// parseCellVoltages — decode register 0x04
-//
-// DATA: 2 bytes per cell, big-endian, direct value in mV
-//   d[0-1] = cell 1 (mV)
-//   d[2-3] = cell 2 (mV)
-//   ...
+// parseCellVoltages — register 0x04, decoded by jbdParseCellVoltages()
 // ---------------------------------------------------------------------------
 void JbdBms::parseCellVoltages(const uint8_t* d, size_t dataLen) {
-    uint8_t count = dataLen / 2;
-    if (count > JBD_MAX_CELLS) count = JBD_MAX_CELLS;
-    // Update cellCount_ if not yet received from 0x03
-    if (cellCount_ == 0) cellCount_ = count;
-    for (uint8_t i = 0; i < count; i++) {
-        cellVoltagesMv_[i] = (uint16_t)d[i * 2] << 8 | d[i * 2 + 1];
-    }
-    hasCellData_ = true;
+    uint8_t count = jbdParseCellVoltages(d, dataLen, frame_.cellVoltagesMv, JBD_MAX_CELLS);
+    // Update the cell count if not yet received from 0x03
+    if (frame_.cellCount == 0) frame_.cellCount = count;
+    frame_.hasCellData = true;
+    frame_.cellMillis = millis();
+    published_.publish(frame_);
 }
 
 // ---------------------------------------------------------------------------
 // printCellVoltages
 // ---------------------------------------------------------------------------
 void JbdBms::printCellVoltages() {
-    uint8_t count = cellCount_ > 0 ? cellCount_ : 0;
+    uint8_t count = frame_.cellCount;
     DEBUG_PRINTLN("[JBD] ===== Cell Voltages =====");
-    uint16_t vmin = 0xFFFF, vmax = 0;
     for (uint8_t i = 0; i < count && i < JBD_MAX_CELLS; i++) {
-        uint16_t v = cellVoltagesMv_[i];
+        uint16_t v = frame_.cellVoltagesMv[i];
         DEBUG_PRINT("[JBD] C");
         if (i + 1 < 10) { DEBUG_PRINT("0"); }
         DEBUG_PRINT(i + 1);
@@ -631,50 +570,24 @@ void JbdBms::printCellVoltages() {
         if (frac < 10)  { DEBUG_PRINT("0"); }
         DEBUG_PRINT(frac);
         DEBUG_PRINTLN(" V");
-        if (v < vmin) vmin = v;
-        if (v > vmax) vmax = v;
     }
-    if (count > 0) {
+    // Derived when the frame was published
+    if (frame_.cellsReported > 0) {
         DEBUG_PRINT("[JBD] Min: ");
-        DEBUG_PRINT(vmin);
-        DEBUG_PRINT(" mV  Max: ");
-        DEBUG_PRINT(vmax);
+        DEBUG_PRINT(frame_.cellMinMv);
+        DEBUG_PRINT(" mV (C");
+        DEBUG_PRINT(frame_.cellWeakest + 1);
+        DEBUG_PRINT(")  Max: ");
+        DEBUG_PRINT(frame_.cellMaxMv);
         DEBUG_PRINT(" mV  Delta: ");
-        DEBUG_PRINT(vmax - vmin);
+        DEBUG_PRINT(frame_.cellDeltaMv);
+        DEBUG_PRINT(" mV  Avg: ");
+        DEBUG_PRINT(frame_.cellAvgMv);
         DEBUG_PRINTLN(" mV");
     }
     DEBUG_PRINTLN("[JBD] ==========================");
 }
 
-// ---------------------------------------------------------------------------
-// getCellVoltageMilliVolts
-// ---------------------------------------------------------------------------
-uint16_t JbdBms::getCellVoltageMilliVolts(uint8_t index) const {
-    if (index >= JBD_MAX_CELLS || index >= cellCount_) return 0;
-    return cellVoltagesMv_[index];
-}
-
-uint16_t JbdBms::getCellMinMilliVolts() const {
-    if (!hasCellData_ || cellCount_ == 0) return 0;
-    uint16_t vmin = 0xFFFF;
-    for (uint8_t i = 0; i < cellCount_ && i < JBD_MAX_CELLS; i++)
-        if (cellVoltagesMv_[i] < vmin) vmin = cellVoltagesMv_[i];
-    return vmin;
-}
-
-uint16_t JbdBms::getCellMaxMilliVolts() const {
-    if (!hasCellData_ || cellCount_ == 0) return 0;
-    uint16_t vmax = 0;
-    for (uint8_t i = 0; i < cellCount_ && i < JBD_MAX_CELLS; i++)
-        if (cellVoltagesMv_[i] > vmax) vmax = cellVoltagesMv_[i];
-    return vmax;
-}
-
-uint16_t JbdBms::getCellDeltaMilliVolts() const {
-    if (!hasCellData_ || cellCount_ == 0) return 0;
-    return getCellMaxMilliVolts() - getCellMinMilliVolts();
-}
-
 
 // ---------------------------------------------------------------------------
 void JbdBms::printFrameHex(const uint8_t* data, size_t len) {
@@ -693,18 +606,18 @@ void JbdBms::printFrameHex(const uint8_t* data, size_t len) {
 void JbdBms::printBasicInfo() {
     DEBUG_PRINTLN("[JBD] ===== Basic Info =====");
     DEBUG_PRINT("[JBD] Voltage: ");
-    DEBUG_PRINT(packVoltageMilliVolts_ / 1000);
+    DEBUG_PRINT(frame_.packVoltageMilliVolts / 1000);
     DEBUG_PRINT(".");
-    DEBUG_PRINT((packVoltageMilliVolts_ % 1000) / 10);  // 2 decimal places
+    DEBUG_PRINT((frame_.packVoltageMilliVolts % 1000) / 10);  // 2 decimal places
     DEBUG_PRINTLN(" V");
     DEBUG_PRINT("[JBD] Current: ");
-    DEBUG_PRINT(packCurrentMilliAmps_);
+    DEBUG_PRINT(frame_.packCurrentMilliAmps);
     DEBUG_PRINTLN(" mA");
     DEBUG_PRINT("[JBD] SoC: ");
-    DEBUG_PRINT(socPercent_);
+    DEBUG_PRINT(frame_.socPercent);
     DEBUG_PRINTLN(" %");
     DEBUG_PRINT("[JBD] Cells: ");
-    DEBUG_PRINTLN(cellCount_);
+    DEBUG_PRINTLN(frame_.cellCount);
     DEBUG_PRINT("[JBD] Cycles: ");
     DEBUG_PRINTLN(cycleCount_);
     DEBUG_PRINT("[JBD] Nominal cap: ");
@@ -722,20 +635,12 @@ void JbdBms::printBasicInfo() {
         DEBUG_PRINT_HEX(currentErrors_, HEX);
         DEBUG_PRINTLN();
     }
-    for (uint8_t i = 0; i < ntcCount_ && i < JBD_MAX_NTC; i++) {
+    for (uint8_t i = 0; i < frame_.tempCount && i < JBD_MAX_NTC; i++) {
         DEBUG_PRINT("[JBD] NTC");
         DEBUG_PRINT(i);
         DEBUG_PRINT(": ");
-        DEBUG_PRINT(ntcTempsCelsius_[i]);
+        DEBUG_PRINT(frame_.tempsCelsius[i]);
         DEBUG_PRINTLN(" C");
     }
     DEBUG_PRINTLN("[JBD] =====================");
 }
-
-// ---------------------------------------------------------------------------
-// getNtcTempCelsius
-// ---------------------------------------------------------------------------
-int16_t JbdBms::getNtcTempCelsius(uint8_t index) const {
-    if (index >= JBD_MAX_NTC || index >= ntcCount_) return 0;
-    return ntcTempsCelsius_[index];
-}
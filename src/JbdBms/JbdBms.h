@@ -6,32 +6,24 @@
 #include <freertos/queue.h>
 #include <freertos/semphr.h>
 #include <freertos/task.h>
+#include "../BluetoothBms/BmsDriver.h"
+#include "../BluetoothBms/BmsReconnectPolicy.h"
+#include "../BluetoothBms/BmsRxRing.h"
+#include "JbdFrameParser.h"
+#include "JbdBmsParser.h"
 
 // JBD BMS uses fixed BLE address (no scan). MAC is configured via Settings/web interface.
 
 // JBD GATT: Service 0xFF00
-// FF01 = Module->Phone: Notify, Read → pCharRx_ (register notify here)
-// FF02 = Phone->Module: Write w/o Rsp → pCharTx_ (write commands here)
+// FF01 = Module->Phone: Notify, Read → subscribed through bmsGattLink
+// FF02 = Phone->Module: Write w/o Rsp → txHandle_ (write commands here)
 #define JBD_SERVICE_UUID     "0000ff00-0000-1000-8000-00805f9b34fb"
 #define JBD_CHAR_UUID_RX     "0000ff01-0000-1000-8000-00805f9b34fb"  // notify
 #define JBD_CHAR_UUID_TX     "0000ff02-0000-1000-8000-00805f9b34fb"  // write
 
-// Frame: DD | REG | STATUS | LEN | DATA... | CHK_H | CHK_L | 77
-// Read request: DD | A5 | REG | 00 | CHK_H | CHK_L | 77
-#define JBD_FRAME_START      0xDD
-#define JBD_FRAME_END        0x77
-#define JBD_CMD_READ         0xA5
-#define JBD_CMD_WRITE        0x5A
-#define JBD_REG_LOGIN        0x00
-#define JBD_REG_BASIC_INFO   0x03
-#define JBD_REG_CELL_VOLTAGES 0x04
-
-#define JBD_MAX_NTC          8
-#define JBD_MAX_CELLS        32
-#define JBD_RX_BUFFER_SIZE   256
+#define JBD_RX_RING_SIZE     256
 
 class BLEClient;
-class BLERemoteCharacteristic;
 
 class JbdBms {
 public:
@@ -42,15 +34,14 @@ public:
     void setMacAddress(const String& macAddress);
 
     bool isConnected() const { return connected_; }
-    bool hasData()     const { return hasData_; }
-    bool hasCellData() const { return hasCellData_; }
-
-    uint32_t getPackVoltageMilliVolts() const { return packVoltageMilliVolts_; }
-    int32_t  getPackCurrentMilliAmps()  const { return packCurrentMilliAmps_; }
-    uint8_t  getSoCPercent()            const { return socPercent_; }
-    uint8_t  getCellCount()             const { return cellCount_; }
-    uint8_t  getNtcCount()              const { return ntcCount_; }
-    int16_t  getNtcTempCelsius(uint8_t index) const;
+    const char* getStateName() const { return connected_ ? "connected" : "connecting"; }
+    bool hasData()     const { return published_.hasData(); }
+    bool hasCellData() const { return published_.hasCellData(); }
+    // Any task: pack, cells and temperatures of the last parsed frame
+    bool readSnapshot(BmsSnapshot& out) const { return published_.read(out); }
+    // Loop: BmsPollLevel, sets the 0x03/0x04 request rates
+    void setPollLevel(uint8_t level) { pollLevel_ = level; }
+
     uint16_t getCycleCount()            const { return cycleCount_; }
     uint32_t getDesignCapacityMahl()    const { return designCapacityMahl_; }
     uint32_t getBalanceCapacityMahl()   const { return balanceCapacityMahl_; }
@@ -58,28 +49,22 @@ public:
     uint8_t  getDsgFetEnabled()         const { return dsgFetEnabled_; }
     uint16_t getCurrentErrors()         const { return currentErrors_; }
 
-    // Individual cell voltages (mV)
-    uint16_t getCellVoltageMilliVolts(uint8_t index) const;
-    uint16_t getCellMinMilliVolts()  const;
-    uint16_t getCellMaxMilliVolts()  const;
-    uint16_t getCellDeltaMilliVolts() const; // max-min difference (balance indicator)
-
 private:
     // State machine: Idle → Connecting → Subscribed.
     // The connectTask now performs BLEClient::connect() AND service discovery
-    // (getService / getCharacteristic / registerForNotify / CCCD writeValue),
+    // (getService / getCharacteristic / getDescriptor, then the CCCD write),
     // all of which can block for several seconds. The main loop never sees a
     // "Connected, awaiting discovery" state — it only sees Subscribed once
-    // the worker has fully wired the characteristics.
+    // the worker has fully wired the characteristics. Discovery is skipped
+    // when bmsGattLink has this MAC's handles.
     enum State {
         Idle,
         Connecting,
         Subscribed
     };
 
-    BLEClient*               pClient_;
-    BLERemoteCharacteristic* pCharRx_;  // FF01 - BMS->ESP (notify)
-    BLERemoteCharacteristic* pCharTx_;  // FF02 - ESP->BMS (write)
+    BLEClient*    pClient_;
+    uint16_t      txHandle_;   // FF02 - ESP->BMS (write), 0 when not subscribed
     QueueHandle_t txQueue_;    // queue of frames for BLE TX (consumed by tx task)
     TaskHandle_t  txTaskHandle_;
     QueueHandle_t connectQueue_;   // depth 1: main loop requests connect (worker runs BLEClient::connect)
@@ -90,24 +75,31 @@ private:
     bool         initialized_;
     bool         enabled_;
     bool         connected_;
-    bool         hasData_;
     String       macAddress_;
-    unsigned long lastConnectAttempt_;
-    unsigned long lastRequestMillis_;
-
-    static const unsigned long CONNECT_RETRY_MS   = 10000;
-    static const unsigned long REQUEST_INTERVAL_MS = 2000;
-
-    uint8_t rxBuffer_[JBD_RX_BUFFER_SIZE];
-    size_t  rxLen_;
-
-    // Decoded data — register 0x03
-    uint32_t packVoltageMilliVolts_;
-    int32_t  packCurrentMilliAmps_;
-    uint8_t  socPercent_;
-    uint8_t  cellCount_;
-    uint8_t  ntcCount_;
-    int16_t  ntcTempsCelsius_[JBD_MAX_NTC];
+    unsigned long subscribedMillis_;
+    BmsReconnectPolicy retry_;   // when Idle may queue the next connect
+    bool         connectCached_; // the queued attempt has cached handles (allowed while armed)
+    bool         viaCache_;      // subscribed on cached handles, not yet answered through them
+    bool         frameSeen_;     // a valid frame since Subscribed
+    bool         cacheStale_;    // cached handles went unanswered: connectTask forgets them
+
+    // Cached handles must answer the first requests within this; both go
+    // out right after subscribing, whatever the poll level
+    static const unsigned long GATT_CACHE_PROBE_MS = 5000;
+
+    // Notifications land in rxRing_ (BLE host task, never blocks); the loop
+    // feeds them to rxParser_. The consumer side of the ring and the parser
+    // are under stateMutex_.
+    BmsRxRing<JBD_RX_RING_SIZE> rxRing_;
+    JbdFrameParser rxParser_;
+    uint32_t rxDropsSeen_;
+    uint32_t rxRejectsSeen_;
+
+    // Registers 0x03 and 0x04 decode into one frame, published after each
+    BmsSnapshot     frame_;
+    BmsSnapshotSlot published_;
+
+    // Decoded data — register 0x03, beyond the snapshot
     uint16_t cycleCount_;
     uint32_t designCapacityMahl_;
     uint32_t balanceCapacityMahl_;
@@ -115,12 +107,9 @@ private:
     uint8_t  dsgFetEnabled_;
     uint16_t currentErrors_;
 
-    // Decoded data — register 0x04
-    bool     hasCellData_;
-    uint16_t cellVoltagesMv_[JBD_MAX_CELLS];
-
-    // Alternating request control 0x03 / 0x04
-    bool     requestCells_; // alternate between requesting 0x03 and 0x04
+    // 0x03 is the Pack field, 0x04 the Cells one; rates set by the poll level
+    BmsPollSchedule poll_;
+    uint8_t  pollLevel_;
 
     // Internos
     void buildReadFrame(uint8_t reg, uint8_t* out, size_t* outLen);
@@ -129,6 +118,7 @@ private:
     void sendBasicInfoRequest();
     void sendCellVoltageRequest();
     void processRxBuffer();
+    void handleFrame(const JbdFrame& frame);
     void parseBasicInfo(const uint8_t* data, size_t dataLen);
     void parseCellVoltages(const uint8_t* data, size_t dataLen);
     void printFrameHex(const uint8_t* data, size_t len);
@@ -136,11 +126,13 @@ private:
     void printCellVoltages();
     void resetConnection();
     void applyResetConnectionLocked(); // caller must hold stateMutex_
+    void abandonConnectAttempt(uint32_t session);
     static void txTask(void* arg);
     static void connectTask(void* arg);
+    static void onGattNotify(void* ctx, uint8_t* data, size_t len);
 
 public:
-    // Called by global notify callback — do not call directly
+    // Called by the notify routing — do not call directly
     void onNotify(uint8_t* data, size_t len);
 };
 
@@ -0,0 +1,120 @@
+#ifndef JBD_BMS_PARSER_H
+#define JBD_BMS_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ── Frame constants ───────────────────────────────────────────────────────────
+
+// Frame: DD | REG | STATUS | LEN | DATA... | CHK_H | CHK_L | 77
+// Read request: DD | A5 | REG | 00 | CHK_H | CHK_L | 77
+// Framing and checksum: JbdFrameParser.h. This header decodes DATA.
+#define JBD_FRAME_START      0xDD
+#define JBD_FRAME_END        0x77
+#define JBD_CMD_READ         0xA5
+#define JBD_CMD_WRITE        0x5A
+#define JBD_REG_LOGIN        0x00
+#define JBD_REG_BASIC_INFO   0x03
+#define JBD_REG_CELL_VOLTAGES 0x04
+#define JBD_REG_HARDWARE_VERSION 0x05
+
+// ── Limits ────────────────────────────────────────────────────────────────────
+
+#define JBD_MAX_NTC          8
+#define JBD_MAX_CELLS        32
+
+// Register 0x03 fields up to and including the NTC count
+#define JBD_BASIC_INFO_MIN_LEN 23
+// Register 0x03 with JBD_MAX_NTC NTCs and the fields newer firmwares append,
+// with room to spare
+#define JBD_BASIC_INFO_MAX_LEN 64
+// Register 0x05, an ASCII model string
+#define JBD_HARDWARE_VERSION_MAX_LEN 48
+
+// ── Types ─────────────────────────────────────────────────────────────────────
+
+struct JbdBasicInfo {
+    uint32_t packVoltageMilliVolts;
+    int32_t  packCurrentMilliAmps;    // negative = discharge
+    uint32_t balanceCapacityMahl;     // remaining
+    uint32_t designCapacityMahl;      // nominal
+    uint16_t cycleCount;
+    uint16_t currentErrors;           // protection flags
+    uint8_t  socPercent;
+    uint8_t  chgFetEnabled;
+    uint8_t  dsgFetEnabled;
+    uint8_t  cellCount;               // as announced; cells are read from 0x04
+    uint8_t  tempCount;               // as announced, not clamped
+    int16_t  tempsCelsius[JBD_MAX_NTC];
+};
+
+// ── Helpers ───────────────────────────────────────────────────────────────────
+
+static inline uint16_t jbdGet16BE(const uint8_t* d, size_t offset) {
+    return (uint16_t)((uint16_t)d[offset] << 8 | d[offset + 1]);
+}
+
+// ── Register 0x03 (basic info) ────────────────────────────────────────────────
+//
+// JBD standard protocol, offset within DATA field:
+//   0-1   Total voltage         (unit: 10mV)
+//   2-3   Current               (unit: 10mA, signed)
+//   4-5   Remaining capacity     (unit: 10mAh)
+//   6-7   Nominal capacity       (unit: 10mAh)
+//   8-9   Charge cycles
+//  10-11  Production date (BCD YYYYMMDD packed)
+//  12-13  Balance bitmask (cells 1-16)
+//  14-15  Balance bitmask (cells 17-32)
+//  16-17  Protection/error flags
+//    18   Software version
+//    19   SoC (%)
+//    20   FET status (bit0=CHG, bit1=DSG)
+//    21   Number of cells in series
+//    22   Number of NTCs
+//  23+    NTC temperature (2 bytes each, Kelvin*10, big-endian)
+//
+// Returns false if DATA stops before the NTC count. NTCs announced but cut
+// off by the payload read as 0.
+static inline bool jbdParseBasicInfo(const uint8_t* d, size_t dataLen, JbdBasicInfo* out) {
+    if (dataLen < JBD_BASIC_INFO_MIN_LEN) return false;
+    memset(out, 0, sizeof(*out));
+
+    out->packVoltageMilliVolts = (uint32_t)jbdGet16BE(d, 0) * 10;
+    out->packCurrentMilliAmps  = (int32_t)(int16_t)jbdGet16BE(d, 2) * 10;
+    out->balanceCapacityMahl   = (uint32_t)jbdGet16BE(d, 4) * 10;
+    out->designCapacityMahl    = (uint32_t)jbdGet16BE(d, 6) * 10;
+    out->cycleCount            = jbdGet16BE(d, 8);
+    out->currentErrors         = jbdGet16BE(d, 16);
+    out->socPercent            = d[19];
+    out->chgFetEnabled         = (d[20] >> 0) & 1;
+    out->dsgFetEnabled         = (d[20] >> 1) & 1;
+    out->cellCount             = d[21];
+    out->tempCount             = d[22];
+
+    for (uint8_t i = 0; i < out->tempCount && i < JBD_MAX_NTC; i++) {
+        size_t off = 23 + (size_t)i * 2;
+        if (off + 1 >= dataLen) break;
+        out->tempsCelsius[i] = (int16_t)((int32_t)jbdGet16BE(d, off) - 2731) / 10;
+    }
+    return true;
+}
+
+// ── Register 0x04 (cell voltages) ─────────────────────────────────────────────
+//
+// DATA: 2 bytes per cell, big-endian, direct value in mV
+//   d[0-1] = cell 1 (mV)
+//   d[2-3] = cell 2 (mV)
+//   ...
+// Returns the number of cells written (at most maxCells).
+static inline uint8_t jbdParseCellVoltages(const uint8_t* d, size_t dataLen,
+                                           uint16_t* cellsMv, uint8_t maxCells) {
+    size_t count = dataLen / 2;
+    if (count > maxCells) count = maxCells;
+    for (size_t i = 0; i < count; i++) {
+        cellsMv[i] = jbdGet16BE(d, i * 2);
+    }
+    return (uint8_t)count;
+}
+
+#endif // JBD_BMS_PARSER_H
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include "JbdBmsParser.h"
+
+// Incremental JBD response framer -- no Arduino deps, host-testable.
+//
+//   [FF AA] | DD | REG | STATUS | LEN | DATA[LEN] | CHK_H | CHK_L | 77
+//   checksum: STATUS + LEN + DATA[...] + CHK == 0 (mod 0x10000)
+//
+// Bytes go in as they arrive, in any chunking; each validated frame comes
+// out through the callback. Bytes outside a frame (the FF AA wrapper some
+// firmwares send, noise) cost one comparison each. A DD is only taken for a
+// frame if REG is a register the driver reads, STATUS ok or error and LEN
+// within what that register holds (maxDataLen()); anything else is dropped
+// at the header byte that does not fit, which starts the next candidate if
+// it is a DD itself (a header byte that fits never is). A candidate that
+// gets past its header and fails its end byte or checksum is rescanned
+// from its next DD, so a real frame that started inside it is still found;
+// only the candidate is rescanned, never the stream.
+struct JbdFrame {
+    uint8_t        reg;
+    uint8_t        status;     // 0x00 ok, anything else a BMS-side error
+    uint8_t        dataLen;
+    const uint8_t* data;
+    const uint8_t* raw;        // DD..77, for logging
+    size_t         rawLen;
+};
+
+class JbdFrameParser {
+public:
+    static const uint8_t kStart = 0xDD;
+    static const uint8_t kEnd = 0x77;
+    static const size_t  kMaxFrameLen = 4 + JBD_BASIC_INFO_MAX_LEN + 3;   // the largest maxDataLen()
+    static_assert(2 * JBD_MAX_CELLS <= JBD_BASIC_INFO_MAX_LEN && JBD_HARDWARE_VERSION_MAX_LEN <= JBD_BASIC_INFO_MAX_LEN,
+                  "kMaxFrameLen covers every register");
+
+    JbdFrameParser() : state_(Sync), rawLen_(0), sum_(0), frames_(0), rejected_(0) {}
+
+    // onFrame(const JbdFrame&) runs for every complete valid frame; the
+    // frame points into the parser and is only valid during the call.
+    template <class OnFrame>
+    void feed(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        size_t i = 0;
+        while (i < len) {
+            if (state_ == Sync) {
+                // Between frames: straight to the next DD
+                const void* at = memchr(data + i, kStart, len - i);
+                if (at == nullptr) return;
+                i = (size_t)((const uint8_t*)at - data);
+            } else if (state_ == Data) {
+                // Payload: whatever of it this chunk holds, in one go
+                size_t n = 4u + raw_[3] - rawLen_;
+                if (n > len - i) n = len - i;
+                memcpy(raw_ + rawLen_, data + i, n);
+                for (size_t k = 0; k < n; k++) sum_ += data[i + k];
+                rawLen_ += n;
+                i += n;
+                if (rawLen_ == 4u + raw_[3]) state_ = ChkHi;
+                continue;
+            }
+            if (step(data[i++], onFrame) == Rejected) rescan(onFrame);
+        }
+    }
+
+    // Drops a partial frame (a new connection).
+    void reset() {
+        state_ = Sync;
+        rawLen_ = 0;
+    }
+
+    uint32_t frames() const { return frames_; }
+    uint32_t rejected() const { return rejected_; }   // end byte or checksum failed
+
+    // The most DATA a reply to `reg` carries; -1 for a register the driver
+    // never reads.
+    static int maxDataLen(uint8_t reg) {
+        switch (reg) {
+            case JBD_REG_BASIC_INFO:       return JBD_BASIC_INFO_MAX_LEN;
+            case JBD_REG_CELL_VOLTAGES:    return 2 * JBD_MAX_CELLS;
+            case JBD_REG_HARDWARE_VERSION: return JBD_HARDWARE_VERSION_MAX_LEN;
+            default:                       return -1;
+        }
+    }
+
+private:
+    enum State { Sync, Reg, Status, Len, Data, ChkHi, ChkLo, End };
+    enum Step { Idle, Started, InFrame, Emitted, Rejected };
+
+    // Drops the candidate; b starts the next one if it is a DD.
+    Step start(uint8_t b) {
+        reset();
+        if (b != kStart) return Idle;
+        raw_[0] = b;
+        rawLen_ = 1;
+        state_ = Reg;
+        return Started;
+    }
+
+    bool headerFits(uint8_t b) const {
+        switch (state_) {
+            case Reg:    return maxDataLen(b) >= 0;
+            case Status: return b == 0x00 || b == 0x80;
+            case Len:    return (int)b <= maxDataLen(raw_[1]);
+            default:     return true;
+        }
+    }
+
+    template <class OnFrame>
+    Step step(uint8_t b, OnFrame& onFrame) {
+        if (state_ == Sync || !headerFits(b)) return start(b);
+        raw_[rawLen_++] = b;
+        switch (state_) {
+            case Reg:
+                state_ = Status;
+                break;
+            case Status:
+                sum_ = b;
+                state_ = Len;
+                break;
+            case Len:
+                sum_ += b;
+                state_ = b == 0 ? ChkHi : Data;
+                break;
+            case Data:
+                sum_ += b;
+                if (rawLen_ == 4u + raw_[3]) state_ = ChkHi;
+                break;
+            case ChkHi:
+                state_ = ChkLo;
+                break;
+            case ChkLo:
+                state_ = End;
+                break;
+            case End: {
+                const uint16_t chk = (uint16_t)((raw_[rawLen_ - 3] << 8) | raw_[rawLen_ - 2]);
+                const bool ok = b == kEnd && (uint16_t)(sum_ + chk) == 0;
+                if (!ok) {
+                    rejected_++;
+                    return Rejected;
+                }
+                JbdFrame frame;
+                frame.reg = raw_[1];
+                frame.status = raw_[2];
+                frame.dataLen = raw_[3];
+                frame.data = raw_ + 4;
+                frame.raw = raw_;
+                frame.rawLen = rawLen_;
+                frames_++;
+                onFrame(frame);
+                reset();
+                return Emitted;
+            }
+            default:
+                break;
+        }
+        return InFrame;
+    }
+
+    // The rejected candidate's bytes, from the first DD after its start, go
+    // through the state machine again (a copy: step() rewrites raw_); bytes
+    // between candidates are skipped to the next DD as in feed(). A
+    // candidate begun and rejected inside the replay continues the scan
+    // from its own next DD, in the same copy. A false DD costs at most its
+    // header, so only a candidate with a fitting header replays its bytes.
+    template <class OnFrame>
+    void rescan(OnFrame& onFrame) {
+        uint8_t pending[kMaxFrameLen];
+        const size_t n = rawLen_;
+        memcpy(pending, raw_, n);
+        reset();
+        size_t from = 0;
+        size_t i = 1;
+        while (i < n) {
+            if (state_ == Sync) {
+                const void* at = memchr(pending + i, kStart, n - i);
+                if (at == nullptr) return;
+                i = (size_t)((const uint8_t*)at - pending);
+            }
+            const Step s = step(pending[i], onFrame);
+            if (s == Started) from = i;
+            if (s == Rejected) {
+                reset();
+                i = from + 1;
+                continue;
+            }
+            i++;
+        }
+    }
+
+    State    state_;
+    uint8_t  raw_[kMaxFrameLen];
+    size_t   rawLen_;
+    uint16_t sum_;
+    uint32_t frames_;
+    uint32_t rejected_;
+};
@@ -7,35 +7,33 @@
 #include <BLEUtils.h>
 #include <BLE2902.h>
 #include <esp_gap_ble_api.h>
+#include "../BluetoothBms/BmsGattLink.h"
 
 struct BleFrame {
     uint8_t data[20];
     size_t  len;
 };
 
-static JkBms* s_jkBms = nullptr;
-
 // ---------------------------------------------------------------------------
-// Global notify callback
+// Notifications, routed by bmsGattLink (BLE host task)
 // ---------------------------------------------------------------------------
-void onJkNotifyCallback(BLERemoteCharacteristic* pChar, uint8_t* pData, size_t length, bool isNotify) {
-    if (s_jkBms && pData && length > 0) {
-        s_jkBms->onNotify(pData, length);
-    }
+void JkBms::onGattNotify(void* ctx, uint8_t* data, size_t len) {
+    static_cast<JkBms*>(ctx)->onNotify(data, len);
 }
 
 // ---------------------------------------------------------------------------
 // Constructor
 // ---------------------------------------------------------------------------
 JkBms::JkBms()
-    : pClient_(nullptr), pChar_(nullptr),
+    : pClient_(nullptr), charHandle_(0),
       txQueue_(nullptr), txTaskHandle_(nullptr),
       connectQueue_(nullptr), connectTaskHandle_(nullptr), stateMutex_(nullptr),
       connectSessionId_(0),
       state_(Idle), initialized_(false), enabled_(false), connected_(false),
-      lastConnectAttempt_(0), lastRequestMillis_(0), lastCellDataMillis_(0),
+      lastRequestMillis_(0), lastCellDataMillis_(0), subscribedMillis_(0),
       deviceInfoRequested_(false), hasCellData_(false),
-      rxLen_(0), protocol_(JkProtocol_32S)
+      connectCached_(false), viaCache_(false), frameSeen_(false), cacheStale_(false),
+      pollLevel_(BmsPollIdle), rxDropsSeen_(0), rxLen_(0), protocol_(JkProtocol_32S)
 {
     memset(hwVersion_, 0, sizeof(hwVersion_));
     memset(rxBuffer_, 0, sizeof(rxBuffer_));
@@ -47,7 +45,6 @@ JkBms::JkBms()
 // ---------------------------------------------------------------------------
 void JkBms::init() {
     if (initialized_) return;
-    s_jkBms = this;
     stateMutex_ = xSemaphoreCreateMutex();
     connectQueue_ = xQueueCreate(1, sizeof(uint8_t));
     if (stateMutex_ == nullptr || connectQueue_ == nullptr) {
@@ -70,12 +67,17 @@ void JkBms::setEnabled(bool enabled) {
     enabled_ = enabled;
     if (!enabled_) {
         resetConnection();
+        retry_.reset();
     }
 }
 
 void JkBms::setMacAddress(const String& macAddress) {
-    macAddress_ = macAddress;
-    macAddress_.trim();
+    String mac = macAddress;
+    mac.trim();
+    if (mac != macAddress_) {
+        retry_.reset();
+    }
+    macAddress_ = mac;
 }
 
 // ---------------------------------------------------------------------------
@@ -101,18 +103,24 @@ void JkBms::applyResetConnectionLocked() {
     if (txQueue_ != nullptr) {
         xQueueReset(txQueue_);
     }
+    bmsGattLink.unsubscribe(this);
     connected_           = false;
-    pChar_               = nullptr;
+    charHandle_          = 0;
+    viaCache_            = false;
+    rxRing_.clear();
     rxLen_               = 0;
     deviceInfoRequested_ = false;
     hasCellData_         = false;
     lastCellDataMillis_  = 0;
     memset(&data_, 0, sizeof(data_));
+    publishData();
     state_               = Idle;
 }
 
 // ---------------------------------------------------------------------------
-// connectTask — runs BLEClient::connect AND service discovery off the main loop
+// connectTask — runs BLEClient::connect AND service discovery off the main loop.
+// Discovery is skipped when bmsGattLink has this MAC's handles, which also
+// remember the address type that worked — the only reconnect allowed while armed.
 // ---------------------------------------------------------------------------
 void JkBms::connectTask(void* arg) {
     JkBms* self = static_cast<JkBms*>(arg);
@@ -121,11 +129,14 @@ void JkBms::connectTask(void* arg) {
         if (xQueueReceive(self->connectQueue_, &cmd, portMAX_DELAY) != pdTRUE) {
             continue;
         }
+        // Until the end of this attempt, the other pack's driver waits
+        BmsGattLink::ConnectTurn turn;
 
         char mac[18];
         mac[0] = '\0';
         uint32_t session = 0;
-        bool okToConnect = false;
+        bool enabled = false;
+        bool cacheStale = false;
 
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         session = self->connectSessionId_;
@@ -133,16 +144,19 @@ void JkBms::connectTask(void* arg) {
             strncpy(mac, self->macAddress_.c_str(), 18);
             mac[17] = '\0';
         }
-        okToConnect = self->enabled_ && !throttle.isArmed() && strlen(mac) == 17;
+        enabled = self->enabled_;
+        cacheStale = self->cacheStale_;
+        self->cacheStale_ = false;
         xSemaphoreGive(self->stateMutex_);
 
-        if (!okToConnect) {
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+        if (cacheStale) {
+            bmsGattLink.forget(mac, BmsTypeJk);
+        }
+        BmsGattHandles handles;
+        const bool cached = bmsGattLink.lookup(mac, BmsTypeJk, handles);
+
+        if (!enabled || strlen(mac) != 17 || (throttle.isArmed() && !cached)) {
+            self->abandonConnectAttempt(session);
             continue;
         }
 
@@ -151,107 +165,107 @@ void JkBms::connectTask(void* arg) {
             self->pClient_ = BLEDevice::createClient();
         }
         // JK BMS devices may use either PUBLIC or RANDOM address type depending
-        // on firmware version. Try PUBLIC first (8 s), then RANDOM.
+        // on firmware version. Try PUBLIC first (8 s), then RANDOM — unless the
+        // cache knows which one this BMS answers on.
         BLEAddress addr(mac);
         bool connectedOk = false;
+        esp_ble_addr_type_t addrType = cached ? (esp_ble_addr_type_t)handles.addrType : BLE_ADDR_TYPE_PUBLIC;
         if (self->pClient_ != nullptr) {
-            connectedOk = self->pClient_->connect(addr, BLE_ADDR_TYPE_PUBLIC);
-            if (!connectedOk) {
-                connectedOk = self->pClient_->connect(addr, BLE_ADDR_TYPE_RANDOM);
+            connectedOk = self->pClient_->connect(addr, addrType);
+            if (!connectedOk && !cached) {
+                addrType = BLE_ADDR_TYPE_RANDOM;
+                connectedOk = self->pClient_->connect(addr, addrType);
             }
         }
 
         if (!connectedOk) {
-            DEBUG_PRINTLN("[JK] Connection failed (both address types), retrying...");
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            DEBUG_PRINTLN(cached ? "[JK] Connection failed, retrying..."
+                                 : "[JK] Connection failed (both address types), retrying...");
+            self->abandonConnectAttempt(session);
             continue;
         }
 
         // Re-validate before slow ATT operations
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool stillValid = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         xSemaphoreGive(self->stateMutex_);
 
         if (!stillValid) {
-            if (self->pClient_->isConnected()) self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
 
-        // ----- Phase 2: ATT service discovery -----
-        BLERemoteService* pService = self->pClient_->getService(JK_SERVICE_UUID);
-        if (!pService) {
-            DEBUG_PRINTLN("[JK] Service FFE0 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+        // ----- Phase 2: ATT service discovery, unless the handles are cached -----
+        if (cached) {
+            DEBUG_PRINTLN("[JK] Cached GATT handles, discovery skipped");
+        } else {
+            const BmsGattLink::DiscoverResult found = bmsGattLink.discover(
+                self->pClient_, JK_SERVICE_UUID, JK_CHAR_UUID, JK_CHAR_UUID, handles);
+            if (found != BmsGattLink::DiscoverOk) {
+                DEBUG_PRINTLN(found == BmsGattLink::DiscoverNoService
+                    ? "[JK] Service FFE0 not found" : "[JK] Characteristic FFE1 not found");
+                self->abandonConnectAttempt(session);
+                continue;
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
-        }
-
-        BLERemoteCharacteristic* pChar = pService->getCharacteristic(JK_CHAR_UUID);
-        if (!pChar) {
-            DEBUG_PRINTLN("[JK] Characteristic FFE1 not found");
-            self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
+            if (handles.cccdHandle == 0) {
+                DEBUG_PRINTLN("[JK] WARNING: descriptor 0x2902 not found — notify may not work");
             }
-            xSemaphoreGive(self->stateMutex_);
-            continue;
+            handles.addrType = (uint8_t)addrType;
         }
 
-        pChar->registerForNotify(onJkNotifyCallback);
-
-        // ESP32-C3 needs CCCD written explicitly to enable notifications
-        BLERemoteDescriptor* pCccd = pChar->getDescriptor(BLEUUID((uint16_t)0x2902));
-        if (pCccd) {
-            uint8_t notifyOn[2] = {0x01, 0x00};
-            pCccd->writeValue(notifyOn, 2, true);
-            DEBUG_PRINTLN("[JK] CCCD written manually (0x0100)");
-        } else {
-            DEBUG_PRINTLN("[JK] WARNING: descriptor 0x2902 not found — notify may not work");
+        // ESP32-C3 needs CCCD written explicitly to enable notifications;
+        // subscribe() does it on the cached handle.
+        if (!bmsGattLink.subscribe(self->pClient_, handles, onGattNotify, self)) {
+            DEBUG_PRINTLN("[JK] Notification subscribe failed");
+            self->abandonConnectAttempt(session);
+            continue;
         }
 
         // ----- Phase 3: commit shared state under mutex -----
         xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
         bool sessionStillCurrent = (session == self->connectSessionId_)
-            && self->enabled_ && !throttle.isArmed();
+            && self->enabled_ && (cached || !throttle.isArmed());
         if (!sessionStillCurrent) {
             xSemaphoreGive(self->stateMutex_);
-            if (self->pClient_->isConnected()) self->pClient_->disconnect();
-            xSemaphoreTake(self->stateMutex_, portMAX_DELAY);
-            if (session == self->connectSessionId_) {
-                self->applyResetConnectionLocked();
-                self->lastConnectAttempt_ = millis();
-            }
-            xSemaphoreGive(self->stateMutex_);
+            self->abandonConnectAttempt(session);
             continue;
         }
-        self->pChar_             = pChar;
+        self->charHandle_        = handles.txHandle;
         self->connected_         = true;
+        self->rxRing_.clear();
         self->rxLen_             = 0;
         self->lastRequestMillis_ = 0;
         self->deviceInfoRequested_ = false;
+        self->viaCache_          = cached;
+        self->frameSeen_         = false;
+        self->subscribedMillis_  = millis();
+        self->retry_.onLinkUp();
         self->state_             = Subscribed;
         xSemaphoreGive(self->stateMutex_);
         DEBUG_PRINTLN("[JK] Subscribed, ready for reads");
+
+        if (!cached) {
+            bmsGattLink.remember(mac, BmsTypeJk, handles);
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// abandonConnectAttempt — connectTask failure path: drops the link and, if the
+// attempt is still the current one, goes back to Idle and backs off.
+// ---------------------------------------------------------------------------
+void JkBms::abandonConnectAttempt(uint32_t session) {
+    bmsGattLink.unsubscribe(this);
+    if (pClient_ != nullptr && pClient_->isConnected()) {
+        pClient_->disconnect();
     }
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    if (session == connectSessionId_) {
+        applyResetConnectionLocked();
+        retry_.onAttemptFailed(millis());
+    }
+    xSemaphoreGive(stateMutex_);
 }
 
 // ---------------------------------------------------------------------------
@@ -262,8 +276,8 @@ void JkBms::txTask(void* arg) {
     BleFrame frame;
     for (;;) {
         if (xQueueReceive(self->txQueue_, &frame, portMAX_DELAY)) {
-            if (self->pChar_ && self->pClient_ && self->pClient_->isConnected()) {
-                self->pChar_->writeValue(frame.data, frame.len, false);
+            if (self->charHandle_ != 0 && self->pClient_ && self->pClient_->isConnected()) {
+                bmsGattLink.write(self->pClient_, self->charHandle_, frame.data, frame.len);
             }
         }
     }
@@ -278,11 +292,11 @@ void JkBms::update() {
 
         case Idle: {
             if (!enabled_ || macAddress_.length() < 17) break;
-            if (throttle.isArmed()) break;
-            {
-                const unsigned long now = millis();
-                if (lastConnectAttempt_ != 0 && (now - lastConnectAttempt_) < CONNECT_RETRY_MS) break;
-            }
+            if (!retry_.due(millis())) break;
+            // While the motor is armed, only reconnect on cached handles:
+            // no service discovery in flight.
+            connectCached_ = bmsGattLink.has(macAddress_.c_str(), BmsTypeJk);
+            if (throttle.isArmed() && !connectCached_) break;
             if (connectQueue_ == nullptr) break;
             {
                 uint8_t q = 1;
@@ -294,7 +308,7 @@ void JkBms::update() {
         }
 
         case Connecting: {
-            if (!enabled_ || macAddress_.length() < 17 || throttle.isArmed()) {
+            if (!enabled_ || macAddress_.length() < 17 || (throttle.isArmed() && !connectCached_)) {
                 resetConnection();
             }
             break;
@@ -304,11 +318,22 @@ void JkBms::update() {
             if (!pClient_->isConnected()) {
                 DEBUG_PRINTLN("[JK] Unexpectedly disconnected");
                 resetConnection();
+                retry_.onLinkLost(millis());
                 break;
             }
 
             processRxBuffer();
 
+            // Cached handles that bring no answer are stale (new BMS firmware,
+            // another device on this MAC): drop them and rediscover.
+            if (viaCache_ && !frameSeen_ && millis() - subscribedMillis_ >= GATT_CACHE_PROBE_MS) {
+                DEBUG_PRINTLN("[JK] No answer on cached GATT handles, rediscovering");
+                resetConnection();
+                cacheStale_ = true;
+                retry_.onLinkLost(millis());
+                break;
+            }
+
             // Send 0x97 device info once right after subscribing
             if (!deviceInfoRequested_) {
                 deviceInfoRequested_ = true;
@@ -320,12 +345,14 @@ void JkBms::update() {
             // Kick the cell-info stream with 0x96, then let the BMS push frames
             // on its own (like the official app / esphome). Each 0x96 write makes
             // the JK beep, so once frames are streaming we stop requesting and
-            // only re-kick if the stream stalls (no frame for CELL_STREAM_TIMEOUT_MS).
+            // only re-kick if the stream stalls (no frame for the poll level's stall time).
             {
                 const unsigned long now = millis();
+                const unsigned long stallMs = BmsPollSchedule::streamStallMs(pollLevel_);
+                const unsigned long kickMs = stallMs < REQUEST_INTERVAL_MS ? stallMs : REQUEST_INTERVAL_MS;
                 const bool streamStalled = (lastCellDataMillis_ == 0)
-                    || (now - lastCellDataMillis_ >= CELL_STREAM_TIMEOUT_MS);
-                if (streamStalled && (now - lastRequestMillis_ >= REQUEST_INTERVAL_MS)) {
+                    || (now - lastCellDataMillis_ >= stallMs);
+                if (streamStalled && (now - lastRequestMillis_ >= kickMs)) {
                     lastRequestMillis_ = now;
                     sendCommand(JK_CMD_CELL_INFO);
                 }
@@ -350,25 +377,44 @@ void JkBms::sendCommand(uint8_t cmd) {
 }
 
 // ---------------------------------------------------------------------------
-// onNotify — called by BLE stack notify callback
+// onNotify — called by the notify routing (BLE host task)
 // ---------------------------------------------------------------------------
 void JkBms::onNotify(uint8_t* data, size_t len) {
-    xSemaphoreTake(stateMutex_, portMAX_DELAY);
-    if (rxLen_ + len > JK_RX_BUFFER_SIZE) {
-        DEBUG_PRINTLN("[JK] RX buffer overflow, discarding");
-        rxLen_ = 0;
-    }
-    memcpy(rxBuffer_ + rxLen_, data, len);
-    rxLen_ += len;
-    xSemaphoreGive(stateMutex_);
+    // Wait-free; a notification that does not fit is dropped whole and
+    // counted, reported by processRxBuffer()
+    rxRing_.push(data, len);
 }
 
 // ---------------------------------------------------------------------------
-// processRxBuffer — find 55 AA EB 90 frames, validate, dispatch
+// processRxBuffer — drain the RX ring into rxBuffer_ and parse it, a
+// buffer's worth at a time so a long burst is not discarded
 // ---------------------------------------------------------------------------
 void JkBms::processRxBuffer() {
     xSemaphoreTake(stateMutex_, portMAX_DELAY);
 
+    if (rxRing_.dropped() != rxDropsSeen_) {
+        rxDropsSeen_ = rxRing_.dropped();
+        DEBUG_PRINT("[JK] RX ring full, notifications dropped: ");
+        DEBUG_PRINTLN(rxDropsSeen_);
+    }
+
+    do {
+        if (rxLen_ == JK_RX_BUFFER_SIZE) {
+            DEBUG_PRINTLN("[JK] RX buffer overflow, discarding");
+            rxLen_ = 0;
+        }
+        rxLen_ += rxRing_.pop(rxBuffer_ + rxLen_, JK_RX_BUFFER_SIZE - rxLen_);
+        parseRxBufferLocked();
+    } while (!rxRing_.empty());
+
+    xSemaphoreGive(stateMutex_);
+}
+
+// ---------------------------------------------------------------------------
+// parseRxBufferLocked — find 55 AA EB 90 frames, validate, dispatch.
+// Caller must hold stateMutex_.
+// ---------------------------------------------------------------------------
+void JkBms::parseRxBufferLocked() {
     bool done = false;
     while (!done && rxLen_ > 0) {
 
@@ -409,6 +455,7 @@ void JkBms::processRxBuffer() {
         }
 
         // Dispatch by frame type
+        frameSeen_ = true;
         uint8_t frameType = rxBuffer_[4];
 
         if (frameType == JK_FRAME_TYPE_DEVICE_INFO) {
@@ -434,6 +481,7 @@ void JkBms::processRxBuffer() {
                 data_ = parsed;
                 hasCellData_ = true;
                 lastCellDataMillis_ = millis();
+                publishData();
                 DEBUG_PRINT("[JK] V=");
                 DEBUG_PRINT(data_.packVoltageMilliVolts);
                 DEBUG_PRINT("mV I=");
@@ -449,42 +497,29 @@ void JkBms::processRxBuffer() {
         memmove(rxBuffer_, rxBuffer_ + JK_FRAME_LENGTH, rxLen_ - JK_FRAME_LENGTH);
         rxLen_ -= JK_FRAME_LENGTH;
     }
-
-    xSemaphoreGive(stateMutex_);
 }
 
 // ---------------------------------------------------------------------------
-// Getters
+// publishData — one cell-info frame carries the pack and the cells; an
+// empty data_ (after a reset) publishes an empty snapshot
 // ---------------------------------------------------------------------------
-int16_t JkBms::getTempCelsius(uint8_t index) const {
-    if (index >= JK_MAX_TEMPS || index >= data_.tempCount) return 0;
-    return data_.tempsCelsius[index];
-}
-
-uint16_t JkBms::getCellVoltageMilliVolts(uint8_t index) const {
-    if (index >= JK_MAX_CELLS || index >= data_.cellCount) return 0;
-    return data_.cellVoltagesMv[index];
-}
-
-uint16_t JkBms::getCellMinMilliVolts() const {
-    if (!hasCellData_ || data_.cellCount == 0) return 0;
-    uint16_t vmin = 0xFFFF;
-    for (uint8_t i = 0; i < data_.cellCount && i < JK_MAX_CELLS; i++)
-        if (data_.cellVoltagesMv[i] < vmin) vmin = data_.cellVoltagesMv[i];
-    return vmin;
-}
-
-uint16_t JkBms::getCellMaxMilliVolts() const {
-    if (!hasCellData_ || data_.cellCount == 0) return 0;
-    uint16_t vmax = 0;
-    for (uint8_t i = 0; i < data_.cellCount && i < JK_MAX_CELLS; i++)
-        if (data_.cellVoltagesMv[i] > vmax) vmax = data_.cellVoltagesMv[i];
-    return vmax;
-}
-
-uint16_t JkBms::getCellDeltaMilliVolts() const {
-    if (!hasCellData_ || data_.cellCount == 0) return 0;
-    return getCellMaxMilliVolts() - getCellMinMilliVolts();
+void JkBms::publishData() {
+    static_assert(JK_MAX_CELLS <= BmsSnapshot::kMaxCells && JK_MAX_TEMPS <= BmsSnapshot::kMaxTemps,
+                  "JK readings must fit the snapshot");
+    BmsSnapshot frame;
+    frame.clear();
+    frame.hasData               = data_.valid;
+    frame.hasCellData           = hasCellData_;
+    frame.packVoltageMilliVolts = data_.packVoltageMilliVolts;
+    frame.packCurrentMilliAmps  = data_.packCurrentMilliAmps;
+    frame.socPercent            = data_.socPercent;
+    frame.cellCount             = data_.cellCount;
+    frame.tempCount             = data_.tempCount;
+    memcpy(frame.cellVoltagesMv, data_.cellVoltagesMv, sizeof(data_.cellVoltagesMv));
+    memcpy(frame.tempsCelsius, data_.tempsCelsius, sizeof(data_.tempsCelsius));
+    frame.dataMillis            = lastCellDataMillis_;
+    frame.cellMillis            = lastCellDataMillis_;
+    published_.publish(frame);
 }
 
 // ---------------------------------------------------------------------------
@@ -7,6 +7,9 @@
 #include <freertos/semphr.h>
 #include <freertos/task.h>
 #include "JkBmsParser.h"
+#include "../BluetoothBms/BmsDriver.h"
+#include "../BluetoothBms/BmsReconnectPolicy.h"
+#include "../BluetoothBms/BmsRxRing.h"
 
 // JK BMS BLE: Service 0xFFE0, Characteristic 0xFFE1 (bidirectional — write + notify)
 #define JK_SERVICE_UUID "0000ffe0-0000-1000-8000-00805f9b34fb"
@@ -15,9 +18,10 @@
 // Holds two full 300-byte JK02 frames so a brief main-loop processing lag
 // cannot drop a complete frame before it is parsed.
 #define JK_RX_BUFFER_SIZE 600
+// Notifications queued between loop passes: three frames' worth of bursts.
+#define JK_RX_RING_SIZE   1024
 
 class BLEClient;
-class BLERemoteCharacteristic;
 
 class JkBms {
 public:
@@ -28,8 +32,13 @@ public:
     void setMacAddress(const String& macAddress);
 
     bool isConnected()  const { return connected_; }
-    bool hasData()      const { return data_.valid; }
-    bool hasCellData()  const { return hasCellData_; }
+    bool hasData()      const { return published_.hasData(); }
+    bool hasCellData()  const { return published_.hasCellData(); }
+    // Any task: pack, cells and temperatures of the last parsed frame
+    bool readSnapshot(BmsSnapshot& out) const { return published_.read(out); }
+    // Loop: BmsPollLevel. The JK streams at its own rate; the level only
+    // sets how soon a stalled stream is re-kicked.
+    void setPollLevel(uint8_t level) { pollLevel_ = level; }
 
     const char* getStateName() const {
         switch (state_) {
@@ -40,23 +49,11 @@ public:
         }
     }
 
-    uint32_t getPackVoltageMilliVolts() const { return data_.packVoltageMilliVolts; }
-    int32_t  getPackCurrentMilliAmps()  const { return data_.packCurrentMilliAmps; }
-    uint8_t  getSoCPercent()            const { return data_.socPercent; }
-    uint8_t  getCellCount()             const { return data_.cellCount; }
-    uint8_t  getTempCount()             const { return data_.tempCount; }
-    int16_t  getTempCelsius(uint8_t index) const;
-
-    uint16_t getCellVoltageMilliVolts(uint8_t index) const;
-    uint16_t getCellMinMilliVolts()   const;
-    uint16_t getCellMaxMilliVolts()   const;
-    uint16_t getCellDeltaMilliVolts() const;
-
 private:
     enum State { Idle, Connecting, Subscribed };
 
-    BLEClient*               pClient_;
-    BLERemoteCharacteristic* pChar_;   // FFE1 — bidirectional (write + notify)
+    BLEClient*        pClient_;
+    uint16_t          charHandle_;   // FFE1 — bidirectional (write + notify), 0 when not subscribed
     QueueHandle_t     txQueue_;
     TaskHandle_t      txTaskHandle_;
     QueueHandle_t     connectQueue_;
@@ -68,32 +65,48 @@ private:
     bool              enabled_;
     bool              connected_;
     String            macAddress_;
-    unsigned long     lastConnectAttempt_;
     unsigned long     lastRequestMillis_;
     unsigned long     lastCellDataMillis_;
+    unsigned long     subscribedMillis_;
     bool              deviceInfoRequested_;
     bool              hasCellData_;
+    BmsReconnectPolicy retry_;       // when Idle may queue the next connect
+    bool              connectCached_; // the queued attempt has cached handles (allowed while armed)
+    bool              viaCache_;      // subscribed on cached handles, not yet answered through them
+    bool              frameSeen_;     // a valid frame since Subscribed
+    bool              cacheStale_;    // cached handles went unanswered: connectTask forgets them
+    uint8_t           pollLevel_;     // BmsPollLevel
 
-    static const unsigned long CONNECT_RETRY_MS      = 10000;
     static const unsigned long REQUEST_INTERVAL_MS   = 2000;
+    // Cached handles must bring an answer within two request rounds
+    static const unsigned long GATT_CACHE_PROBE_MS   = 2 * REQUEST_INTERVAL_MS + 1000;
     // Once cell-info frames are streaming, the BMS pushes them on its own. Only
-    // re-request (which makes the JK beep on each command) if the stream stalls.
-    static const unsigned long CELL_STREAM_TIMEOUT_MS = 3000;
+    // re-request (which makes the JK beep on each command) if the stream stalls
+    // for BmsPollSchedule::streamStallMs() of the poll level.
 
+    // onNotify() only pushes to rxRing_; the loop drains it into rxBuffer_.
+    // Ring consumer side and rxBuffer_ are under stateMutex_.
+    BmsRxRing<JK_RX_RING_SIZE> rxRing_;
+    uint32_t  rxDropsSeen_;
     uint8_t   rxBuffer_[JK_RX_BUFFER_SIZE];
     size_t    rxLen_;
 
     JkProtocol protocol_;
     char       hwVersion_[16];
     JkBmsData  data_;
+    BmsSnapshotSlot published_;
 
     void processRxBuffer();
+    void parseRxBufferLocked();
+    void publishData();
     void sendCommand(uint8_t cmd);
     void printFrameHex(const uint8_t* data, size_t len);
     void resetConnection();
     void applyResetConnectionLocked();
+    void abandonConnectAttempt(uint32_t session);
     static void txTask(void* arg);
     static void connectTask(void* arg);
+    static void onGattNotify(void* ctx, uint8_t* data, size_t len);
 
 public:
     void onNotify(uint8_t* data, size_t len);
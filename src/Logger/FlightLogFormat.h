@@ -0,0 +1,684 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+// Packed binary flight log -- no Arduino deps, host-testable.
+//
+// A log file ("/YYYYMMDD_NNN.flog") is one Header followed by records,
+// all little-endian:
+//
+//   header (kHeaderSize bytes; kLegacyHeaderSize before version 3)
+//     magic "FLOG" | version u8 | schema u8 | recordSize u16 | flags u8 |
+//     fastRecordSize u8 | startEpochMs u64 | startMillis u32 |
+//     startMonoUs u64 (version 3)
+//   full record (header.recordSize bytes: kRecordSize with parallel BMS
+//   packs, kRecordSizeV1 otherwise)
+//     offset u32 | flags u8 | five u8 | ten u16/i16 |
+//     packFlags u8 | per BMS pack: soc u8, four u16/i16 (kRecordSize only)
+//   fast record (header.fastRecordSize bytes, kFastRecordSize), flag RecordFast
+//     offset u32 | flags u8 | two u8 | five u16
+//
+// Time: startMonoUs is the monotonic microsecond clock (esp_timer) at the
+// start of the file and startEpochMs the wall-clock time of that instant,
+// the file's one anchor; startMillis is startMonoUs in ms for older
+// readers. A record's offset counts microseconds from startMonoUs and
+// wraps every ~71 minutes (RecordClock unwraps it). Versions 1 and 2
+// stored milliseconds from startMillis.
+//
+// Rate classes: a full record (every field) is written at 1 Hz; in
+// high-rate mode fast records carry only the fast channels (throttle,
+// power, current, RPM, voltage) at up to 50 Hz in between. Every record
+// starts with offset and flags, and flags tells which kind it is.
+//
+// Writing a record is a handful of stores instead of a dozen vsnprintf
+// calls, and a record is 29 bytes (48 with parallel packs) instead of a
+// 65-140 byte CSV line.
+// GET /logs/<name>.csv converts back to the historical CSV while streaming
+// (kCsvHeader/formatCsvLine()), so downloaded files look exactly as
+// before and existing tooling keeps working.
+//
+// recordSize is stored in the header so a later schema can append fields:
+// older readers decode the prefix they know and skip the rest. The
+// per-pack BMS fields were appended that way, and are only written when a
+// flight starts with two packs: kRecordSizeV1 files (a single pack, or
+// older) convert with those columns empty.
+namespace FlightLog {
+
+static const uint8_t  kVersion = 3;     // 1: full records only, fastRecordSize was reserved (0)
+                                        // 2: offsets in ms, no startMonoUs
+static const uint8_t  kSchemaTelemetryV1 = 1;
+static const size_t   kHeaderSize = 30;
+static const size_t   kLegacyHeaderSize = 22;   // versions 1 and 2
+static const size_t   kRecordSize = 48;
+static const size_t   kRecordSizeV1 = 29;   // without the per-pack BMS fields
+static const size_t   kFastRecordSize = 17;
+static const size_t   kRecordPrefixSize = 5;   // offset + flags, common to both kinds
+static const char     kFileExtension[] = ".flog";
+static const uint8_t  kMaxPacks = 2;        // per-pack BMS fields (Settings kMaxBmsPacks)
+
+enum HeaderFlag : uint8_t {
+    HeaderEpochValid = 1 << 0,   // startEpochMs is wall-clock time
+    HeaderNameHasDate = 1 << 1,  // file name carries the date: CSV shows HH:MM:SS only
+    HeaderMillis = 1 << 2,       // high-rate file: CSV timestamps carry milliseconds
+};
+
+// Which groups of a record hold data; a clear bit becomes empty CSV cells.
+enum RecordFlag : uint8_t {
+    RecordHasTelemetry = 1 << 0,
+    RecordHasPowerKw   = 1 << 1,
+    RecordHasCurrent   = 1 << 2,
+    RecordHasBmsTemp   = 1 << 3,
+    RecordHasCells     = 1 << 4,
+    RecordPreArm       = 1 << 5,   // from the pre-arm ring, captured while disarmed
+    RecordPostDisarm   = 1 << 6,   // from the tail captured after disarm
+    RecordFast         = 1 << 7,   // fast record: slow groups are absent
+};
+
+// Per pack in Record::packFlags, shifted by packFlagShift(pack).
+enum PackFlag : uint8_t {
+    PackHasData  = 1 << 0,   // soc, current
+    PackHasCells = 1 << 1,   // cellMinMv, cellMaxMv
+    PackHasTemp  = 1 << 2,   // tempMaxC (a pack may have no sensors)
+};
+
+static const uint8_t kPackFlagBits = 3;
+static_assert(kPackFlagBits * kMaxPacks <= 8, "per-pack flags must fit Record::packFlags");
+
+inline uint8_t packFlagShift(uint8_t pack) { return (uint8_t)(kPackFlagBits * pack); }
+
+// Log rates offered in the system config page. 1 Hz writes full records
+// only, as before high-rate mode existed.
+static const uint8_t kLogRatesHz[] = {1, 10, 25, 50};
+static const uint8_t kDefaultLogRateHz = 1;
+
+inline bool isSupportedLogRate(uint32_t hz) {
+    for (uint8_t rate : kLogRatesHz) {
+        if (rate == hz) return true;
+    }
+    return false;
+}
+
+struct Header {
+    uint8_t  version;
+    uint8_t  schema;
+    uint16_t recordSize;
+    uint8_t  flags;
+    uint8_t  fastRecordSize;   // 0 in version 1 files: no fast records
+    uint64_t startEpochMs;
+    uint32_t startMillis;
+    uint64_t startMonoUs;      // startMillis * 1000 before version 3
+};
+
+inline size_t headerSize(uint8_t version) { return version >= 3 ? kHeaderSize : kLegacyHeaderSize; }
+// A file's full record size: the per-pack fields only with parallel packs.
+// A kRecordSizeV1 record is the leading part of an encoded kRecordSize one.
+inline size_t fullRecordSize(bool withPacks) { return withPacks ? kRecordSize : kRecordSizeV1; }
+
+// One BMS pack of a parallel battery; the record's own bmsTempMaxC and
+// cell fields are the worst across packs.
+struct PackRecord {
+    uint8_t  soc;
+    int16_t  currentDa;   // signed: a pack can charge the other
+    uint16_t cellMinMv;
+    uint16_t cellMaxMv;
+    int16_t  tempMaxC;
+};
+
+// Temperatures are kept in 0.1 °C and current in 0.1 A: one decimal more
+// than the CSV shows, in half the bytes of milli-units.
+struct Record {
+    uint32_t offset;   // as stored: see RecordClock
+    uint8_t  flags;
+    uint8_t  batteryPercentCc;
+    uint8_t  batteryPercentVoltage;
+    uint8_t  throttlePercent;
+    uint8_t  powerPercent;
+    uint16_t batteryVoltageMv;
+    uint16_t powerKwX10;
+    uint16_t throttleRaw;
+    uint16_t rpm;
+    uint16_t escCurrentDa;
+    int16_t  motorTempDc;
+    int16_t  escTempDc;
+    int16_t  bmsTempMaxC;
+    uint16_t cellMinMv;
+    uint16_t cellMaxMv;
+    uint8_t  packFlags;   // PackFlag per pack
+    PackRecord packs[kMaxPacks];
+};
+
+// Fast channels only. flags uses RecordFast plus RecordHasTelemetry
+// (voltage), RecordHasPowerKw and RecordHasCurrent (RPM and current).
+struct FastRecord {
+    uint32_t offset;
+    uint8_t  flags;
+    uint8_t  throttlePercent;
+    uint8_t  powerPercent;
+    uint16_t throttleRaw;
+    uint16_t rpm;
+    uint16_t escCurrentDa;
+    uint16_t batteryVoltageMv;
+    uint16_t powerKwX10;
+};
+
+inline void putU16(uint8_t*& p, uint16_t v) { *p++ = (uint8_t)v; *p++ = (uint8_t)(v >> 8); }
+inline void putU32(uint8_t*& p, uint32_t v) { for (uint8_t i = 0; i < 4; i++) *p++ = (uint8_t)(v >> (8 * i)); }
+inline void putU64(uint8_t*& p, uint64_t v) { for (uint8_t i = 0; i < 8; i++) *p++ = (uint8_t)(v >> (8 * i)); }
+inline uint16_t getU16(const uint8_t*& p) { uint16_t v = (uint16_t)(p[0] | (p[1] << 8)); p += 2; return v; }
+inline uint32_t getU32(const uint8_t*& p) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    p += 4;
+    return v;
+}
+inline uint64_t getU64(const uint8_t*& p) {
+    uint64_t v = 0;
+    for (uint8_t i = 0; i < 8; i++) v |= (uint64_t)p[i] << (8 * i);
+    p += 8;
+    return v;
+}
+
+// Saturating conversions from the firmware's milli-units.
+inline int16_t milliToDeci(int32_t milli) {
+    const int32_t deci = milli / 100;
+    if (deci > INT16_MAX) return INT16_MAX;
+    if (deci < INT16_MIN) return INT16_MIN;
+    return (int16_t)deci;
+}
+inline uint16_t milliToDeciU(uint32_t milli) {
+    const uint32_t deci = milli / 100;
+    return deci > UINT16_MAX ? (uint16_t)UINT16_MAX : (uint16_t)deci;
+}
+
+inline void encodeHeader(const Header& h, uint8_t out[kHeaderSize]) {
+    uint8_t* p = out;
+    *p++ = 'F'; *p++ = 'L'; *p++ = 'O'; *p++ = 'G';
+    *p++ = h.version;
+    *p++ = h.schema;
+    putU16(p, h.recordSize);
+    *p++ = h.flags;
+    *p++ = h.fastRecordSize;
+    putU64(p, h.startEpochMs);
+    putU32(p, h.startMillis);
+    putU64(p, h.startMonoUs);
+}
+
+// Rejects unknown magic/version/schema and records shorter than kRecordSizeV1.
+// Version 1 files decode with fastRecordSize 0; `len` need only cover
+// headerSize(version).
+inline bool decodeHeader(const uint8_t* in, size_t len, Header& h) {
+    if (len < kLegacyHeaderSize || memcmp(in, "FLOG", 4) != 0) return false;
+    const uint8_t* p = in + 4;
+    h.version = *p++;
+    h.schema = *p++;
+    h.recordSize = getU16(p);
+    h.flags = *p++;
+    h.fastRecordSize = *p++;
+    h.startEpochMs = getU64(p);
+    h.startMillis = getU32(p);
+    h.startMonoUs = (uint64_t)h.startMillis * 1000;
+    if (h.version == 1) {
+        h.fastRecordSize = 0;
+    } else if (h.version == 0 || h.version > kVersion || h.fastRecordSize < kFastRecordSize) {
+        return false;
+    } else if (h.version == kVersion) {
+        if (len < kHeaderSize) return false;
+        h.startMonoUs = getU64(p);
+    }
+    return h.schema == kSchemaTelemetryV1 && h.recordSize >= kRecordSizeV1;
+}
+
+inline void encodeRecord(const Record& r, uint8_t out[kRecordSize]) {
+    uint8_t* p = out;
+    putU32(p, r.offset);
+    *p++ = r.flags;
+    *p++ = r.batteryPercentCc;
+    *p++ = r.batteryPercentVoltage;
+    *p++ = r.throttlePercent;
+    *p++ = r.powerPercent;
+    putU16(p, r.batteryVoltageMv);
+    putU16(p, r.powerKwX10);
+    putU16(p, r.throttleRaw);
+    putU16(p, r.rpm);
+    putU16(p, r.escCurrentDa);
+    putU16(p, (uint16_t)r.motorTempDc);
+    putU16(p, (uint16_t)r.escTempDc);
+    putU16(p, (uint16_t)r.bmsTempMaxC);
+    putU16(p, r.cellMinMv);
+    putU16(p, r.cellMaxMv);
+    *p++ = r.packFlags;
+    for (const PackRecord& pack : r.packs) {
+        *p++ = pack.soc;
+        putU16(p, (uint16_t)pack.currentDa);
+        putU16(p, pack.cellMinMv);
+        putU16(p, pack.cellMaxMv);
+        putU16(p, (uint16_t)pack.tempMaxC);
+    }
+}
+
+inline void encodeFastRecord(const FastRecord& r, uint8_t out[kFastRecordSize]) {
+    uint8_t* p = out;
+    putU32(p, r.offset);
+    *p++ = (uint8_t)(r.flags | RecordFast);
+    *p++ = r.throttlePercent;
+    *p++ = r.powerPercent;
+    putU16(p, r.throttleRaw);
+    putU16(p, r.rpm);
+    putU16(p, r.escCurrentDa);
+    putU16(p, r.batteryVoltageMv);
+    putU16(p, r.powerKwX10);
+}
+
+// A fast record as a Record with the slow groups empty, so both kinds go
+// through formatCsvLine(). `in` must hold kFastRecordSize bytes.
+inline void decodeFastRecord(const uint8_t* in, Record& r) {
+    memset(&r, 0, sizeof(r));
+    const uint8_t* p = in;
+    r.offset = getU32(p);
+    r.flags = (uint8_t)(*p++ & (RecordFast | RecordPreArm | RecordPostDisarm
+                                | RecordHasTelemetry | RecordHasPowerKw | RecordHasCurrent));
+    r.throttlePercent = *p++;
+    r.powerPercent = *p++;
+    r.throttleRaw = getU16(p);
+    r.rpm = getU16(p);
+    r.escCurrentDa = getU16(p);
+    r.batteryVoltageMv = getU16(p);
+    r.powerKwX10 = getU16(p);
+}
+
+// `in` must hold `size` bytes, at least kRecordSizeV1: the header's
+// recordSize, or kRecordSize if that is larger (the caller advances by
+// recordSize). A kRecordSizeV1 record decodes with no pack data.
+inline void decodeRecord(const uint8_t* in, Record& r, size_t size = kRecordSize) {
+    const uint8_t* p = in;
+    r.offset = getU32(p);
+    r.flags = *p++;
+    r.batteryPercentCc = *p++;
+    r.batteryPercentVoltage = *p++;
+    r.throttlePercent = *p++;
+    r.powerPercent = *p++;
+    r.batteryVoltageMv = getU16(p);
+    r.powerKwX10 = getU16(p);
+    r.throttleRaw = getU16(p);
+    r.rpm = getU16(p);
+    r.escCurrentDa = getU16(p);
+    r.motorTempDc = (int16_t)getU16(p);
+    r.escTempDc = (int16_t)getU16(p);
+    r.bmsTempMaxC = (int16_t)getU16(p);
+    r.cellMinMv = getU16(p);
+    r.cellMaxMv = getU16(p);
+    if (size < kRecordSize) {
+        r.packFlags = 0;
+        memset(r.packs, 0, sizeof(r.packs));
+        return;
+    }
+    r.packFlags = *p++;
+    for (PackRecord& pack : r.packs) {
+        pack.soc = *p++;
+        pack.currentDa = (int16_t)getU16(p);
+        pack.cellMinMv = getU16(p);
+        pack.cellMaxMv = getU16(p);
+        pack.tempMaxC = (int16_t)getU16(p);
+    }
+}
+
+// Extends the records' 32-bit offset to a 64-bit offset in microseconds.
+// Version 3 offsets are microseconds and wrap every ~71 minutes; records
+// are in time order and never that far apart (at least one a second while
+// the file is open), so each is the previous one plus the forward distance
+// modulo 2^32. Older versions stored milliseconds, which never wrap in a
+// flight.
+class RecordClock {
+public:
+    RecordClock() : micros_(true), lastUs_(0) {}
+
+    // `fromUs`: a time at or shortly before the next record, when reading
+    // starts mid-file (a compressed log's sync point); 0 at the first record.
+    void reset(const Header& h, uint64_t fromUs = 0) {
+        micros_ = h.version >= 3;
+        lastUs_ = fromUs;
+    }
+
+    uint64_t offsetUs(uint32_t offset) {
+        if (!micros_) return (uint64_t)offset * 1000;
+        lastUs_ += (uint32_t)(offset - (uint32_t)lastUs_);
+        return lastUs_;
+    }
+
+private:
+    bool     micros_;
+    uint64_t lastUs_;
+};
+
+// Column names of the historical TelemetryLogger CSV, plus "phase": "pre"
+// (pre-arm ring), "armed" or "post" (tail after disarm), and "uptime_us":
+// the record's time on the controller's monotonic clock, the one the
+// event journal and /api/telemetry use. Then, per BMS pack of a parallel
+// battery, its SoC, current (A), cell extremes and hottest sensor; empty
+// with a single BMS or none.
+static const char kCsvHeader[] =
+    "timestamp,battery_percent_cc,battery_percent_voltage,voltage,power_kw,throttle_percent,"
+    "throttle_raw,power_percent,motor_temp,rpm,esc_current,esc_temp,battery_temp_max,"
+    "cell_voltage_min_mv,cell_voltage_max_mv,phase,uptime_us,"
+    "pack1_soc,pack1_current,pack1_cell_min_mv,pack1_cell_max_mv,pack1_temp_max,"
+    "pack2_soc,pack2_current,pack2_cell_min_mv,pack2_cell_max_mv,pack2_temp_max\r\n";
+
+// Longest line formatCsvLine() can produce, NUL included.
+static const size_t kMaxCsvLine = 256;
+
+// Writes `v` in decimal with a NUL; returns the length, or 0 if `cap` is
+// too small. For the per-line numbers where snprintf() would dominate.
+inline size_t formatDecimal(uint64_t v, char* out, size_t cap) {
+    char digits[20];
+    size_t n = 0;
+    do {
+        digits[n++] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v > 0);
+    if (n >= cap) return 0;
+    for (size_t i = 0; i < n; i++) out[i] = digits[n - 1 - i];
+    out[n] = '\0';
+    return n;
+}
+
+// The wall-clock second formatTimestamp() last wrote. Records come in time
+// order, so a converter pays for gmtime_r() and snprintf() once a second
+// and copies the text for the other records of that second.
+struct TimestampCache {
+    TimestampCache() : second(UINT64_MAX), len(0) {}
+    uint64_t second;
+    size_t   len;
+    char     text[24];
+};
+
+// Timestamp as the text logger wrote it: "HH:MM:SS" when the file name
+// already has the date, full "YYYY-MM-DDTHH:MM:SS" otherwise, and
+// "ms:<millis>" when the clock was not set at file start. High-rate files
+// (HeaderMillis) append ".mmm" to the wall-clock forms. Returns the length,
+// negative on error, or at least `cap` when it does not fit.
+inline int formatTimestamp(const Header& h, uint64_t offsetUs, char* out, size_t cap,
+                           TimestampCache* cache = nullptr) {
+    if (!(h.flags & HeaderEpochValid)) {
+        if (cap < 4) return (int)cap;
+        memcpy(out, "ms:", 3);
+        const size_t n = formatDecimal((uint32_t)((h.startMonoUs + offsetUs) / 1000), out + 3, cap - 3);
+        return n == 0 ? (int)cap : (int)(3 + n);
+    }
+    const uint64_t epochMs = h.startEpochMs + offsetUs / 1000;
+    TimestampCache local;
+    TimestampCache& c = cache != nullptr ? *cache : local;
+    if (c.second != epochMs / 1000) {
+        const time_t seconds = (time_t)(epochMs / 1000);
+        struct tm t;
+        gmtime_r(&seconds, &t);
+        int n;
+        if (h.flags & HeaderNameHasDate) {
+            n = snprintf(c.text, sizeof(c.text), "%02d:%02d:%02d", t.tm_hour, t.tm_min, t.tm_sec);
+        } else {
+            n = snprintf(c.text, sizeof(c.text), "%04d-%02d-%02dT%02d:%02d:%02d",
+                         t.tm_year + 1900, t.tm_mon + 1, t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec);
+        }
+        if (n < 0 || (size_t)n >= sizeof(c.text)) return -1;
+        c.second = epochMs / 1000;
+        c.len = (size_t)n;
+    }
+    const size_t millis = (h.flags & HeaderMillis) ? 4 : 0;
+    if (c.len + millis >= cap) return (int)cap;
+    memcpy(out, c.text, c.len);
+    if (millis > 0) {
+        const unsigned ms = (unsigned)(epochMs % 1000);
+        out[c.len] = '.';
+        out[c.len + 1] = (char)('0' + ms / 100);
+        out[c.len + 2] = (char)('0' + ms / 10 % 10);
+        out[c.len + 3] = (char)('0' + ms % 10);
+    }
+    out[c.len + millis] = '\0';
+    return (int)(c.len + millis);
+}
+
+// One CSV line (with "\r\n") for a record `offsetUs` into the file (from
+// RecordClock); empty cells where the record has no data, as the text
+// logger wrote them. A fast record (RecordFast) leaves the slow columns
+// empty. Returns the length, or 0 if `cap` is too small (kMaxCsvLine always
+// fits).
+inline size_t formatCsvLine(const Header& h, const Record& r, uint64_t offsetUs, char* out, size_t cap,
+                            TimestampCache* cache = nullptr) {
+    size_t used = 0;
+    bool ok = true;
+    auto append = [&](int n) {
+        if (n < 0 || (size_t)n >= cap - used) { ok = false; return; }
+        used += (size_t)n;
+    };
+#define FLIGHTLOG_APPEND(...) do { if (ok) append(snprintf(out + used, cap - used, __VA_ARGS__)); } while (0)
+
+    if (ok) append(formatTimestamp(h, offsetUs, out + used, cap - used, cache));
+    FLIGHTLOG_APPEND(",");
+
+    const bool hasTelemetry = (r.flags & RecordHasTelemetry) != 0;
+    const bool hasSlow = hasTelemetry && !(r.flags & RecordFast);
+    if (hasTelemetry) {
+        if (hasSlow) {
+            FLIGHTLOG_APPEND("%u,%u,", r.batteryPercentCc, r.batteryPercentVoltage);
+        } else {
+            FLIGHTLOG_APPEND(",,");
+        }
+        FLIGHTLOG_APPEND("%u.%03u,", r.batteryVoltageMv / 1000, r.batteryVoltageMv % 1000);
+        if (r.flags & RecordHasPowerKw) {
+            FLIGHTLOG_APPEND("%u.%u", r.powerKwX10 / 10, r.powerKwX10 % 10);
+        }
+        FLIGHTLOG_APPEND(",");
+    } else {
+        FLIGHTLOG_APPEND(",,,,");
+    }
+
+    FLIGHTLOG_APPEND("%u,%u,%u,", r.throttlePercent, r.throttleRaw, r.powerPercent);
+
+    if (hasSlow) FLIGHTLOG_APPEND("%d", r.motorTempDc / 10);
+    FLIGHTLOG_APPEND(",");
+    if (r.flags & RecordHasCurrent) {
+        FLIGHTLOG_APPEND("%u,%u", r.rpm, r.escCurrentDa / 10);
+    } else {
+        FLIGHTLOG_APPEND(",");
+    }
+    FLIGHTLOG_APPEND(",");
+    if (hasSlow) FLIGHTLOG_APPEND("%d", r.escTempDc / 10);
+
+    if (r.flags & RecordHasBmsTemp) {
+        FLIGHTLOG_APPEND(",%d", r.bmsTempMaxC);
+    } else {
+        FLIGHTLOG_APPEND(",");
+    }
+    if (r.flags & RecordHasCells) {
+        FLIGHTLOG_APPEND(",%u,%u", r.cellMinMv, r.cellMaxMv);
+    } else {
+        FLIGHTLOG_APPEND(",,");
+    }
+    FLIGHTLOG_APPEND(",%s,", (r.flags & RecordPreArm) ? "pre"
+                             : (r.flags & RecordPostDisarm) ? "post" : "armed");
+    if (ok) {
+        const size_t n = formatDecimal(h.startMonoUs + offsetUs, out + used, cap - used);
+        if (n == 0) return 0;
+        used += n;
+    }
+
+    for (uint8_t i = 0; i < kMaxPacks; i++) {
+        const PackRecord& pack = r.packs[i];
+        const uint8_t flags = (uint8_t)(r.packFlags >> packFlagShift(i));
+        if (flags & PackHasData) {
+            FLIGHTLOG_APPEND(",%u,%d", pack.soc, pack.currentDa / 10);
+        } else {
+            FLIGHTLOG_APPEND(",,");
+        }
+        if (flags & PackHasCells) {
+            FLIGHTLOG_APPEND(",%u,%u", pack.cellMinMv, pack.cellMaxMv);
+        } else {
+            FLIGHTLOG_APPEND(",,");
+        }
+        if (flags & PackHasTemp) {
+            FLIGHTLOG_APPEND(",%d", pack.tempMaxC);
+        } else {
+            FLIGHTLOG_APPEND(",");
+        }
+    }
+    FLIGHTLOG_APPEND("\r\n");
+#undef FLIGHTLOG_APPEND
+
+    return ok ? used : 0;
+}
+
+// Incremental file -> CSV conversion for a streaming HTTP response. Feed the
+// raw file bytes in any chunking with push(); read() hands out CSV bytes.
+// Holds at most one record and one formatted line, so memory is constant
+// whatever the file size.
+class CsvConverter {
+public:
+    CsvConverter()
+        : state_(ReadingHeader), have_(0), lineLen_(0), linePos_(0), skip_(0),
+          fromMs_(0), toMs_(UINT32_MAX), lastOffsetMs_(0) {}
+
+    bool failed() const { return state_ == Failed; }
+
+    // Past the end of the window: nothing more to convert.
+    bool done() const { return state_ == Done; }
+
+    // Only records whose offset from the start of the file, in ms, is in
+    // [fromMs, toMs] become lines; the first record after toMs ends the
+    // conversion (records are in time order). The CSV header line is always
+    // produced. Set before pushing.
+    void setWindow(uint32_t fromMs, uint32_t toMs) {
+        fromMs_ = fromMs;
+        toMs_ = toMs;
+    }
+
+    // Offset in ms of the last record read, in or out of the window.
+    uint32_t lastOffsetMs() const { return lastOffsetMs_; }
+
+    // Still taking the file header; it is kLegacyHeaderSize or kHeaderSize
+    // bytes depending on its version.
+    bool readingHeader() const { return state_ == ReadingHeader; }
+
+    // The next record pushed starts a compressed block whose sync point
+    // says `firstMs`, rather than following the last one pushed. Only once
+    // the header has been read.
+    void resumeAt(uint32_t firstMs) { clock_.reset(header_, (uint64_t)firstMs * 1000); }
+
+    // Number of input bytes the converter can take right now (0 while a
+    // formatted line is still waiting to be read).
+    size_t wants() const {
+        if (state_ == Failed || state_ == Done || linePos_ < lineLen_) return 0;
+        if (skip_ > 0) return skip_;
+        return target() - have_;
+    }
+
+    // Consumes up to wants() bytes; returns how many were taken.
+    size_t push(const uint8_t* data, size_t len) {
+        size_t taken = 0;
+        while (taken < len && wants() > 0) {
+            if (skip_ > 0) {
+                const size_t n = (len - taken) < skip_ ? (len - taken) : skip_;
+                skip_ -= n;
+                taken += n;
+                continue;
+            }
+            const size_t need = target() - have_;
+            const size_t n = (len - taken) < need ? (len - taken) : need;
+            memcpy(pending_ + have_, data + taken, n);
+            have_ += n;
+            taken += n;
+            // Reaching the prefix only tells which kind of record this is.
+            if (have_ == target()) complete();
+        }
+        return taken;
+    }
+
+    // Copies out up to cap bytes of CSV; returns how many.
+    size_t read(uint8_t* out, size_t cap) {
+        const size_t n = (lineLen_ - linePos_) < cap ? (lineLen_ - linePos_) : cap;
+        memcpy(out, line_ + linePos_, n);
+        linePos_ += n;
+        return n;
+    }
+
+private:
+    enum State : uint8_t { ReadingHeader, ReadingRecords, Done, Failed };
+
+    State   state_;
+    Header  header_;
+    RecordClock clock_;
+    TimestampCache timestamp_;
+    uint8_t pending_[kHeaderSize > kRecordSize ? kHeaderSize : kRecordSize];
+    size_t  have_;
+    char    line_[kMaxCsvLine > sizeof(kCsvHeader) ? kMaxCsvLine : sizeof(kCsvHeader)];
+    size_t  lineLen_;
+    size_t  linePos_;
+    size_t  skip_;   // bytes of a longer (newer-schema) record to skip
+    uint32_t fromMs_;
+    uint32_t toMs_;
+    uint32_t lastOffsetMs_;
+
+    bool pendingIsFast() const { return (pending_[kRecordPrefixSize - 1] & RecordFast) != 0; }
+
+    // The part of a full record this reader decodes; a newer schema's extra
+    // bytes are skipped.
+    size_t fullSize() const { return header_.recordSize < kRecordSize ? header_.recordSize : kRecordSize; }
+
+    // Bytes of the item being read: the header up to its version, the rest
+    // of the header, a record prefix, or the record that prefix announced.
+    size_t target() const {
+        if (state_ == ReadingHeader) return have_ < kLegacyHeaderSize ? kLegacyHeaderSize : headerSize(pending_[4]);
+        if (have_ < kRecordPrefixSize) return kRecordPrefixSize;
+        return pendingIsFast() ? kFastRecordSize : fullSize();
+    }
+
+    void fail() {
+        state_ = Failed;
+        lineLen_ = 0;
+        linePos_ = 0;
+    }
+
+    void complete() {
+        linePos_ = 0;
+        if (state_ == ReadingHeader) {
+            const size_t len = have_;
+            have_ = 0;
+            if (!decodeHeader(pending_, len, header_)) {
+                fail();
+                return;
+            }
+            clock_.reset(header_);
+            timestamp_ = TimestampCache();
+            state_ = ReadingRecords;
+            lineLen_ = sizeof(kCsvHeader) - 1;
+            memcpy(line_, kCsvHeader, lineLen_);
+            return;
+        }
+        Record r;
+        if (pendingIsFast()) {
+            if (header_.fastRecordSize == 0) {   // version 1 never wrote these
+                fail();
+                return;
+            }
+            decodeFastRecord(pending_, r);
+            skip_ = header_.fastRecordSize - kFastRecordSize;
+        } else {
+            decodeRecord(pending_, r, fullSize());
+            skip_ = header_.recordSize - fullSize();
+        }
+        have_ = 0;
+        const uint64_t offsetUs = clock_.offsetUs(r.offset);
+        lastOffsetMs_ = (uint32_t)(offsetUs / 1000);
+        if (lastOffsetMs_ > toMs_) {
+            state_ = Done;
+            lineLen_ = 0;
+            return;
+        }
+        lineLen_ = lastOffsetMs_ < fromMs_ ? 0 : formatCsvLine(header_, r, offsetUs, line_, sizeof(line_), &timestamp_);
+    }
+};
+
+} // namespace FlightLog
@@ -0,0 +1,178 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <atomic>
+
+// RAM double buffer between the loop task (producer) and the log writer task
+// (consumer) -- no Arduino deps, host-testable.
+//
+// The producer appends records to the active buffer and seal()s it when it
+// is full or the flush policy says so. Sealing hands the buffer to the writer
+// and makes the other one active. Only one buffer is ever sealed: while the
+// writer still holds it, seal() fails and the producer keeps filling the
+// active one, so the loop never waits on flash. A record that finds the
+// active buffer full and cannot seal it is dropped and counted.
+template <size_t Capacity>
+class LogDoubleBuffer {
+public:
+    static const size_t kCapacity = Capacity;
+
+    LogDoubleBuffer() : active_(0), sealed_(kNone), dropped_(0) {
+        len_[0] = 0;
+        len_[1] = 0;
+    }
+
+    // ---- producer (one task) ----
+
+    bool fits(size_t len) const { return Capacity - len_[active_] >= len; }
+    size_t pending() const { return len_[active_]; }
+    uint32_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    // Copies the record into the active buffer; false (and counted as
+    // dropped) if it does not fit.
+    bool append(const uint8_t* data, size_t len) {
+        if (!fits(len)) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        memcpy(buf_[active_] + len_[active_], data, len);
+        len_[active_] += len;
+        return true;
+    }
+
+    // Hands the active buffer to the consumer. False if it is empty or the
+    // consumer has not released the previous one yet.
+    bool seal() {
+        if (len_[active_] == 0 || sealed_.load(std::memory_order_acquire) != kNone) {
+            return false;
+        }
+        sealed_.store(active_, std::memory_order_release);
+        active_ ^= 1;
+        len_[active_] = 0;
+        return true;
+    }
+
+    // Takes back the buffer just sealed, for when the consumer could not be
+    // told about it. Only valid right after a successful seal(), before any
+    // append().
+    void unseal() {
+        active_ ^= 1;
+        sealed_.store(kNone, std::memory_order_release);
+    }
+
+    // ---- consumer (one task) ----
+
+    // The sealed buffer, if any. Stays valid until release().
+    bool peekSealed(const uint8_t*& data, size_t& len) const {
+        const uint8_t slot = sealed_.load(std::memory_order_acquire);
+        if (slot == kNone) return false;
+        data = buf_[slot];
+        len = len_[slot];
+        return true;
+    }
+
+    void release() { sealed_.store(kNone, std::memory_order_release); }
+
+private:
+    static const uint8_t kNone = 0xFF;
+
+    uint8_t buf_[2][Capacity];
+    size_t len_[2];
+    uint8_t active_;                 // producer-owned
+    std::atomic<uint8_t> sealed_;    // kNone, or the slot the consumer owns
+    std::atomic<uint32_t> dropped_;
+};
+
+// Byte ring of the most recent variable-length records, oldest evicted
+// first. Each record's first four bytes are its capture time (a wrapping
+// u32 clock, little-endian), which is what age-based expiry reads. Single task only:
+// the owner hands it to another task by not touching it meanwhile.
+template <size_t Capacity>
+class LogRing {
+public:
+    static const size_t kCapacity = Capacity;
+    static const size_t kMaxRecord = 255;
+
+    LogRing() { clear(); }
+
+    void clear() {
+        head_ = 0;
+        used_ = 0;
+        count_ = 0;
+    }
+
+    bool empty() const { return count_ == 0; }
+    size_t count() const { return count_; }
+    size_t bytesUsed() const { return used_; }
+
+    // Appends a record (at least 4 bytes), evicting the oldest ones to make
+    // room. False if it can never fit.
+    bool push(const uint8_t* rec, size_t len) {
+        if (len < 4 || len > kMaxRecord || len + 1 > Capacity) return false;
+        while (Capacity - used_ < len + 1) dropOldest();
+        size_t pos = (head_ + used_) % Capacity;
+        buf_[pos] = (uint8_t)len;
+        for (size_t i = 0; i < len; i++) {
+            pos = (pos + 1) % Capacity;
+            buf_[pos] = rec[i];
+        }
+        used_ += len + 1;
+        count_++;
+        return true;
+    }
+
+    // Capture time of the oldest record; only valid when !empty().
+    uint32_t oldestTime() const {
+        uint32_t v = 0;
+        for (size_t i = 0; i < 4; i++) v |= (uint32_t)buf_[(head_ + 1 + i) % Capacity] << (8 * i);
+        return v;
+    }
+
+    // Drops records captured more than maxAge before now (same units).
+    void expire(uint32_t now, uint32_t maxAge) {
+        while (!empty() && now - oldestTime() > maxAge) dropOldest();
+    }
+
+    // Moves the oldest record to `out`; returns its length, or 0 if the
+    // ring is empty or `cap` is too small.
+    size_t pop(uint8_t* out, size_t cap) {
+        if (empty()) return 0;
+        const size_t len = buf_[head_];
+        if (len > cap) return 0;
+        for (size_t i = 0; i < len; i++) out[i] = buf_[(head_ + 1 + i) % Capacity];
+        dropOldest();
+        return len;
+    }
+
+private:
+    uint8_t buf_[Capacity];
+    size_t head_;    // length byte of the oldest record
+    size_t used_;
+    size_t count_;
+
+    void dropOldest() {
+        const size_t len = buf_[head_];
+        head_ = (head_ + len + 1) % Capacity;
+        used_ -= len + 1;
+        count_--;
+    }
+};
+
+// When the loop should seal a partly filled buffer: at most `intervalMs`
+// of records sit in RAM, so a power cut loses at most that much.
+inline bool logFlushDue(size_t pendingBytes, uint32_t nowMs, uint32_t lastSealMs, uint32_t intervalMs) {
+    return pendingBytes > 0 && nowMs - lastSealMs >= intervalMs;
+}
+
+// Counters reported by the log writer (GET /api/telemetry, "logger").
+struct LogWriterStats {
+    uint32_t droppedRecords;    // producer found both buffers busy
+    uint32_t buffersWritten;
+    uint32_t bytesWritten;
+    uint32_t writeErrors;       // short writes or files that failed to open
+    uint32_t maxWriteLatencyUs; // worst write+flush of one buffer since boot
+    uint32_t lastWriteLatencyUs;
+};
@@ -0,0 +1,332 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+// Streaming LZSS for flight logs, heatshrink-style: a fixed 1 KB window,
+// no heap, no tables -- no Arduino deps, host-testable.
+//
+// Bit stream, MSB first:
+//   1 | byte                   literal                      (9 bits)
+//   0 | offset-1 (kWindowBits) | length-kMinMatch (kLookaheadBits)
+//                              copy from `offset` bytes back (15 bits)
+// The last byte is padded with zero bits, which never decode to a token.
+//
+// A compressed log file is kFileHeaderSize bytes -- magic "FLZ1" and the
+// uncompressed size (u32 LE) -- followed by the stream of the whole .flog
+// (header and records). The name stays ".flog"; readers tell the two apart
+// by the magic.
+//
+// The stream is cut into blocks that never copy from an earlier block, so
+// a Decoder can start at any block. An optional footer after the stream
+// lists them as sync points, each the start of a record:
+//   count * (firstMs u32 | rawOffset u32 | bitOffset u32) |
+//   endMs u32 | count u32 | "FTIX"
+// firstMs is the record's offset from the start of the log in ms
+// (FlightLog::RecordClock), bitOffset counts from the start of the file,
+// endMs is the last record's offset in ms. Readers going front to back
+// stop at the raw size and never look at the footer.
+//
+// Both sides use the same push/read shape as FlightLog::CsvConverter:
+// push() takes what input it can, read() drains output, so the caller can
+// chain them through small buffers.
+namespace LogCompression {
+
+static const uint8_t kWindowBits = 10;
+static const uint8_t kLookaheadBits = 4;
+static const size_t  kWindowSize = (size_t)1 << kWindowBits;
+static const size_t  kMinMatch = 2;   // a 2-byte copy (15 bits) beats two literals (18)
+static const size_t  kMaxMatch = kMinMatch + ((size_t)1 << kLookaheadBits) - 1;
+static const size_t  kFileHeaderSize = 8;
+static const char    kMagic[4] = {'F', 'L', 'Z', '1'};
+
+inline bool isCompressed(const uint8_t* data, size_t len) {
+    return len >= sizeof(kMagic) && memcmp(data, kMagic, sizeof(kMagic)) == 0;
+}
+
+inline void encodeFileHeader(uint32_t rawSize, uint8_t* out) {
+    memcpy(out, kMagic, sizeof(kMagic));
+    for (uint8_t i = 0; i < 4; i++) out[4 + i] = (uint8_t)(rawSize >> (8 * i));
+}
+
+inline bool decodeFileHeader(const uint8_t* in, size_t len, uint32_t& rawSize) {
+    if (len < kFileHeaderSize || !isCompressed(in, len)) return false;
+    rawSize = 0;
+    for (uint8_t i = 0; i < 4; i++) rawSize |= (uint32_t)in[4 + i] << (8 * i);
+    return true;
+}
+
+struct SyncPoint {
+    uint32_t firstMs;
+    uint32_t rawOffset;
+    uint32_t bitOffset;
+};
+
+static const size_t kSyncPointSize = 12;
+static const size_t kTrailerSize = 12;
+static const char   kTrailerMagic[4] = {'F', 'T', 'I', 'X'};
+
+inline void putU32(uint8_t* p, uint32_t v) { for (uint8_t i = 0; i < 4; i++) p[i] = (uint8_t)(v >> (8 * i)); }
+inline uint32_t getU32(const uint8_t* p) {
+    uint32_t v = 0;
+    for (uint8_t i = 0; i < 4; i++) v |= (uint32_t)p[i] << (8 * i);
+    return v;
+}
+
+inline void encodeSyncPoint(const SyncPoint& s, uint8_t* out) {
+    putU32(out, s.firstMs);
+    putU32(out + 4, s.rawOffset);
+    putU32(out + 8, s.bitOffset);
+}
+
+inline void decodeSyncPoint(const uint8_t* in, SyncPoint& s) {
+    s.firstMs = getU32(in);
+    s.rawOffset = getU32(in + 4);
+    s.bitOffset = getU32(in + 8);
+}
+
+inline void encodeTrailer(uint32_t endMs, uint32_t count, uint8_t* out) {
+    putU32(out, endMs);
+    putU32(out + 4, count);
+    memcpy(out + 8, kTrailerMagic, sizeof(kTrailerMagic));
+}
+
+// The last kTrailerSize bytes of a compressed file of `fileSize` bytes;
+// false when there is no footer (or it cannot fit).
+inline bool decodeTrailer(const uint8_t* in, uint32_t fileSize, uint32_t& endMs, uint32_t& count) {
+    if (memcmp(in + 8, kTrailerMagic, sizeof(kTrailerMagic)) != 0) return false;
+    endMs = getU32(in);
+    count = getU32(in + 4);
+    return count > 0 && (uint64_t)count * kSyncPointSize + kTrailerSize + kFileHeaderSize <= fileSize;
+}
+
+// File offset of sync point i, given the footer's count.
+inline uint32_t syncPointOffset(uint32_t fileSize, uint32_t count, uint32_t i) {
+    return fileSize - kTrailerSize - (count - i) * (uint32_t)kSyncPointSize;
+}
+
+class Encoder {
+public:
+    Encoder() { reset(); }
+
+    void reset() {
+        pos_ = 0;
+        pendingLen_ = 0;
+        bits_ = 0;
+        bitCount_ = 0;
+        outLen_ = 0;
+        outPos_ = 0;
+        finishing_ = false;
+        flushing_ = false;
+        blockStart_ = 0;
+        bitsOut_ = 0;
+        memset(window_, 0, sizeof(window_));
+    }
+
+    // Takes input bytes; fewer than len when output is waiting to be read.
+    size_t push(const uint8_t* data, size_t len) {
+        size_t taken = 0;
+        while (taken < len && !finishing_ && !flushing_) {
+            if (pendingLen_ == kMaxMatch && !step()) break;
+            pending_[pendingLen_++] = data[taken++];
+        }
+        return taken;
+    }
+
+    // No more input: the rest of the lookahead and the last partial byte
+    // come out of read().
+    void finish() { finishing_ = true; }
+
+    // Ends the current block: what was pushed is encoded by the next
+    // read()s, and nothing after it copies from before it. Drain read()
+    // until it returns 0; bitsOut() is then where the next block starts.
+    void endBlock() { flushing_ = true; }
+
+    // Bits of compressed output so far, read or not.
+    uint32_t bitsOut() const { return bitsOut_; }
+
+    // Copies out up to cap compressed bytes; 0 once drained (and, after
+    // finish(), once the stream is complete).
+    size_t read(uint8_t* out, size_t cap) {
+        size_t n = 0;
+        while (n < cap) {
+            if (outPos_ < outLen_) {
+                out[n++] = out_[outPos_++];
+                continue;
+            }
+            outLen_ = 0;
+            outPos_ = 0;
+            const bool full = pendingLen_ == kMaxMatch;
+            if ((full || ((finishing_ || flushing_) && pendingLen_ > 0)) && step()) continue;
+            if (flushing_ && pendingLen_ == 0) {
+                flushing_ = false;
+                blockStart_ = pos_;
+            }
+            if (finishing_ && pendingLen_ == 0 && bitCount_ > 0) {
+                out_[outLen_++] = (uint8_t)(bits_ << (8 - bitCount_));
+                bitCount_ = 0;
+                continue;
+            }
+            break;
+        }
+        return n;
+    }
+
+private:
+    static const size_t kOutSize = 8;   // room for any token plus spill
+
+    uint8_t  window_[kWindowSize];   // ring of the last kWindowSize input bytes
+    uint32_t pos_;                   // bytes moved into the window so far
+    uint8_t  pending_[kMaxMatch];    // lookahead, not yet encoded
+    size_t   pendingLen_;
+    uint32_t bits_;
+    uint8_t  bitCount_;
+    uint8_t  out_[kOutSize];
+    size_t   outLen_;
+    size_t   outPos_;
+    bool     finishing_;
+    bool     flushing_;
+    uint32_t blockStart_;            // pos_ where the current block began
+    uint32_t bitsOut_;
+
+    // Byte `i` of the stream that starts `dist` bytes before the lookahead;
+    // runs on into the lookahead itself, so matches may overlap.
+    uint8_t at(size_t dist, size_t i) const {
+        return i < dist ? window_[(pos_ - dist + i) & (kWindowSize - 1)] : pending_[i - dist];
+    }
+
+    void putBits(uint32_t value, uint8_t count) {
+        bitsOut_ += count;
+        bits_ = (bits_ << count) | value;
+        bitCount_ += count;
+        while (bitCount_ >= 8) {
+            bitCount_ -= 8;
+            out_[outLen_++] = (uint8_t)(bits_ >> bitCount_);
+        }
+        bits_ &= (1u << bitCount_) - 1;
+    }
+
+    // Encodes one token from the lookahead; false if the output is full.
+    bool step() {
+        if (outLen_ + 2 > kOutSize) return false;
+        size_t bestLen = 0;
+        size_t bestDist = 0;
+        const size_t inBlock = pos_ - blockStart_;
+        const size_t maxDist = inBlock < kWindowSize ? inBlock : kWindowSize;
+        for (size_t dist = 1; dist <= maxDist && bestLen < pendingLen_; dist++) {
+            if (at(dist, 0) != pending_[0]) continue;
+            size_t len = 1;
+            while (len < pendingLen_ && at(dist, len) == pending_[len]) len++;
+            if (len > bestLen) {
+                bestLen = len;
+                bestDist = dist;
+            }
+        }
+
+        size_t used = 1;
+        if (bestLen >= kMinMatch) {
+            putBits(0, 1);
+            putBits((uint32_t)(bestDist - 1), kWindowBits);
+            putBits((uint32_t)(bestLen - kMinMatch), kLookaheadBits);
+            used = bestLen;
+        } else {
+            putBits(1, 1);
+            putBits(pending_[0], 8);
+        }
+        for (size_t i = 0; i < used; i++) {
+            window_[pos_ & (kWindowSize - 1)] = pending_[i];
+            pos_++;
+        }
+        pendingLen_ -= used;
+        memmove(pending_, pending_ + used, pendingLen_);
+        return true;
+    }
+};
+
+class Decoder {
+public:
+    Decoder() { reset(); }
+
+    // Starts at the beginning of the stream, or at a block: `rawOffset` is
+    // the block's position in the decompressed log and `skipBits` its bit
+    // within the first byte pushed (SyncPoint::bitOffset % 8).
+    void reset(uint32_t rawOffset = 0, uint8_t skipBits = 0) {
+        pos_ = rawOffset;
+        bits_ = 0;
+        bitCount_ = 0;
+        skip_ = skipBits;
+        copyDist_ = 0;
+        copyLeft_ = 0;
+        memset(window_, 0, sizeof(window_));
+    }
+
+    // Takes compressed bytes while there is room in the bit buffer.
+    size_t push(const uint8_t* data, size_t len) {
+        size_t taken = 0;
+        while (taken < len && bitCount_ <= 24) {
+            bits_ = (bits_ << 8) | data[taken++];
+            bitCount_ += 8;
+            if (skip_ > 0) {
+                bitCount_ -= skip_;
+                bits_ &= (1u << bitCount_) - 1;
+                skip_ = 0;
+            }
+        }
+        return taken;
+    }
+
+    // Copies out up to cap decompressed bytes; 0 when it needs more input.
+    size_t read(uint8_t* out, size_t cap) {
+        size_t n = 0;
+        while (n < cap) {
+            if (copyLeft_ > 0) {
+                const uint8_t b = window_[(pos_ - copyDist_) & (kWindowSize - 1)];
+                emit(b, out, n);
+                copyLeft_--;
+                continue;
+            }
+            if (bitCount_ < 1) break;
+            if (peekBits(1)) {
+                if (bitCount_ < 9) break;
+                takeBits(1);
+                emit((uint8_t)takeBits(8), out, n);
+            } else {
+                if (bitCount_ < 1 + kWindowBits + kLookaheadBits) break;
+                takeBits(1);
+                copyDist_ = takeBits(kWindowBits) + 1;
+                copyLeft_ = takeBits(kLookaheadBits) + kMinMatch;
+            }
+        }
+        return n;
+    }
+
+    // Position in the decompressed log.
+    uint32_t produced() const { return pos_; }
+
+private:
+    uint8_t  window_[kWindowSize];
+    uint32_t pos_;
+    uint32_t bits_;
+    uint8_t  bitCount_;
+    uint8_t  skip_;
+    uint32_t copyDist_;
+    uint32_t copyLeft_;
+
+    uint32_t peekBits(uint8_t count) const { return (bits_ >> (bitCount_ - count)) & ((1u << count) - 1); }
+
+    uint32_t takeBits(uint8_t count) {
+        const uint32_t v = peekBits(count);
+        bitCount_ -= count;
+        return v;
+    }
+
+    void emit(uint8_t b, uint8_t* out, size_t& n) {
+        window_[pos_ & (kWindowSize - 1)] = b;
+        pos_++;
+        out[n++] = b;
+    }
+};
+
+} // namespace LogCompression
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "FlightLogFormat.h"
+#include "../FlightStats/FlightStatsLogic.h"
+
+// In-RAM index of the log files on LittleFS, persisted as one small file so
+// starting a flight and listing the logs page need no directory walk -- no
+// Arduino deps, host-testable.
+//
+// Each entry is one log ("20250419_003" + kind) with its stored size, start
+// time and, once FlightStats has written it, the encoded flight summary.
+// The sequence counters give the next file name without looking at the
+// other files. The owner (Logger) rebuilds the index from a directory scan
+// when the persisted copy is missing or corrupt, or when the name it picked
+// turns out to exist already.
+//
+// Persisted layout, little-endian:
+//   magic "LI" | version u8 | count u8 | flags u8 | lastDate u32 |
+//   lastDateSeq u16 | lastPlainSeq u32 | count * entry | FNV-1a u32
+//   entry: stem[kStemSize] | kind u8 | hasSummary u8 | size u32 |
+//          startEpochMs u64 | summary[FlightSummaryCodec::kEncodedSize]
+class LogIndex {
+public:
+    static const uint8_t kVersion = 1;
+    static const size_t  kMaxEntries = 64;
+    static const size_t  kStemSize = 24;   // NUL-terminated
+    static const size_t  kHeaderSize = 2 + 1 + 1 + 1 + 4 + 2 + 4;
+    static const size_t  kEntrySize = kStemSize + 1 + 1 + 4 + 8 + FlightSummaryCodec::kEncodedSize;
+    static const size_t  kChecksumSize = 4;
+
+    enum Kind : uint8_t {
+        KindFlog,   // binary log, downloaded as CSV
+        KindCsv,    // text log from older firmware
+        KindTxt,
+        KindCount,
+    };
+
+    struct Entry {
+        char     stem[kStemSize];
+        uint8_t  kind;
+        bool     hasSummary;
+        uint32_t size;
+        uint64_t startEpochMs;   // 0 when unknown (clock not synced, legacy log)
+        uint8_t  summary[FlightSummaryCodec::kEncodedSize];
+    };
+
+    LogIndex() { reset(); }
+
+    // Forgets everything, counters included (before a rebuild).
+    void reset() {
+        count_ = 0;
+        complete_ = true;
+        lastDate_ = 0;
+        lastDateSeq_ = 0;
+        lastPlainSeq_ = 0;
+    }
+
+    // Forgets the entries but keeps the counters, so names are not reused
+    // after the logs were deleted.
+    void clearEntries() {
+        count_ = 0;
+        complete_ = true;
+    }
+
+    size_t count() const { return count_; }
+    const Entry& at(size_t i) const { return entries_[i]; }
+    // False once a log could not be indexed (table full, odd name): callers
+    // that must see every file fall back to a directory scan.
+    bool complete() const { return complete_; }
+    void markIncomplete() { complete_ = false; }
+
+    static const char* extension(uint8_t kind) {
+        switch (kind) {
+            case KindFlog: return FlightLog::kFileExtension;
+            case KindCsv:  return ".csv";
+            case KindTxt:  return ".txt";
+            default:       return "";
+        }
+    }
+
+    // "/20250419_003.flog" (or without the slash) -> stem and kind. False for
+    // anything that is not a log file or whose stem does not fit.
+    static bool parsePath(const char* path, char* stem, uint8_t& kind) {
+        if (path[0] == '/') path++;
+        const char* dot = strrchr(path, '.');
+        if (dot == nullptr || dot == path) return false;
+        kind = KindCount;
+        for (uint8_t k = 0; k < KindCount; k++) {
+            if (strcmp(dot, extension(k)) == 0) kind = k;
+        }
+        const size_t len = (size_t)(dot - path);
+        if (kind == KindCount || len >= kStemSize) return false;
+        memcpy(stem, path, len);
+        stem[len] = '\0';
+        return true;
+    }
+
+    // "/" + stem + extension; false if it does not fit.
+    static bool pathFor(const Entry& e, char* out, size_t cap) {
+        const int n = snprintf(out, cap, "/%s%s", e.stem, extension(e.kind));
+        return n > 0 && (size_t)n < cap;
+    }
+
+    // Sequence number in a stem: "YYYYMMDD_NNN" gives date and NNN,
+    // "NNNNN" gives date 0 and NNNNN. False for any other name.
+    static bool parseSeq(const char* stem, uint32_t& date, uint32_t& seq) {
+        const size_t len = strlen(stem);
+        if (len == 0) return false;
+        const char* us = strchr(stem, '_');
+        if (us == nullptr) {
+            date = 0;
+            return parseDigits(stem, len, seq);
+        }
+        return us - stem == 8 && parseDigits(stem, 8, date) && date != 0
+            && parseDigits(us + 1, len - 9, seq);
+    }
+
+    // Next sequence number for a date (YYYYMMDD, or 0 for undated names).
+    uint32_t nextSeq(uint32_t date) const {
+        if (date == 0) return lastPlainSeq_ + 1;
+        if (date == lastDate_) return (uint32_t)lastDateSeq_ + 1;
+        uint32_t maxSeq = 0;   // clock went back to a day already logged
+        for (size_t i = 0; i < count_; i++) {
+            uint32_t d, s;
+            if (parseSeq(entries_[i].stem, d, s) && d == date && s > maxSeq) maxSeq = s;
+        }
+        return maxSeq + 1;
+    }
+
+    // A binary log for `date` holding only its header (the flight never
+    // logged a record), whose name can be reused; -1 if none.
+    int findReusable(uint32_t date) const {
+        int best = -1;
+        uint32_t bestSeq = 0;
+        for (size_t i = 0; i < count_; i++) {
+            const Entry& e = entries_[i];
+            uint32_t d, s;
+            if (e.kind != KindFlog || e.size > FlightLog::kHeaderSize || !parseSeq(e.stem, d, s) || d != date) {
+                continue;
+            }
+            if (best < 0 || s < bestSeq) {
+                best = (int)i;
+                bestSeq = s;
+            }
+        }
+        return best;
+    }
+
+    int find(const char* stem) const {
+        for (size_t i = 0; i < count_; i++) {
+            if (strcmp(entries_[i].stem, stem) == 0) return (int)i;
+        }
+        return -1;
+    }
+
+    int findPath(const char* path) const {
+        char stem[kStemSize];
+        uint8_t kind;
+        if (!parsePath(path, stem, kind)) return -1;
+        const int i = find(stem);
+        return (i >= 0 && entries_[i].kind == kind) ? i : -1;
+    }
+
+    // Adds (or replaces, for the same stem) a log and raises the counters.
+    // A binary log wins over an older text log of the same name. Returns
+    // the slot, or -1 (index marked incomplete) when it is full.
+    int add(const char* stem, uint8_t kind, uint32_t size, uint64_t startEpochMs) {
+        uint32_t d, s;
+        if (parseSeq(stem, d, s)) noteSeq(d, s);
+        int i = find(stem);
+        if (i >= 0 && entries_[i].kind == KindFlog && kind != KindFlog) return i;
+        if (i < 0) {
+            if (count_ == kMaxEntries || strlen(stem) >= kStemSize) {
+                complete_ = false;
+                return -1;
+            }
+            i = (int)count_++;
+        }
+        Entry& e = entries_[i];
+        memset(&e, 0, sizeof(e));
+        strcpy(e.stem, stem);
+        e.kind = kind;
+        e.size = size;
+        e.startEpochMs = startEpochMs;
+        return i;
+    }
+
+    bool remove(const char* path) {
+        const int i = findPath(path);
+        if (i < 0) return false;
+        removeAt((size_t)i);
+        return true;
+    }
+
+    void removeAt(size_t i) {
+        for (size_t j = i + 1; j < count_; j++) entries_[j - 1] = entries_[j];
+        count_--;
+    }
+
+    bool setSize(const char* path, uint32_t size) {
+        const int i = findPath(path);
+        if (i < 0) return false;
+        entries_[i].size = size;
+        return true;
+    }
+
+    bool addBytes(const char* path, uint32_t bytes) {
+        const int i = findPath(path);
+        if (i < 0) return false;
+        entries_[i].size += bytes;
+        return true;
+    }
+
+    // Attaches an encoded FlightSummaryCodec record to a log.
+    bool setSummary(const char* path, const uint8_t* encoded, size_t len) {
+        const int i = findPath(path);
+        if (i < 0 || len != FlightSummaryCodec::kEncodedSize) return false;
+        memcpy(entries_[i].summary, encoded, len);
+        entries_[i].hasSummary = true;
+        return true;
+    }
+
+    size_t encodedSize() const { return kHeaderSize + count_ * kEntrySize + kChecksumSize; }
+
+    // ---- persistence, one piece at a time so no caller needs a
+    // whole-index buffer; the checksum runs over header and entries ----
+
+    void encodeHeader(uint8_t* out) const {
+        uint8_t* p = out;
+        *p++ = 'L';
+        *p++ = 'I';
+        *p++ = kVersion;
+        *p++ = (uint8_t)count_;
+        *p++ = complete_ ? 1 : 0;
+        FlightLog::putU32(p, lastDate_);
+        FlightLog::putU16(p, lastDateSeq_);
+        FlightLog::putU32(p, lastPlainSeq_);
+    }
+
+    void encodeEntry(size_t i, uint8_t* out) const {
+        const Entry& e = entries_[i];
+        uint8_t* p = out;
+        memcpy(p, e.stem, kStemSize);
+        p += kStemSize;
+        *p++ = e.kind;
+        *p++ = e.hasSummary ? 1 : 0;
+        FlightLog::putU32(p, e.size);
+        FlightLog::putU64(p, e.startEpochMs);
+        memcpy(p, e.summary, sizeof(e.summary));
+    }
+
+    // Resets the index from a persisted header; returns the entry count
+    // to read next, or -1 if the header is not one we know.
+    int decodeHeader(const uint8_t* in) {
+        reset();
+        if (in[0] != 'L' || in[1] != 'I' || in[2] != kVersion || in[3] > kMaxEntries) return -1;
+        const uint8_t* p = in + 5;
+        complete_ = (in[4] & 1) != 0;
+        lastDate_ = FlightLog::getU32(p);
+        lastDateSeq_ = FlightLog::getU16(p);
+        lastPlainSeq_ = FlightLog::getU32(p);
+        return in[3];
+    }
+
+    bool decodeEntry(const uint8_t* in) {
+        if (count_ == kMaxEntries) return false;
+        Entry& e = entries_[count_];
+        const uint8_t* p = in;
+        memcpy(e.stem, p, kStemSize);
+        p += kStemSize;
+        e.kind = *p++;
+        e.hasSummary = *p++ != 0;
+        e.size = FlightLog::getU32(p);
+        e.startEpochMs = FlightLog::getU64(p);
+        memcpy(e.summary, p, sizeof(e.summary));
+        if (e.stem[kStemSize - 1] != '\0' || e.stem[0] == '\0' || e.kind >= KindCount) return false;
+        count_++;
+        return true;
+    }
+
+    static uint32_t checksumInit() { return 2166136261u; }
+    static uint32_t checksum(uint32_t h, const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) {
+            h ^= data[i];
+            h *= 16777619u;
+        }
+        return h;
+    }
+
+private:
+    Entry entries_[kMaxEntries];
+    size_t count_;
+    bool complete_;
+    uint32_t lastDate_;       // newest YYYYMMDD a log was named after
+    uint16_t lastDateSeq_;    // highest NNN used on lastDate_
+    uint32_t lastPlainSeq_;   // highest NNNNN of undated names
+
+    static bool parseDigits(const char* s, size_t len, uint32_t& out) {
+        if (len == 0 || len > 9) return false;
+        out = 0;
+        for (size_t i = 0; i < len; i++) {
+            if (s[i] < '0' || s[i] > '9') return false;
+            out = out * 10 + (uint32_t)(s[i] - '0');
+        }
+        return true;
+    }
+
+    void noteSeq(uint32_t date, uint32_t seq) {
+        if (date == 0) {
+            if (seq > lastPlainSeq_) lastPlainSeq_ = seq;
+        } else if (date > lastDate_) {
+            lastDate_ = date;
+            lastDateSeq_ = (uint16_t)seq;
+        } else if (date == lastDate_ && seq > lastDateSeq_) {
+            lastDateSeq_ = (uint16_t)seq;
+        }
+    }
+};
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "LogIndex.h"
+
+// Free-space budget for the flight logs on the LittleFS data partition
+// (min_spiffs: a few dozen 4 KB blocks) -- no Arduino deps, host-testable.
+//
+// The logger keeps `reserve` bytes free for the next flight by deleting the
+// oldest logs (and their .sum files) after each flight, at boot, and during
+// a flight when the space left runs short. The file being written is never
+// deleted.
+namespace LogStorage {
+
+static const uint16_t kMinReserveKb = 8;
+static const uint16_t kMaxReserveKb = 64;
+static const uint16_t kDefaultReserveKb = 24;
+
+inline bool isValidReserveKb(uint32_t kb) { return kb >= kMinReserveKb && kb <= kMaxReserveKb; }
+
+// Space a log really takes: LittleFS allocates whole blocks, one more for
+// the .sum file.
+inline uint32_t footprint(uint32_t size, bool hasSummary, uint32_t blockSize) {
+    if (blockSize == 0) return size;
+    uint32_t blocks = (size + blockSize - 1) / blockSize;
+    if (blocks == 0) blocks = 1;
+    if (hasSummary) blocks++;
+    return blocks * blockSize;
+}
+
+// How many of the oldest logs (index order, skipping slot `keep`) to delete
+// so that at least `reserve` bytes are free and, after adding `newLogs`
+// entries, the index still has room for every log. Stops early if the logs
+// run out; the caller then reports low space.
+inline size_t planRotation(const LogIndex& index, uint32_t freeBytes, uint32_t reserve,
+                           uint32_t blockSize, int keep, size_t newLogs) {
+    size_t n = 0;
+    size_t remaining = index.count();
+    uint64_t willBeFree = freeBytes;
+    for (size_t i = 0; i < index.count(); i++) {
+        const bool spaceOk = willBeFree >= reserve;
+        const bool roomOk = remaining + newLogs <= LogIndex::kMaxEntries;
+        if (spaceOk && roomOk) break;
+        if ((int)i == keep) continue;
+        const LogIndex::Entry& e = index.at(i);
+        willBeFree += footprint(e.size, e.hasSummary, blockSize);
+        remaining--;
+        n++;
+    }
+    return n;
+}
+
+} // namespace LogStorage
+
+// Storage health reported by the log writer (GET /api/telemetry, "storage").
+struct LogStorageHealth {
+    uint32_t totalBytes;
+    uint32_t usedBytes;      // as of the last check (boot, flight start/end, low space)
+    uint32_t reserveBytes;
+    uint32_t logsRotated;    // oldest logs deleted to keep the reserve, since boot
+    bool     lowSpace;       // reserve could not be kept even after rotating
+};
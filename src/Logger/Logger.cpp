@@ -1,259 +1,1025 @@
 #include "Logger.h"
 #include "../Throttle/Throttle.h"
+#include "../Settings/Settings.h"
+#include "../Clock/Clock.h"
 #include <time.h>
-#include <sys/time.h>
 
 extern Throttle throttle;
+extern Settings settings;
 
 static const time_t MIN_VALID_EPOCH = 1577836800; // 2020-01-01 UTC
+static const char INDEX_PATH[] = "/logs.idx";
+static const char INDEX_TEMP_PATH[] = "/logs.idx.tmp";
+static const char COMPRESS_TEMP_PATH[] = "/compress.tmp";
 
 bool Logger::isTimeSynced() {
     return time(nullptr) > MIN_VALID_EPOCH;
 }
 
-void Logger::formatTimestamp(char* buf, size_t len) {
-    if (!isTimeSynced()) {
-        snprintf(buf, len, "ms:%lu", millis());
+Logger::Logger()
+    : loggingEnabled_(false),
+      closePending_(false),
+      summaryPending_(false),
+      inTail_(false),
+      tailStartMillis_(0),
+      highRate_(false),
+      packRecords_(false),
+      fullRecordSize_(FlightLog::kRecordSizeV1),
+      reserveBytes_((uint32_t)LogStorage::kDefaultReserveKb * 1024),
+      lastSettingsMillis_(0),
+      fileStartUs_(0),
+      lastSealMillis_(0),
+      preArmRingBusy_(false),
+      commandQueue_(nullptr),
+      releasedSignal_(nullptr),
+      stateMutex_(nullptr),
+      writerTask_(nullptr),
+      fileOpen_(false),
+      indexLoaded_(false),
+      pendingSummaryLen_(0),
+      freeEstimate_(0),
+      freeAtCheck_(0) {
+    currentFileName_[0] = '\0';
+    pendingSummaryPath_[0] = '\0';
+    nextCompressPath_[0] = '\0';
+    compress_.active = false;
+    memset(&header_, 0, sizeof(header_));
+    memset(&stats_, 0, sizeof(stats_));
+    memset(&storage_, 0, sizeof(storage_));
+}
+
+void Logger::init() {
+    if (!LittleFS.begin(true)) {
+        Serial.println("LittleFS Mount Failed");
+        return;
+    }
+    reserveBytes_ = (uint32_t)settings.getLogReserveKb() * 1024;
+    stateMutex_ = xSemaphoreCreateMutex();
+    releasedSignal_ = xSemaphoreCreateBinary();
+    commandQueue_ = xQueueCreate(COMMAND_QUEUE_DEPTH, sizeof(Command));
+    if (stateMutex_ == nullptr || releasedSignal_ == nullptr || commandQueue_ == nullptr) {
+        Serial.println("Logger: queue or mutex create failed");
+        commandQueue_ = nullptr;
+        return;
+    }
+    if (xTaskCreate(writerTask, "log_writer", WRITER_STACK_SIZE, this, WRITER_PRIORITY, &writerTask_) != pdPASS) {
+        Serial.println("Logger: writer task create failed");
+        commandQueue_ = nullptr;
         return;
     }
+    // Don't create/open log file yet - wait for arm
+}
 
-    time_t now = time(nullptr);
-    struct tm t;
-    gmtime_r(&now, &t);
+// ---------------------------------------------------------------------------
+// Loop task side: never blocks and never touches LittleFS.
+// ---------------------------------------------------------------------------
 
-    if (fileHasDate) {
-        snprintf(buf, len, "%02d:%02d:%02d",
-                 t.tm_hour, t.tm_min, t.tm_sec);
-    } else {
-        snprintf(buf, len, "%04d-%02d-%02dT%02d:%02d:%02d",
-                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday,
-                 t.tm_hour, t.tm_min, t.tm_sec);
+void Logger::handle() {
+    const bool isArmed = throttle.isArmed();
+    const unsigned long now = millis();
+    if (now - lastSettingsMillis_ >= SETTINGS_REFRESH_MS) {
+        lastSettingsMillis_ = now;
+        reserveBytes_ = (uint32_t)settings.getLogReserveKb() * 1024;
+    }
+
+    // Disarm: commit what is buffered now, keep logging the tail, then close.
+    // Re-arming during the tail closes this file and starts the next one.
+    if (loggingEnabled_ && !isArmed && !inTail_) {
+        inTail_ = true;
+        tailStartMillis_ = now;
+        sealAndHandOff();
+    }
+    if (inTail_ && (isArmed || now - tailStartMillis_ >= POST_DISARM_TAIL_MS)) {
+        stopLogging();
+    }
+
+    // The last buffer and the Close go out as soon as the writer has room;
+    // a new flight waits for them so records never land in the wrong file.
+    if (closePending_) {
+        const Command close = makeCommand(CommandClose);
+        if ((buffer_.pending() == 0 || sealAndHandOff()) && sendCommand(close, 0)) {
+            closePending_ = false;
+        }
+    }
+
+    if (summaryPending_ && sendCommand(makeCommand(CommandSummary), 0)) {
+        summaryPending_ = false;
+    }
+
+    if (!loggingEnabled_ && !closePending_ && isArmed) {
+        startLogging();
     }
-}
 
-Logger::Logger() {
-    currentFileName = "";
-    fileOpen = false;
-    loggingEnabled = false;
-    wasArmed = false;
-    fileHasDate = false;
-    csvHeader = "";
+    if (loggingEnabled_ && logFlushDue(buffer_.pending(), now, lastSealMillis_, FLUSH_INTERVAL_MS)) {
+        sealAndHandOff();
+    }
 }
 
-void Logger::init() {
-    if (!LittleFS.begin(true)) {
-        Serial.println("LittleFS Mount Failed");
+void Logger::startLogging() {
+    if (commandQueue_ == nullptr) return;
+
+    const uint64_t nowUs = Clock::nowUs();
+
+    // The file starts at the oldest pre-arm record so every offset is
+    // positive. A ring still being written for the previous file (very
+    // short flight) is left out.
+    bool withRing = false;
+    uint64_t startUs = nowUs;
+    if (!preArmRingBusy_.load()) {
+        preArmRing_.expire((uint32_t)nowUs, PRE_ARM_WINDOW_US);
+        if (!preArmRing_.empty()) {
+            withRing = true;
+            startUs = nowUs - (uint32_t)((uint32_t)nowUs - preArmRing_.oldestTime());
+        }
+    }
+
+    Command start = makeCommand(CommandStart);
+    start.header.version = FlightLog::kVersion;
+    start.header.schema = FlightLog::kSchemaTelemetryV1;
+    const size_t fullSize = FlightLog::fullRecordSize(packRecords_);
+    start.header.recordSize = (uint16_t)fullSize;
+    start.header.flags = highRate_ ? FlightLog::HeaderMillis : 0;
+    start.header.fastRecordSize = FlightLog::kFastRecordSize;
+    start.header.startEpochMs = 0;
+    start.header.startMillis = (uint32_t)(startUs / 1000);
+    start.header.startMonoUs = startUs;
+    uint64_t startEpochUs;
+    if (Clock::epochUsAt(startUs, startEpochUs)) {
+        start.header.startEpochMs = startEpochUs / 1000;
+        start.header.flags |= FlightLog::HeaderEpochValid;
+    }
+
+    // Busy before the send: the writer may pick the command up at once.
+    if (withRing) preArmRingBusy_.store(true);
+    if (!sendCommand(start, 0)) {   // retried on the next loop
+        if (withRing) preArmRingBusy_.store(false);
         return;
     }
-    // Don't create/open log file yet - wait for startLogging()
+
+    fileStartUs_ = startUs;
+    fullRecordSize_ = fullSize;
+    lastSealMillis_ = millis();
+    loggingEnabled_ = true;
 }
 
-void Logger::startLogging() {
-    if (loggingEnabled) {
-        return; // Already logging
+void Logger::stopLogging() {
+    loggingEnabled_ = false;
+    inTail_ = false;
+    closePending_ = true;
+}
+
+void Logger::logRecord(const uint8_t* record, size_t len) {
+    if (len != FlightLog::kRecordSize && len != FlightLog::kFastRecordSize) return;
+
+    const uint64_t nowUs = Clock::nowUs();
+    if (!loggingEnabled_ || inTail_) {
+        pushPreArm(record, len, (uint32_t)nowUs);
     }
+    if (!loggingEnabled_) return;
+    // The file's full records may stop before the per-pack fields
+    if (len == FlightLog::kRecordSize) len = fullRecordSize_;
 
-    loggingEnabled = true;
-    createNewFile();
-    openLogFile();
+    // Stamp the offset from the header's start time over the record's
+    // leading offset field, so callers need not know the file origin.
+    uint8_t stamped[FlightLog::kRecordSize];
+    memcpy(stamped, record, len);
+    uint8_t* offsetField = stamped;
+    FlightLog::putU32(offsetField, (uint32_t)(nowUs - fileStartUs_));
+    if (inTail_) {
+        stamped[FlightLog::kRecordPrefixSize - 1] |= FlightLog::RecordPostDisarm;
+    }
+
+    if (!buffer_.fits(len)) {
+        sealAndHandOff();
+    }
+    buffer_.append(stamped, len);   // counts a drop if still full
 }
 
-Logger::~Logger() {
-    closeLogFile();
+// Ring records keep their capture time (low 32 bits of Clock::nowUs()) in
+// the offset field until the writer rebases them on the new file's start.
+void Logger::pushPreArm(const uint8_t* record, size_t len, uint32_t nowUs) {
+    if (preArmRingBusy_.load()) return;
+    uint8_t captured[FlightLog::kRecordSize];
+    memcpy(captured, record, len);
+    uint8_t* timeField = captured;
+    FlightLog::putU32(timeField, nowUs);
+    uint8_t& flags = captured[FlightLog::kRecordPrefixSize - 1];
+    flags = (uint8_t)((flags | FlightLog::RecordPreArm) & ~FlightLog::RecordPostDisarm);
+    preArmRing_.push(captured, len);
+    preArmRing_.expire(nowUs, PRE_ARM_WINDOW_US);
+}
+
+void Logger::requestFlush() {
+    if (loggingEnabled_) {
+        sealAndHandOff();
+    }
+}
+
+bool Logger::sealAndHandOff() {
+    if (!buffer_.seal()) return false;
+    const Command write = makeCommand(CommandWrite);
+    if (!sendCommand(write, 0)) {
+        buffer_.unseal();
+        return false;
+    }
+    lastSealMillis_ = millis();
+    return true;
+}
+
+Logger::Command Logger::makeCommand(CommandType type) {
+    Command cmd;
+    memset(&cmd, 0, sizeof(cmd));
+    cmd.type = type;
+    return cmd;
+}
+
+bool Logger::sendCommand(const Command& cmd, TickType_t wait) {
+    return commandQueue_ != nullptr && xQueueSend(commandQueue_, &cmd, wait) == pdTRUE;
+}
+
+// ---------------------------------------------------------------------------
+// Web server side.
+// ---------------------------------------------------------------------------
+
+void Logger::afterLogFilesClearedFromStorage() {
+    const Command recreate = makeCommand(CommandRecreate);
+    sendCommand(recreate, pdMS_TO_TICKS(CLOSE_WAIT_MS));
+}
+
+void Logger::closeLogFile() {
+    if (commandQueue_ == nullptr) return;
+    xSemaphoreTake(releasedSignal_, 0);   // drop a stale signal from a timed-out wait
+    const Command release = makeCommand(CommandRelease);
+    if (sendCommand(release, pdMS_TO_TICKS(CLOSE_WAIT_MS))) {
+        xSemaphoreTake(releasedSignal_, pdMS_TO_TICKS(CLOSE_WAIT_MS));
+    }
+}
+
+void Logger::afterLogFileRemoved(const char* path) {
+    Command forget = makeCommand(CommandForget);
+    const size_t len = strlen(path);
+    if (len >= sizeof(forget.path)) return;
+    memcpy(forget.path, path, len + 1);
+    sendCommand(forget, pdMS_TO_TICKS(CLOSE_WAIT_MS));
+}
+
+bool Logger::getLogEntry(size_t i, LogIndex::Entry& out) {
+    if (stateMutex_ == nullptr) return false;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    const bool ok = i < index_.count();
+    if (ok) out = index_.at(i);
+    xSemaphoreGive(stateMutex_);
+    return ok;
+}
+
+bool Logger::isLogIndexComplete() {
+    if (stateMutex_ == nullptr || !indexLoaded_) return false;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    const bool complete = index_.complete();
+    xSemaphoreGive(stateMutex_);
+    return complete;
+}
+
+// Loop task (FlightStats). The .sum file is the writer's; the index entry
+// is written out with the index at the next close. A Summary command the
+// queue has no room for is retried from handle().
+void Logger::setLogSummary(const char* path, const uint8_t* encoded, size_t len) {
+    if (stateMutex_ == nullptr) return;
+    const size_t pathLen = strlen(path);
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    index_.setSummary(path, encoded, len);
+    if (pathLen < sizeof(pendingSummaryPath_) && len <= sizeof(pendingSummary_)) {
+        memcpy(pendingSummaryPath_, path, pathLen + 1);
+        memcpy(pendingSummary_, encoded, len);
+        pendingSummaryLen_ = len;
+    }
+    xSemaphoreGive(stateMutex_);
+    summaryPending_ = !sendCommand(makeCommand(CommandSummary), 0);
+}
+
+void Logger::indexSummary(const char* path, const uint8_t* encoded, size_t len) {
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    index_.setSummary(path, encoded, len);
+    xSemaphoreGive(stateMutex_);
+}
+
+bool Logger::getCurrentFileName(char* out, size_t cap) {
+    if (stateMutex_ == nullptr || cap == 0) return false;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    const size_t len = strlen(currentFileName_);
+    const bool ok = len > 0 && len < cap;
+    if (ok) memcpy(out, currentFileName_, len + 1);
+    xSemaphoreGive(stateMutex_);
+    return ok;
+}
+
+void Logger::getStorageHealth(LogStorageHealth& out) {
+    memset(&out, 0, sizeof(out));
+    if (stateMutex_ == nullptr) return;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    out = storage_;
+    xSemaphoreGive(stateMutex_);
+}
+
+void Logger::getStats(LogWriterStats& out) {
+    memset(&out, 0, sizeof(out));
+    if (stateMutex_ != nullptr) {
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        out = stats_;
+        xSemaphoreGive(stateMutex_);
+    }
+    out.droppedRecords = buffer_.dropped();
+}
+
+// ---------------------------------------------------------------------------
+// Writer task: owns the file and every LittleFS call.
+// ---------------------------------------------------------------------------
+
+void Logger::writerTask(void* arg) {
+    Logger* self = static_cast<Logger*>(arg);
+    self->loadIndex();
+    self->enforceStorageBudget(1);
+    Command cmd;
+    for (;;) {
+        // While a log is to be compressed, a tick without a command runs
+        // the next slice of it.
+        const bool compressing = self->compress_.active || self->nextCompressPath_[0] != '\0';
+        if (xQueueReceive(self->commandQueue_, &cmd, compressing ? 1 : portMAX_DELAY) == pdTRUE) {
+            self->runCommand(cmd);
+        } else if (compressing) {
+            self->compressSlice();
+        }
+    }
+}
+
+void Logger::runCommand(const Command& cmd) {
+    switch (cmd.type) {
+        case CommandStart:
+            closeFileHandle();
+            header_ = cmd.header;
+            enforceStorageBudget(1);
+            createNewFile();
+            writePreArmRing();
+            break;
+        case CommandWrite:
+            writeSealedBuffer();
+            break;
+        case CommandClose: {
+            char closed[sizeof(currentFileName_)];
+            strcpy(closed, currentFileName_);
+            closeFileHandle();
+            setCurrentFileName("");
+            if (closed[0] != '\0') strcpy(nextCompressPath_, closed);   // compressSlice()
+            saveIndex();   // final size and summary; the compressed size when done
+            enforceStorageBudget(1);   // room for the next flight before it arms
+            break;
+        }
+        case CommandRelease:
+            closeFileHandle();
+            xSemaphoreGive(releasedSignal_);
+            break;
+        case CommandRecreate:
+            cancelCompress(nullptr);
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            index_.clearEntries();
+            xSemaphoreGive(stateMutex_);
+            // Only mid-flight: the next buffers go to a fresh file with the
+            // same start time, so offsets stay valid.
+            if (currentFileName_[0] != '\0') {
+                closeFileHandle();
+                createNewFile();
+            } else {
+                saveIndex();
+            }
+            break;
+        case CommandForget:
+            cancelCompress(cmd.path);
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            index_.remove(cmd.path);
+            xSemaphoreGive(stateMutex_);
+            saveIndex();
+            break;
+        case CommandSummary:
+            writePendingSummary();
+            break;
+    }
+}
+
+// The latest summary setLogSummary() left; one already written is not
+// written again.
+void Logger::writePendingSummary() {
+    char path[sizeof(pendingSummaryPath_)];
+    uint8_t record[sizeof(pendingSummary_)];
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    memcpy(path, pendingSummaryPath_, sizeof(path));
+    memcpy(record, pendingSummary_, sizeof(record));
+    const size_t len = pendingSummaryLen_;
+    pendingSummaryPath_[0] = '\0';
+    xSemaphoreGive(stateMutex_);
+
+    char summaryPath[40];
+    if (path[0] == '\0' || !FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))) {
+        return;
+    }
+    File file = LittleFS.open(summaryPath, "w");
+    if (!file) {
+        Serial.printf("[Logger] Failed to write %s\n", summaryPath);
+        return;
+    }
+    file.write(record, len);
+    file.close();
+}
+
+// "/YYYYMMDD_NNN.flog", or "/NNNNN.flog" without a date.
+static bool formatLogName(char* out, size_t cap, uint32_t date, uint32_t seq) {
+    const int n = date != 0
+        ? snprintf(out, cap, "/%08lu_%03lu%s", (unsigned long)date, (unsigned long)seq, FlightLog::kFileExtension)
+        : snprintf(out, cap, "/%05lu%s", (unsigned long)seq, FlightLog::kFileExtension);
+    return n > 0 && (size_t)n < cap;
 }
 
 void Logger::createNewFile() {
-    // Build date prefix when clock is synced (e.g. "20250419"), else empty.
-    char datePrefix[12] = "";
+    // Date part of the name when the clock is synced (e.g. 20250419), else 0.
+    uint32_t date = 0;
     if (isTimeSynced()) {
         time_t now = time(nullptr);
         struct tm t;
         gmtime_r(&now, &t);
-        snprintf(datePrefix, sizeof(datePrefix), "%04d%02d%02d",
-                 t.tm_year + 1900, t.tm_mon + 1, t.tm_mday);
+        date = (uint32_t)(t.tm_year + 1900) * 10000 + (uint32_t)(t.tm_mon + 1) * 100 + (uint32_t)t.tm_mday;
     }
-    const bool useDate = (datePrefix[0] != '\0');
-    fileHasDate = useDate;
+    header_.flags = (uint8_t)(date != 0 ? (header_.flags | FlightLog::HeaderNameHasDate)
+                                        : (header_.flags & ~FlightLog::HeaderNameHasDate));
 
-    File root = LittleFS.open("/");
-    if (!root) {
-        Serial.println("Failed to open directory");
+    // The name comes from the index: a header-only .flog of a flight that
+    // never logged a record is reused, else the next sequence number.
+    uint32_t seq = 0;
+    uint32_t unusedDate = 0;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    const int reusable = index_.findReusable(date);
+    const bool reuse = reusable >= 0 && LogIndex::parseSeq(index_.at(reusable).stem, unusedDate, seq);
+    if (!reuse) seq = index_.nextSeq(date);
+    xSemaphoreGive(stateMutex_);
+
+    char fileNameBuf[32];
+    formatLogName(fileNameBuf, sizeof(fileNameBuf), date, seq);
+
+    // The index lags the disk (power cut before it was saved, files put
+    // there by hand): rebuild it once, then step over names still taken.
+    if (!reuse && LittleFS.exists(fileNameBuf)) {
+        Serial.println("Log index out of date, rebuilding");
+        rebuildIndex();
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        seq = index_.nextSeq(date);
+        xSemaphoreGive(stateMutex_);
+        formatLogName(fileNameBuf, sizeof(fileNameBuf), date, seq);
+        for (uint32_t probe = 0; probe < MAX_NAME_PROBES && LittleFS.exists(fileNameBuf); probe++) {
+            formatLogName(fileNameBuf, sizeof(fileNameBuf), date, ++seq);
+        }
+    }
+
+    // POWER LOSS SAFETY: the header is committed before any record, so a
+    // file cut short still converts. A reused file is truncated first.
+    logFile_ = LittleFS.open(fileNameBuf, "w");
+    if (!logFile_) {
+        Serial.print("Failed to create log file: ");
+        Serial.println(fileNameBuf);
+        setCurrentFileName("");
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        stats_.writeErrors++;
+        xSemaphoreGive(stateMutex_);
         return;
     }
+    uint8_t encoded[FlightLog::kHeaderSize];
+    FlightLog::encodeHeader(header_, encoded);
+    logFile_.write(encoded, sizeof(encoded));
+    logFile_.flush();
+    fileOpen_ = true;
+    setCurrentFileName(fileNameBuf);
+    indexFile(fileNameBuf, FlightLog::kHeaderSize,
+              (header_.flags & FlightLog::HeaderEpochValid) ? header_.startEpochMs : 0);
+    saveIndex();
+    Serial.print(reuse ? "Reusing empty log file: " : "New log file created: ");
+    Serial.println(fileNameBuf);
+}
 
-    root.rewindDirectory();
+void Logger::indexFile(const char* path, uint32_t size, uint64_t startEpochMs) {
+    char stem[LogIndex::kStemSize];
+    uint8_t kind;
+    if (!LogIndex::parsePath(path, stem, kind)) return;
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    index_.add(stem, kind, size, startEpochMs);
+    xSemaphoreGive(stateMutex_);
+}
 
-    int maxSeqNum = 0;       // highest NNN seen for the date prefix (or overall)
-    int minEmptySeqNum = -1; // lowest NNN of an empty file for this prefix
+// Reads the persisted index at boot. Anything that does not check out --
+// missing, unknown version, bad checksum, newest log gone -- means one
+// directory scan to rebuild it.
+void Logger::loadIndex() {
+    bool ok = false;
+    File file = LittleFS.open(INDEX_PATH, "r");
+    if (file) {
+        uint8_t buf[LogIndex::kEntrySize];
+        uint32_t sum = LogIndex::checksumInit();
+        int count = -1;
+        if (file.read(buf, LogIndex::kHeaderSize) == LogIndex::kHeaderSize) {
+            sum = LogIndex::checksum(sum, buf, LogIndex::kHeaderSize);
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            count = index_.decodeHeader(buf);
+            xSemaphoreGive(stateMutex_);
+        }
+        ok = count >= 0;
+        for (int i = 0; ok && i < count; i++) {
+            ok = file.read(buf, LogIndex::kEntrySize) == LogIndex::kEntrySize;
+            if (!ok) break;
+            sum = LogIndex::checksum(sum, buf, LogIndex::kEntrySize);
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            ok = index_.decodeEntry(buf);
+            xSemaphoreGive(stateMutex_);
+        }
+        if (ok) {
+            const uint8_t* p = buf;
+            ok = file.read(buf, LogIndex::kChecksumSize) == LogIndex::kChecksumSize
+                && FlightLog::getU32(p) == sum;
+        }
+        file.close();
+    }
 
-    File file = root.openNextFile();
-    while (file) {
-        String fileName = file.name();
-        if (fileName.startsWith("/")) fileName = fileName.substring(1);
-
-        // Accept both YYYYMMDD_NNN.csv (date) and NNNNN.csv (legacy).
-        String seqPart;
-        if (useDate) {
-            String expectedPrefix = String(datePrefix) + "_";
-            if (fileName.startsWith(expectedPrefix) && fileName.endsWith(".csv")) {
-                seqPart = fileName.substring(expectedPrefix.length(),
-                                             fileName.length() - 4);
-            }
-        } else {
-            int dotIndex = fileName.indexOf('.');
-            if (dotIndex > 0) {
-                seqPart = fileName.substring(0, dotIndex);
+    // Records and the summary of the newest log may have landed after the
+    // index was last saved (power cut in flight).
+    if (ok && index_.count() > 0) {
+        char path[40];
+        char summaryPath[40];
+        ok = LogIndex::pathFor(index_.at(index_.count() - 1), path, sizeof(path));
+        File log;
+        if (ok) log = LittleFS.open(path, "r");
+        ok = ok && log;
+        if (ok) {
+            const uint32_t size = log.size();
+            log.close();
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            index_.setSize(path, size);
+            xSemaphoreGive(stateMutex_);
+            if (FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))) {
+                loadSummary(path, summaryPath);
             }
         }
+    }
+
+    if (!ok) {
+        Serial.println("Log index missing or invalid, rebuilding");
+        rebuildIndex();
+        saveIndex();
+    }
+    indexLoaded_ = true;
+}
+
+// One directory walk: every log with its size, start time (from the .flog
+// header) and summary (from its .sum file).
+void Logger::rebuildIndex() {
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    index_.reset();
+    xSemaphoreGive(stateMutex_);
 
-        if (seqPart.length() > 0) {
-            bool allDigits = true;
-            for (unsigned int i = 0; i < seqPart.length(); i++) {
-                if (!isdigit(seqPart.charAt(i))) { allDigits = false; break; }
+    File root = LittleFS.open("/");
+    if (!root) {
+        Serial.println("Failed to open directory");
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        index_.markIncomplete();
+        xSemaphoreGive(stateMutex_);
+        return;
+    }
+    char path[40];
+    char summaryPath[40];
+    File file = root.openNextFile();
+    while (file) {
+        const char* name = file.name();
+        const char* dot = strrchr(name, '.');
+        const bool isLog = dot != nullptr && (strcmp(dot, FlightLog::kFileExtension) == 0
+                                              || strcmp(dot, ".csv") == 0 || strcmp(dot, ".txt") == 0);
+        char stem[LogIndex::kStemSize];
+        uint8_t kind;
+        const int pathLen = snprintf(path, sizeof(path), "%s%s", name[0] == '/' ? "" : "/", name);
+        if (isLog && pathLen > 0 && pathLen < (int)sizeof(path) && LogIndex::parsePath(path, stem, kind)) {
+            uint64_t startEpochMs = 0;
+            FlightLog::Header h;
+            if (kind == LogIndex::KindFlog && readLogHeader(file, h) && (h.flags & FlightLog::HeaderEpochValid)) {
+                startEpochMs = h.startEpochMs;
             }
-            if (allDigits) {
-                int num = seqPart.toInt();
-                if (num > maxSeqNum) maxSeqNum = num;
-                if (file.size() == 0 && (minEmptySeqNum < 0 || num < minEmptySeqNum)) {
-                    minEmptySeqNum = num;
-                }
+            indexFile(path, (uint32_t)file.size(), startEpochMs);
+            if (FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))) {
+                loadSummary(path, summaryPath);
             }
+        } else if (isLog) {
+            // A log whose name is too long to index.
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            index_.markIncomplete();
+            xSemaphoreGive(stateMutex_);
         }
         file.close();
         file = root.openNextFile();
     }
     root.close();
+}
 
-    char fileNameBuf[32];
+void Logger::loadSummary(const char* path, const char* summaryPath) {
+    if (!LittleFS.exists(summaryPath)) return;
+    File sum = LittleFS.open(summaryPath, "r");
+    if (!sum) return;
+    uint8_t record[FlightSummaryCodec::kEncodedSize];
+    const size_t len = sum.read(record, sizeof(record));
+    sum.close();
+    indexSummary(path, record, len);
+}
 
-    if (minEmptySeqNum >= 0) {
-        if (useDate) {
-            snprintf(fileNameBuf, sizeof(fileNameBuf), "/%s_%03d.csv", datePrefix, minEmptySeqNum);
-        } else {
-            snprintf(fileNameBuf, sizeof(fileNameBuf), "/%05d.csv", minEmptySeqNum);
-        }
-        currentFileName = String(fileNameBuf);
-        Serial.print("Reusing empty log file: ");
-        Serial.println(currentFileName);
-        return;
+// The .flog header of a log, compressed or not.
+bool Logger::readLogHeader(File& file, FlightLog::Header& h) {
+    uint8_t head[FlightLog::kHeaderSize];
+    size_t len = file.read(head, LogCompression::kFileHeaderSize);
+    if (!LogCompression::isCompressed(head, len)) {
+        len += file.read(head + len, sizeof(head) - len);
+        return FlightLog::decodeHeader(head, len, h);
     }
+    // One byte at a time: the decoder always has room for it. An older
+    // log's header is shorter and may be all the file holds.
+    decoder_.reset();
+    len = 0;
+    while (len < sizeof(head)) {
+        const size_t got = decoder_.read(head + len, sizeof(head) - len);
+        len += got;
+        if (got > 0) continue;
+        uint8_t b;
+        if (file.read(&b, 1) != 1) break;
+        decoder_.push(&b, 1);
+    }
+    return FlightLog::decodeHeader(head, len, h);
+}
 
-    int nextSeqNum = maxSeqNum + 1;
-    if (useDate) {
-        snprintf(fileNameBuf, sizeof(fileNameBuf), "/%s_%03d.csv", datePrefix, nextSeqNum);
-    } else {
-        snprintf(fileNameBuf, sizeof(fileNameBuf), "/%05d.csv", nextSeqNum);
+// Compresses closed logs in place: a temporary file renamed over each, and
+// only when it comes out smaller. A long flight takes seconds from LittleFS,
+// so the writer runs it COMPRESS_SLICE_BYTES at a time between commands
+// (writerTask()). A closed log waits in nextCompressPath_ for the running
+// one; when another closes meanwhile, the one waiting is left uncompressed
+// (still a valid log).
+//
+// The log is read a record at a time so each block starts on a record;
+// the sync point footer (LogCompression.h) goes after the stream.
+bool Logger::beginCompress(const char* path) {
+    CompressJob& job = compress_;
+    job.in = LittleFS.open(path, "r");
+    if (!job.in) return false;
+    job.rawSize = job.in.size();
+    uint8_t head[FlightLog::kHeaderSize];
+    const size_t headLen = job.in.read(head, sizeof(head));
+    FlightLog::Header& h = job.header;
+    // Records are read into a UINT8_MAX buffer (compressSlice());
+    // fastRecordSize is a u8
+    if (!FlightLog::decodeHeader(head, headLen, h) || job.rawSize <= FlightLog::headerSize(h.version)
+        || h.recordSize > UINT8_MAX) {
+        job.in.close();   // already compressed, or not a log
+        return false;
+    }
+    job.out = LittleFS.open(COMPRESS_TEMP_PATH, "w");
+    if (!job.out) {
+        job.in.close();
+        return false;
     }
-    currentFileName = String(fileNameBuf);
+    strcpy(job.path, path);
 
-    // POWER LOSS SAFETY
-    File newFile = LittleFS.open(currentFileName, "w");
-    if (newFile) {
-        newFile.close();
-        Serial.print("New log file created: ");
-        Serial.println(currentFileName);
-    } else {
-        Serial.print("Failed to create log file: ");
-        Serial.println(currentFileName);
-        currentFileName = "";
+    uint8_t fileHead[LogCompression::kFileHeaderSize];
+    LogCompression::encodeFileHeader(job.rawSize, fileHead);
+    job.ok = job.out.write(fileHead, sizeof(fileHead)) == sizeof(fileHead);
+    job.outSize = sizeof(fileHead);
+    const uint32_t stretched = job.rawSize / MAX_SYNC_POINTS + 1;
+    job.blockBytes = stretched > COMPRESS_BLOCK_SIZE ? stretched : COMPRESS_BLOCK_SIZE;
+    job.syncCount = 0;
+    job.lastSync = 0;
+    job.endMs = 0;
+    job.rawPos = FlightLog::headerSize(h.version);
+    job.clock.reset(h);
+    job.in.seek(job.rawPos);
+    encoder_.reset();
+    feedCompressor(head, job.rawPos);
+    job.active = true;
+    return true;
+}
+
+void Logger::drainCompressor() {
+    uint8_t outBuf[64];
+    size_t got;
+    while ((got = encoder_.read(outBuf, sizeof(outBuf))) > 0) {
+        compress_.ok = compress_.ok && compress_.out.write(outBuf, got) == got;
+        compress_.outSize += got;
     }
 }
 
-void Logger::openLogFile() {
-    if (currentFileName.length() == 0) return;
+void Logger::feedCompressor(const uint8_t* data, size_t len) {
+    size_t pos = 0;
+    do {
+        pos += encoder_.push(data + pos, len - pos);
+        drainCompressor();
+    } while (pos < len);
+}
 
-    if (fileOpen) {
-        closeLogFile();
+void Logger::compressSlice() {
+    CompressJob& job = compress_;
+    if (!job.active) {
+        char path[sizeof(nextCompressPath_)];
+        strcpy(path, nextCompressPath_);
+        nextCompressPath_[0] = '\0';
+        if (!beginCompress(path)) return;
     }
+    const FlightLog::Header& h = job.header;
+    uint8_t record[UINT8_MAX];
+    const uint32_t sliceEnd = job.rawPos + COMPRESS_SLICE_BYTES;
+    bool done = false;
+    while (job.rawPos < sliceEnd) {
+        if (!job.ok || job.outSize >= job.rawSize) {
+            done = true;
+            break;
+        }
+        size_t n = job.in.read(record, FlightLog::kRecordPrefixSize);
+        if (n == 0) {
+            done = true;
+            break;
+        }
+        const uint8_t flags = record[FlightLog::kRecordPrefixSize - 1];
+        const size_t size = (flags & FlightLog::RecordFast) ? h.fastRecordSize : h.recordSize;
+        if (n == FlightLog::kRecordPrefixSize && size > n) {
+            n += job.in.read(record + n, size - n);
+        }
+        // A whole record (not the torn tail of a power cut) may open a block.
+        if (n == size && n > FlightLog::kRecordPrefixSize) {
+            const uint8_t* offsetField = record;
+            job.endMs = (uint32_t)(job.clock.offsetUs(FlightLog::getU32(offsetField)) / 1000);
+            if (job.syncCount < MAX_SYNC_POINTS
+                && (job.syncCount == 0 || job.rawPos - job.lastSync >= job.blockBytes)) {
+                encoder_.endBlock();
+                drainCompressor();
+                syncPoints_[job.syncCount++] = {job.endMs, job.rawPos,
+                                                (uint32_t)(LogCompression::kFileHeaderSize * 8) + encoder_.bitsOut()};
+                job.lastSync = job.rawPos;
+            }
+        }
+        feedCompressor(record, n);
+        job.rawPos += n;
+    }
+    if (done) finishCompress();
+}
 
-    logFile = LittleFS.open(currentFileName, "a");
-    if (!logFile) {
-        Serial.println("Failed to open log file for appending");
-        fileOpen = false;
-        return;
+void Logger::finishCompress() {
+    CompressJob& job = compress_;
+    job.in.close();
+    encoder_.finish();
+    drainCompressor();
+
+    if (job.syncCount > 0) {
+        uint8_t entry[LogCompression::kSyncPointSize];
+        for (size_t i = 0; i < job.syncCount; i++) {
+            LogCompression::encodeSyncPoint(syncPoints_[i], entry);
+            job.ok = job.ok && job.out.write(entry, sizeof(entry)) == sizeof(entry);
+        }
+        uint8_t trailer[LogCompression::kTrailerSize];
+        LogCompression::encodeTrailer(job.endMs, job.syncCount, trailer);
+        job.ok = job.ok && job.out.write(trailer, sizeof(trailer)) == sizeof(trailer);
+        job.outSize += job.syncCount * LogCompression::kSyncPointSize + sizeof(trailer);
     }
-    fileOpen = true;
+    job.out.close();
+    job.active = false;
 
-    if (logFile.size() == 0 && csvHeader.length() > 0) {
-        logFile.print("timestamp,");
-        logFile.print(csvHeader);
-        logFile.print("\r\n");
-        logFile.flush();
+    // Not renamed over a log deleted meanwhile (cancelCompress() not run yet)
+    if (!job.ok || job.outSize >= job.rawSize || !LittleFS.exists(job.path)
+        || !LittleFS.rename(COMPRESS_TEMP_PATH, job.path)) {
+        LittleFS.remove(COMPRESS_TEMP_PATH);
+    } else {
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        index_.setSize(job.path, job.outSize);
+        xSemaphoreGive(stateMutex_);
+        saveIndex();
+        Serial.printf("Log compressed: %s %lu -> %lu bytes\n", job.path, (unsigned long)job.rawSize,
+                      (unsigned long)job.outSize);
     }
 }
 
-void Logger::closeLogFile() {
-    if (fileOpen && logFile) {
-        logFile.flush();
-        logFile.close();
-        fileOpen = false;
+// The log at `path` (every log for nullptr) is being deleted: drop its
+// compression, running or waiting.
+void Logger::cancelCompress(const char* path) {
+    if (nextCompressPath_[0] != '\0' && (path == nullptr || strcmp(nextCompressPath_, path) == 0)) {
+        nextCompressPath_[0] = '\0';
     }
+    CompressJob& job = compress_;
+    if (!job.active || (path != nullptr && strcmp(job.path, path) != 0)) return;
+    job.in.close();
+    job.out.close();
+    LittleFS.remove(COMPRESS_TEMP_PATH);
+    job.active = false;
 }
 
-void Logger::stopLogging() {
-    if (loggingEnabled) {
-        closeLogFile();
-        loggingEnabled = false;
-        currentFileName = "";
+// Written to a temporary file and renamed over the old one, so a power cut
+// leaves either index whole. Only the writer adds or removes entries, so
+// the count cannot change under it; each entry is copied under the mutex
+// because the loop may be setting its summary.
+void Logger::saveIndex() {
+    File file = LittleFS.open(INDEX_TEMP_PATH, "w");
+    bool ok = (bool)file;
+    if (ok) {
+        uint8_t buf[LogIndex::kEntrySize];
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        index_.encodeHeader(buf);
+        xSemaphoreGive(stateMutex_);
+        uint32_t sum = LogIndex::checksum(LogIndex::checksumInit(), buf, LogIndex::kHeaderSize);
+        ok = file.write(buf, LogIndex::kHeaderSize) == LogIndex::kHeaderSize;
+        for (size_t i = 0; ok && i < index_.count(); i++) {
+            xSemaphoreTake(stateMutex_, portMAX_DELAY);
+            index_.encodeEntry(i, buf);
+            xSemaphoreGive(stateMutex_);
+            sum = LogIndex::checksum(sum, buf, LogIndex::kEntrySize);
+            ok = file.write(buf, LogIndex::kEntrySize) == LogIndex::kEntrySize;
+        }
+        uint8_t* p = buf;
+        FlightLog::putU32(p, sum);
+        ok = ok && file.write(buf, LogIndex::kChecksumSize) == LogIndex::kChecksumSize;
+        file.close();
+    }
+    if (!ok || !LittleFS.rename(INDEX_TEMP_PATH, INDEX_PATH)) {
+        Serial.println("Failed to save log index");
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        stats_.writeErrors++;
+        xSemaphoreGive(stateMutex_);
     }
 }
 
-void Logger::setHeader(const String &header) {
-    csvHeader = header;
+bool Logger::openLogFile() {
+    logFile_ = LittleFS.open(currentFileName_, "a");
+    if (!logFile_) {
+        Serial.println("Failed to open log file for appending");
+        return false;
+    }
+    fileOpen_ = true;
+
+    // Deleted behind our back (e.g. /delete): start it again with the header.
+    if (logFile_.size() == 0) {
+        uint8_t encoded[FlightLog::kHeaderSize];
+        FlightLog::encodeHeader(header_, encoded);
+        logFile_.write(encoded, sizeof(encoded));
+        indexFile(currentFileName_, FlightLog::kHeaderSize,
+                  (header_.flags & FlightLog::HeaderEpochValid) ? header_.startEpochMs : 0);
+    }
+    return true;
 }
 
-void Logger::afterLogFilesClearedFromStorage() {
-    closeLogFile();
-    createNewFile();
-    if (loggingEnabled) {
-        openLogFile();
+void Logger::closeFileHandle() {
+    if (fileOpen_ && logFile_) {
+        logFile_.flush();
+        logFile_.close();
     }
+    fileOpen_ = false;
 }
 
-void Logger::log(const char* data) {
-    bool isArmed = throttle.isArmed();
+void Logger::writeSealedBuffer() {
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    if (!buffer_.peekSealed(data, len)) return;
 
-    // Detect transition from armed to disarmed
-    if (wasArmed && !isArmed) {
-        stopLogging();
+    const uint32_t startUs = micros();
+    bool ok = false;
+    if (currentFileName_[0] != '\0' && (fileOpen_ || openLogFile())) {
+        ok = writeWithRetry(data, len);
+        logFile_.flush();
     }
+    const uint32_t latencyUs = micros() - startUs;
+    buffer_.release();
 
-    // Start logging automatically once throttle is armed
-    if (!loggingEnabled && isArmed) {
-        startLogging();
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    stats_.buffersWritten++;
+    if (ok) {
+        stats_.bytesWritten += len;
+        index_.addBytes(currentFileName_, len);
+    } else {
+        stats_.writeErrors++;
     }
+    stats_.lastWriteLatencyUs = latencyUs;
+    if (latencyUs > stats_.maxWriteLatencyUs) stats_.maxWriteLatencyUs = latencyUs;
+    xSemaphoreGive(stateMutex_);
+    if (ok) noteBytesWritten(len);
+}
+
+// Right after the header, before any record of the flight. Releases the
+// ring back to the loop even if the file could not be created.
+void Logger::writePreArmRing() {
+    if (!preArmRingBusy_.load()) return;
 
-    // Only log when throttle is armed
-    if (!isArmed) {
-        wasArmed = false;
-        return; // Don't log when throttle is not armed
+    uint8_t record[FlightLog::kRecordSize];
+    size_t written = 0;
+    bool ok = true;
+    while (size_t len = preArmRing_.pop(record, sizeof(record))) {
+        if (!fileOpen_) continue;
+        // Captured whole; cut to the file's full record size
+        if (!(record[FlightLog::kRecordPrefixSize - 1] & FlightLog::RecordFast)) {
+            len = header_.recordSize;
+        }
+        const uint8_t* timeField = record;
+        const uint32_t capturedUs = FlightLog::getU32(timeField);
+        uint8_t* offsetField = record;
+        FlightLog::putU32(offsetField, capturedUs - (uint32_t)header_.startMonoUs);
+        ok = ok && logFile_.write(record, len) == len;
+        written += len;
     }
+    preArmRing_.clear();
+    preArmRingBusy_.store(false);
 
-    wasArmed = true;
+    if (written == 0) return;
+    logFile_.flush();
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    if (ok) {
+        stats_.bytesWritten += written;
+        index_.addBytes(currentFileName_, written);
+    } else {
+        stats_.writeErrors++;
+    }
+    xSemaphoreGive(stateMutex_);
+    noteBytesWritten(written);
+}
 
-    if (!loggingEnabled) {
-        return; // Don't log until logging is enabled
+// A short write almost always means the partition is full: rotate old logs
+// out and write the rest once more, rather than losing the flight.
+bool Logger::writeWithRetry(const uint8_t* data, size_t len) {
+    size_t written = logFile_.write(data, len);
+    if (written == len) return true;
+    Serial.println("Log write short, making room");
+    enforceStorageBudget(0);
+    written += logFile_.write(data + written, len - written);
+    return written == len;
+}
+
+// Mid-flight budget check, only when the estimate says the reserve is being
+// eaten into and at most once per block written after that.
+void Logger::noteBytesWritten(size_t len) {
+    freeEstimate_ = freeEstimate_ > len ? freeEstimate_ - (uint32_t)len : 0;
+    if (freeEstimate_ < reserveBytes_ && freeAtCheck_ - freeEstimate_ >= STORAGE_BLOCK_SIZE) {
+        enforceStorageBudget(0);
     }
+}
 
-    if (currentFileName.length() == 0) return;
+// Deletes the oldest logs (never the one being written) until the reserve
+// is free and the index has room for `newLogs` more, then refreshes the
+// storage health. LittleFS has no preallocation, so keeping the reserve free
+// ahead of arming is how the next flight's space is set aside.
+void Logger::enforceStorageBudget(size_t newLogs) {
+    const uint32_t total = LittleFS.totalBytes();
+    uint32_t used = LittleFS.usedBytes();
+    uint32_t freeBytes = used < total ? total - used : 0;
+    const uint32_t reserve = reserveBytes_;
+    uint32_t rotated = 0;
+    char path[40];
+    char summaryPath[40];
 
-    // Ensure file is open
-    if (!fileOpen) {
-        openLogFile();
-        if (!fileOpen) {
-            Serial.println("Failed to open log file");
-            return;
+    for (;;) {
+        LogIndex::Entry victim;
+        xSemaphoreTake(stateMutex_, portMAX_DELAY);
+        const int keep = currentFileName_[0] != '\0' ? index_.findPath(currentFileName_) : -1;
+        const size_t n = LogStorage::planRotation(index_, freeBytes, reserve, STORAGE_BLOCK_SIZE, keep, newLogs);
+        const size_t slot = keep == 0 ? 1 : 0;
+        if (n > 0) {
+            victim = index_.at(slot);
+            index_.removeAt(slot);
         }
+        xSemaphoreGive(stateMutex_);
+        if (n == 0) break;
+
+        if (LogIndex::pathFor(victim, path, sizeof(path))) {
+            cancelCompress(path);
+            LittleFS.remove(path);
+            if (FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))
+                && LittleFS.exists(summaryPath)) {
+                LittleFS.remove(summaryPath);
+            }
+            Serial.print("Log storage low, deleted ");
+            Serial.println(path);
+        }
+        freeBytes += LogStorage::footprint(victim.size, victim.hasSummary, STORAGE_BLOCK_SIZE);
+        rotated++;
+    }
+
+    if (rotated > 0) {
+        saveIndex();
+        used = LittleFS.usedBytes();
+        freeBytes = used < total ? total - used : 0;
     }
+    freeEstimate_ = freeBytes;
+    freeAtCheck_ = freeBytes;
 
-    char tsBuf[24];
-    formatTimestamp(tsBuf, sizeof(tsBuf));
-    logFile.print(tsBuf);
-    logFile.print(",");
-    logFile.print(data);
-    logFile.flush(); // Force data to be written to storage immediately
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    storage_.totalBytes = total;
+    storage_.usedBytes = total - freeBytes;
+    storage_.reserveBytes = reserve;
+    storage_.logsRotated += rotated;
+    storage_.lowSpace = freeBytes < reserve;
+    xSemaphoreGive(stateMutex_);
 }
 
-void Logger::log(const String &data) {
-    log(data.c_str());
+void Logger::setCurrentFileName(const char* name) {
+    xSemaphoreTake(stateMutex_, portMAX_DELAY);
+    strncpy(currentFileName_, name, sizeof(currentFileName_) - 1);
+    currentFileName_[sizeof(currentFileName_) - 1] = '\0';
+    xSemaphoreGive(stateMutex_);
 }
@@ -3,48 +3,245 @@
 
 #include <Arduino.h>
 #include <LittleFS.h>
-#include <vector>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include "FlightLogFormat.h"
+#include "LogBuffer.h"
+#include "LogIndex.h"
+#include "LogStorage.h"
+#include "LogCompression.h"
 
+/**
+ * Flight log writer. The loop task only copies records into a RAM double
+ * buffer (LogBuffer.h); a low-priority writer task owns the file and does
+ * every LittleFS call (directory scan, open, write, flush, close), so the
+ * loop never blocks on flash.
+ *
+ * A buffer is handed to the writer when it is full, every FLUSH_INTERVAL_MS,
+ * on disarm and on requestFlush(). Each hand-off is one write + flush.
+ *
+ * While disarmed, records go to a RAM ring holding the last
+ * PRE_ARM_WINDOW_US; on arm it is written at the head of the new file. After
+ * disarm the file stays open for POST_DISARM_TAIL_MS more of records, so a
+ * fault disarm has context on both sides without logging to flash all the
+ * time.
+ *
+ * The writer also keeps a LogIndex of the files on LittleFS (sizes, start
+ * times, flight summaries, next sequence number), persisted next to the
+ * logs, so a new flight and the logs page need no directory walk.
+ *
+ * The writer keeps the configured reserve (Settings::getLogReserveKb) free
+ * on LittleFS by deleting the oldest logs: at boot and after each flight,
+ * so the next one starts with room, and mid-flight when the space runs
+ * short or a write fails.
+ *
+ * Once a flight's file is closed the writer compresses it in place
+ * (LogCompression.h); downloads decompress it on the fly. The stream is cut
+ * into independent blocks listed in a footer with their first record's
+ * offset, so a download of a time window starts at the nearest block.
+ * Compression runs a slice at a time whenever no command is waiting, so
+ * the next flight's Start and Writes never wait behind it.
+ */
 class Logger {
 public:
     Logger();
     void init();
-    void startLogging();
-    void log(const char* data);
-    void log(const String &data);
-    void setHeader(const String &header);
+    /** Loop task: starts a file on arm, closes it after the post-disarm tail, timed flushes. */
+    void handle();
+    /**
+     * Loop task: appends one encoded FlightLog record, full or fast
+     * (FlightLogFormat.h): to the file while logging, to the pre-arm ring
+     * while disarmed (and both during the post-disarm tail). Never touches
+     * flash; counted as dropped if both buffers are busy. Stamped here
+     * with Clock::nowUs(), in µs from the file's start.
+     */
+    void logRecord(const uint8_t* record, size_t len);
+    /**
+     * Whether the next flight's file is high-rate (millisecond CSV
+     * timestamps). Latched when the file starts.
+     */
+    void setHighRate(bool highRate) { highRate_ = highRate; }
+    /**
+     * Whether the next flight's full records carry the per-pack BMS fields
+     * (parallel packs). Latched when the file starts; without them a full
+     * record is logged as its kRecordSizeV1 leading part.
+     */
+    void setPackRecords(bool packRecords) { packRecords_ = packRecords; }
+    /** Loop task: hand buffered records to the writer now (e.g. brownout warning). */
+    void requestFlush();
     /** Call after log files were removed from LittleFS (e.g. web UI delete-all). */
     void afterLogFilesClearedFromStorage();
     /**
      * Flush and release the file handle so another reader can open the same file
-     * without seeing a stale cached size. The file is reopened automatically on
-     * the next log() call.
+     * without seeing a stale cached size. The writer reopens it for the next
+     * buffer. Waits up to CLOSE_WAIT_MS for the writer; never call from loop().
      */
     void closeLogFile();
-    ~Logger();
+
+    /** Web server: the file was removed from LittleFS; drop it from the index. */
+    void afterLogFileRemoved(const char* path);
+    /**
+     * Loop task: attach an encoded FlightSummaryCodec record to a log in the
+     * index and have the writer save it next to the log (summaryPathFor()).
+     * Only copies it to RAM here; the latest one wins if the writer is behind.
+     */
+    void setLogSummary(const char* path, const uint8_t* encoded, size_t len);
+    /** Copies entry i of the log index; false past the end. */
+    bool getLogEntry(size_t i, LogIndex::Entry& out);
+    /**
+     * Whether the index lists every log file. False until it is loaded at
+     * boot and when it overflowed: callers then walk the directory.
+     */
+    bool isLogIndexComplete();
+
+    /** Copies the path of the file the current flight logs to; false when not logging. */
+    bool getCurrentFileName(char* out, size_t cap);
+
+    void getStats(LogWriterStats& out);
+    void getStorageHealth(LogStorageHealth& out);
 
     /** Returns true if the system clock has been set (epoch > 2020). */
     static bool isTimeSynced();
 
 private:
-    String currentFileName;
-    File logFile;
-    bool fileOpen;
-    bool loggingEnabled;
-    bool wasArmed;
-    bool fileHasDate;
-    String csvHeader;
+    enum CommandType : uint8_t {
+        CommandStart,    // create a new file; header from the command
+        CommandWrite,    // write the sealed buffer
+        CommandClose,    // end of flight
+        CommandRelease,  // close the handle for a reader; reopen on next write
+        CommandRecreate, // files were deleted: start over in a new file
+        CommandForget,   // a file was deleted: drop it from the index
+        CommandSummary,  // write the pending flight summary file
+    };
+    struct Command {
+        CommandType type;
+        FlightLog::Header header;
+        char path[32];   // CommandForget
+    };
 
-    void createNewFile();
-    void openLogFile();
+    static const size_t BUFFER_SIZE = 2048;
+    static const unsigned long FLUSH_INTERVAL_MS = 5000;
+    static const size_t COMMAND_QUEUE_DEPTH = 8;
+    static const uint32_t WRITER_STACK_SIZE = 4096;
+    static const UBaseType_t WRITER_PRIORITY = 1;
+    static const TickType_t CLOSE_WAIT_MS = 500;
+    // Names still taken after an index rebuild are stepped over, this many at most.
+    static const uint32_t MAX_NAME_PROBES = 100;
+    // LittleFS allocation unit on the ESP32 flash.
+    static const uint32_t STORAGE_BLOCK_SIZE = 4096;
+    // 30 s at 1 Hz fits easily; at 50 Hz the ring holds the last ~9 s.
+    static const size_t PRE_ARM_RING_SIZE = 8192;
+    static const uint32_t PRE_ARM_WINDOW_US = 30000000;
+    static const unsigned long POST_DISARM_TAIL_MS = 10000;
+    // Settings the loop re-reads are refreshed this often, not every pass.
+    static const unsigned long SETTINGS_REFRESH_MS = 1000;
+    // Compressed block spacing: at least this much raw log, stretched so a
+    // long flight still fits MAX_SYNC_POINTS blocks.
+    static const uint32_t COMPRESS_BLOCK_SIZE = 4096;
+    static const size_t MAX_SYNC_POINTS = 64;
+    // Raw log compressed per writer wakeup without a command; the most a
+    // Start or Write waits behind compression.
+    static const uint32_t COMPRESS_SLICE_BYTES = 2048;
+
+    // Loop task state.
+    LogDoubleBuffer<BUFFER_SIZE> buffer_;
+    bool loggingEnabled_;
+    bool closePending_;      // tail over; the last buffer or Close not yet handed off
+    bool summaryPending_;    // a Summary command not yet handed off
+    bool inTail_;            // disarmed, still logging the post-disarm tail
+    unsigned long tailStartMillis_;
+    volatile bool highRate_;
+    volatile bool packRecords_;
+    size_t fullRecordSize_;      // latched at the file's start (header recordSize)
+    volatile uint32_t reserveBytes_;   // from Settings, refreshed every SETTINGS_REFRESH_MS
+    unsigned long lastSettingsMillis_;
+    uint64_t fileStartUs_;       // Clock::nowUs() at the file's start (header startMonoUs)
+    unsigned long lastSealMillis_;
+
+    // Loop-owned while disarmed; handed to the writer with CommandStart
+    // (busy) until it has been written to the new file.
+    LogRing<PRE_ARM_RING_SIZE> preArmRing_;
+    std::atomic<bool> preArmRingBusy_;
+
+    QueueHandle_t commandQueue_;
+    SemaphoreHandle_t releasedSignal_;
+    SemaphoreHandle_t stateMutex_;   // guards currentFileName_, stats_ and index_
+    TaskHandle_t writerTask_;
+
+    // Writer task state (currentFileName_ also read under stateMutex_).
+    char currentFileName_[32];
+    File logFile_;
+    bool fileOpen_;
+    FlightLog::Header header_;
+    LogWriterStats stats_;
+    // Entries are added and removed only by the writer; others read them,
+    // and the loop sets summaries, under stateMutex_.
+    LogIndex index_;
+    volatile bool indexLoaded_;
+    LogStorageHealth storage_;     // under stateMutex_
+    // Set by the loop, written out by CommandSummary; under stateMutex_
+    char pendingSummaryPath_[32];
+    uint8_t pendingSummary_[FlightSummaryCodec::kEncodedSize];
+    size_t pendingSummaryLen_;
+    uint32_t freeEstimate_;        // measured free space minus bytes written since
+    uint32_t freeAtCheck_;         // freeEstimate_ right after the last budget check
+    LogCompression::Encoder encoder_;
+    LogCompression::Decoder decoder_;
+    LogCompression::SyncPoint syncPoints_[MAX_SYNC_POINTS];
+    // The closed log being compressed (encoder_, syncPoints_), and the one
+    // closed after it, waiting. Writer task only.
+    struct CompressJob {
+        bool active;
+        bool ok;
+        char path[32];
+        File in;
+        File out;
+        FlightLog::Header header;
+        FlightLog::RecordClock clock;
+        uint32_t rawSize;
+        uint32_t rawPos;
+        uint32_t outSize;
+        uint32_t blockBytes;
+        uint32_t lastSync;
+        uint32_t endMs;
+        size_t syncCount;
+    };
+    CompressJob compress_;
+    char nextCompressPath_[32];
+
+    void startLogging();
     void stopLogging();
+    bool sealAndHandOff();
+    void pushPreArm(const uint8_t* record, size_t len, uint32_t nowUs);
+    static Command makeCommand(CommandType type);
+    bool sendCommand(const Command& cmd, TickType_t wait);
 
-    /**
-     * Writes current time. If the log filename already encodes the date,
-     * emits "HH:MM:SS"; otherwise emits the full "YYYY-MM-DDTHH:MM:SS" so the
-     * date is preserved. Falls back to "ms:NNNNNNN" if the clock is not synced.
-     */
-    void formatTimestamp(char* buf, size_t len);
+    static void writerTask(void* arg);
+    void runCommand(const Command& cmd);
+    void createNewFile();
+    void loadIndex();
+    void rebuildIndex();
+    void saveIndex();
+    void indexFile(const char* path, uint32_t size, uint64_t startEpochMs);
+    void loadSummary(const char* path, const char* summaryPath);
+    void indexSummary(const char* path, const uint8_t* encoded, size_t len);
+    void writePendingSummary();
+    void enforceStorageBudget(size_t newLogs);
+    bool beginCompress(const char* path);
+    void compressSlice();
+    void feedCompressor(const uint8_t* data, size_t len);
+    void drainCompressor();
+    void finishCompress();
+    void cancelCompress(const char* path);
+    bool readLogHeader(File& file, FlightLog::Header& h);
+    bool writeWithRetry(const uint8_t* data, size_t len);
+    void noteBytesWritten(size_t len);
+    bool openLogFile();
+    void closeFileHandle();
+    void writeSealedBuffer();
+    void writePreArmRing();
+    void setCurrentFileName(const char* name);
 };
 
 #endif
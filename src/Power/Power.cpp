@@ -44,13 +44,18 @@ void Power::checkSignalLoss() {
     bool escLost   = escTempContract_.update(telemetry.isEscTempValid(), now, SIGNAL_LOSS_GRACE_MS);
     bool battLost  = batteryContract_.update(telemetry.isBatteryVoltageValid(), now, SIGNAL_LOSS_GRACE_MS);
 
+    // Every trip is journaled, including those behind the one that
+    // disarmed.
     if (motorLost) {
+        eventJournal.record(EventJournalFormat::EventSignalLost, EventJournalFormat::SignalLostMotorTemp);
         throttle.setDisarmed(DisarmReason::MotorTempLost);
     }
     if (escLost) {
+        eventJournal.record(EventJournalFormat::EventSignalLost, EventJournalFormat::SignalLostEscTemp);
         throttle.setDisarmed(DisarmReason::EscTempLost);
     }
     if (battLost) {
+        eventJournal.record(EventJournalFormat::EventSignalLost, EventJournalFormat::SignalLostBatteryVoltage);
         throttle.setDisarmed(DisarmReason::BatteryVoltageLost);
     }
 }
@@ -11,11 +11,18 @@ extern Power power;
 extern Sound sound;
 extern RemoteLink remoteLink;
 
-PowerAlert::PowerAlert() : seq_(0), activeCauses_(0) {}
+PowerAlert::PowerAlert() : seq_(0), activeCauses_(0), journaledCauses_(0) {}
 
 void PowerAlert::handle() {
     activeCauses_ = power.getActiveLimitCauses();
 
+    // Transitions while armed only; a disarm closes an open episode.
+    const uint8_t armedCauses = throttle.isArmed() ? activeCauses_ : 0;
+    if (armedCauses != journaledCauses_) {
+        journaledCauses_ = armedCauses;
+        eventJournal.record(EventJournalFormat::EventPowerLimit, armedCauses);
+    }
+
     if (logic_.update(throttle.isArmed(), activeCauses_, millis(), POWER_ALERT_BEEP_INTERVAL_MS)) {
         seq_++;
         sound.play(SoundEvent::PowerAlert);
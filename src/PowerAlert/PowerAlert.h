@@ -14,4 +14,5 @@ private:
     PowerAlertLogic logic_;
     uint32_t seq_;
     uint8_t  activeCauses_;
+    uint8_t  journaledCauses_;   // last armed causes written to the event journal
 };
@@ -1,6 +1,8 @@
 #include "Settings.h"
 #include "../config.h"
 #include "../BoardConfig.h"
+#include "../Logger/FlightLogFormat.h"
+#include "../Logger/LogStorage.h"
 #include <cstring>
 
 namespace {
@@ -43,6 +45,10 @@ bool isValidBmsMacFormat(const String& s) {
     return true;
 }
 
+// NVS keys per pack; pack 0 keeps the single-BMS keys
+const char* const kBmsTypeKeys[kMaxBmsPacks] = { "bmsType", "bmsType2" };
+const char* const kBmsMacKeys[kMaxBmsPacks] = { "bmsMac", "bmsMac2" };
+
 } // namespace
 
 Settings::Settings() {
@@ -55,8 +61,13 @@ Settings::Settings() {
     escMaxTemp = 0;
     escTempReductionStart = 0;
     powerControlEnabled = true;
-    bmsType = BmsTypeNone;
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        bmsType[pack] = BmsTypeNone;
+    }
+    bmsRevision = 0;
     buzzerVolume = getDefaultBuzzerVolume();
+    logRateHz = FlightLog::kDefaultLogRateHz;
+    logReserveKb = LogStorage::kDefaultReserveKb;
     voltageDividerRatio = getDefaultVoltageDividerRatio();
     throttleSource = ThrottleSourceWired;
     remoteMac = "";
@@ -93,19 +104,23 @@ void Settings::load() {
 
     // Load generic Bluetooth BMS settings, falling back to legacy JBD keys.
     if (preferences.isKey("bmsType") || preferences.isKey("bmsMac")) {
-        bmsType = preferences.getUChar("bmsType", getDefaultBmsType());
-        bmsMac = readBoundedPrefString(preferences, "bmsMac");
+        bmsType[0] = preferences.getUChar("bmsType", getDefaultBmsType());
+        bmsMac[0] = readBoundedPrefString(preferences, "bmsMac");
     } else {
         const String legacyMac = readBoundedPrefString(preferences, "jbdBmsMac");
         const bool legacyEnabled = preferences.getBool("jbdBmsEn", false);
         if (legacyEnabled && legacyMac.length() >= 17) {
-            bmsType = BmsTypeJbd;
-            bmsMac = legacyMac;
+            bmsType[0] = BmsTypeJbd;
+            bmsMac[0] = legacyMac;
         } else {
-            bmsType = getDefaultBmsType();
-            bmsMac = "";
+            bmsType[0] = getDefaultBmsType();
+            bmsMac[0] = "";
         }
     }
+    for (uint8_t pack = 1; pack < kMaxBmsPacks; pack++) {
+        bmsType[pack] = preferences.getUChar(kBmsTypeKeys[pack], BmsTypeNone);
+        bmsMac[pack] = readBoundedPrefString(preferences, kBmsMacKeys[pack]);
+    }
 
     // Load config PIN (default "0000")
     configPin = readBoundedPrefString(preferences, "cfgPin");
@@ -115,6 +130,14 @@ void Settings::load() {
     buzzerVolume = preferences.getUChar("buzzVol", getDefaultBuzzerVolume());
     if (buzzerVolume > 100) buzzerVolume = getDefaultBuzzerVolume();
 
+    // Flight log rate (default 1 Hz), reset if not one of the offered rates
+    logRateHz = preferences.getUChar("logRate", FlightLog::kDefaultLogRateHz);
+    if (!FlightLog::isSupportedLogRate(logRateHz)) logRateHz = FlightLog::kDefaultLogRateHz;
+
+    // Log storage reserve (default 24 KB), reset if out of range
+    logReserveKb = preferences.getUShort("logReserve", LogStorage::kDefaultReserveKb);
+    if (!LogStorage::isValidReserveKb(logReserveKb)) logReserveKb = LogStorage::kDefaultReserveKb;
+
     // Load voltage divider calibration ratio
     voltageDividerRatio = preferences.getFloat("vDivR", getDefaultVoltageDividerRatio());
     if (voltageDividerRatio < 1.0f || voltageDividerRatio > 100.0f) voltageDividerRatio = getDefaultVoltageDividerRatio();
@@ -130,25 +153,37 @@ void Settings::load() {
 
     bool repaired = false;
 
-    bmsMac.trim();
-    if (!isValidBmsMacFormat(bmsMac)) {
-        if (bmsMac.length() > 0) {
-            Serial.println("[Settings] Invalid or oversized BMS MAC in NVS, clearing");
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        bmsMac[pack].trim();
+        if (!isValidBmsMacFormat(bmsMac[pack])) {
+            if (bmsMac[pack].length() > 0) {
+                Serial.println("[Settings] Invalid or oversized BMS MAC in NVS, clearing");
+                repaired = true;
+            }
+            bmsMac[pack] = "";
+        }
+
+        if (bmsType[pack] > BmsTypeJk) {
+            Serial.println("[Settings] Invalid BMS type in NVS, resetting to None");
+            bmsType[pack] = BmsTypeNone;
             repaired = true;
         }
-        bmsMac = "";
-    }
 
-    if (bmsType > BmsTypeJk) {
-        Serial.println("[Settings] Invalid BMS type in NVS, resetting to None");
-        bmsType = BmsTypeNone;
-        repaired = true;
+        if (bmsType[pack] != BmsTypeNone && bmsMac[pack].length() != 17) {
+            Serial.println("[Settings] BMS type requires a valid MAC; disabling BMS in NVS");
+            bmsType[pack] = BmsTypeNone;
+            repaired = true;
+        }
     }
 
-    if (bmsType != BmsTypeNone && bmsMac.length() != 17) {
-        Serial.println("[Settings] BMS type requires a valid MAC; disabling BMS in NVS");
-        bmsType = BmsTypeNone;
-        repaired = true;
+    // One BMS cannot be two packs
+    for (uint8_t pack = 1; pack < kMaxBmsPacks; pack++) {
+        if (bmsType[pack] != BmsTypeNone && bmsType[0] != BmsTypeNone
+            && bmsMac[pack].equalsIgnoreCase(bmsMac[0])) {
+            Serial.println("[Settings] Second BMS repeats the first one's MAC; disabling it in NVS");
+            bmsType[pack] = BmsTypeNone;
+            repaired = true;
+        }
     }
 
     if (repaired) {
@@ -170,9 +205,13 @@ void Settings::save() {
     preferences.putInt("escMaxT", escMaxTemp);
     preferences.putInt("escRedT", escTempReductionStart);
     preferences.putBool("pwrCtrl", powerControlEnabled);
-    preferences.putUChar("bmsType", bmsType);
-    preferences.putString("bmsMac", bmsMac);
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        preferences.putUChar(kBmsTypeKeys[pack], bmsType[pack]);
+        preferences.putString(kBmsMacKeys[pack], bmsMac[pack]);
+    }
     preferences.putUChar("buzzVol", buzzerVolume);
+    preferences.putUChar("logRate", logRateHz);
+    preferences.putUShort("logReserve", logReserveKb);
     preferences.putFloat("vDivR", voltageDividerRatio);
     preferences.putUChar("thrSrc", throttleSource);
     preferences.putString("rmtMac", remoteMac);
@@ -278,35 +317,50 @@ bool Settings::getDefaultPowerControlEnabled() const {
     return true;  // Power control enabled by default
 }
 
-uint8_t Settings::getBmsType() const {
-    return bmsType;
+uint8_t Settings::getBmsType(uint8_t pack) const {
+    return pack < kMaxBmsPacks ? bmsType[pack] : (uint8_t)BmsTypeNone;
 }
 
-void Settings::setBmsType(uint8_t type) {
+void Settings::setBmsType(uint8_t type, uint8_t pack) {
+    if (pack >= kMaxBmsPacks) {
+        return;
+    }
     if (type > BmsTypeJk) {
         type = BmsTypeNone;
     }
-    bmsType = type;
+    bmsType[pack] = type;
+    bmsRevision = bmsRevision + 1;
 }
 
-String Settings::getBmsMac() const {
+String Settings::getBmsMac(uint8_t pack) const {
+    if (pack >= kMaxBmsPacks) {
+        return String();
+    }
     // String is a heap-allocated object — protect against concurrent access from WiFi task.
     if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY);
-    String copy = bmsMac;
+    String copy = bmsMac[pack];
     if (mutex_) xSemaphoreGive(mutex_);
     return copy;
 }
 
-void Settings::setBmsMac(const char* mac) {
+void Settings::setBmsMac(const char* mac, uint8_t pack) {
+    if (pack >= kMaxBmsPacks) {
+        return;
+    }
     if (mutex_) xSemaphoreTake(mutex_, portMAX_DELAY);
     if (mac != nullptr) {
-        bmsMac = String(mac);
+        bmsMac[pack] = String(mac);
     } else {
-        bmsMac = "";
+        bmsMac[pack] = "";
     }
+    bmsRevision = bmsRevision + 1;
     if (mutex_) xSemaphoreGive(mutex_);
 }
 
+bool Settings::isBmsConfigured(uint8_t pack) const {
+    return getBmsType(pack) != BmsTypeNone && getBmsMac(pack).length() >= 17;
+}
+
 uint8_t Settings::getDefaultBmsType() const {
     return BmsTypeNone;
 }
@@ -333,6 +387,24 @@ void Settings::setBuzzerVolume(uint8_t percent) {
     buzzerVolume = percent;
 }
 
+uint8_t Settings::getLogRateHz() const {
+    return logRateHz;
+}
+
+void Settings::setLogRateHz(uint8_t hz) {
+    if (!FlightLog::isSupportedLogRate(hz)) return;
+    logRateHz = hz;
+}
+
+uint16_t Settings::getLogReserveKb() const {
+    return logReserveKb;
+}
+
+void Settings::setLogReserveKb(uint16_t kb) {
+    if (!LogStorage::isValidReserveKb(kb)) return;
+    logReserveKb = kb;
+}
+
 uint8_t Settings::getThrottleSource() const {
     return throttleSource;
 }
@@ -19,6 +19,10 @@ enum BmsType : uint8_t {
     BmsTypeJk = 3
 };
 
+// Packs flown in parallel, each with its own BMS type and MAC. Pack 0 is
+// the one older firmware knew as "the" BMS.
+static const uint8_t kMaxBmsPacks = 2;
+
 enum ThrottleSource : uint8_t {
     ThrottleSourceWired = 0,
     ThrottleSourceWireless = 1
@@ -64,11 +68,16 @@ public:
     bool getPowerControlEnabled() const;
     void setPowerControlEnabled(bool enabled);
 
-    // Bluetooth BMS
-    uint8_t getBmsType() const;
-    void setBmsType(uint8_t type);
-    String getBmsMac() const;
-    void setBmsMac(const char* mac);
+    // Bluetooth BMS, per pack (0 .. kMaxBmsPacks-1); an out-of-range pack
+    // reads as not configured.
+    uint8_t getBmsType(uint8_t pack = 0) const;
+    void setBmsType(uint8_t type, uint8_t pack = 0);
+    String getBmsMac(uint8_t pack = 0) const;
+    void setBmsMac(const char* mac, uint8_t pack = 0);
+    bool isBmsConfigured(uint8_t pack = 0) const;
+    // Bumped by the two setters above: lets the BMS facade notice a change
+    // without copying the MAC every loop.
+    uint32_t getBmsRevision() const { return bmsRevision; }
 
     // Config PIN — required on all write endpoints and OTA. Default: "0000".
     String getConfigPin() const;
@@ -78,6 +87,14 @@ public:
     uint8_t getBuzzerVolume() const;
     void setBuzzerVolume(uint8_t percent);
 
+    // Flight log rate for the fast channels (FlightLog::kLogRatesHz; 1 = full records only)
+    uint8_t getLogRateHz() const;
+    void setLogRateHz(uint8_t hz);
+
+    // Free space (KB) kept on LittleFS for the next flight; oldest logs are deleted for it
+    uint16_t getLogReserveKb() const;
+    void setLogReserveKb(uint16_t kb);
+
     // Voltage divider calibration ratio (XAG/Tmotor: compensates resistor tolerance)
     float getVoltageDividerRatio() const;
     void setVoltageDividerRatio(float ratio);
@@ -126,9 +143,12 @@ private:
     bool powerControlEnabled;
     uint8_t throttleSource;
     String remoteMac;
-    String bmsMac;
-    uint8_t bmsType;
+    String bmsMac[kMaxBmsPacks];
+    uint8_t bmsType[kMaxBmsPacks];
+    volatile uint32_t bmsRevision;
     uint8_t buzzerVolume;
+    uint8_t logRateHz;
+    uint16_t logReserveKb;
     float voltageDividerRatio;
 };
 
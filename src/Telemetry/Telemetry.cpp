@@ -62,16 +62,18 @@ bool Telemetry::hasData() const {
 
 uint16_t Telemetry::getBatteryVoltageMilliVolts() const {
     uint16_t v = s_backend_ptr && s_backend_ptr->getBatteryVoltageMilliVolts ? s_backend_ptr->getBatteryVoltageMilliVolts() : 0;
-    if (v == 0 && bluetoothBms.hasData()) {
-        return (uint16_t)bluetoothBms.getPackVoltageMilliVolts();
+    BmsSnapshot bms;
+    if (v == 0 && bluetoothBms.getSnapshot(bms)) {
+        return (uint16_t)bms.packVoltageMilliVolts;
     }
     return v;
 }
 
 uint32_t Telemetry::getBatteryCurrentMilliAmps() const {
     uint32_t a = s_backend_ptr && s_backend_ptr->getBatteryCurrentMilliAmps ? s_backend_ptr->getBatteryCurrentMilliAmps() : 0;
-    if (a == 0 && bluetoothBms.hasData()) {
-        int32_t bmsMa = bluetoothBms.getPackCurrentMilliAmps();
+    BmsSnapshot bms;
+    if (a == 0 && bluetoothBms.getSnapshot(bms)) {
+        int32_t bmsMa = bms.packCurrentMilliAmps;
         return (uint32_t)(bmsMa < 0 ? -bmsMa : bmsMa);
     }
     return a;
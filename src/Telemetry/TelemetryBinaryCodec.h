@@ -0,0 +1,320 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Compact binary encoding of the /api/telemetry frame -- no Arduino deps,
+// host-testable. The JSON frame repeats ~40 key names and the full buzzer and
+// powerAlert arrays on every poll (~1 KB); this encoding sends only the
+// values, and in a delta frame only the values that changed since a frame
+// the client already holds. The 2.4 GHz radio is shared with ESP-NOW and the
+// BLE BMS link, so every byte of softAP airtime saved matters.
+//
+// Wire format, version 1. "var" is an unsigned LEB128 varint, "svar" a
+// zig-zag encoded signed varint.
+//
+//   u8   magic            TELEMETRY_BIN_MAGIC
+//   u8   version          TELEMETRY_BIN_VERSION
+//   u8   flags            bit0 = keyframe
+//   var  seq              frame sequence number (never 0)
+//   var  baseSeq          delta frames only: the frame this one is relative to
+//   var  presentMask      bit i set = field i exists in this frame
+//   var  changedMask      delta frames only: fields carried below
+//   svar value[i]         for each set bit of changedMask (keyframe:
+//                         presentMask), ascending i: value - base value
+//                         (base is 0 in a keyframe or for a newly present field)
+//   u8   beepCount        beeps newer than the base frame's newest beep
+//   per beep:
+//     var  seqDelta       vs the previous beep (first: vs the base's newest seq)
+//     var  freq, onMs, offMs
+//     u8   reps
+//     u8   layer | active << 1
+//
+// Fields that are absent in the frame keep their last value in the encoder's
+// copy but are never sent; a decoder must consult presentMask before reading.
+// Any change to the field list or layout must bump TELEMETRY_BIN_VERSION and
+// the JS decoder (WebServer/Pages/TelemetryCodecScript.h) in the same commit.
+
+static const uint8_t TELEMETRY_BIN_MAGIC   = 0xF7;
+static const uint8_t TELEMETRY_BIN_VERSION = 1;
+static const uint8_t TELEMETRY_BIN_FLAG_KEYFRAME = 0x01;
+
+enum TelemetryField : uint8_t {
+    TelemetryFieldFlags = 0,          // TelemetryFlag bits
+    TelemetryFieldBatteryPercentCc,
+    TelemetryFieldBatteryPercentVoltage,
+    TelemetryFieldBatteryVoltageMv,
+    TelemetryFieldPowerKwX10,
+    TelemetryFieldThrottlePercent,
+    TelemetryFieldThrottleRaw,
+    TelemetryFieldPowerPercent,
+    TelemetryFieldMotorTempMc,
+    TelemetryFieldRpm,
+    TelemetryFieldEscCurrentMa,
+    TelemetryFieldEscTempMc,
+    TelemetryFieldDisarmReason,       // DisarmReason enum value
+    TelemetryFieldPowerScale,
+    TelemetryFieldArmCharge,
+    TelemetryFieldUptimeMs,
+    TelemetryFieldLastTelemetryUpdateMs,
+    TelemetryFieldHourMeterSec,
+    TelemetryFieldSessionSec,
+    TelemetryFieldBmsState,           // index into the BMS state name table
+    TelemetryFieldBmsTempMaxC,
+    TelemetryFieldBmsCellMinMv,
+    TelemetryFieldBmsCellMaxMv,
+    TelemetryFieldBmsCellDeltaMv,
+    TelemetryFieldSignals,            // SignalState: motorTemp | escTemp << 2 | battV << 4
+    TelemetryFieldPowerAlertSeq,
+    TelemetryFieldPowerAlertCauses,   // PowerLimitCause bitmask
+    TelemetryFieldCount
+};
+
+enum TelemetryFlag : uint16_t {
+    TelemetryFlagHasTelemetry   = 1 << 0,
+    TelemetryFlagArmed          = 1 << 1,
+    TelemetryFlagAvCurrent      = 1 << 2,
+    TelemetryFlagAvRpm          = 1 << 3,
+    TelemetryFlagAvPowerKw      = 1 << 4,
+    TelemetryFlagAvBms          = 1 << 5,
+    TelemetryFlagAvBmsCells     = 1 << 6,
+    TelemetryFlagBmsConnected   = 1 << 7,
+    TelemetryFlagBmsConfigured  = 1 << 8,
+};
+
+struct TelemetryBeep {
+    uint32_t seq;
+    uint16_t frequency;
+    uint16_t onMs;
+    uint16_t offMs;
+    uint8_t  reps;
+    uint8_t  layer;
+    bool     active;
+};
+
+struct TelemetryFrame {
+    static const uint8_t kMaxBeeps = 8;
+
+    uint32_t seq;
+    uint32_t presentMask;
+    int32_t  values[TelemetryFieldCount];
+    uint8_t  beepCount;
+    TelemetryBeep beeps[kMaxBeeps];   // ascending seq, oldest first
+
+    void clear() {
+        seq = 0;
+        presentMask = 0;
+        for (uint8_t i = 0; i < TelemetryFieldCount; i++) values[i] = 0;
+        beepCount = 0;
+    }
+
+    void set(TelemetryField field, int32_t value) {
+        values[field] = value;
+        presentMask |= (1UL << field);
+    }
+
+    bool has(TelemetryField field) const { return (presentMask & (1UL << field)) != 0; }
+
+    uint32_t newestBeepSeq() const { return beepCount > 0 ? beeps[beepCount - 1].seq : 0; }
+};
+
+namespace TelemetryBinary {
+
+inline uint32_t zigzag(int32_t v) { return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31); }
+inline int32_t unzigzag(uint32_t v) { return (int32_t)(v >> 1) ^ -(int32_t)(v & 1); }
+
+// Bounded byte writer/reader: an overrun latches ok = false instead of
+// writing or reading past the buffer.
+struct Writer {
+    uint8_t* buf;
+    size_t   cap;
+    size_t   len;
+    bool     ok;
+
+    void u8(uint8_t v) {
+        if (len >= cap) { ok = false; return; }
+        buf[len++] = v;
+    }
+    void var(uint32_t v) {
+        while (v >= 0x80) {
+            u8((uint8_t)(v | 0x80));
+            v >>= 7;
+        }
+        u8((uint8_t)v);
+    }
+};
+
+struct Reader {
+    const uint8_t* buf;
+    size_t         len;
+    size_t         pos;
+    bool           ok;
+
+    uint8_t u8() {
+        if (pos >= len) { ok = false; return 0; }
+        return buf[pos++];
+    }
+    uint32_t var() {
+        uint32_t v = 0;
+        for (uint8_t shift = 0; shift < 35; shift += 7) {
+            uint8_t b = u8();
+            if (!ok) return 0;
+            v |= (uint32_t)(b & 0x7F) << shift;
+            if ((b & 0x80) == 0) return v;
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+// Worst case: header + every field as a 5-byte varint + every beep field.
+static const size_t kMaxEncodedSize = 3 + 5 * 4 + 5 * TelemetryFieldCount + 1
+                                      + TelemetryFrame::kMaxBeeps * (5 * 4 + 2);
+
+// Encodes `cur` relative to `base` (nullptr = keyframe). Returns the number
+// of bytes written, or 0 if `out` is too small.
+inline size_t encode(const TelemetryFrame& cur, const TelemetryFrame* base, uint8_t* out, size_t cap) {
+    Writer w = { out, cap, 0, true };
+    const bool keyframe = (base == nullptr);
+
+    uint32_t changedMask = cur.presentMask;
+    if (!keyframe) {
+        changedMask = 0;
+        for (uint8_t i = 0; i < TelemetryFieldCount; i++) {
+            const uint32_t bit = 1UL << i;
+            if (!(cur.presentMask & bit)) continue;
+            if (!(base->presentMask & bit) || base->values[i] != cur.values[i]) {
+                changedMask |= bit;
+            }
+        }
+    }
+
+    w.u8(TELEMETRY_BIN_MAGIC);
+    w.u8(TELEMETRY_BIN_VERSION);
+    w.u8(keyframe ? TELEMETRY_BIN_FLAG_KEYFRAME : 0);
+    w.var(cur.seq);
+    if (!keyframe) w.var(base->seq);
+    w.var(cur.presentMask);
+    if (!keyframe) w.var(changedMask);
+
+    for (uint8_t i = 0; i < TelemetryFieldCount; i++) {
+        const uint32_t bit = 1UL << i;
+        if (!(changedMask & bit)) continue;
+        int32_t prev = 0;
+        if (!keyframe && (base->presentMask & bit)) prev = base->values[i];
+        w.var(zigzag((int32_t)((uint32_t)cur.values[i] - (uint32_t)prev)));
+    }
+
+    const uint32_t baseNewest = keyframe ? 0 : base->newestBeepSeq();
+    uint8_t first = 0;
+    while (first < cur.beepCount && cur.beeps[first].seq <= baseNewest) first++;
+    w.u8((uint8_t)(cur.beepCount - first));
+    uint32_t prevSeq = baseNewest;
+    for (uint8_t i = first; i < cur.beepCount; i++) {
+        const TelemetryBeep& b = cur.beeps[i];
+        w.var(b.seq - prevSeq);
+        w.var(b.frequency);
+        w.var(b.onMs);
+        w.var(b.offMs);
+        w.u8(b.reps);
+        w.u8((uint8_t)((b.layer & 0x01) | (b.active ? 0x02 : 0)));
+        prevSeq = b.seq;
+    }
+
+    return w.ok ? w.len : 0;
+}
+
+// Decodes a frame. A delta frame needs `base` with the matching seq; returns
+// false on a malformed buffer, unknown version or base mismatch.
+inline bool decode(const uint8_t* in, size_t len, const TelemetryFrame* base, TelemetryFrame& out) {
+    Reader r = { in, len, 0, true };
+    if (r.u8() != TELEMETRY_BIN_MAGIC) return false;
+    if (r.u8() != TELEMETRY_BIN_VERSION) return false;
+    const bool keyframe = (r.u8() & TELEMETRY_BIN_FLAG_KEYFRAME) != 0;
+
+    TelemetryFrame result;
+    if (keyframe) {
+        result.clear();
+    } else {
+        if (base == nullptr) return false;
+        result = *base;
+    }
+
+    result.seq = r.var();
+    if (!keyframe && r.var() != base->seq) return false;
+    const uint32_t presentMask = r.var();
+    const uint32_t changedMask = keyframe ? presentMask : r.var();
+    if (!r.ok || (changedMask & ~presentMask) != 0) return false;
+
+    for (uint8_t i = 0; i < TelemetryFieldCount; i++) {
+        const uint32_t bit = 1UL << i;
+        if (!(changedMask & bit)) continue;
+        int32_t prev = 0;
+        if (!keyframe && (result.presentMask & bit)) prev = result.values[i];
+        result.values[i] = (int32_t)((uint32_t)prev + (uint32_t)unzigzag(r.var()));
+    }
+    result.presentMask = presentMask;
+
+    const uint8_t newCount = r.u8();
+    if (!r.ok || newCount > TelemetryFrame::kMaxBeeps) return false;
+
+    // Append the new beeps to the base ring, keeping the newest kMaxBeeps --
+    // the same window the firmware ring holds.
+    uint32_t prevSeq = result.newestBeepSeq();
+    for (uint8_t i = 0; i < newCount; i++) {
+        TelemetryBeep b;
+        b.seq = prevSeq + r.var();
+        b.frequency = (uint16_t)r.var();
+        b.onMs = (uint16_t)r.var();
+        b.offMs = (uint16_t)r.var();
+        b.reps = r.u8();
+        const uint8_t bits = r.u8();
+        b.layer = bits & 0x01;
+        b.active = (bits & 0x02) != 0;
+        if (!r.ok) return false;
+        if (result.beepCount == TelemetryFrame::kMaxBeeps) {
+            for (uint8_t j = 1; j < TelemetryFrame::kMaxBeeps; j++) result.beeps[j - 1] = result.beeps[j];
+            result.beepCount--;
+        }
+        result.beeps[result.beepCount++] = b;
+        prevSeq = b.seq;
+    }
+
+    if (r.pos != r.len) return false;
+    out = result;
+    return true;
+}
+
+} // namespace TelemetryBinary
+
+// Last N frames produced, so a delta can be encoded against whichever frame
+// a client last acknowledged. A client whose ack has aged out gets a keyframe.
+template <uint8_t N>
+class TelemetryFrameHistory {
+public:
+    TelemetryFrameHistory() : next_(0), count_(0) {}
+
+    void push(const TelemetryFrame& frame) {
+        frames_[next_] = frame;
+        next_ = (uint8_t)((next_ + 1) % N);
+        if (count_ < N) count_++;
+    }
+
+    const TelemetryFrame* find(uint32_t seq) const {
+        if (seq == 0) return nullptr;
+        for (uint8_t i = 0; i < count_; i++) {
+            if (frames_[i].seq == seq) return &frames_[i];
+        }
+        return nullptr;
+    }
+
+    const TelemetryFrame* latest() const {
+        if (count_ == 0) return nullptr;
+        return &frames_[(next_ + N - 1) % N];
+    }
+
+private:
+    TelemetryFrame frames_[N];
+    uint8_t next_;
+    uint8_t count_;
+};
@@ -6,159 +6,174 @@
 #include "../BatteryMonitor/BatteryMonitor.h"
 #include "../Logger/Logger.h"
 #include "../BluetoothBms/BluetoothBms.h"
-#include <cstdarg>
-#include <cstdio>
 
 extern Throttle throttle;
 extern Power power;
 extern BatteryMonitor batteryMonitor;
 extern Logger logger;
 
-namespace {
-bool appendToBuffer(char* data, size_t size, size_t& used, const char* format, ...) {
-    if (used >= size) {
-        return false;
-    }
-
-    va_list args;
-    va_start(args, format);
-    const int written = vsnprintf(data + used, size - used, format, args);
-    va_end(args);
-
-    if (written < 0) {
-        return false;
-    }
-
-    const size_t charsWritten = static_cast<size_t>(written);
-    if (charsWritten >= (size - used)) {
-        used = size - 1;
-        data[used] = '\0';
-        return false;
-    }
-
-    used += charsWritten;
-    return true;
-}
-} // namespace
-
 TelemetryLogger::TelemetryLogger() {
     lastUpdate = 0;
+    lastFastUpdate = 0;
+    fastInterval = 0;
+    lastLatch = 0;
+    batteryLimited = false;
 }
 
 void TelemetryLogger::init() {
-    logger.setHeader("battery_percent_cc,battery_percent_voltage,voltage,power_kw,throttle_percent,throttle_raw,power_percent,motor_temp,rpm,esc_current,esc_temp,battery_temp_max,cell_voltage_min_mv,cell_voltage_max_mv");
+    // Records are packed binary (FlightLogFormat.h); the CSV header is
+    // produced when a log is downloaded.
 }
 
 void TelemetryLogger::handle() {
-    if (millis() - lastUpdate < UPDATE_INTERVAL) {
-        return;
+    // Brownout warning: the battery limiter engages when the pack sags
+    // toward cutoff, which is also what browns out the controller. Commit
+    // what is buffered while there is still power to do it.
+    const bool limited = (power.getActiveLimitCauses() & POWER_LIMIT_BATTERY) != 0;
+    if (limited && !batteryLimited) {
+        logger.requestFlush();
+    }
+    batteryLimited = limited;
+
+    // Rate classes: the configured rate applies to the fast channels and is
+    // latched while disarmed, so a flight keeps the rate it started with;
+    // so is whether its full records carry the per-pack BMS fields. Both
+    // are read every LATCH_INTERVAL rather than every pass; the Logger
+    // starts the file with the same values, so they always agree.
+    const unsigned long now = millis();
+    if (!throttle.isArmed() && now - lastLatch >= LATCH_INTERVAL) {
+        lastLatch = now;
+        const uint8_t rateHz = settings.getLogRateHz();
+        fastInterval = rateHz > 1 ? 1000 / rateHz : 0;
+        logger.setHighRate(fastInterval > 0);
+        logger.setPackRecords(bluetoothBms.getPackCount() >= 2);
     }
-    lastUpdate = millis();
 
-    char data[LINE_BUFFER_SIZE] = {0};
-    size_t used = 0;
+    if (now - lastUpdate >= UPDATE_INTERVAL) {
+        lastUpdate = now;
+        lastFastUpdate = now;   // the full record carries the fast channels too
+        logFullRecord();
+    } else if (fastInterval > 0 && now - lastFastUpdate >= fastInterval) {
+        lastFastUpdate = now;
+        logFastRecord();
+    }
+}
+
+void TelemetryLogger::logFullRecord() {
+    FlightLog::Record record;
+    memset(&record, 0, sizeof(record));
 
-    writeBatteryInfo(data, sizeof(data), used);
-    writeThrottleInfo(data, sizeof(data), used);
-    writeMotorInfo(data, sizeof(data), used);
-    writeEscInfo(data, sizeof(data), used);
-    writeBmsInfo(data, sizeof(data), used);
-    appendToBuffer(data, sizeof(data), used, "\r\n");
+    writeBatteryInfo(record);
+    writeThrottleInfo(record);
+    writeMotorInfo(record);
+    writeEscInfo(record);
+    writeBmsInfo(record);
 
-    logger.log(data);
+    uint8_t encoded[FlightLog::kRecordSize];
+    FlightLog::encodeRecord(record, encoded);
+    logger.logRecord(encoded, sizeof(encoded));
 }
 
-void TelemetryLogger::writeBatteryInfo(char* data, size_t size, size_t& used) {
+// Throttle, power, current, RPM and pack voltage only: the same values the
+// full record's fast fields hold, without the slow sensors.
+void TelemetryLogger::logFastRecord() {
+    FlightLog::Record full;
+    memset(&full, 0, sizeof(full));
+    writeBatteryInfo(full);
+    writeThrottleInfo(full);
+    writeMotorInfo(full);
+
+    FlightLog::FastRecord record;
+    record.offset = 0;   // stamped by the logger
+    record.flags = full.flags & (FlightLog::RecordHasTelemetry | FlightLog::RecordHasPowerKw
+                                 | FlightLog::RecordHasCurrent);
+    record.throttlePercent = full.throttlePercent;
+    record.powerPercent = full.powerPercent;
+    record.throttleRaw = full.throttleRaw;
+    record.rpm = full.rpm;
+    record.escCurrentDa = full.escCurrentDa;
+    record.batteryVoltageMv = full.batteryVoltageMv;
+    record.powerKwX10 = full.powerKwX10;
+
+    uint8_t encoded[FlightLog::kFastRecordSize];
+    FlightLog::encodeFastRecord(record, encoded);
+    logger.logRecord(encoded, sizeof(encoded));
+}
+
+void TelemetryLogger::writeBatteryInfo(FlightLog::Record& record) {
     if (!telemetry.hasData()) {
-        appendToBuffer(data, size, used, ",,,,");
         return;
     }
 
-    uint8_t batteryPercentageCC = batteryMonitor.getSoC();
-    uint8_t batteryPercentageVoltage = batteryMonitor.getSoCFromVoltage();
+    record.flags |= FlightLog::RecordHasTelemetry;
+    record.batteryPercentCc = batteryMonitor.getSoC();
+    record.batteryPercentVoltage = batteryMonitor.getSoCFromVoltage();
 
-    uint16_t millivolts = telemetry.getBatteryVoltageMilliVolts();
-    uint16_t volts = millivolts / 1000;
-    uint16_t decimals = millivolts % 1000;
-
-    appendToBuffer(data, size, used, "%u,%u,%u.", batteryPercentageCC, batteryPercentageVoltage, volts);
-    if (decimals < 10) {
-        appendToBuffer(data, size, used, "0");
-    }
-    appendToBuffer(data, size, used, "%u,", decimals);
+    const uint16_t millivolts = telemetry.getBatteryVoltageMilliVolts();
+    record.batteryVoltageMv = millivolts;
 
     if (isPowerKwAvailable()) {
-        uint32_t powerMilliWatts = ((uint32_t)millivolts * telemetry.getBatteryCurrentMilliAmps()) / 1000;
-        uint32_t powerKwInt = powerMilliWatts / 1000000;
-        uint32_t powerKwDecimal = (powerMilliWatts / 100000) % 10;
-        appendToBuffer(data, size, used, "%lu.%lu", (unsigned long)powerKwInt, (unsigned long)powerKwDecimal);
+        const uint64_t powerMilliWatts = ((uint64_t)millivolts * telemetry.getBatteryCurrentMilliAmps()) / 1000;
+        const uint64_t powerKwX10 = powerMilliWatts / 100000;
+        record.flags |= FlightLog::RecordHasPowerKw;
+        record.powerKwX10 = powerKwX10 > UINT16_MAX ? (uint16_t)UINT16_MAX : (uint16_t)powerKwX10;
     }
-    appendToBuffer(data, size, used, ",");
 }
 
-void TelemetryLogger::writeThrottleInfo(char* data, size_t size, size_t& used) {
-    unsigned int throttlePercentage = throttle.getThrottlePercentage();
-    unsigned int throttleRaw = throttle.getThrottleRaw();
-    unsigned int powerPercentage = power.getPower();
-
-    appendToBuffer(data, size, used, "%u,%u,%u,", throttlePercentage, throttleRaw, powerPercentage);
+void TelemetryLogger::writeThrottleInfo(FlightLog::Record& record) {
+    record.throttlePercent = (uint8_t)throttle.getThrottlePercentage();
+    record.throttleRaw = (uint16_t)throttle.getThrottleRaw();
+    record.powerPercent = (uint8_t)power.getPower();
 }
 
-void TelemetryLogger::writeMotorInfo(char* data, size_t size, size_t& used) {
-    if (!telemetry.hasData()) {
-        appendToBuffer(data, size, used, ",");
-    } else {
-        int32_t tempCelsius = telemetry.getMotorTempMilliCelsius() / 1000;
-        appendToBuffer(data, size, used, "%ld", (long)tempCelsius);
+void TelemetryLogger::writeMotorInfo(FlightLog::Record& record) {
+    if (telemetry.hasData()) {
+        record.motorTempDc = FlightLog::milliToDeci(telemetry.getMotorTempMilliCelsius());
     }
-    appendToBuffer(data, size, used, ",");
 
     if (isCurrentAvailable()) {
-        appendToBuffer(
-            data,
-            size,
-            used,
-            "%lu,%lu",
-            (unsigned long)telemetry.getRpm(),
-            (unsigned long)(telemetry.getBatteryCurrentMilliAmps() / 1000)
-        );
-    } else {
-        appendToBuffer(data, size, used, ",");
+        record.flags |= FlightLog::RecordHasCurrent;
+        record.rpm = telemetry.getRpm();
+        record.escCurrentDa = FlightLog::milliToDeciU(telemetry.getBatteryCurrentMilliAmps());
     }
-    appendToBuffer(data, size, used, ",");
 }
 
-void TelemetryLogger::writeEscInfo(char* data, size_t size, size_t& used) {
-    if (!telemetry.hasData()) {
-        appendToBuffer(data, size, used, "");
-        return;
+void TelemetryLogger::writeEscInfo(FlightLog::Record& record) {
+    if (telemetry.hasData()) {
+        record.escTempDc = FlightLog::milliToDeci(telemetry.getEscTempMilliCelsius());
     }
-
-    int32_t escTempCelsius = telemetry.getEscTempMilliCelsius() / 1000;
-    appendToBuffer(data, size, used, "%ld", (long)escTempCelsius);
 }
 
-void TelemetryLogger::writeBmsInfo(char* data, size_t size, size_t& used) {
-    if (bluetoothBms.hasData() && bluetoothBms.getTempCount() > 0) {
-        int16_t maxTemp = bluetoothBms.getTempCelsius(0);
-        for (uint8_t i = 1; i < bluetoothBms.getTempCount(); i++) {
-            int16_t t = bluetoothBms.getTempCelsius(i);
-            if (t > maxTemp) maxTemp = t;
-        }
-        appendToBuffer(data, size, used, ",%d", maxTemp);
-    } else {
-        appendToBuffer(data, size, used, ",");
+void TelemetryLogger::writeBmsInfo(FlightLog::Record& record) {
+    BmsSnapshot bms;
+    if (bluetoothBms.getSnapshot(bms) && bms.tempCount > 0) {
+        record.flags |= FlightLog::RecordHasBmsTemp;
+        record.bmsTempMaxC = bms.tempMaxCelsius;
+    }
+    if (bms.hasCellData) {
+        record.flags |= FlightLog::RecordHasCells;
+        record.cellMinMv = bms.cellMinMv;
+        record.cellMaxMv = bms.cellMaxMv;
     }
-    if (bluetoothBms.hasCellData()) {
-        appendToBuffer(
-            data,
-            size,
-            used,
-            ",%u,%u",
-            bluetoothBms.getCellMinMilliVolts(),
-            bluetoothBms.getCellMaxMilliVolts()
-        );
-    } else {
-        appendToBuffer(data, size, used, ",,");
+
+    // Parallel packs: the fields above are the worst across them, each
+    // pack's own reading goes in the per-pack fields
+    if (bluetoothBms.getPackCount() < 2) return;
+    for (uint8_t i = 0; i < FlightLog::kMaxPacks && i < kMaxBmsPacks; i++) {
+        BmsSnapshot pack;
+        if (!bluetoothBms.getPackSnapshot(i, pack)) continue;
+        FlightLog::PackRecord& out = record.packs[i];
+        out.soc = pack.socPercent;
+        out.currentDa = FlightLog::milliToDeci(pack.packCurrentMilliAmps);
+        record.packFlags |= (uint8_t)(FlightLog::PackHasData << FlightLog::packFlagShift(i));
+        if (pack.tempCount > 0) {
+            out.tempMaxC = pack.tempMaxCelsius;
+            record.packFlags |= (uint8_t)(FlightLog::PackHasTemp << FlightLog::packFlagShift(i));
+        }
+        if (pack.hasCellData) {
+            out.cellMinMv = pack.cellMinMv;
+            out.cellMaxMv = pack.cellMaxMv;
+            record.packFlags |= (uint8_t)(FlightLog::PackHasCells << FlightLog::packFlagShift(i));
+        }
     }
 }
@@ -2,6 +2,7 @@
 #define TELEMETRY_LOGGER_H
 
 #include <Arduino.h>
+#include "../Logger/FlightLogFormat.h"
 
 class TelemetryLogger {
 public:
@@ -10,15 +11,21 @@ public:
     void handle();
 
 private:
-    unsigned long lastUpdate;
+    unsigned long lastUpdate;       // full record (every field), 1 Hz
+    unsigned long lastFastUpdate;   // fast record (fast channels only)
+    unsigned long fastInterval;     // 0 = 1 Hz mode, no fast records
+    unsigned long lastLatch;        // log rate and pack count last read
+    bool batteryLimited;
     static const unsigned long UPDATE_INTERVAL = 1000;
-    static const size_t LINE_BUFFER_SIZE = 224;
+    static const unsigned long LATCH_INTERVAL = 1000;
 
-    void writeBatteryInfo(char* data, size_t size, size_t& used);
-    void writeThrottleInfo(char* data, size_t size, size_t& used);
-    void writeMotorInfo(char* data, size_t size, size_t& used);
-    void writeEscInfo(char* data, size_t size, size_t& used);
-    void writeBmsInfo(char* data, size_t size, size_t& used);
+    void logFullRecord();
+    void logFastRecord();
+    void writeBatteryInfo(FlightLog::Record& record);
+    void writeThrottleInfo(FlightLog::Record& record);
+    void writeMotorInfo(FlightLog::Record& record);
+    void writeEscInfo(FlightLog::Record& record);
+    void writeBmsInfo(FlightLog::Record& record);
 };
 
 #endif
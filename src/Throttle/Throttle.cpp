@@ -311,6 +311,7 @@ void Throttle::setArmed()
   wiredValidity.reset();
   throttleArmed = true;
   power.onArmed();
+  eventJournal.record(EventJournalFormat::EventArmed);
 }
 
 void Throttle::setDisarmed(DisarmReason reason)
@@ -321,6 +322,7 @@ void Throttle::setDisarmed(DisarmReason reason)
 
   throttleArmed = false;
   lastDisarmReason = reason;
+  eventJournal.record(EventJournalFormat::EventDisarmed, (uint8_t)reason);
 
   // Only the manual disarm gets an event. A fault disarm is announced by
   // SoundState::FaultDisarm, declared from lastDisarmReason in main.cpp's
@@ -13,6 +13,9 @@
 #include <AsyncJson.h>
 #include <esp_heap_caps.h>
 #include <sys/time.h>
+#include "JsonStreamWriter.h"
+#include "ETagLogic.h"
+#include "HttpRange.h"
 #include "Pages/CommonLayout.h"
 #include "Pages/ConfigPowerPage.h"
 #include "Pages/ConfigThermalPage.h"
@@ -23,13 +26,19 @@
 #include "Pages/FirmwarePage.h"
 #include "Pages/LogsPage.h"
 #include "Pages/TelemetryPage.h"
+#include "Pages/TelemetryCodecScript.h"
 #include "Pages/LegacyIndexPage.h"
 #include "../Version.h"
 #include "../Logger/Logger.h"
+#include "../Logger/FlightLogFormat.h"
+#include "../Logger/LogCompression.h"
+#include "../Clock/Clock.h"
 #if IS_TMOTOR
 #include "../Tmotor/TmotorCan.h"
 #endif
 #include <vector>
+#include <memory>
+#include <algorithm>
 
 extern Logger logger;
 
@@ -47,6 +56,10 @@ const char* CONTROLLER_LABEL = "Unknown";
 #endif
 
 namespace {
+// Scratch buffer for one JSON telemetry body (see buildTelemetryJson()):
+// ~2 KB worst case with a full buzzer ring and every flightStats group.
+const size_t TELEMETRY_JSON_CAPACITY = 3072;
+
 void logWebHeap(const char* tag) {
     Serial.printf(
         "[WebServer] %s heap=%u min=%u largest=%u\n",
@@ -69,6 +82,34 @@ void sendJsonResponse(AsyncWebServerRequest* request, int httpStatus, const TJso
     request->send(response);
 }
 
+typedef JsonStreamWriter<Print> ResponseJsonWriter;
+
+// Streams the body written by `write(ResponseJsonWriter&)` straight into the
+// response buffer: no DOM, no intermediate String. With DEBUG, logs the body
+// size and how much heap the request took before it was handed to AsyncTCP.
+template <typename TWrite>
+void sendStreamedJson(AsyncWebServerRequest* request, const char* tag, TWrite write, int httpStatus = 200) {
+#if DEBUG
+    const uint32_t heapBefore = ESP.getFreeHeap();
+#endif
+    AsyncResponseStream* response = request->beginResponseStream("application/json");
+    if (response == nullptr) {
+        request->send(500, "text/plain", "Sem memória");
+        return;
+    }
+    response->setCode(httpStatus);
+    ResponseJsonWriter json(*response);
+    write(json);
+    json.flush();
+#if DEBUG
+    Serial.printf("[WebServer] %s json=%u bytes heapCost=%d\n",
+                  tag, (unsigned)json.bytesWritten(), (int)(heapBefore - ESP.getFreeHeap()));
+#else
+    (void)tag;
+#endif
+    request->send(response);
+}
+
 const char* toBmsScanStatusLabel(uint8_t status) {
     switch (status) {
         case BluetoothBmsScanScanning:
@@ -83,134 +124,560 @@ const char* toBmsScanStatusLabel(uint8_t status) {
     }
 }
 
+// Results stream in while the scan runs; the page polls and shows them as
+// they come.
 void sendBmsScanStatusResponse(AsyncWebServerRequest* request, int httpStatus = 200) {
-    StaticJsonDocument<2048> doc;
-    doc["ok"] = (httpStatus >= 200 && httpStatus < 300);
-    doc["status"] = toBmsScanStatusLabel(bluetoothBms.getWebScanStatus());
-    doc["busy"] = bluetoothBms.isWebScanBusy();
-
-    if (bluetoothBms.getWebScanStatus() == BluetoothBmsScanError && strlen(bluetoothBms.getWebScanError()) > 0) {
-        doc["error"] = bluetoothBms.getWebScanError();
-    }
-
-    JsonArray results = doc.createNestedArray("results");
-    const BluetoothBmsScanResult* scanResults = bluetoothBms.getWebScanResults();
-    const uint8_t resultCount = bluetoothBms.getWebScanResultCount();
-
-    for (uint8_t i = 0; i < resultCount; i++) {
-        JsonObject entry = results.createNestedObject();
-        entry["mac"] = scanResults[i].mac;
-        entry["name"] = scanResults[i].name;
-        entry["rssi"] = scanResults[i].rssi;
-        entry["detectedType"] = scanResults[i].detectedType;
-        entry["advertisedServices"] = scanResults[i].advertisedServices;
-    }
-
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
-    }
-
-    sendJsonResponse(request, httpStatus, doc);
+    sendStreamedJson(request, "/api/bms/scan/status", [httpStatus](ResponseJsonWriter& json) {
+        BmsScanEntry results[BmsScanTable::kEntries];
+        const uint8_t count = bluetoothBms.copyWebScanResults(results, BmsScanTable::kEntries);
+        const uint8_t status = bluetoothBms.getWebScanStatus();
+
+        json.beginObject();
+        json.member("ok", httpStatus >= 200 && httpStatus < 300);
+        json.member("status", toBmsScanStatusLabel(status));
+        json.member("busy", bluetoothBms.isWebScanBusy());
+        if (status == BluetoothBmsScanError && strlen(bluetoothBms.getWebScanError()) > 0) {
+            json.member("error", bluetoothBms.getWebScanError());
+        }
+        json.beginArray("results");
+        for (uint8_t i = 0; i < count; i++) {
+            char services[64];
+            results[i].formatServices(services, sizeof(services));
+            json.beginObject();
+            json.member("mac", results[i].mac);
+            json.member("name", results[i].name);
+            json.member("rssi", results[i].rssi);
+            json.member("detectedType", results[i].protocol);
+            json.member("advertisedServices", services);
+            json.endObject();
+        }
+        json.endArray();
+        json.endObject();
+    }, httpStatus);
 }
 
 void sendPowerConfigResponse(AsyncWebServerRequest* request) {
-    StaticJsonDocument<512> doc;
-    doc["batteryCapacity"] = settings.getBatteryCapacityMah();
-    doc["batteryMinVoltage"] = settings.getBatteryMinVoltage();
-    doc["batteryMaxVoltage"] = settings.getBatteryMaxVoltage();
-    doc["powerControlEnabled"] = settings.getPowerControlEnabled();
-    doc["voltageDividerRatio"] = serialized(String(settings.getVoltageDividerRatio(), 2));
-    doc["defaultVoltageDividerRatio"] = serialized(String(settings.getDefaultVoltageDividerRatio(), 2));
+    sendStreamedJson(request, "/api/config/power GET", [](ResponseJsonWriter& json) {
+        json.beginObject();
+        json.member("batteryCapacity", settings.getBatteryCapacityMah());
+        json.member("batteryMinVoltage", settings.getBatteryMinVoltage());
+        json.member("batteryMaxVoltage", settings.getBatteryMaxVoltage());
+        json.member("powerControlEnabled", settings.getPowerControlEnabled());
+        // Two decimals, as the page has always shown them.
+        json.memberFixed("voltageDividerRatio", (int32_t)lroundf(settings.getVoltageDividerRatio() * 100.0f), 2);
+        json.memberFixed("defaultVoltageDividerRatio", (int32_t)lroundf(settings.getDefaultVoltageDividerRatio() * 100.0f), 2);
 #if IS_XAG || IS_TMOTOR
-    doc["hasVoltageSensor"] = true;
+        json.member("hasVoltageSensor", true);
 #else
-    doc["hasVoltageSensor"] = false;
+        json.member("hasVoltageSensor", false);
 #endif
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
-    }
-    sendJsonResponse(request, 200, doc);
+        json.endObject();
+    });
 }
 
 void sendThermalConfigResponse(AsyncWebServerRequest* request) {
-    StaticJsonDocument<512> doc;
-    doc["motorMaxTemp"] = settings.getMotorMaxTemp();
-    doc["motorTempReductionStart"] = settings.getMotorTempReductionStart();
-    doc["escMaxTemp"] = settings.getEscMaxTemp();
-    doc["escTempReductionStart"] = settings.getEscTempReductionStart();
+    sendStreamedJson(request, "/api/config/thermal GET", [](ResponseJsonWriter& json) {
+        json.beginObject();
+        json.member("motorMaxTemp", settings.getMotorMaxTemp());
+        json.member("motorTempReductionStart", settings.getMotorTempReductionStart());
+        json.member("escMaxTemp", settings.getEscMaxTemp());
+        json.member("escTempReductionStart", settings.getEscTempReductionStart());
 #if IS_TMOTOR
-    doc["motorTempSource"] = (uint8_t)settings.getMotorTempSource();
+        json.member("motorTempSource", (uint8_t)settings.getMotorTempSource());
 #endif
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
-    }
-    sendJsonResponse(request, 200, doc);
+        json.endObject();
+    });
 }
 
 void sendBmsConfigResponse(AsyncWebServerRequest* request) {
-    StaticJsonDocument<256> doc;
-    doc["bmsType"] = settings.getBmsType();
-    doc["bmsMac"] = settings.getBmsMac();
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
+    sendStreamedJson(request, "/api/config/bms GET", [](ResponseJsonWriter& json) {
+        json.beginObject();
+        json.member("bmsType", settings.getBmsType(0));
+        json.member("bmsMac", settings.getBmsMac(0).c_str());
+        json.member("bmsType2", settings.getBmsType(1));
+        json.member("bmsMac2", settings.getBmsMac(1).c_str());
+        json.endObject();
+    });
+}
+
+// nullptr for "" or "XX:XX:XX:XX:XX:XX", else the message for the client
+const char* bmsMacFormatError(const String& s) {
+    if (s.length() == 0) {
+        return nullptr;
     }
-    sendJsonResponse(request, 200, doc);
+    if (s.length() != 17) {
+        return "O MAC do BMS deve ter 17 caracteres (XX:XX:XX:XX:XX:XX)";
+    }
+    for (int i = 0; i < 17; i++) {
+        if (i == 2 || i == 5 || i == 8 || i == 11 || i == 14) {
+            if (s[i] != ':') {
+                return "Formato do MAC do BMS: XX:XX:XX:XX:XX:XX";
+            }
+        } else {
+            const char c = s[i];
+            const bool hex = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
+            if (!hex) {
+                return "O MAC do BMS deve usar dígitos hexadecimais (0-9, A-F)";
+            }
+        }
+    }
+    return nullptr;
+}
+
+// One pack's reading: shared by /api/bms/status and /api/telemetry
+void writeBmsPackMembers(ResponseJsonWriter& json, const BmsSnapshot& bms, uint32_t now) {
+    json.member("dataAgeMs", (uint32_t)(now - bms.dataMillis));
+    json.member("voltageMv", bms.packVoltageMilliVolts);
+    json.member("currentMa", bms.packCurrentMilliAmps);
+    json.member("soc", bms.socPercent);
+    json.member("cellCount", bms.cellCount);
+    if (bms.tempCount > 0) {
+        json.member("tempMaxC", bms.tempMaxCelsius);
+    }
+    if (bms.hasCellData) {
+        json.member("cellAgeMs", (uint32_t)(now - bms.cellMillis));
+        json.member("cellMinMv", bms.cellMinMv);
+        json.member("cellMaxMv", bms.cellMaxMv);
+        json.member("cellDeltaMv", bms.cellDeltaMv);
+        json.member("cellAvgMv", bms.cellAvgMv);
+        if (bms.cellWeakest != BmsSnapshot::kNoCell) {
+            json.member("cellWeakest", bms.cellWeakest);
+        }
+    }
+}
+
+// A pack's cell tracker: this session's sag and minimums against the
+// baseline stored for its MAC, one array entry per cell
+void writeBmsCellTrend(ResponseJsonWriter& json, const BmsCellTrendReport& trend) {
+    const uint8_t cells = trend.cellCount < BmsSnapshot::kMaxCells ? trend.cellCount : BmsSnapshot::kMaxCells;
+    json.beginObject("cellTrend");
+    json.member("samples", trend.samples);
+    json.member("sessions", trend.sessions);
+    json.member("maxDeltaMv", trend.maxDeltaMv);
+    const uint8_t weakest = trend.weakestCell();
+    if (weakest != BmsSnapshot::kNoCell) {
+        json.member("weakest", weakest);
+    }
+    json.beginArray("sagUohm");
+    for (uint8_t i = 0; i < cells; i++) json.value(trend.sagUohm[i]);
+    json.endArray();
+    json.beginArray("baselineUohm");
+    for (uint8_t i = 0; i < cells; i++) json.value(trend.baselineUohm[i]);
+    json.endArray();
+    json.beginArray("minMv");
+    for (uint8_t i = 0; i < cells; i++) json.value(trend.minMv[i]);
+    json.endArray();
+    json.endObject();
+}
+
+// "packs": one entry per selected BMS, in pack order; the cell trends only
+// for /api/bms/status
+void writeBmsPacks(ResponseJsonWriter& json, uint32_t now, bool withCellTrend) {
+    json.beginArray("packs");
+    for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+        const uint8_t type = bluetoothBms.getPackType(pack);
+        if (type == BmsTypeNone) continue;
+        BmsSnapshot bms;
+        const bool hasData = bluetoothBms.getPackSnapshot(pack, bms);
+        json.beginObject();
+        json.member("index", pack);
+        json.member("type", type);
+        json.member("connected", bluetoothBms.isPackConnected(pack));
+        json.member("state", bluetoothBms.getPackState(pack));
+        json.member("hasData", hasData);
+        if (hasData) {
+            writeBmsPackMembers(json, bms, now);
+        }
+        BmsCellTrendReport trend;
+        if (withCellTrend && bluetoothBms.getPackCellTrend(pack, trend)) {
+            writeBmsCellTrend(json, trend);
+        }
+        json.endObject();
+    }
+    json.endArray();
 }
 
 // Live BLE BMS connection status + readings, polled by the /config/bms page so
 // the user can see whether the configured BMS is actually connecting/streaming.
 void sendBmsStatusResponse(AsyncWebServerRequest* request) {
-    StaticJsonDocument<512> doc;
-    const uint8_t type = settings.getBmsType();
-    const String mac = settings.getBmsMac();
-    doc["type"] = type;
-    doc["mac"] = mac;
-    doc["configured"] = (type != BmsTypeNone && mac.length() >= 17);
-    doc["connected"] = bluetoothBms.isConnected();
-    doc["state"] = bluetoothBms.getConnectionState();
-
-    const bool hasData = isBmsDataAvailable();
-    doc["hasData"] = hasData;
-    if (hasData) {
-        doc["voltageMv"] = bluetoothBms.getPackVoltageMilliVolts();
-        doc["currentMa"] = bluetoothBms.getPackCurrentMilliAmps();
-        doc["soc"] = bluetoothBms.getSoCPercent();
-        doc["cellCount"] = bluetoothBms.getCellCount();
-        if (bluetoothBms.getTempCount() > 0) {
-            int16_t maxTemp = bluetoothBms.getTempCelsius(0);
-            for (uint8_t i = 1; i < bluetoothBms.getTempCount(); i++) {
-                int16_t t = bluetoothBms.getTempCelsius(i);
-                if (t > maxTemp) maxTemp = t;
+    sendStreamedJson(request, "/api/bms/status", [](ResponseJsonWriter& json) {
+        const uint8_t type = settings.getBmsType(0);
+        const String mac = settings.getBmsMac(0);
+        json.beginObject();
+        json.member("type", type);
+        json.member("mac", mac.c_str());
+        json.member("configured", settings.isBmsConfigured(0) || settings.isBmsConfigured(1));
+        json.member("connected", bluetoothBms.isConnected());
+        json.member("state", bluetoothBms.getConnectionState());
+        json.member("pollLevel", bmsPollLevelName(bluetoothBms.getPollLevel()));
+
+        BmsSnapshot bms;
+        const bool hasData = bluetoothBms.getSnapshot(bms);
+        const uint32_t now = millis();
+        json.member("hasData", hasData);
+        if (hasData) {
+            json.member("dataAgeMs", (uint32_t)(now - bms.dataMillis));
+            json.member("voltageMv", bms.packVoltageMilliVolts);
+            json.member("currentMa", bms.packCurrentMilliAmps);
+            json.member("soc", bms.socPercent);
+            json.member("cellCount", bms.cellCount);
+            if (bms.tempCount > 0) {
+                json.member("tempC", bms.tempMaxCelsius);
+            }
+            if (bms.hasCellData) {
+                json.member("cellAgeMs", (uint32_t)(now - bms.cellMillis));
+                json.member("cellMinMv", bms.cellMinMv);
+                json.member("cellMaxMv", bms.cellMaxMv);
+                json.member("cellDeltaMv", bms.cellDeltaMv);
+                json.member("cellAvgMv", bms.cellAvgMv);
+                if (bms.cellWeakest != BmsSnapshot::kNoCell) {
+                    json.member("cellWeakest", bms.cellWeakest);
+                }
+                // Lowest voltage per cell under load, 0 = not seen under load yet
+                json.beginArray("cellLoadMinMv");
+                for (uint8_t i = 0; i < bms.cellCount && i < BmsSnapshot::kMaxCells; i++) {
+                    json.value(bms.cellLoadMinMv[i]);
+                }
+                json.endArray();
+            }
+        }
+        writeBmsPacks(json, now, true);
+        json.endObject();
+    });
+}
+
+void sendSystemConfigResponse(AsyncWebServerRequest* request) {
+    sendStreamedJson(request, "/api/config/system GET", [](ResponseJsonWriter& json) {
+        json.beginObject();
+        json.member("buzzerVolume", settings.getBuzzerVolume());
+        json.member("throttleSource", settings.getThrottleSource());
+        json.member("remoteMac", settings.getRemoteMac().c_str());
+        json.member("logRateHz", settings.getLogRateHz());
+        json.member("logReserveKb", settings.getLogReserveKb());
+        json.endObject();
+    });
+}
+
+// Members of a FlightSummary, shared by /api/telemetry (current flight) and
+// /list (per-log summaries). Unavailable groups are omitted, as in telemetry.
+template <typename Sink>
+void writeFlightSummaryMembers(JsonStreamWriter<Sink>& json, const FlightSummary& s) {
+    json.member("durationMs", s.durationMs);
+    if (s.has(FlightSummaryHasBatteryVoltage)) {
+        json.member("minBatteryVoltageMv", s.minBatteryVoltageMv);
+    }
+    if (s.has(FlightSummaryHasCurrent)) {
+        json.member("maxCurrentMa", s.maxCurrentMa);
+        json.member("meanCurrentMa", s.meanCurrentMa);
+        json.member("maxPowerW", s.maxPowerW);
+        json.member("meanPowerW", s.meanPowerW);
+        json.member("usedMah", s.usedMah);
+        json.member("usedWhX10", s.usedWhX10);
+    }
+    if (s.has(FlightSummaryHasMotorTemp)) {
+        json.member("maxMotorTempMc", s.maxMotorTempMc);
+        json.member("meanMotorTempMc", s.meanMotorTempMc);
+    }
+    if (s.has(FlightSummaryHasEscTemp)) {
+        json.member("maxEscTempMc", s.maxEscTempMc);
+        json.member("meanEscTempMc", s.meanEscTempMc);
+    }
+    if (s.has(FlightSummaryHasCells)) {
+        json.member("minCellMv", s.minCellMv);
+        json.member("maxCellDeltaMv", s.maxCellDeltaMv);
+    }
+    json.beginObject("limitMs");
+    json.member("battery", s.limitMs[FlightLimitBattery]);
+    json.member("motorTemp", s.limitMs[FlightLimitMotorTemp]);
+    json.member("escTemp", s.limitMs[FlightLimitEscTemp]);
+    json.endObject();
+}
+
+// Battery power in kW x10. 64-bit: mV x mA overflows 32 bits above ~85 A at 50 V.
+uint16_t powerKwX10From(uint16_t batteryVoltageMv, uint32_t batteryCurrentMa) {
+    const uint64_t powerMilliWatts = ((uint64_t) batteryVoltageMv * batteryCurrentMa) / 1000;
+    const uint64_t powerKwX10 = powerMilliWatts / 100000;
+    return powerKwX10 > UINT16_MAX ? (uint16_t) UINT16_MAX : (uint16_t) powerKwX10;
+}
+
+// Writes the full telemetry frame shared by GET /api/telemetry and the
+// WebSocket push channel, so both transports always carry the same fields.
+template <typename Sink>
+void writeTelemetryJson(JsonStreamWriter<Sink>& json) {
+    const bool hasTelemetry = telemetry.hasData();
+    const uint16_t batteryVoltageMv = telemetry.getBatteryVoltageMilliVolts();
+    const uint32_t batteryCurrentMa = telemetry.getBatteryCurrentMilliAmps();
+
+    // kW x10 to avoid float over JSON transport (7 => 0.7 kW)
+    const uint16_t powerKwX10 = isPowerKwAvailable() ? powerKwX10From(batteryVoltageMv, batteryCurrentMa) : 0;
+
+    json.beginObject();
+
+    // Availability: explicit flags so frontend can show N/A vs 0
+    json.beginObject("availability");
+    json.member("current", isCurrentAvailable());
+    json.member("rpm", isRpmAvailable());
+    json.member("powerKw", isPowerKwAvailable());
+    json.member("bms", isBmsDataAvailable());
+    json.member("bmsCells", isBmsCellDataAvailable());
+    json.endObject();
+
+    // Signal validity for the three power-limiting sensors — see
+    // docs/superpowers/specs/2026-08-01-signal-validity-design.md.
+    char motorTempCode[2] = { signalStateCode(telemetry.getMotorTempState()), '\0' };
+    char escTempCode[2]   = { signalStateCode(telemetry.getEscTempState()), '\0' };
+    char battVCode[2]     = { signalStateCode(telemetry.getBatteryVoltageState()), '\0' };
+    json.beginObject("signals");
+    json.member("motorTemp", motorTempCode);
+    json.member("escTemp", escTempCode);
+    json.member("battV", battVCode);
+    json.endObject();
+
+    json.member("hasTelemetry", hasTelemetry);
+    json.member("batteryPercentCc", batteryMonitor.getSoC());
+    json.member("batteryPercentVoltage", batteryMonitor.getSoCFromVoltage());
+    json.member("batteryVoltageMv", batteryVoltageMv);
+
+    if (isPowerKwAvailable()) {
+        json.member("powerKwX10", powerKwX10);
+    }
+    json.member("throttlePercent", throttle.getThrottlePercentage());
+    json.member("throttleRaw", throttle.getThrottleRaw());
+    json.member("powerPercent", power.getPower());
+    json.member("motorTempMc", telemetry.getMotorTempMilliCelsius());
+    if (isRpmAvailable()) {
+        json.member("rpm", telemetry.getRpm());
+    }
+    if (isCurrentAvailable()) {
+        json.member("escCurrentMa", batteryCurrentMa);
+    }
+    json.member("escTempMc", telemetry.getEscTempMilliCelsius());
+    json.member("armed", throttle.isArmed());
+    json.member("disarmReason", disarmReasonCode(throttle.getDisarmReason()));
+    json.member("powerScale", button.getPowerScale());
+    json.member("armCharge", button.getArmCharge());
+    json.member("uptimeMs", millis());
+    json.member("uptimeUs", Clock::nowUs());
+    json.member("lastTelemetryUpdateMs", telemetry.getLastUpdate());
+    json.member("hourMeterSec", hourMeter.getHourMeterSec());
+    json.member("sessionSec", hourMeter.getSessionSec());
+
+    json.member("bmsConnected", bluetoothBms.isConnected());
+    json.member("bmsState", bluetoothBms.getConnectionState());
+    json.member("bmsConfigured", settings.isBmsConfigured(0) || settings.isBmsConfigured(1));
+
+    // Generic Bluetooth BMS data when available
+    BmsSnapshot bms;
+    if (bluetoothBms.getSnapshot(bms)) {
+        const uint32_t now = millis();
+        json.beginObject("bms");
+        json.member("available", true);
+        json.member("pollLevel", bmsPollLevelName(bluetoothBms.getPollLevel()));
+        json.member("dataAgeMs", (uint32_t)(now - bms.dataMillis));
+        if (bms.tempCount > 0) {
+            json.member("tempMaxC", bms.tempMaxCelsius);
+        }
+        if (bms.hasCellData) {
+            json.member("cellAgeMs", (uint32_t)(now - bms.cellMillis));
+            json.member("cellMinMv", bms.cellMinMv);
+            json.member("cellMaxMv", bms.cellMaxMv);
+            json.member("cellDeltaMv", bms.cellDeltaMv);
+            json.member("cellAvgMv", bms.cellAvgMv);
+            if (bms.cellWeakest != BmsSnapshot::kNoCell) {
+                json.member("cellWeakest", bms.cellWeakest);
             }
-            doc["tempC"] = maxTemp;
         }
-        if (isBmsCellDataAvailable()) {
-            doc["cellMinMv"] = bluetoothBms.getCellMinMilliVolts();
-            doc["cellMaxMv"] = bluetoothBms.getCellMaxMilliVolts();
-            doc["cellDeltaMv"] = bluetoothBms.getCellDeltaMilliVolts();
+        if (bluetoothBms.getPackCount() > 1) {
+            json.member("currentMa", bms.packCurrentMilliAmps);
+            writeBmsPacks(json, now, false);
         }
+        json.endObject();
     }
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
+
+    {
+        uint8_t causes = powerAlert.getActiveCauses();
+        json.beginObject("powerAlert");
+        json.member("seq", powerAlert.getAlertSeq());
+        json.beginArray("causes");
+        if (causes & POWER_LIMIT_BATTERY)    json.value("battery");
+        if (causes & POWER_LIMIT_MOTOR_TEMP) json.value("motorTemp");
+        if (causes & POWER_LIMIT_ESC_TEMP)   json.value("escTemp");
+        json.endArray();
+        json.endObject();
+    }
+
+    {
+        FlightSummary summary;
+        bool inFlight = false;
+        if (flightStats.getSummary(summary, inFlight)) {
+            json.beginObject("flightStats");
+            json.member("inFlight", inFlight);
+            writeFlightSummaryMembers(json, summary);
+            json.endObject();
+        }
+    }
+
+    {
+        LogWriterStats stats;
+        logger.getStats(stats);
+        json.beginObject("logger");
+        json.member("droppedRecords", stats.droppedRecords);
+        json.member("buffersWritten", stats.buffersWritten);
+        json.member("bytesWritten", stats.bytesWritten);
+        json.member("writeErrors", stats.writeErrors);
+        json.member("maxWriteLatencyUs", stats.maxWriteLatencyUs);
+        json.member("lastWriteLatencyUs", stats.lastWriteLatencyUs);
+        json.endObject();
+    }
+
+    {
+        LogStorageHealth storage;
+        logger.getStorageHealth(storage);
+        json.beginObject("storage");
+        json.member("totalBytes", storage.totalBytes);
+        json.member("usedBytes", storage.usedBytes);
+        json.member("reserveBytes", storage.reserveBytes);
+        json.member("logsRotated", storage.logsRotated);
+        json.member("lowSpace", storage.lowSpace);
+        json.endObject();
+    }
+
+    {
+        BeepEvent evBuf[Sound::kRingSize];
+        uint8_t evCount = sound.getBeepEvents(evBuf, Sound::kRingSize);
+        json.beginArray("buzzer");
+        for (uint8_t i = 0; i < evCount; i++) {
+            json.beginObject();
+            json.member("seq",    evBuf[i].seq);
+            json.member("freq",   evBuf[i].frequency);
+            json.member("onMs",   evBuf[i].onMs);
+            json.member("offMs",  evBuf[i].offMs);
+            json.member("reps",   evBuf[i].reps);
+            json.member("layer",  evBuf[i].layer);
+            json.member("active", evBuf[i].active);
+            json.endObject();
+        }
+        json.endArray();
     }
-    sendJsonResponse(request, 200, doc);
+
+    json.endObject();
 }
 
-void sendSystemConfigResponse(AsyncWebServerRequest* request) {
-    StaticJsonDocument<256> doc;
-    doc["buzzerVolume"] = settings.getBuzzerVolume();
-    doc["throttleSource"] = settings.getThrottleSource();
-    doc["remoteMac"] = settings.getRemoteMac();
-    if (doc.overflowed()) {
-        request->send(500, "text/plain", "Estouro do buffer JSON");
-        return;
+// BMS connection state names as reported by BluetoothBms::getConnectionState();
+// the binary frame carries the index. Order is part of the binary wire format.
+const char* const BMS_STATE_NAMES[] = { "none", "idle", "connecting", "connected", "unknown" };
+
+uint8_t bmsStateIndex(const char* state) {
+    for (uint8_t i = 0; i < sizeof(BMS_STATE_NAMES) / sizeof(BMS_STATE_NAMES[0]); i++) {
+        if (strcmp(state, BMS_STATE_NAMES[i]) == 0) return i;
+    }
+    return 4; // "unknown"
+}
+
+// The live fields of writeTelemetryJson() as a TelemetryFrame for the binary
+// encoding (see Telemetry/TelemetryBinaryCodec.h). Optional fields are only
+// set() when the JSON frame would include them. JSON-only, so binary clients
+// still poll GET /api/telemetry for them: uptimeUs (the frame carries
+// uptimeMs), bms.pollLevel, bms.dataAgeMs, bms.cellAgeMs, bms.cellAvgMv,
+// bms.cellWeakest, bms.currentMa, bms.packs, flightStats, logger and storage.
+void fillTelemetryFrame(TelemetryFrame& frame) {
+    static_assert(Sound::kRingSize <= TelemetryFrame::kMaxBeeps, "beep ring must fit the binary frame");
+
+    frame.clear();
+    const uint16_t batteryVoltageMv = telemetry.getBatteryVoltageMilliVolts();
+    const uint32_t batteryCurrentMa = telemetry.getBatteryCurrentMilliAmps();
+
+    uint16_t flags = 0;
+    if (telemetry.hasData())          flags |= TelemetryFlagHasTelemetry;
+    if (throttle.isArmed())           flags |= TelemetryFlagArmed;
+    if (isCurrentAvailable())         flags |= TelemetryFlagAvCurrent;
+    if (isRpmAvailable())             flags |= TelemetryFlagAvRpm;
+    if (isPowerKwAvailable())         flags |= TelemetryFlagAvPowerKw;
+    if (isBmsDataAvailable())         flags |= TelemetryFlagAvBms;
+    if (isBmsCellDataAvailable())     flags |= TelemetryFlagAvBmsCells;
+    if (bluetoothBms.isConnected())   flags |= TelemetryFlagBmsConnected;
+    if (settings.isBmsConfigured(0) || settings.isBmsConfigured(1)) {
+        flags |= TelemetryFlagBmsConfigured;
+    }
+    frame.set(TelemetryFieldFlags, flags);
+
+    frame.set(TelemetryFieldSignals,
+              (int32_t)telemetry.getMotorTempState()
+              | ((int32_t)telemetry.getEscTempState() << 2)
+              | ((int32_t)telemetry.getBatteryVoltageState() << 4));
+
+    frame.set(TelemetryFieldBatteryPercentCc, batteryMonitor.getSoC());
+    frame.set(TelemetryFieldBatteryPercentVoltage, batteryMonitor.getSoCFromVoltage());
+    frame.set(TelemetryFieldBatteryVoltageMv, batteryVoltageMv);
+    if (isPowerKwAvailable()) {
+        frame.set(TelemetryFieldPowerKwX10, powerKwX10From(batteryVoltageMv, batteryCurrentMa));
+    }
+    frame.set(TelemetryFieldThrottlePercent, throttle.getThrottlePercentage());
+    frame.set(TelemetryFieldThrottleRaw, throttle.getThrottleRaw());
+    frame.set(TelemetryFieldPowerPercent, power.getPower());
+    frame.set(TelemetryFieldMotorTempMc, telemetry.getMotorTempMilliCelsius());
+    if (isRpmAvailable()) {
+        frame.set(TelemetryFieldRpm, telemetry.getRpm());
+    }
+    if (isCurrentAvailable()) {
+        frame.set(TelemetryFieldEscCurrentMa, (int32_t)batteryCurrentMa);
+    }
+    frame.set(TelemetryFieldEscTempMc, telemetry.getEscTempMilliCelsius());
+    frame.set(TelemetryFieldDisarmReason, (int32_t)throttle.getDisarmReason());
+    frame.set(TelemetryFieldPowerScale, button.getPowerScale());
+    frame.set(TelemetryFieldArmCharge, button.getArmCharge());
+    frame.set(TelemetryFieldUptimeMs, (int32_t)millis());
+    frame.set(TelemetryFieldLastTelemetryUpdateMs, (int32_t)telemetry.getLastUpdate());
+    frame.set(TelemetryFieldHourMeterSec, (int32_t)hourMeter.getHourMeterSec());
+    frame.set(TelemetryFieldSessionSec, (int32_t)hourMeter.getSessionSec());
+    frame.set(TelemetryFieldBmsState, bmsStateIndex(bluetoothBms.getConnectionState()));
+
+    BmsSnapshot bms;
+    if (bluetoothBms.getSnapshot(bms)) {
+        if (bms.tempCount > 0) {
+            frame.set(TelemetryFieldBmsTempMaxC, bms.tempMaxCelsius);
+        }
+        if (bms.hasCellData) {
+            frame.set(TelemetryFieldBmsCellMinMv, bms.cellMinMv);
+            frame.set(TelemetryFieldBmsCellMaxMv, bms.cellMaxMv);
+            frame.set(TelemetryFieldBmsCellDeltaMv, bms.cellDeltaMv);
+        }
+    }
+
+    frame.set(TelemetryFieldPowerAlertSeq, (int32_t)powerAlert.getAlertSeq());
+    frame.set(TelemetryFieldPowerAlertCauses, powerAlert.getActiveCauses());
+
+    BeepEvent evBuf[Sound::kRingSize];
+    const uint8_t evCount = sound.getBeepEvents(evBuf, Sound::kRingSize);
+    for (uint8_t i = 0; i < evCount; i++) {
+        TelemetryBeep& b = frame.beeps[i];
+        b.seq       = evBuf[i].seq;
+        b.frequency = evBuf[i].frequency;
+        b.onMs      = evBuf[i].onMs;
+        b.offMs     = evBuf[i].offMs;
+        b.reps      = evBuf[i].reps;
+        b.layer     = evBuf[i].layer;
+        b.active    = evBuf[i].active;
+    }
+    frame.beepCount = evCount;
+}
+
+// One JSON telemetry body as a shared buffer, or nullptr on
+// overflow/allocation failure. Callers hold pushMutex_, which also guards
+// the static scratch buffer (see ControllerWebServer::currentTelemetryJson()).
+AsyncWebSocketSharedBuffer buildTelemetryJson() {
+    // Static: keeps the 2 KB scratch buffer off the loop task stack.
+    static uint8_t scratch[TELEMETRY_JSON_CAPACITY];
+    JsonBufferSink sink(scratch, sizeof(scratch));
+    JsonStreamWriter<JsonBufferSink> json(sink);
+    writeTelemetryJson(json);
+    json.flush();
+    if (sink.overflowed()) {
+        return nullptr;
     }
-    sendJsonResponse(request, 200, doc);
+
+    // WebSocket text frames are length-delimited: no NUL terminator.
+    return std::make_shared<std::vector<uint8_t>>(scratch, scratch + sink.len);
 }
 
 // Returns true when the request carries the correct X-Config-Pin header.
@@ -219,15 +686,314 @@ bool checkPin(AsyncWebServerRequest* request) {
     if (!request->hasHeader("X-Config-Pin")) return false;
     return request->getHeader("X-Config-Pin")->value() == settings.getConfigPin();
 }
+
+// Flight logs are stored as packed binary "/X.flog" but always shown and
+// downloaded as "/X.csv". Returns the stored path for a name from /list
+// (the .flog when it exists, else the name itself: a legacy text log).
+String storedLogPath(const String& path) {
+    if (!path.endsWith(".csv")) return path;
+    String flogPath = path.substring(0, path.length() - 4) + FlightLog::kFileExtension;
+    return LittleFS.exists(flogPath) ? flogPath : path;
+}
+
+// Streams a .flog as CSV: at most one file chunk, one record and one CSV
+// line are held at a time, whatever the log size. A log the writer has
+// compressed (LogCompression.h) goes through the decoder first.
+struct CsvDownload {
+    File file;
+    bool compressed;
+    uint32_t rawSize;
+    LogCompression::Decoder decoder;
+    uint8_t raw[64];
+    size_t rawLen;
+    size_t rawPos;
+    FlightLog::CsvConverter converter;
+    uint8_t chunk[64];
+    uint32_t toMs;
+    uint32_t scanLastMs;   // ?last= on a log without a footer: find its end first
+};
+
+// /api/events page size.
+const size_t EVENTS_DEFAULT = 100;
+const size_t EVENTS_MAX = 200;
+
+// Bytes of log a fill call may scan for ?last= before yielding.
+const size_t LOG_SCAN_STEP = 2048;
+// Window parameters are whole seconds; this keeps them in u32 ms.
+const unsigned long MAX_WINDOW_SECONDS = 4000000;
+
+// Reads an optional ?from= / ?to= / ?last= in seconds. False when present
+// but not a number in range.
+bool windowParam(AsyncWebServerRequest* request, const char* name, bool& present, uint32_t& ms) {
+    present = request->hasParam(name);
+    if (!present) return true;
+    const String& value = request->getParam(name)->value();
+    char* end = nullptr;
+    const unsigned long seconds = strtoul(value.c_str(), &end, 10);
+    if (value.length() == 0 || value[0] == '-' || *end != '\0' || seconds > MAX_WINDOW_SECONDS) return false;
+    ms = (uint32_t)seconds * 1000;
+    return true;
+}
+
+// A stored file as is, honouring a single-range Range header.
+AsyncWebServerResponse* beginStoredResponse(AsyncWebServerRequest* request, const String& path, const char* type) {
+    const char* range = request->hasHeader("Range") ? request->getHeader("Range")->value().c_str() : nullptr;
+    File probe = LittleFS.open(path, "r");
+    const uint32_t size = probe ? probe.size() : 0;
+    probe.close();
+    uint32_t start = 0;
+    uint32_t length = 0;
+    const HttpRange::Result result = HttpRange::parse(range, size, start, length);
+    char contentRange[HttpRange::kMaxContentRange];
+    if (result == HttpRange::Unsatisfiable) {
+        AsyncWebServerResponse* response = request->beginResponse(416, "text/plain", "Intervalo inválido");
+        snprintf(contentRange, sizeof(contentRange), "bytes */%lu", (unsigned long)size);
+        response->addHeader("Content-Range", contentRange);
+        return response;
+    }
+    if (result == HttpRange::None) {
+        AsyncWebServerResponse* response = request->beginResponse(LittleFS, path, type);
+        response->addHeader("Accept-Ranges", "bytes");
+        return response;
+    }
+    auto file = std::make_shared<File>(LittleFS.open(path, "r"));
+    AsyncWebServerResponse* response = request->beginResponse(type, length,
+        [file, start, length](uint8_t* buffer, size_t maxLen, size_t index) -> size_t {
+            if (!*file || index >= length) return 0;
+            if (maxLen > length - index) maxLen = length - index;
+            file->seek(start + index);
+            return file->read(buffer, maxLen);
+        });
+    response->setCode(206);
+    HttpRange::formatContentRange(contentRange, sizeof(contentRange), start, length, size);
+    response->addHeader("Content-Range", contentRange);
+    response->addHeader("Accept-Ranges", "bytes");
+    return response;
+}
+
+// Positions the file after the compression header, if any.
+bool openCsvDownload(CsvDownload& download, const String& path) {
+    download.file = LittleFS.open(path, "r");
+    if (!download.file) return false;
+    uint8_t head[LogCompression::kFileHeaderSize];
+    const size_t len = download.file.read(head, sizeof(head));
+    download.compressed = LogCompression::decodeFileHeader(head, len, download.rawSize);
+    download.rawLen = 0;
+    download.rawPos = 0;
+    if (!download.compressed) download.file.seek(0);
+    return true;
+}
+
+size_t readLogBytes(CsvDownload& download, uint8_t* out, size_t want) {
+    if (!download.compressed) return download.file.read(out, want);
+    const uint32_t left = download.rawSize - download.decoder.produced();
+    if (want > left) want = left;
+    while (want > 0) {
+        const size_t n = download.decoder.read(out, want);
+        if (n > 0) return n;
+        if (download.rawPos == download.rawLen) {
+            download.rawLen = download.file.read(download.raw, sizeof(download.raw));
+            download.rawPos = 0;
+            if (download.rawLen == 0) break;
+        }
+        download.rawPos += download.decoder.push(download.raw + download.rawPos, download.rawLen - download.rawPos);
+    }
+    return 0;
+}
+
+// Reads the sync point footer of a compressed log, leaving the file where
+// it was. False for raw logs and logs compressed before footers existed.
+bool readLogFooter(CsvDownload& download, uint32_t& endMs, uint32_t& count) {
+    if (!download.compressed) return false;
+    const uint32_t fileSize = download.file.size();
+    if (fileSize < LogCompression::kFileHeaderSize + LogCompression::kTrailerSize) return false;
+    const size_t position = download.file.position();
+    uint8_t trailer[LogCompression::kTrailerSize];
+    download.file.seek(fileSize - sizeof(trailer));
+    const bool ok = download.file.read(trailer, sizeof(trailer)) == sizeof(trailer)
+                 && LogCompression::decodeTrailer(trailer, fileSize, endMs, count);
+    download.file.seek(position);
+    return ok;
+}
+
+// Rewinds to the first byte of the log, for a second pass.
+void rewindCsvDownload(CsvDownload& download) {
+    download.file.seek(download.compressed ? LogCompression::kFileHeaderSize : 0);
+    download.decoder.reset();
+    download.rawLen = 0;
+    download.rawPos = 0;
+    download.converter = FlightLog::CsvConverter();
+}
+
+// Starts a download at the window [fromMs, toMs] (offsets from the start
+// of the log). The header goes through the converter first. Then a
+// compressed log with `syncCount` footer entries jumps to the last block
+// starting at or before fromMs. Whatever is still before the window is
+// read and dropped by the converter.
+void seekCsvDownload(CsvDownload& download, uint32_t fromMs, uint32_t toMs, uint32_t syncCount) {
+    download.converter.setWindow(fromMs, toMs);
+    LogCompression::SyncPoint best = {0, 0, 0};
+    const uint32_t fileSize = download.file.size();
+    uint8_t entry[LogCompression::kSyncPointSize];
+    for (uint32_t i = 0; i < syncCount; i++) {
+        download.file.seek(LogCompression::syncPointOffset(fileSize, syncCount, i));
+        if (download.file.read(entry, sizeof(entry)) != sizeof(entry)) break;
+        LogCompression::SyncPoint s;
+        LogCompression::decodeSyncPoint(entry, s);
+        if (s.firstMs > fromMs) break;
+        best = s;
+    }
+    if (syncCount > 0) download.file.seek(LogCompression::kFileHeaderSize);
+
+    // Exactly the header, whose size depends on the log's version: nothing
+    // of the first record may be left in the converter before the jump.
+    uint8_t head[FlightLog::kHeaderSize];
+    while (download.converter.readingHeader()) {
+        const size_t n = readLogBytes(download, head, download.converter.wants());
+        if (n == 0) break;
+        download.converter.push(head, n);
+    }
+
+    if (best.rawOffset > download.decoder.produced() && best.bitOffset / 8 < fileSize) {
+        download.file.seek(best.bitOffset / 8);
+        download.decoder.reset(best.rawOffset, (uint8_t)(best.bitOffset % 8));
+        download.rawLen = 0;
+        download.rawPos = 0;
+        download.converter.resumeAt(best.firstMs);
+    }
+}
+
+// ?last= on a log without a footer: one bounded step of a pass that finds
+// the last offset. The handler set an empty window for it, so records are
+// decoded but never formatted; only the CSV header line is, once. True
+// once the download has been rewound and windowed.
+bool scanCsvDownload(CsvDownload& download) {
+    uint8_t sink[64];
+    size_t scanned = 0;
+    while (scanned < LOG_SCAN_STEP) {
+        if (download.converter.read(sink, sizeof(sink)) > 0) continue;
+        size_t want = download.converter.wants();
+        if (want == 0) break;
+        if (want > sizeof(download.chunk)) want = sizeof(download.chunk);
+        const size_t got = readLogBytes(download, download.chunk, want);
+        if (got == 0) break;
+        download.converter.push(download.chunk, got);
+        scanned += got;
+    }
+    if (scanned >= LOG_SCAN_STEP) return false;
+
+    const uint32_t endMs = download.converter.lastOffsetMs();
+    const uint32_t fromMs = endMs > download.scanLastMs ? endMs - download.scanLastMs : 0;
+    download.scanLastMs = 0;
+    rewindCsvDownload(download);
+    download.converter.setWindow(fromMs, download.toMs);
+    return true;
+}
+
+size_t fillCsvDownload(CsvDownload& download, uint8_t* buffer, size_t maxLen) {
+    if (download.scanLastMs > 0 && !scanCsvDownload(download)) return RESPONSE_TRY_AGAIN;
+    size_t written = 0;
+    while (written < maxLen) {
+        const size_t n = download.converter.read(buffer + written, maxLen - written);
+        written += n;
+        if (n > 0) continue;
+
+        size_t want = download.converter.wants();
+        if (want == 0) break;   // past the window, or failed: not a flight log
+        if (want > sizeof(download.chunk)) want = sizeof(download.chunk);
+        const size_t got = readLogBytes(download, download.chunk, want);
+        if (got == 0) break;    // end of file; a torn last record is dropped
+        download.converter.push(download.chunk, got);
+    }
+    return written;
+}
+
+// One /list element per index entry; no file is opened.
+void writeLogListFromIndex(ResponseJsonWriter& json) {
+    LogIndex::Entry entry;
+    char path[40];
+    for (size_t i = 0; logger.getLogEntry(i, entry); i++) {
+        const int pathLen = snprintf(path, sizeof(path), "/%s%s", entry.stem,
+                                     entry.kind == LogIndex::KindFlog ? ".csv" : LogIndex::extension(entry.kind));
+        if (pathLen <= 0 || pathLen >= (int)sizeof(path)) continue;
+        json.beginObject();
+        json.member("name", path);
+        json.member("size", entry.size);
+        if (entry.startEpochMs != 0) json.member("startEpoch", (uint32_t)(entry.startEpochMs / 1000));
+        FlightSummary summary;
+        if (entry.hasSummary && FlightSummaryCodec::decode(entry.summary, sizeof(entry.summary), summary)) {
+            json.beginObject("summary");
+            writeFlightSummaryMembers(json, summary);
+            json.endObject();
+        }
+        json.endObject();
+    }
+}
+
+// Fallback for /list when the index is incomplete (not loaded yet, or more
+// logs than it holds): opens every log's .sum file.
+void writeLogListFromDirectory(ResponseJsonWriter& json) {
+    File root = LittleFS.open("/");
+    if (!root) return;
+    File file = root.openNextFile();
+    char path[40];
+    char summaryPath[40];
+    while (file) {
+        const char* name = file.name();
+        size_t nameLen = strlen(name);
+        bool isCsv = nameLen > 4 && strcmp(name + nameLen - 4, ".csv") == 0;
+        bool isTxt = nameLen > 4 && strcmp(name + nameLen - 4, ".txt") == 0;
+        const size_t extLen = sizeof(FlightLog::kFileExtension) - 1;
+        bool isFlog = nameLen > extLen
+            && strcmp(name + nameLen - extLen, FlightLog::kFileExtension) == 0;
+        int pathLen = -1;
+        if (isFlog) {
+            pathLen = snprintf(path, sizeof(path), "/%.*s.csv", (int)(nameLen - extLen), name);
+        } else if (isCsv || isTxt) {
+            pathLen = snprintf(path, sizeof(path), "/%s", name);
+        }
+        if (pathLen > 0 && pathLen < (int)sizeof(path)) {
+            json.beginObject();
+            json.member("name", path);
+            json.member("size", (uint32_t)file.size());
+
+            FlightSummary summary;
+            if (FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))
+                && LittleFS.exists(summaryPath)) {
+                File sumFile = LittleFS.open(summaryPath, "r");
+                uint8_t record[FlightSummaryCodec::kEncodedSize];
+                const size_t len = sumFile ? sumFile.read(record, sizeof(record)) : 0;
+                if (sumFile) sumFile.close();
+                if (FlightSummaryCodec::decode(record, len, summary)) {
+                    json.beginObject("summary");
+                    writeFlightSummaryMembers(json, summary);
+                    json.endObject();
+                }
+            }
+            json.endObject();
+        }
+        file = root.openNextFile();
+    }
+}
 } // namespace
 
 
-ControllerWebServer::ControllerWebServer() : server(80) { // Initialize server on port 80
+ControllerWebServer::ControllerWebServer()
+    : server(80), // Initialize server on port 80
+      telemetrySocket("/ws/telemetry"),
+      frameSeq_(0),
+      telemetryJsonSeq_(0),
+      bootId_(0),
+      pushMutex_(nullptr),
+      lastTelemetryPushMs_(0),
+      lastTelemetryCleanupMs_(0) {
     isActive = true;
 }
 
 void ControllerWebServer::begin() {
     isActive = true;
+    pushMutex_ = xSemaphoreCreateMutex();
+    bootId_ = esp_random();
     startAP();
 }
 
@@ -309,10 +1075,7 @@ void ControllerWebServer::startAP() {
             memcpy(buf, data, copyLen);
             const int64_t epochMs = atoll(buf);
             if (epochMs > 1577836800000LL) { // sanity: > 2020-01-01
-                struct timeval tv;
-                tv.tv_sec  = (time_t)(epochMs / 1000);
-                tv.tv_usec = (suseconds_t)((epochMs % 1000) * 1000);
-                settimeofday(&tv, nullptr);
+                Clock::setWallClock(epochMs);
                 request->send(200, "text/plain", "OK");
             } else {
                 request->send(400, "text/plain", "Epoch inválido");
@@ -523,44 +1286,47 @@ void ControllerWebServer::startAP() {
                 return;
             }
 
-            const uint8_t bmsType = doc["bmsType"].as<uint8_t>();
-            if (bmsType > BmsTypeJk) {
-                request->send(400, "text/plain", "Tipo de BMS inválido");
-                return;
-            }
-
-            String s = doc["bmsMac"].as<const char*>() ? doc["bmsMac"].as<const char*>() : "";
-            s.trim();
-
-            if (s.length() > 0) {
-                if (s.length() != 17) {
-                    request->send(400, "text/plain", "O MAC do BMS deve ter 17 caracteres (XX:XX:XX:XX:XX:XX)");
+            // Pack 0 is required; the second pack only changes when its
+            // fields are sent, so older pages keep it as it is.
+            static const char* const kTypeKeys[kMaxBmsPacks] = { "bmsType", "bmsType2" };
+            static const char* const kMacKeys[kMaxBmsPacks] = { "bmsMac", "bmsMac2" };
+            uint8_t types[kMaxBmsPacks];
+            String macs[kMaxBmsPacks];
+            bool given[kMaxBmsPacks];
+            for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+                given[pack] = pack == 0 || (doc.containsKey(kTypeKeys[pack]) && doc.containsKey(kMacKeys[pack]));
+                types[pack] = given[pack] ? doc[kTypeKeys[pack]].as<uint8_t>() : settings.getBmsType(pack);
+                macs[pack] = given[pack] ? String(doc[kMacKeys[pack]] | "") : settings.getBmsMac(pack);
+                macs[pack].trim();
+                if (!given[pack]) continue;
+
+                if (types[pack] > BmsTypeJk) {
+                    request->send(400, "text/plain", "Tipo de BMS inválido");
                     return;
                 }
-                for (int i = 0; i < 17; i++) {
-                    if (i == 2 || i == 5 || i == 8 || i == 11 || i == 14) {
-                        if (s[i] != ':') {
-                            request->send(400, "text/plain", "Formato do MAC do BMS: XX:XX:XX:XX:XX:XX");
-                            return;
-                        }
-                    } else {
-                        const char c = s[i];
-                        const bool hex = (c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') || (c >= 'a' && c <= 'f');
-                        if (!hex) {
-                            request->send(400, "text/plain", "O MAC do BMS deve usar dígitos hexadecimais (0-9, A-F)");
-                            return;
-                        }
-                    }
+                const char* macError = bmsMacFormatError(macs[pack]);
+                if (macError != nullptr) {
+                    request->send(400, "text/plain", macError);
+                    return;
+                }
+                if (types[pack] != BmsTypeNone && macs[pack].length() != 17) {
+                    request->send(400, "text/plain", "O MAC do BMS deve ser configurado para o tipo de BMS selecionado");
+                    return;
                 }
             }
-
-            if (bmsType != BmsTypeNone && s.length() != 17) {
-                request->send(400, "text/plain", "O MAC do BMS deve ser configurado para o tipo de BMS selecionado");
-                return;
+            for (uint8_t pack = 1; pack < kMaxBmsPacks; pack++) {
+                if (types[pack] != BmsTypeNone && types[0] != BmsTypeNone
+                    && macs[pack].equalsIgnoreCase(macs[0])) {
+                    request->send(400, "text/plain", "O segundo BMS deve ter um MAC diferente do primeiro");
+                    return;
+                }
             }
 
-            settings.setBmsType(bmsType);
-            settings.setBmsMac(s.c_str());
+            for (uint8_t pack = 0; pack < kMaxBmsPacks; pack++) {
+                if (!given[pack]) continue;
+                settings.setBmsType(types[pack], pack);
+                settings.setBmsMac(macs[pack].c_str(), pack);
+            }
             settings.save();
 
             request->send(200, "text/plain", "Sucesso: Configurações do BMS salvas");
@@ -606,6 +1372,26 @@ void ControllerWebServer::startAP() {
                 settings.setThrottleSource((uint8_t)src);
             }
 
+            // Optional: flight log rate for the fast channels; applies from the next arm.
+            if (doc.containsKey("logRateHz")) {
+                int32_t rate = doc["logRateHz"];
+                if (!FlightLog::isSupportedLogRate(rate < 0 ? 0 : (uint32_t)rate)) {
+                    request->send(400, "text/plain", "logRateHz inválido (1, 10, 25 ou 50)");
+                    return;
+                }
+                settings.setLogRateHz((uint8_t)rate);
+            }
+
+            // Optional: free space kept for the next flight; oldest logs are deleted for it.
+            if (doc.containsKey("logReserveKb")) {
+                int32_t reserve = doc["logReserveKb"];
+                if (!LogStorage::isValidReserveKb(reserve < 0 ? 0 : (uint32_t)reserve)) {
+                    request->send(400, "text/plain", "logReserveKb fora do intervalo (8-64)");
+                    return;
+                }
+                settings.setLogReserveKb((uint16_t)reserve);
+            }
+
             settings.save();
             buzzer.setVolume((uint8_t)volume);
 
@@ -645,13 +1431,11 @@ void ControllerWebServer::startAP() {
     // The POST body must be { "currentPin": "xxxx", "newPin": "yyyy" }.
     // newPin must be 4-8 characters. Current PIN is validated before applying.
     server.on("/api/config/pin", HTTP_GET, [](AsyncWebServerRequest *request) {
-        StaticJsonDocument<64> doc;
-        doc["isDefault"] = (settings.getConfigPin() == "0000");
-        if (doc.overflowed()) {
-            request->send(500, "text/plain", "Estouro do buffer JSON");
-            return;
-        }
-        sendJsonResponse(request, 200, doc);
+        sendStreamedJson(request, "/api/config/pin GET", [](ResponseJsonWriter& json) {
+            json.beginObject();
+            json.member("isDefault", settings.getConfigPin() == "0000");
+            json.endObject();
+        });
     });
 
     AsyncCallbackJsonWebHandler* savePinHandler = new AsyncCallbackJsonWebHandler(
@@ -711,124 +1495,23 @@ void ControllerWebServer::startAP() {
     });
 #endif
 
-    // Telemetry API
-    server.on("/api/telemetry", HTTP_GET, [](AsyncWebServerRequest *request){
-        StaticJsonDocument<2048> doc;
-
-        const bool hasTelemetry = telemetry.hasData();
-        const uint16_t batteryVoltageMv = telemetry.getBatteryVoltageMilliVolts();
-        const uint32_t batteryCurrentMa = telemetry.getBatteryCurrentMilliAmps();
-
-        // kW x10 to avoid float over JSON transport (7 => 0.7 kW)
-        uint16_t powerKwX10 = 0;
-        if (isPowerKwAvailable()) {
-            const uint32_t powerMilliWatts = ((uint32_t) batteryVoltageMv * batteryCurrentMa) / 1000;
-            powerKwX10 = (uint16_t) (powerMilliWatts / 100000);
-        }
-
-        // Availability: explicit flags so frontend can show N/A vs 0
-        JsonObject availability = doc.createNestedObject("availability");
-        availability["current"] = isCurrentAvailable();
-        availability["rpm"] = isRpmAvailable();
-        availability["powerKw"] = isPowerKwAvailable();
-        availability["bms"] = isBmsDataAvailable();
-        availability["bmsCells"] = isBmsCellDataAvailable();
-
-        // Signal validity for the three power-limiting sensors — see
-        // docs/superpowers/specs/2026-08-01-signal-validity-design.md.
-        JsonObject signals = doc.createNestedObject("signals");
-        char motorTempCode[2] = { signalStateCode(telemetry.getMotorTempState()), '\0' };
-        char escTempCode[2]   = { signalStateCode(telemetry.getEscTempState()), '\0' };
-        char battVCode[2]     = { signalStateCode(telemetry.getBatteryVoltageState()), '\0' };
-        signals["motorTemp"] = motorTempCode;
-        signals["escTemp"] = escTempCode;
-        signals["battV"] = battVCode;
-
-        doc["hasTelemetry"] = hasTelemetry;
-        doc["batteryPercentCc"] = batteryMonitor.getSoC();
-        doc["batteryPercentVoltage"] = batteryMonitor.getSoCFromVoltage();
-        doc["batteryVoltageMv"] = batteryVoltageMv;
-
-        if (isPowerKwAvailable()) {
-            doc["powerKwX10"] = powerKwX10;
-        }
-        doc["throttlePercent"] = throttle.getThrottlePercentage();
-        doc["throttleRaw"] = throttle.getThrottleRaw();
-        doc["powerPercent"] = power.getPower();
-        doc["motorTempMc"] = telemetry.getMotorTempMilliCelsius();
-        if (isRpmAvailable()) {
-            doc["rpm"] = telemetry.getRpm();
-        }
-        if (isCurrentAvailable()) {
-            doc["escCurrentMa"] = batteryCurrentMa;
-        }
-        doc["escTempMc"] = telemetry.getEscTempMilliCelsius();
-        doc["armed"] = throttle.isArmed();
-        doc["disarmReason"] = disarmReasonCode(throttle.getDisarmReason());
-        doc["powerScale"] = button.getPowerScale();
-        doc["armCharge"] = button.getArmCharge();
-        doc["uptimeMs"] = millis();
-        doc["lastTelemetryUpdateMs"] = telemetry.getLastUpdate();
-        doc["hourMeterSec"] = hourMeter.getHourMeterSec();
-        doc["sessionSec"] = hourMeter.getSessionSec();
-
-        doc["bmsConnected"] = bluetoothBms.isConnected();
-        doc["bmsState"] = bluetoothBms.getConnectionState();
-        doc["bmsConfigured"] = (settings.getBmsType() != BmsTypeNone && settings.getBmsMac().length() >= 17);
-
-        // Generic Bluetooth BMS data when available
-        if (isBmsDataAvailable()) {
-            JsonObject bms = doc.createNestedObject("bms");
-            bms["available"] = true;
-            if (bluetoothBms.getTempCount() > 0) {
-                int16_t maxTemp = bluetoothBms.getTempCelsius(0);
-                for (uint8_t i = 1; i < bluetoothBms.getTempCount(); i++) {
-                    int16_t t = bluetoothBms.getTempCelsius(i);
-                    if (t > maxTemp) maxTemp = t;
-                }
-                bms["tempMaxC"] = maxTemp;
-            }
-            if (isBmsCellDataAvailable()) {
-                bms["cellMinMv"] = bluetoothBms.getCellMinMilliVolts();
-                bms["cellMaxMv"] = bluetoothBms.getCellMaxMilliVolts();
-                bms["cellDeltaMv"] = bluetoothBms.getCellDeltaMilliVolts();
-            }
-        }
-
-        {
-            uint8_t causes = powerAlert.getActiveCauses();
-            JsonObject pa = doc.createNestedObject("powerAlert");
-            pa["seq"] = powerAlert.getAlertSeq();
-            JsonArray causesArr = pa.createNestedArray("causes");
-            if (causes & POWER_LIMIT_BATTERY)    causesArr.add("battery");
-            if (causes & POWER_LIMIT_MOTOR_TEMP) causesArr.add("motorTemp");
-            if (causes & POWER_LIMIT_ESC_TEMP)   causesArr.add("escTemp");
-        }
-
-        {
-            BeepEvent evBuf[Sound::kRingSize];
-            uint8_t evCount = sound.getBeepEvents(evBuf, Sound::kRingSize);
-            JsonArray buzzerArr = doc.createNestedArray("buzzer");
-            for (uint8_t i = 0; i < evCount; i++) {
-                JsonObject buzzerObj = buzzerArr.createNestedObject();
-                buzzerObj["seq"]    = evBuf[i].seq;
-                buzzerObj["freq"]   = evBuf[i].frequency;
-                buzzerObj["onMs"]   = evBuf[i].onMs;
-                buzzerObj["offMs"]  = evBuf[i].offMs;
-                buzzerObj["reps"]   = evBuf[i].reps;
-                buzzerObj["layer"]  = evBuf[i].layer;
-                buzzerObj["active"] = evBuf[i].active;
-            }
-        }
+    // Telemetry push channel. The loop serialises one frame per period and
+    // fans it out (see pushTelemetry()); GET /api/telemetry below stays as the
+    // polling fallback for clients that cannot hold a socket open.
+    telemetrySocket.onEvent([this](AsyncWebSocket* socket, AsyncWebSocketClient* client,
+                                   AwsEventType type, void* arg, uint8_t* data, size_t len) {
+        onTelemetrySocketEvent(client, type, arg, data, len);
+    });
+    server.addHandler(&telemetrySocket);
 
-        if (doc.overflowed()) {
-            request->send(500, "text/plain", "Estouro do buffer JSON");
-            return;
-        }
+    // Telemetry API
+    server.on("/api/telemetry", HTTP_GET, [this](AsyncWebServerRequest *request){
+        sendJsonTelemetry(request);
+    });
 
-        String response;
-        serializeJson(doc, response);
-        request->send(200, "application/json", response);
+    // Compact binary telemetry with delta encoding (Telemetry/TelemetryBinaryCodec.h).
+    server.on("/api/telemetry.bin", HTTP_GET, [this](AsyncWebServerRequest *request){
+        sendBinaryTelemetry(request);
     });
 
     server.on("/config.css", HTTP_GET, [](AsyncWebServerRequest *request){
@@ -842,6 +1525,11 @@ void ControllerWebServer::startAP() {
             reinterpret_cast<const uint8_t*>(COMMON_JS), strlen(COMMON_JS));
     });
 
+    server.on("/telemetry-codec.js", HTTP_GET, [](AsyncWebServerRequest *request){
+        logWebHeap("/telemetry-codec.js");
+        request->send(200, "application/javascript; charset=utf-8", reinterpret_cast<const uint8_t*>(TELEMETRY_CODEC_JS), strlen_P(TELEMETRY_CODEC_JS));
+    });
+
     server.on("/dashboard.js", HTTP_GET, [](AsyncWebServerRequest *request){
         logWebHeap("/dashboard.js");
         request->send(200, "application/javascript; charset=utf-8", DASHBOARD_JS);
@@ -919,7 +1607,11 @@ void ControllerWebServer::startAP() {
     // Stream log files from LittleFS.
     // We close the logger's write handle first so LittleFS reports the correct
     // file size (avoiding a truncated Content-Length) and no concurrent handle
-    // is held during the transfer. Logger::log() reopens automatically.
+    // is held during the transfer. The log writer reopens it for its next buffer.
+    // Binary .flog logs are converted to CSV on the fly (chunked, no length),
+    // optionally only a time window: ?from=&to= seconds from the start of
+    // the log, or ?last= seconds before its end.
+    // Files sent as stored (?format=flog, legacy text logs) take a Range.
     server.on("/logs/*", HTTP_GET, [](AsyncWebServerRequest *request){
         String url = request->url(); // e.g. "/logs/20260425_001.csv"
         String filePath = url.substring(5); // strip "/logs" -> "/20260425_001.csv"
@@ -932,45 +1624,110 @@ void ControllerWebServer::startAP() {
 
         logger.closeLogFile();
 
-        if (!LittleFS.exists(filePath)) {
+        const String storedPath = storedLogPath(filePath);
+        if (!LittleFS.exists(storedPath)) {
             request->send(404, "text/plain", "Arquivo não encontrado");
             return;
         }
 
         String fileName = filePath.substring(1); // strip leading '/'
-        AsyncWebServerResponse *response = request->beginResponse(LittleFS, filePath, "text/csv");
+        AsyncWebServerResponse *response;
+        const bool isFlog = storedPath.endsWith(FlightLog::kFileExtension);
+        if (isFlog && request->hasParam("format") && request->getParam("format")->value() == "flog") {
+            // The stored file as is (compressed, several times smaller than
+            // the CSV); tools/flog2csv converts it on the computer.
+            fileName = storedPath.substring(1);
+            response = beginStoredResponse(request, storedPath, "application/octet-stream");
+        } else if (isFlog) {
+            bool hasFrom, hasTo, hasLast;
+            uint32_t fromMs = 0;
+            uint32_t toMs = UINT32_MAX;
+            uint32_t lastMs = 0;
+            if (!windowParam(request, "from", hasFrom, fromMs) || !windowParam(request, "to", hasTo, toMs)
+                || !windowParam(request, "last", hasLast, lastMs) || (hasLast && (hasFrom || lastMs == 0))
+                || fromMs > toMs) {
+                request->send(400, "text/plain", "Intervalo inválido");
+                return;
+            }
+            auto download = std::make_shared<CsvDownload>();
+            if (!openCsvDownload(*download, storedPath)) {
+                request->send(500, "text/plain", "Erro no sistema de arquivos");
+                return;
+            }
+            uint32_t endMs = 0;
+            uint32_t syncCount = 0;
+            const bool hasFooter = readLogFooter(*download, endMs, syncCount);
+            download->toMs = toMs;
+            download->scanLastMs = 0;
+            if (hasLast && !hasFooter) {
+                download->scanLastMs = lastMs;
+                // Empty window: the scan pass decodes records without formatting them
+                download->converter.setWindow(UINT32_MAX, UINT32_MAX);
+            } else {
+                if (hasLast) fromMs = endMs > lastMs ? endMs - lastMs : 0;
+                seekCsvDownload(*download, fromMs, toMs, hasFooter ? syncCount : 0);
+            }
+            response = request->beginChunkedResponse("text/csv",
+                [download](uint8_t* buffer, size_t maxLen, size_t) -> size_t {
+                    return fillCsvDownload(*download, buffer, maxLen);
+                });
+        } else {
+            response = beginStoredResponse(request, storedPath, "text/csv");
+        }
         response->addHeader("Content-Disposition", "attachment; filename=\"" + fileName + "\"");
         request->send(response);
     });
 
-    // List files API
-    server.on("/list", HTTP_GET, [](AsyncWebServerRequest *request){
-        AsyncResponseStream* resp = request->beginResponseStream("application/json");
-        if (!resp) { request->send(500, "text/plain", "Sem memória"); return; }
-
-        resp->print('[');
-        File root = LittleFS.open("/");
-        bool first = true;
-        if (root) {
-            File file = root.openNextFile();
-            char entry[80];
-            while (file) {
-                const char* name = file.name();
-                size_t nameLen = strlen(name);
-                bool isCsv = nameLen > 4 && strcmp(name + nameLen - 4, ".csv") == 0;
-                bool isTxt = nameLen > 4 && strcmp(name + nameLen - 4, ".txt") == 0;
-                if (isCsv || isTxt) {
-                    if (!first) resp->print(',');
-                    first = false;
-                    snprintf(entry, sizeof(entry), "{\"name\":\"/%s\",\"size\":%u}",
-                             name, (unsigned)file.size());
-                    resp->print(entry);
-                }
-                file = root.openNextFile();
+    // Event journal, newest first: ?limit= events (default 100, at most
+    // EVENTS_MAX). Fixed-size records: only the events sent are read.
+    server.on("/api/events", HTTP_GET, [](AsyncWebServerRequest *request){
+        size_t limit = EVENTS_DEFAULT;
+        if (request->hasParam("limit")) {
+            const long requested = request->getParam("limit")->value().toInt();
+            if (requested <= 0 || requested > (long)EVENTS_MAX) {
+                request->send(400, "text/plain", "limit fora do intervalo (1-200)");
+                return;
             }
+            limit = (size_t)requested;
         }
-        resp->print(']');
-        request->send(resp);
+        std::vector<EventJournalFormat::Event> events(limit);
+        events.resize(eventJournal.readLatest(events.data(), limit));
+        sendStreamedJson(request, "/api/events", [&events](ResponseJsonWriter& json) {
+            json.beginObject();
+            json.member("dropped", eventJournal.getDropped());
+            json.beginArray("events");
+            for (const EventJournalFormat::Event& e : events) {
+                json.beginObject();
+                json.member("uptimeUs", e.uptimeUs);
+                if (e.epochS != 0) json.member("epoch", e.epochS);
+                json.member("code", EventJournalFormat::eventCode(e.id));
+                json.member("arg", e.arg);
+                if (e.value != 0) json.member("value", e.value);
+                if (e.id == EventJournalFormat::EventDisarmed) {
+                    json.member("reason", disarmReasonCode((DisarmReason)e.arg));
+                }
+                json.endObject();
+            }
+            json.endArray();
+            json.endObject();
+        });
+    });
+
+    // List files API. Each log carries its flight summary when FlightStats
+    // wrote one at disarm. Binary .flog logs are listed under their .csv
+    // download name; size is the stored size. Served from the logger's
+    // index in one pass; the directory is only walked when the index does
+    // not cover every file.
+    server.on("/list", HTTP_GET, [](AsyncWebServerRequest *request){
+        sendStreamedJson(request, "/list", [](ResponseJsonWriter& json) {
+            json.beginArray();
+            if (logger.isLogIndexComplete()) {
+                writeLogListFromIndex(json);
+            } else {
+                writeLogListFromDirectory(json);
+            }
+            json.endArray();
+        });
     });
 
     // Delete file API
@@ -984,9 +1741,16 @@ void ControllerWebServer::startAP() {
                 return;
             }
             if(!filename.startsWith("/")) filename = "/" + filename;
+            filename = storedLogPath(filename);
 
             if(LittleFS.exists(filename)){
                 LittleFS.remove(filename);
+                char summaryPath[40];
+                if (FlightSummaryCodec::summaryPathFor(filename.c_str(), summaryPath, sizeof(summaryPath))
+                    && LittleFS.exists(summaryPath)) {
+                    LittleFS.remove(summaryPath);
+                }
+                logger.afterLogFileRemoved(filename.c_str());
                 request->send(200, "text/plain", "Excluído");
             } else {
                 request->send(404, "text/plain", "Arquivo não encontrado");
@@ -998,26 +1762,40 @@ void ControllerWebServer::startAP() {
 
     server.on("/delete-all-logs", HTTP_GET, [](AsyncWebServerRequest *request){
         if (!checkPin(request)) { request->send(403, "text/plain", "Invalid PIN"); return; }
-        File root = LittleFS.open("/");
-        if (!root) {
-            request->send(500, "text/plain", "Erro no sistema de arquivos");
-            return;
-        }
         std::vector<String> toDelete;
-        File file = root.openNextFile();
-        while (file) {
-            String fileName = String(file.name());
-            if (!fileName.startsWith("/")) {
-                fileName = "/" + fileName;
+        if (logger.isLogIndexComplete()) {
+            LogIndex::Entry entry;
+            char path[40];
+            char summaryPath[40];
+            for (size_t i = 0; logger.getLogEntry(i, entry); i++) {
+                if (!LogIndex::pathFor(entry, path, sizeof(path))) continue;
+                toDelete.push_back(String(path));
+                if (FlightSummaryCodec::summaryPathFor(path, summaryPath, sizeof(summaryPath))) {
+                    toDelete.push_back(String(summaryPath));
+                }
             }
-            if (fileName.endsWith(".csv") || fileName.endsWith(".txt")) {
-                toDelete.push_back(fileName);
+        } else {
+            File root = LittleFS.open("/");
+            if (!root) {
+                request->send(500, "text/plain", "Erro no sistema de arquivos");
+                return;
+            }
+            File file = root.openNextFile();
+            while (file) {
+                String fileName = String(file.name());
+                if (!fileName.startsWith("/")) {
+                    fileName = "/" + fileName;
+                }
+                if (fileName.endsWith(".csv") || fileName.endsWith(".txt") || fileName.endsWith(".sum")
+                    || fileName.endsWith(FlightLog::kFileExtension)) {
+                    toDelete.push_back(fileName);
+                }
+                file = root.openNextFile();
             }
-            file = root.openNextFile();
+            root.close();
         }
-        root.close();
         for (const String& name : toDelete) {
-            LittleFS.remove(name);
+            if (LittleFS.exists(name)) LittleFS.remove(name);
         }
         logger.afterLogFilesClearedFromStorage();
         request->send(200, "text/plain", "OK");
@@ -1089,5 +1867,276 @@ void ControllerWebServer::handleClient() {
     if (isActive) {
         ElegantOTA.loop(); // Process ElegantOTA events only if the server is active
         dnsServer.processNextRequest(); // Only process DNS when WiFi is active
+        pushTelemetry();
+    }
+}
+
+// Runs on the AsyncTCP task. Only bookkeeping here — never build or send a
+// frame from this context, the loop task owns serialisation.
+void ControllerWebServer::onTelemetrySocketEvent(AsyncWebSocketClient* client, AwsEventType type,
+                                                 void* arg, uint8_t* data, size_t len) {
+    if (pushMutex_ == nullptr) return;
+
+    switch (type) {
+        case WS_EVT_CONNECT: {
+            xSemaphoreTake(pushMutex_, portMAX_DELAY);
+            const bool added = pushSchedule_.addClient(client->id(), TELEMETRY_PUSH_INTERVAL_MS);
+            xSemaphoreGive(pushMutex_);
+            if (!added) {
+                // Table full: the page falls back to polling /api/telemetry.
+                client->close();
+            }
+            break;
+        }
+        case WS_EVT_DISCONNECT:
+            xSemaphoreTake(pushMutex_, portMAX_DELAY);
+            pushSchedule_.removeClient(client->id());
+            xSemaphoreGive(pushMutex_);
+            break;
+        case WS_EVT_DATA: {
+            // Single-frame text messages only: "interval:<ms>", "format:bin"
+            // or "keyframe" (a binary frame failed to decode: resync).
+            const AwsFrameInfo* info = static_cast<const AwsFrameInfo*>(arg);
+            if (!info->final || info->index != 0 || info->len != len || info->opcode != WS_TEXT) break;
+            static const char INTERVAL_PREFIX[] = "interval:";
+            static const char FORMAT_BINARY[] = "format:bin";
+            static const char KEYFRAME[] = "keyframe";
+            const size_t prefixLen = sizeof(INTERVAL_PREFIX) - 1;
+            char buf[24] = {0};
+            const size_t copyLen = len < sizeof(buf) - 1 ? len : sizeof(buf) - 1;
+            memcpy(buf, data, copyLen);
+            if (strcmp(buf, FORMAT_BINARY) == 0) {
+                xSemaphoreTake(pushMutex_, portMAX_DELAY);
+                pushSchedule_.setClientBinary(client->id(), true);
+                xSemaphoreGive(pushMutex_);
+                break;
+            }
+            if (strcmp(buf, KEYFRAME) == 0) {
+                xSemaphoreTake(pushMutex_, portMAX_DELAY);
+                pushSchedule_.requestKeyframe(client->id());
+                xSemaphoreGive(pushMutex_);
+                break;
+            }
+            if (strncmp(buf, INTERVAL_PREFIX, prefixLen) != 0) break;
+            const uint32_t requestedMs = (uint32_t)strtoul(buf + prefixLen, nullptr, 10);
+            xSemaphoreTake(pushMutex_, portMAX_DELAY);
+            pushSchedule_.setClientInterval(client->id(), requestedMs,
+                                            TELEMETRY_PUSH_INTERVAL_MS, TELEMETRY_PUSH_MAX_INTERVAL_MS);
+            xSemaphoreGive(pushMutex_);
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+// Serialise-once fan-out: one telemetry frame per period regardless of how
+// many clients are connected. Every client's send queue holds a reference to
+// the same shared buffer, so N clients cost one serialisation and one heap
+// allocation instead of N of each. Binary clients get a delta against the
+// frame they last received; clients sharing a base share the encoding too.
+void ControllerWebServer::pushTelemetry() {
+    const unsigned long now = millis();
+
+    if (now - lastTelemetryCleanupMs_ >= TELEMETRY_CLEANUP_INTERVAL_MS) {
+        lastTelemetryCleanupMs_ = now;
+        telemetrySocket.cleanupClients(TelemetryPushSchedule::kMaxClients);
+    }
+
+    if (now - lastTelemetryPushMs_ < TELEMETRY_PUSH_INTERVAL_MS) {
+        return;
+    }
+    lastTelemetryPushMs_ = now;
+
+    if (pushMutex_ == nullptr) {
+        return;
+    }
+
+    // Snapshot every period, clients or not: /api/telemetry.bin serves
+    // deltas against this history.
+    static TelemetryFrame frame;
+    fillTelemetryFrame(frame);
+    xSemaphoreTake(pushMutex_, portMAX_DELAY);
+    if (++frameSeq_ == 0) frameSeq_ = 1; // 0 means "no frame" to the codec
+    frame.seq = frameSeq_;
+    frameHistory_.push(frame);
+    xSemaphoreGive(pushMutex_);
+
+    if (telemetrySocket.count() == 0) {
+        return;
+    }
+
+    AsyncWebSocketSharedBuffer jsonFrame;
+    struct BinaryEncoding {
+        uint32_t baseSeq;
+        AsyncWebSocketSharedBuffer buffer;
+    } binaryFrames[TelemetryPushSchedule::kMaxClients];
+    uint8_t binaryFrameCount = 0;
+
+    // The AsyncTCP task adds and deletes clients as they come and go, so no
+    // client pointer is held here: the ids come from the schedule (kept by
+    // the same connect/disconnect events, under pushMutex_) and the socket's
+    // id-based calls look each one up under its own lock. To a client
+    // already gone the send simply fails.
+    uint32_t clientIds[TelemetryPushSchedule::kMaxClients];
+    xSemaphoreTake(pushMutex_, portMAX_DELAY);
+    const uint8_t clientCount = pushSchedule_.copyClientIds(clientIds, TelemetryPushSchedule::kMaxClients);
+    xSemaphoreGive(pushMutex_);
+
+    for (uint8_t c = 0; c < clientCount; c++) {
+        const uint32_t id = clientIds[c];
+        // Full queue (WS_MAX_QUEUED_MESSAGES, platformio.ini): skip this frame
+        const bool writable = telemetrySocket.availableForWrite(id);
+
+        xSemaphoreTake(pushMutex_, portMAX_DELAY);
+        const bool send = pushSchedule_.shouldSend(id, now, writable);
+        const bool binary = pushSchedule_.isClientBinary(id);
+        const uint32_t baseSeq = pushSchedule_.getLastFrameSeq(id);
+        xSemaphoreGive(pushMutex_);
+
+        if (!send) continue;
+
+        if (!binary) {
+            if (!jsonFrame) jsonFrame = currentTelemetryJson(nullptr);
+            if (jsonFrame) telemetrySocket.text(id, jsonFrame);
+            continue;
+        }
+
+        // frameHistory_ is only written by this task, so no lock to read it.
+        const TelemetryFrame* base = frameHistory_.find(baseSeq);
+        const uint32_t encodedBase = base ? base->seq : 0;
+        AsyncWebSocketSharedBuffer encoded;
+        for (uint8_t i = 0; i < binaryFrameCount; i++) {
+            if (binaryFrames[i].baseSeq == encodedBase) encoded = binaryFrames[i].buffer;
+        }
+        if (!encoded) {
+            uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+            const size_t len = TelemetryBinary::encode(frame, base, buf, sizeof(buf));
+            if (len == 0) continue;
+            encoded = std::make_shared<std::vector<uint8_t>>(buf, buf + len);
+            if (binaryFrameCount < TelemetryPushSchedule::kMaxClients) {
+                binaryFrames[binaryFrameCount].baseSeq = encodedBase;
+                binaryFrames[binaryFrameCount].buffer = encoded;
+                binaryFrameCount++;
+            }
+        }
+        // The base of the next delta only once the frame is queued
+        if (telemetrySocket.binary(id, encoded)) {
+            xSemaphoreTake(pushMutex_, portMAX_DELAY);
+            pushSchedule_.markFrameSent(id, frame.seq);
+            xSemaphoreGive(pushMutex_);
+        }
+    }
+}
+
+// GET /api/telemetry.bin?ack=<seq>: the latest snapshot, delta-encoded
+// against frame <seq> when the client still holds it and it is in the
+// history, otherwise a keyframe. Runs on the AsyncTCP task.
+void ControllerWebServer::sendBinaryTelemetry(AsyncWebServerRequest* request) {
+    uint32_t ackSeq = 0;
+    if (request->hasParam("ack")) {
+        ackSeq = (uint32_t)strtoul(request->getParam("ack")->value().c_str(), nullptr, 10);
+    }
+
+    TelemetryFrame current;
+    TelemetryFrame base;
+    bool haveCurrent = false;
+    bool haveBase = false;
+    if (pushMutex_ != nullptr) {
+        xSemaphoreTake(pushMutex_, portMAX_DELAY);
+        const TelemetryFrame* latest = frameHistory_.latest();
+        if (latest != nullptr) {
+            current = *latest;
+            haveCurrent = true;
+            const TelemetryFrame* acked = frameHistory_.find(ackSeq);
+            if (acked != nullptr && acked->seq != latest->seq) {
+                base = *acked;
+                haveBase = true;
+            }
+        }
+        xSemaphoreGive(pushMutex_);
+    }
+
+    if (!haveCurrent) {
+        request->send(503, "text/plain", "Telemetria indisponível");
+        return;
+    }
+
+    uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+    const size_t len = TelemetryBinary::encode(current, haveBase ? &base : nullptr, buf, sizeof(buf));
+    if (len == 0) {
+        request->send(500, "text/plain", "Estouro do buffer binário");
+        return;
+    }
+
+    // Stream response copies buf, which lives on this stack frame.
+    AsyncResponseStream* response = request->beginResponseStream("application/octet-stream");
+    if (response == nullptr) {
+        request->send(500, "text/plain", "Sem memória");
+        return;
     }
+    response->addHeader("Cache-Control", "no-store");
+    response->write(buf, len);
+    request->send(response);
+}
+
+// The JSON body for the current push period, serialised by whichever task
+// asks first and reused until the loop takes the next snapshot. Sets
+// *generation (when non-null) to the frameSeq_ the body belongs to.
+AsyncWebSocketSharedBuffer ControllerWebServer::currentTelemetryJson(uint32_t* generation) {
+    if (pushMutex_ == nullptr) {
+        return nullptr;
+    }
+    // Serialising under the lock makes concurrent callers wait for the one
+    // build instead of repeating it; the writer never calls into AsyncTCP.
+    xSemaphoreTake(pushMutex_, portMAX_DELAY);
+    if (!telemetryJson_ || telemetryJsonSeq_ != frameSeq_) {
+        telemetryJson_ = buildTelemetryJson();
+        telemetryJsonSeq_ = frameSeq_;
+    }
+    AsyncWebSocketSharedBuffer body = telemetryJson_;
+    if (generation != nullptr) *generation = telemetryJsonSeq_;
+    xSemaphoreGive(pushMutex_);
+    return body;
+}
+
+// GET /api/telemetry: the cached body for the current push period, or 304
+// when If-None-Match already names it. Runs on the AsyncTCP task.
+void ControllerWebServer::sendJsonTelemetry(AsyncWebServerRequest* request) {
+    uint32_t generation = 0;
+    AsyncWebSocketSharedBuffer body = currentTelemetryJson(&generation);
+    if (!body) {
+        request->send(500, "text/plain", "Estouro do buffer JSON");
+        return;
+    }
+
+    char etag[ETag::kMaxLength];
+    ETag::format(etag, sizeof(etag), bootId_, generation);
+    if (request->hasHeader("If-None-Match")
+        && ETag::matches(request->getHeader("If-None-Match")->value().c_str(), etag)) {
+        AsyncWebServerResponse* notModified = request->beginResponse(304);
+        notModified->addHeader("ETag", etag);
+        notModified->addHeader("Cache-Control", "no-cache");
+        request->send(notModified);
+        return;
+    }
+
+    // The filler keeps the shared body alive until it has been sent, so the
+    // bytes go from the cache to the socket without another copy.
+    AsyncWebServerResponse* response = request->beginResponse(
+        "application/json", body->size(),
+        [body](uint8_t* out, size_t maxLen, size_t index) -> size_t {
+            if (index >= body->size()) return 0;
+            const size_t n = std::min(maxLen, body->size() - index);
+            memcpy(out, body->data() + index, n);
+            return n;
+        });
+    if (response == nullptr) {
+        request->send(500, "text/plain", "Sem memória");
+        return;
+    }
+    response->addHeader("ETag", etag);
+    // Browsers may keep the body but must revalidate: it expires every push period.
+    response->addHeader("Cache-Control", "no-cache");
+    request->send(response);
 }
@@ -7,6 +7,8 @@
 #include <ESPAsyncWebServer.h>
 #include <ElegantOTA.h>
 #include <DNSServer.h>
+#include "TelemetryPushLogic.h"
+#include "../Telemetry/TelemetryBinaryCodec.h"
 
 class ControllerWebServer {
 public:
@@ -15,10 +17,43 @@ public:
     void handleClient();
 
 private:
+    // Push period for /ws/telemetry. Clients may ask for a slower rate
+    // ("interval:<ms>" text message) up to TELEMETRY_PUSH_MAX_INTERVAL_MS.
+    static const uint16_t TELEMETRY_PUSH_INTERVAL_MS = 500;
+    static const uint16_t TELEMETRY_PUSH_MAX_INTERVAL_MS = 5000;
+    // AsyncWebSocket::cleanupClients() cadence, reclaiming dropped sockets.
+    static const unsigned long TELEMETRY_CLEANUP_INTERVAL_MS = 2000;
+    // Binary frames kept for delta encoding: 4 s of history at the push rate,
+    // enough for a 1 Hz poller; older acks get a keyframe.
+    static const uint8_t TELEMETRY_FRAME_HISTORY = 8;
+
     void startAP(); // Declare the private method
+    void onTelemetrySocketEvent(AsyncWebSocketClient* client, AwsEventType type, void* arg, uint8_t* data, size_t len);
+    void pushTelemetry();
+    void sendBinaryTelemetry(AsyncWebServerRequest* request);
+    void sendJsonTelemetry(AsyncWebServerRequest* request);
+    AsyncWebSocketSharedBuffer currentTelemetryJson(uint32_t* generation);
     bool isActive;
     AsyncWebServer server;
+    AsyncWebSocket telemetrySocket;
     DNSServer dnsServer;
+
+    // Touched from the AsyncTCP task (connect/disconnect/interval requests,
+    // /api/telemetry.bin) and the loop task (fan-out), so guarded by
+    // pushMutex_. frameHistory_ is written only by the loop task.
+    TelemetryPushSchedule pushSchedule_;
+    TelemetryFrameHistory<TELEMETRY_FRAME_HISTORY> frameHistory_;
+    uint32_t frameSeq_;
+    // Last serialised JSON telemetry body and the frameSeq_ it was built
+    // for, shared by GET /api/telemetry and JSON WebSocket clients so each
+    // push period is serialised at most once. Guarded by pushMutex_.
+    AsyncWebSocketSharedBuffer telemetryJson_;
+    uint32_t telemetryJsonSeq_;
+    // Random per boot; part of the /api/telemetry ETag (see ETagLogic.h).
+    uint32_t bootId_;
+    SemaphoreHandle_t pushMutex_;
+    unsigned long lastTelemetryPushMs_;
+    unsigned long lastTelemetryCleanupMs_;
 };
 
 #endif // CONTROLLER_WEBSERVER_H
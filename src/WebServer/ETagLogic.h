@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Pure ETag helpers for cached API responses -- no Arduino deps,
+// host-testable.
+//
+// A cached body is identified by the generation it was built for (the
+// telemetry frame sequence number). The generation restarts at every boot,
+// so the tag also carries a per-boot id: a browser holding "…-5" from before
+// a reboot must not get a 304 for the new boot's frame 5.
+namespace ETag {
+
+// Longest tag format() writes, including quotes and NUL.
+static const size_t kMaxLength = 2 + 8 + 1 + 10 + 1;
+
+// Writes the quoted tag "<bootId hex>-<generation>". Returns its length,
+// or 0 if `cap` is too small.
+inline size_t format(char* out, size_t cap, uint32_t bootId, uint32_t generation) {
+    const int n = snprintf(out, cap, "\"%08lx-%lu\"", (unsigned long)bootId, (unsigned long)generation);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    return (size_t)n;
+}
+
+// True when an If-None-Match header value matches `etag` (quoted, as
+// produced by format()). Handles lists ("a", "b"), "*" and weak W/ tags --
+// If-None-Match always uses the weak comparison (RFC 9110 13.1.2).
+inline bool matches(const char* ifNoneMatch, const char* etag) {
+    if (ifNoneMatch == nullptr || etag == nullptr) return false;
+    const size_t etagLen = strlen(etag);
+    const char* p = ifNoneMatch;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t' || *p == ',') p++;
+        if (*p == '\0') break;
+        const char* start = p;
+        while (*p != '\0' && *p != ',') p++;
+        const char* end = p;
+        while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+        if (end - start == 1 && *start == '*') return true;
+        if (end - start > 2 && start[0] == 'W' && start[1] == '/') start += 2;
+        if ((size_t)(end - start) == etagLen && memcmp(start, etag, etagLen) == 0) return true;
+    }
+    return false;
+}
+
+} // namespace ETag
@@ -0,0 +1,85 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+// Pure HTTP Range helpers for log downloads -- no Arduino deps,
+// host-testable.
+//
+// Only a single byte range is served ("bytes=a-b", "bytes=a-", "bytes=-n",
+// RFC 9110 14.1.2). Anything else -- other units, lists of ranges, syntax
+// errors -- is answered with the whole file, which the RFC allows.
+namespace HttpRange {
+
+enum Result : uint8_t {
+    None,            // no usable Range: send 200 with the whole file
+    Satisfiable,     // send 206 with [start, start + length)
+    Unsatisfiable,   // send 416 with "bytes */size"
+};
+
+// Longest Content-Range value formatContentRange() writes, NUL included.
+static const size_t kMaxContentRange = 6 + 10 + 1 + 10 + 1 + 10 + 1;
+
+// Reads a decimal position; false on no digits or overflow.
+inline bool parsePosition(const char*& p, uint32_t& out) {
+    if (*p < '0' || *p > '9') return false;
+    uint64_t v = 0;
+    while (*p >= '0' && *p <= '9') {
+        v = v * 10 + (uint64_t)(*p++ - '0');
+        if (v > UINT32_MAX) return false;
+    }
+    out = (uint32_t)v;
+    return true;
+}
+
+inline Result parse(const char* header, uint32_t size, uint32_t& start, uint32_t& length) {
+    if (header == nullptr) return None;
+    const char* p = header;
+    while (*p == ' ') p++;
+    if (strncmp(p, "bytes=", 6) != 0) return None;
+    p += 6;
+    while (*p == ' ') p++;
+
+    uint32_t first = 0;
+    uint32_t last = 0;
+    bool hasFirst = false;
+    bool hasLast = false;
+    if (*p != '-') {
+        if (!parsePosition(p, first)) return None;
+        hasFirst = true;
+    }
+    if (*p++ != '-') return None;
+    if (*p >= '0' && *p <= '9') {
+        if (!parsePosition(p, last)) return None;
+        hasLast = true;
+    }
+    while (*p == ' ') p++;
+    if (*p != '\0') return None;          // a list, or trailing junk
+    if (!hasFirst && !hasLast) return None;
+    if (hasFirst && hasLast && last < first) return None;
+
+    if (!hasFirst) {                      // suffix: the last `last` bytes
+        if (last == 0 || size == 0) return Unsatisfiable;
+        length = last < size ? last : size;
+        start = size - length;
+        return Satisfiable;
+    }
+    if (first >= size) return Unsatisfiable;
+    if (!hasLast || last >= size) last = size - 1;
+    start = first;
+    length = last - first + 1;
+    return Satisfiable;
+}
+
+// "bytes a-b/size" for a 206 response. Returns the length, or 0 if `cap`
+// is too small.
+inline size_t formatContentRange(char* out, size_t cap, uint32_t start, uint32_t length, uint32_t size) {
+    const int n = snprintf(out, cap, "bytes %lu-%lu/%lu", (unsigned long)start,
+                           (unsigned long)(start + length - 1), (unsigned long)size);
+    if (n < 0 || (size_t)n >= cap) return 0;
+    return (size_t)n;
+}
+
+} // namespace HttpRange
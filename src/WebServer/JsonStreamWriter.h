@@ -0,0 +1,236 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+#include <type_traits>
+
+// Streaming JSON writer -- no Arduino deps, host-testable.
+//
+// Emits JSON straight into a sink as members are written: no document tree,
+// no intermediate String, no heap allocation of its own. The GET endpoints
+// used to build an ArduinoJson DOM (up to 2 KB on the AsyncTCP stack), check
+// overflowed(), serialise into a String and copy that into the response; with
+// this writer the only buffer is the response's own.
+//
+// Sink is anything with `size_t write(const uint8_t* data, size_t len)` --
+// Arduino's Print (so AsyncResponseStream) on the device, the sinks below on
+// the host. Output is staged in a small internal buffer so the sink sees a
+// few large writes instead of one per token; call flush() when done.
+//
+// Keys are string literals: their length is a compile-time constant, so a key
+// costs one memcpy, never a strlen. Keys are written verbatim (no escaping),
+// which is fine for literals; string *values* are escaped.
+template <typename Sink>
+class JsonStreamWriter {
+public:
+    static const size_t kStageSize = 64;
+
+    explicit JsonStreamWriter(Sink& sink)
+        : sink_(sink), staged_(0), written_(0), depth_(0), commaMask_(0), afterKey_(false) {}
+
+    void beginObject() { prefix(); put('{'); push(); }
+    void endObject()   { pop(); put('}'); }
+    void beginArray()  { prefix(); put('['); push(); }
+    void endArray()    { pop(); put(']'); }
+
+    template <size_t N>
+    void key(const char (&name)[N]) {
+        prefix();
+        put('"');
+        putRaw(name, N - 1);
+        putRaw("\":", 2);
+        afterKey_ = true;
+    }
+
+    template <size_t N>
+    void beginObject(const char (&name)[N]) { key(name); beginObject(); }
+
+    template <size_t N>
+    void beginArray(const char (&name)[N]) { key(name); beginArray(); }
+
+    void value(bool v) {
+        prefix();
+        if (v) putRaw("true", 4); else putRaw("false", 5);
+    }
+
+    void value(const char* s) {
+        prefix();
+        put('"');
+        putEscaped(s);
+        put('"');
+    }
+
+    void value(char* s) { value(static_cast<const char*>(s)); }
+
+    template <typename T,
+              typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, int>::type = 0>
+    void value(T v) {
+        prefix();
+        putInteger(v, std::is_signed<T>());
+    }
+
+    // Fixed-point number: valueFixed(2313, 2) writes 23.13. Avoids float
+    // formatting for values the firmware already keeps scaled.
+    void valueFixed(int32_t scaled, uint8_t decimals) {
+        prefix();
+        uint32_t magnitude = scaled < 0 ? (uint32_t)0 - (uint32_t)scaled : (uint32_t)scaled;
+        if (scaled < 0) put('-');
+        uint32_t divisor = 1;
+        for (uint8_t i = 0; i < decimals; i++) divisor *= 10;
+        putUnsigned(magnitude / divisor);
+        if (decimals == 0) return;
+        put('.');
+        uint32_t frac = magnitude % divisor;
+        for (uint32_t d = divisor / 10; d > 0; d /= 10) {
+            put((char)('0' + (frac / d) % 10));
+        }
+    }
+
+    void valueNull() { prefix(); putRaw("null", 4); }
+
+    template <size_t N, typename T>
+    void member(const char (&name)[N], T v) { key(name); value(v); }
+
+    template <size_t N>
+    void memberFixed(const char (&name)[N], int32_t scaled, uint8_t decimals) { key(name); valueFixed(scaled, decimals); }
+
+    // Hands any staged bytes to the sink. Must be called once the document
+    // is complete; safe to call more than once.
+    void flush() {
+        if (staged_ > 0) {
+            sink_.write(stage_, staged_);
+            staged_ = 0;
+        }
+    }
+
+    size_t bytesWritten() const { return written_; }
+
+private:
+    Sink&    sink_;
+    uint8_t  stage_[kStageSize];
+    size_t   staged_;
+    size_t   written_;
+    uint8_t  depth_;
+    uint32_t commaMask_;   // bit d set: container at depth d already has an element
+    bool     afterKey_;
+
+    void push() {
+        depth_++;
+        commaMask_ &= ~(1UL << (depth_ & 31));
+    }
+
+    void pop() {
+        if (depth_ > 0) depth_--;
+    }
+
+    // Separator before a key or a value: nothing right after a key, a comma
+    // before every element but the first of its container.
+    void prefix() {
+        if (afterKey_) {
+            afterKey_ = false;
+            return;
+        }
+        const uint32_t bit = 1UL << (depth_ & 31);
+        if (commaMask_ & bit) put(',');
+        commaMask_ |= bit;
+    }
+
+    void put(char c) {
+        if (staged_ == kStageSize) flush();
+        stage_[staged_++] = (uint8_t)c;
+        written_++;
+    }
+
+    // Tops up the stage before flushing, so the sink sees full kStageSize
+    // writes; a run at least a stage long goes to the sink directly.
+    void putRaw(const char* s, size_t len) {
+        written_ += len;
+        while (len > 0) {
+            if (staged_ == 0 && len >= kStageSize) {
+                sink_.write(reinterpret_cast<const uint8_t*>(s), len);
+                return;
+            }
+            size_t n = kStageSize - staged_;
+            if (n > len) n = len;
+            memcpy(stage_ + staged_, s, n);
+            staged_ += n;
+            s += n;
+            len -= n;
+            if (staged_ == kStageSize) flush();
+        }
+    }
+
+    template <typename T>
+    void putInteger(T v, std::true_type) {
+        if (v < 0) {
+            put('-');
+            // Negate in unsigned space: correct for the minimum value too.
+            putUnsigned(static_cast<uint64_t>(0) - static_cast<uint64_t>(static_cast<int64_t>(v)));
+        } else {
+            putUnsigned(static_cast<uint64_t>(v));
+        }
+    }
+
+    template <typename T>
+    void putInteger(T v, std::false_type) { putUnsigned(static_cast<uint64_t>(v)); }
+
+    void putUnsigned(uint64_t v) {
+        char digits[20];
+        uint8_t n = 0;
+        if (v <= 0xFFFFFFFFULL) {
+            // 32-bit division is much cheaper than 64-bit on the C3.
+            uint32_t v32 = (uint32_t)v;
+            do { digits[n++] = (char)('0' + v32 % 10); v32 /= 10; } while (v32 != 0);
+        } else {
+            do { digits[n++] = (char)('0' + v % 10); v /= 10; } while (v != 0);
+        }
+        while (n > 0) put(digits[--n]);
+    }
+
+    void putEscaped(const char* s) {
+        if (s == nullptr) return;
+        static const char HEX_DIGITS[] = "0123456789abcdef";
+        for (; *s != '\0'; s++) {
+            const unsigned char c = (unsigned char)*s;
+            switch (c) {
+                case '"':  putRaw("\\\"", 2); break;
+                case '\\': putRaw("\\\\", 2); break;
+                case '\n': putRaw("\\n", 2); break;
+                case '\r': putRaw("\\r", 2); break;
+                case '\t': putRaw("\\t", 2); break;
+                default:
+                    if (c < 0x20) {
+                        putRaw("\\u00", 4);
+                        put(HEX_DIGITS[c >> 4]);
+                        put(HEX_DIGITS[c & 0x0F]);
+                    } else {
+                        put((char)c);
+                    }
+            }
+        }
+    }
+};
+
+// Fixed-capacity sink: writes into caller-owned memory and latches
+// overflowed() instead of writing past the end.
+struct JsonBufferSink {
+    uint8_t* buf;
+    size_t   cap;
+    size_t   len;
+    bool     overflow;
+
+    JsonBufferSink(uint8_t* buffer, size_t capacity) : buf(buffer), cap(capacity), len(0), overflow(false) {}
+
+    size_t write(const uint8_t* data, size_t n) {
+        if (n > cap - len) {
+            overflow = true;
+            n = cap - len;
+        }
+        memcpy(buf + len, data, n);
+        len += n;
+        return n;
+    }
+
+    bool overflowed() const { return overflow; }
+};
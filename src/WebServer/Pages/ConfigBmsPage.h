@@ -42,6 +42,7 @@ static const char CONFIG_BMS_PAGE_HTML[] PROGMEM = R"rawliteral(
                     <div>Temp.: <strong id="bmsStTemp">--</strong></div>
                     <div>Delta: <strong id="bmsStDelta">--</strong></div>
                 </div>
+                <div id="bmsStatusPacks" style="display:none; margin-top:8px; gap:6px;"></div>
             </div>
 
             <form id="bmsConfigForm">
@@ -62,6 +63,18 @@ static const char CONFIG_BMS_PAGE_HTML[] PROGMEM = R"rawliteral(
                     <div class="info-text">Formato: XX:XX:XX:XX:XX:XX (6 bytes hex com dois-pontos).</div>
                 </div>
 
+                <div class="form-group">
+                    <label for="bmsType2">Segundo pack em paralelo (opcional):</label>
+                    <select id="bmsType2" name="bmsType2">
+                        <option value="0">Desativado</option>
+                        <option value="1">JBD</option>
+                        <option value="2">Daly (D2 BLE)</option>
+                        <option value="3">JK BMS</option>
+                    </select>
+                    <input type="text" id="bmsMac2" name="bmsMac2" maxlength="17" placeholder="A5:C2:39:2B:FC:4F" style="margin-top:8px;">
+                    <div class="info-text">Para dois packs ligados em paralelo, cada um com seu BMS (tipos podem ser diferentes). As correntes são somadas e a tensão, o SoC e as células consideram o pack mais fraco.</div>
+                </div>
+
                 <div class="form-group">
                     <button type="button" id="scanBmsButton">Buscar BMS</button>
                     <div class="info-text" id="bmsScanStatus">Pressione "Buscar BMS" para procurar dispositivos JBD, Daly e JK próximos.</div>
@@ -150,7 +163,8 @@ const renderBmsScanResults = (results) => {
             <div>MAC: <code>${escapeHtml(entry.mac || '')}</code></div>
             <div>RSSI: ${typeof entry.rssi === 'number' ? entry.rssi + ' dBm' : 'N/A'}</div>
             <div>Services: <code>${escapeHtml(entry.advertisedServices || 'none')}</code></div>
-            <div><button type="button" class="use-bms-result" data-mac="${escapeHtml(entry.mac || '')}" data-type="${escapeHtml(entry.detectedType || 0)}">Usar este BMS</button></div>
+            <div><button type="button" class="use-bms-result" data-mac="${escapeHtml(entry.mac || '')}" data-type="${escapeHtml(entry.detectedType || 0)}">Usar este BMS</button>
+                <button type="button" class="use-bms-result" data-pack="2" data-mac="${escapeHtml(entry.mac || '')}" data-type="${escapeHtml(entry.detectedType || 0)}">Usar como 2º pack</button></div>
         `;
         container.appendChild(row);
     });
@@ -159,10 +173,11 @@ const renderBmsScanResults = (results) => {
         button.addEventListener('click', () => {
             const selectedMac = button.dataset.mac || '';
             const detectedType = button.dataset.type || '0';
+            const suffix = button.dataset.pack === '2' ? '2' : '';
 
-            $('bmsMac').value = selectedMac;
+            $('bmsMac' + suffix).value = selectedMac;
             if (detectedType !== '0') {
-                $('bmsType').value = detectedType;
+                $('bmsType' + suffix).value = detectedType;
                 setBmsScanStatus('BMS escaneado selecionado. Revise o tipo detectado e salve a configuração.');
             } else {
                 $('scanBmsButton').disabled = true;
@@ -171,7 +186,7 @@ const renderBmsScanResults = (results) => {
                     .then((data) => {
                         $('scanBmsButton').disabled = false;
                         if (data && Number(data.detectedType) > 0) {
-                            $('bmsType').value = String(data.detectedType);
+                            $('bmsType' + suffix).value = String(data.detectedType);
                             setBmsScanStatus('Tipo de BMS detectado após conexão. Revise os campos e salve a configuração.');
                         } else {
                             setBmsScanStatus('MAC do dispositivo BLE selecionado. Tipo ainda desconhecido após o teste de conexão.');
@@ -265,6 +280,8 @@ const loadCurrentValues = () => {
         .then((data) => {
             $('bmsType').value = String(typeof data.bmsType === 'number' ? data.bmsType : 0);
             $('bmsMac').value = data.bmsMac || '';
+            $('bmsType2').value = String(typeof data.bmsType2 === 'number' ? data.bmsType2 : 0);
+            $('bmsMac2').value = data.bmsMac2 || '';
         })
         .catch((error) => {
             console.error('Error loading BMS settings:', error);
@@ -283,10 +300,36 @@ const BMS_STATE_LABELS = {
 
 let bmsStatusPollTimer = null;
 
+const renderBmsPacks = (data) => {
+    const el = $('bmsStatusPacks');
+    if (!el) return;
+    const packs = data && Array.isArray(data.packs) ? data.packs : [];
+    if (packs.length < 2) {
+        el.style.display = 'none';
+        return;
+    }
+    el.style.display = 'grid';
+    el.innerHTML = packs.map((p) => {
+        const label = `Pack ${p.index + 1} — ${escapeHtml(BMS_TYPE_LABELS[p.type] || '')}`;
+        if (!p.hasData) {
+            return `<div>${label}: ${escapeHtml(BMS_STATE_LABELS[p.state] || p.state || '')}</div>`;
+        }
+        const parts = [
+            (p.voltageMv / 1000).toFixed(2) + ' V',
+            (p.currentMa / 1000).toFixed(2) + ' A',
+            p.soc + ' %'
+        ];
+        if (typeof p.cellMinMv === 'number') parts.push(`células ${p.cellMinMv}–${p.cellMaxMv} mV`);
+        if (typeof p.tempMaxC === 'number') parts.push(p.tempMaxC + ' °C');
+        return `<div>${label}: <strong>${parts.join(' · ')}</strong></div>`;
+    }).join('');
+};
+
 const renderBmsStatus = (data) => {
     const stateEl = $('bmsStatusState');
     const dataEl = $('bmsStatusData');
     if (!stateEl || !dataEl) return;
+    renderBmsPacks(data);
 
     if (!data || !data.configured) {
         stateEl.textContent = 'BMS não configurado — selecione o tipo e o MAC e salve para conectar.';
@@ -337,12 +380,20 @@ $('bmsConfigForm').addEventListener('submit', function(e) {
 
     const bmsType = parseInt($('bmsType').value, 10) || 0;
     const bmsMac = $('bmsMac').value.trim();
+    const bmsType2 = parseInt($('bmsType2').value, 10) || 0;
+    const bmsMac2 = $('bmsMac2').value.trim();
+    const macPattern = /^([0-9A-Fa-f]{2}:){5}[0-9A-Fa-f]{2}$/;
 
-    if (bmsType !== 0 && !/^([0-9A-Fa-f]{2}:){5}[0-9A-Fa-f]{2}$/.test(bmsMac)) {
+    if ((bmsType !== 0 && !macPattern.test(bmsMac)) || (bmsType2 !== 0 && !macPattern.test(bmsMac2))) {
         showMessage('O MAC do BMS deve estar no formato XX:XX:XX:XX:XX:XX', 'err');
         saveButton.disabled = false;
         return;
     }
+    if (bmsType !== 0 && bmsType2 !== 0 && bmsMac.toUpperCase() === bmsMac2.toUpperCase()) {
+        showMessage('O segundo BMS deve ter um MAC diferente do primeiro', 'err');
+        saveButton.disabled = false;
+        return;
+    }
 
     const pin = $('configPin').value;
     setPin(pin);
@@ -352,7 +403,9 @@ $('bmsConfigForm').addEventListener('submit', function(e) {
         headers: { 'Content-Type': 'application/json', 'X-Config-Pin': pin },
         body: JSON.stringify({
             bmsType: bmsType,
-            bmsMac: bmsMac
+            bmsMac: bmsMac,
+            bmsType2: bmsType2,
+            bmsMac2: bmsMac2
         })
     })
         .then((response) => response.text().then((text) => ({ ok: response.ok, text })))
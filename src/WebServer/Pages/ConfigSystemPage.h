@@ -50,6 +50,23 @@ static const char CONFIG_SYSTEM_PAGE_HTML[] PROGMEM = R"rawliteral(
                     <div class="info-text">No modo sem fio, o acelerador e o botão vêm do controle remoto por ESP-NOW.</div>
                 </div>
 
+                <h2>Registro de voo</h2>
+                <div class="form-group">
+                    <label for="logRateHz">Taxa de registro</label>
+                    <select id="logRateHz" name="logRateHz">
+                        <option value="1">1 Hz (padrão)</option>
+                        <option value="10">10 Hz</option>
+                        <option value="25">25 Hz</option>
+                        <option value="50">50 Hz</option>
+                    </select>
+                    <div class="info-text">Acelerador, potência, corrente, RPM e tensão são gravados nesta taxa; temperaturas, SoC e células continuam a 1 Hz. Taxas altas ocupam mais memória (50 Hz: ~3 MB por hora). Vale a partir do próximo armamento.</div>
+                </div>
+                <div class="form-group">
+                    <label for="logReserveKb">Reserva de memória (KB)</label>
+                    <input type="number" id="logReserveKb" name="logReserveKb" min="8" max="64" step="1">
+                    <div class="info-text">Espaço mantido livre para o próximo voo (8 a 64 KB). Quando a memória enche, os logs mais antigos são apagados para manter esta reserva; o voo em andamento nunca é apagado.</div>
+                </div>
+
                 <div class="form-group">
                     <label for="configPin">PIN</label>
                     <input type="password" id="configPin" maxlength="8" placeholder="Necessário para salvar">
@@ -95,6 +112,8 @@ const loadCurrentValues = () => {
             $('buzzerVolume').value = data.buzzerVolume;
             $('buzzerVolumeValue').textContent = data.buzzerVolume;
             if (data.throttleSource !== undefined) $('throttleSource').value = String(data.throttleSource);
+            if (data.logRateHz !== undefined) $('logRateHz').value = String(data.logRateHz);
+            if (data.logReserveKb !== undefined) $('logReserveKb').value = data.logReserveKb;
             $('remoteMac').textContent = (data.remoteMac && data.remoteMac.length) ? data.remoteMac : 'não pareado';
         })
         .catch((error) => {
@@ -127,7 +146,9 @@ $('systemConfigForm').addEventListener('submit', function(e) {
 
     const data = {
         buzzerVolume: parseInt($('buzzerVolume').value, 10),
-        throttleSource: parseInt($('throttleSource').value, 10)
+        throttleSource: parseInt($('throttleSource').value, 10),
+        logRateHz: parseInt($('logRateHz').value, 10),
+        logReserveKb: parseInt($('logReserveKb').value, 10)
     };
 
     const pin = $('configPin').value;
@@ -11,7 +11,7 @@
 //   P4 → between BUILD_TIME and CONTROLLER_LABEL
 //   P5 → from after CONTROLLER_LABEL to end of </html>
 
-static const char DASHBOARD_HTML_P1[] PROGMEM = R"rawliteral(<!DOCTYPE html><html><head><title>FlyController Painel</title><meta charset="utf-8"><meta name="viewport" content="width=device-width, initial-scale=1"><link rel="stylesheet" href="/config.css"><script src="/config-common.js" defer></script><script src="/dashboard.js" defer></script></head><body><div class="page"><div class="topbar"><a class="nav-btn active" href="/">Painel</a><a class="nav-btn" href="/telemetry">Telemetria</a><a class="nav-btn" href="/firmware">Firmware</a><a class="nav-btn" href="/logs-page">Registros</a><a class="nav-btn" href="/config">Configura&#xE7;&#xF5;es</a></div>
+static const char DASHBOARD_HTML_P1[] PROGMEM = R"rawliteral(<!DOCTYPE html><html><head><title>FlyController Painel</title><meta charset="utf-8"><meta name="viewport" content="width=device-width, initial-scale=1"><link rel="stylesheet" href="/config.css"><script src="/config-common.js" defer></script><script src="/telemetry-codec.js" defer></script><script src="/dashboard.js" defer></script></head><body><div class="page"><div class="topbar"><a class="nav-btn active" href="/">Painel</a><a class="nav-btn" href="/telemetry">Telemetria</a><a class="nav-btn" href="/firmware">Firmware</a><a class="nav-btn" href="/logs-page">Registros</a><a class="nav-btn" href="/config">Configura&#xE7;&#xF5;es</a></div>
 <div class="panel">
     <h1>FlyController Painel</h1>
     <div class="sub">Acesso r&#xE1;pido e status b&#xE1;sico do dispositivo</div>
@@ -63,27 +63,22 @@ const fmtSeconds = s => {
     return `${h}:${String(m).padStart(2,'0')}:${String(sec).padStart(2,'0')}`;
 };
 
-function loadDashboard() {
-    fetchJson('/api/telemetry')
-        .then((d) => {
-            setText('batteryVoltage', formatVoltage(d.batteryVoltageMv || 0));
-            setText('armed', d.armed ? 'ARMADO' : 'DESARMADO');
-            setText('uptime', `${Math.floor((d.uptimeMs || 0) / 1000)} s`);
-            setText('hourMeter', fmtSeconds(d.hourMeterSec || 0));
-            if (!d.hasTelemetry) {
-                setText('telemetryState', 'Sem dados de telemetria');
-                setText('freshness', '--');
-                return;
-            }
-            const age = Math.max(0, (d.uptimeMs || 0) - (d.lastTelemetryUpdateMs || 0));
-            setText('telemetryState', age > 3000 ? 'DESATUALIZADO' : 'AO VIVO');
-            setText('freshness', `${age} ms`);
-        })
-        .catch(() => {
-            setText('telemetryState', 'Indispon\xEDvel');
-        });
-}
+const renderDashboard = (d) => {
+    setText('batteryVoltage', formatVoltage(d.batteryVoltageMv || 0));
+    setText('armed', d.armed ? 'ARMADO' : 'DESARMADO');
+    setText('uptime', `${Math.floor((d.uptimeMs || 0) / 1000)} s`);
+    setText('hourMeter', fmtSeconds(d.hourMeterSec || 0));
+    if (!d.hasTelemetry) {
+        setText('telemetryState', 'Sem dados de telemetria');
+        setText('freshness', '--');
+        return;
+    }
+    const age = Math.max(0, (d.uptimeMs || 0) - (d.lastTelemetryUpdateMs || 0));
+    setText('telemetryState', age > 3000 ? 'DESATUALIZADO' : 'AO VIVO');
+    setText('freshness', `${age} ms`);
+};
 
-loadDashboard();
-setInterval(loadDashboard, 1000);
+openTelemetryStream(renderDashboard, () => {
+    setText('telemetryState', 'Indispon\xEDvel');
+}, 1000);
 )rawliteral";
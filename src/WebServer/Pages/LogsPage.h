@@ -12,19 +12,49 @@ inline String renderLogsPage() {
     </div>
     <div class="table-wrap">
         <table id="fileTable">
-            <thead><tr><th>Arquivo</th><th>Tamanho</th><th>Ação</th></tr></thead>
-            <tbody><tr><td colspan="3">Carregando...</td></tr></tbody>
+            <thead><tr><th>Arquivo</th><th>Tamanho</th><th>Resumo do voo</th><th>Ação</th></tr></thead>
+            <tbody><tr><td colspan="4">Carregando...</td></tr></tbody>
         </table>
     </div>
     <div class="panel-footer" style="margin-top:1rem;">
         <button type="button" id="deleteAllBtn" class="btn btn-red" disabled onclick="deleteAllLogs()">Excluir todos os registros</button>
     </div>
 </div>
+<div class="panel">
+    <h1>Eventos</h1>
+    <div class="table-wrap">
+        <table id="eventTable">
+            <thead><tr><th>Quando</th><th>Evento</th><th>Detalhe</th></tr></thead>
+            <tbody><tr><td colspan="3">Carregando...</td></tr></tbody>
+        </table>
+    </div>
+    <div class="panel-footer" style="margin-top:1rem;">
+        <button type="button" class="btn" onclick="loadEvents()">Atualizar</button>
+    </div>
+</div>
 )rawliteral";
 
     const char* script = R"rawliteral(
 const toCsvName = (filename) => filename.replace(/\.txt$/i, '.csv');
 
+// One-line flight summary from the /list "summary" object (FlightStats).
+const formatSummary = (s) => {
+    if (!s) return '—';
+    const totalSec = Math.round(s.durationMs / 1000);
+    const parts = [`${Math.floor(totalSec / 60)}:${String(totalSec % 60).padStart(2, '0')}`];
+    if (s.maxCurrentMa !== undefined) {
+        parts.push(`${(s.maxCurrentMa / 1000).toFixed(0)} A máx`);
+        parts.push(`${s.usedMah} mAh`);
+        parts.push(`${(s.usedWhX10 / 10).toFixed(1)} Wh`);
+    }
+    if (s.maxMotorTempMc !== undefined) parts.push(`motor ${(s.maxMotorTempMc / 1000).toFixed(0)} °C`);
+    if (s.maxEscTempMc !== undefined) parts.push(`ESC ${(s.maxEscTempMc / 1000).toFixed(0)} °C`);
+    if (s.minCellMv !== undefined) parts.push(`célula mín ${(s.minCellMv / 1000).toFixed(2)} V`);
+    const limitedMs = s.limitMs.battery + s.limitMs.motorTemp + s.limitMs.escTemp;
+    if (limitedMs > 0) parts.push(`limitado ${Math.round(limitedMs / 1000)} s`);
+    return parts.join(' · ');
+};
+
 const loadFiles = () => {
     fetchJson('/list')
         .then((files) => {
@@ -32,7 +62,7 @@ const loadFiles = () => {
             const deleteAllBtn = document.querySelector('#deleteAllBtn');
             tbody.innerHTML = '';
             if (files.length === 0) {
-                tbody.innerHTML = '<tr><td colspan="3">Nenhum registro encontrado.</td></tr>';
+                tbody.innerHTML = '<tr><td colspan="4">Nenhum registro encontrado.</td></tr>';
                 if (deleteAllBtn) deleteAllBtn.disabled = true;
                 return;
             }
@@ -45,6 +75,7 @@ const loadFiles = () => {
                 tr.innerHTML = `
                     <td>${displayName}</td>
                     <td>${formatBytes(f.size)}</td>
+                    <td>${formatSummary(f.summary)}</td>
                     <td>
                         <a class="btn btn-sm btn-green" href="/logs${f.name}" download="${downloadName}">Baixar CSV</a>
                         <button class="btn btn-sm btn-red" onclick="deleteFile('${f.name}')">Excluir</button>
@@ -53,7 +84,7 @@ const loadFiles = () => {
             });
         })
         .catch(() => {
-            document.querySelector('#fileTable tbody').innerHTML = '<tr><td colspan="3">Erro ao carregar arquivos.</td></tr>';
+            document.querySelector('#fileTable tbody').innerHTML = '<tr><td colspan="4">Erro ao carregar arquivos.</td></tr>';
             const deleteAllBtn = document.querySelector('#deleteAllBtn');
             if (deleteAllBtn) deleteAllBtn.disabled = true;
         });
@@ -73,6 +104,72 @@ const deleteAllLogs = () => {
         .then((r) => r.ok ? loadFiles() : r.text().then((t) => alert('Falha ao excluir: ' + t)));
 };
 
+// Event journal (/api/events), newest first.
+const EVENT_LABELS = {
+    BOOT: 'Ligado',
+    ARM: 'Armado',
+    DISARM: 'Desarmado',
+    SIGNAL_LOST: 'Sinal perdido',
+    CAN_BUS_OFF: 'CAN desligado (bus-off)',
+    CAN_RECOVERED: 'CAN recuperado',
+    BMS_CONNECTED: 'BMS conectado',
+    BMS_DISCONNECTED: 'BMS desconectado',
+    POWER_LIMIT: 'Limite de potência',
+};
+const SIGNAL_NAMES = { 1: 'temperatura do motor', 2: 'temperatura do ESC', 3: 'tensão da bateria' };
+const BMS_NAMES = { 1: 'JBD', 2: 'Daly', 3: 'JK' };
+
+const formatUptime = (ms) => {
+    const s = Math.floor(ms / 1000);
+    const h = Math.floor(s / 3600);
+    const m = Math.floor((s % 3600) / 60);
+    return `${h}:${String(m).padStart(2, '0')}:${String(s % 60).padStart(2, '0')}`;
+};
+
+const eventDetail = (e) => {
+    switch (e.code) {
+        case 'BOOT': return `reset ${e.arg}`;
+        case 'DISARM': return e.reason || '';
+        case 'SIGNAL_LOST': return SIGNAL_NAMES[e.arg] || '';
+        case 'CAN_BUS_OFF': return e.value !== undefined ? `TEC ${e.value}` : '';
+        case 'BMS_CONNECTED':
+        case 'BMS_DISCONNECTED': {
+            const name = BMS_NAMES[e.arg] || '';
+            return e.value ? `${name} (pack ${e.value + 1})` : name;   // value: pack index, 0 omitted
+        }
+        case 'POWER_LIMIT': {
+            if (e.arg === 0) return 'encerrado';
+            const causes = [];
+            if (e.arg & 1) causes.push('bateria');
+            if (e.arg & 2) causes.push('motor');
+            if (e.arg & 4) causes.push('ESC');
+            return causes.join(', ');
+        }
+    }
+    return '';
+};
+
+const loadEvents = () => {
+    const tbody = document.querySelector('#eventTable tbody');
+    fetchJson('/api/events')
+        .then((data) => {
+            tbody.innerHTML = '';
+            if (data.events.length === 0) {
+                tbody.innerHTML = '<tr><td colspan="3">Nenhum evento registrado.</td></tr>';
+                return;
+            }
+            data.events.forEach((e) => {
+                const when = e.epoch ? new Date(e.epoch * 1000).toLocaleString() : `+${formatUptime(e.uptimeUs / 1000)}`;
+                const tr = document.createElement('tr');
+                tr.innerHTML = `<td>${when}</td><td>${EVENT_LABELS[e.code] || e.code}</td><td>${eventDetail(e)}</td>`;
+                tbody.appendChild(tr);
+            });
+        })
+        .catch(() => {
+            tbody.innerHTML = '<tr><td colspan="3">Erro ao carregar eventos.</td></tr>';
+        });
+};
+
 // Pre-fill PIN from sessionStorage on page load
 window.addEventListener('DOMContentLoaded', () => {
     const pinInput = document.querySelector('#logPin');
@@ -80,6 +177,7 @@ window.addEventListener('DOMContentLoaded', () => {
 });
 
 loadFiles();
+loadEvents();
 )rawliteral";
 
     PageSpec spec = {
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <Arduino.h>
+
+// Browser side of the compact telemetry encoding. Mirrors
+// Telemetry/TelemetryBinaryCodec.h field for field: any change to the wire
+// format must update both in the same commit.
+//
+// openTelemetryStream() subscribes to /ws/telemetry in binary mode and, while
+// the socket is down, polls /api/telemetry.bin with the last held frame as
+// ack. Either way onFrame receives an object shaped like the JSON from
+// /api/telemetry, so the page renderers don't care which transport is used.
+static const char TELEMETRY_CODEC_JS[] PROGMEM = R"rawliteral(
+const TB_MAGIC = 0xF7;
+const TB_VERSION = 1;
+const TB_FIELDS = ['flags', 'batteryPercentCc', 'batteryPercentVoltage', 'batteryVoltageMv',
+    'powerKwX10', 'throttlePercent', 'throttleRaw', 'powerPercent', 'motorTempMc', 'rpm',
+    'escCurrentMa', 'escTempMc', 'disarmReason', 'powerScale', 'armCharge', 'uptimeMs',
+    'lastTelemetryUpdateMs', 'hourMeterSec', 'sessionSec', 'bmsState', 'bmsTempMaxC',
+    'bmsCellMinMv', 'bmsCellMaxMv', 'bmsCellDeltaMv', 'signals', 'powerAlertSeq', 'powerAlertCauses'];
+const TB_MAX_BEEPS = 8;
+const TB_DISARM_CODES = ['', 'MANUAL', 'THR ERR', 'LINK ERR', 'MOT ERR', 'ESC ERR', 'BATT ERR'];
+const TB_BMS_STATES = ['none', 'idle', 'connecting', 'connected', 'unknown'];
+const TB_SIGNAL_CODES = ['a', 's', 'i', 'v'];
+
+// Returns the decoded frame, or null if the buffer is malformed or is a delta
+// against a frame other than `base`.
+const tbDecode = (buffer, base) => {
+    const b = new Uint8Array(buffer);
+    let pos = 0;
+    let ok = true;
+    const u8 = () => {
+        if (pos >= b.length) { ok = false; return 0; }
+        return b[pos++];
+    };
+    const varint = () => {
+        let v = 0;
+        for (let shift = 0; shift < 35; shift += 7) {
+            const byte = u8();
+            if (!ok) return 0;
+            v += (byte & 0x7F) * Math.pow(2, shift);
+            if ((byte & 0x80) === 0) return v;
+        }
+        ok = false;
+        return 0;
+    };
+    const unzigzag = (v) => (v >>> 1) ^ -(v & 1);
+
+    if (u8() !== TB_MAGIC || u8() !== TB_VERSION) return null;
+    const keyframe = (u8() & 1) !== 0;
+    if (!keyframe && !base) return null;
+
+    const f = keyframe
+        ? { seq: 0, present: 0, values: new Array(TB_FIELDS.length).fill(0), beeps: [] }
+        : { seq: 0, present: base.present, values: base.values.slice(), beeps: base.beeps.slice() };
+    f.seq = varint();
+    if (!keyframe && varint() !== base.seq) return null;
+    const present = varint() >>> 0;
+    const changed = keyframe ? present : (varint() >>> 0);
+    if (!ok) return null;
+
+    for (let i = 0; i < TB_FIELDS.length; i++) {
+        const bit = (1 << i) >>> 0;
+        if (!(changed & bit)) continue;
+        const prev = (!keyframe && (f.present & bit)) ? f.values[i] : 0;
+        f.values[i] = (prev + unzigzag(varint())) | 0;
+    }
+    f.present = present;
+
+    const count = u8();
+    let prevSeq = f.beeps.length ? f.beeps[f.beeps.length - 1].seq : 0;
+    for (let i = 0; i < count; i++) {
+        const seq = prevSeq + varint();
+        const freq = varint();
+        const onMs = varint();
+        const offMs = varint();
+        const reps = u8();
+        const bits = u8();
+        f.beeps.push({ seq, freq, onMs, offMs, reps, layer: bits & 1, active: (bits & 2) !== 0 });
+        prevSeq = seq;
+    }
+    if (!ok || pos !== b.length) return null;
+    if (f.beeps.length > TB_MAX_BEEPS) f.beeps = f.beeps.slice(-TB_MAX_BEEPS);
+    return f;
+};
+
+// Decoded frame -> the same object shape as GET /api/telemetry.
+const tbToTelemetry = (f) => {
+    const has = (name) => (f.present & ((1 << TB_FIELDS.indexOf(name)) >>> 0)) !== 0;
+    const val = (name) => f.values[TB_FIELDS.indexOf(name)];
+    const flags = val('flags');
+    const sig = val('signals');
+    const causes = val('powerAlertCauses');
+    const d = {
+        availability: {
+            current: !!(flags & 4), rpm: !!(flags & 8), powerKw: !!(flags & 16),
+            bms: !!(flags & 32), bmsCells: !!(flags & 64),
+        },
+        signals: {
+            motorTemp: TB_SIGNAL_CODES[sig & 3],
+            escTemp: TB_SIGNAL_CODES[(sig >> 2) & 3],
+            battV: TB_SIGNAL_CODES[(sig >> 4) & 3],
+        },
+        hasTelemetry: !!(flags & 1),
+        armed: !!(flags & 2),
+        bmsConnected: !!(flags & 128),
+        bmsConfigured: !!(flags & 256),
+        disarmReason: TB_DISARM_CODES[val('disarmReason')] || '',
+        bmsState: TB_BMS_STATES[val('bmsState')] || 'unknown',
+        powerAlert: {
+            seq: val('powerAlertSeq') >>> 0,
+            causes: [
+                ...((causes & 1) ? ['battery'] : []),
+                ...((causes & 2) ? ['motorTemp'] : []),
+                ...((causes & 4) ? ['escTemp'] : []),
+            ],
+        },
+        buzzer: f.beeps,
+    };
+    ['batteryPercentCc', 'batteryPercentVoltage', 'batteryVoltageMv', 'powerKwX10',
+     'throttlePercent', 'throttleRaw', 'powerPercent', 'motorTempMc', 'rpm', 'escCurrentMa',
+     'escTempMc', 'powerScale', 'armCharge'].forEach((name) => {
+        if (has(name)) d[name] = val(name);
+    });
+    ['uptimeMs', 'lastTelemetryUpdateMs', 'hourMeterSec', 'sessionSec'].forEach((name) => {
+        if (has(name)) d[name] = val(name) >>> 0;
+    });
+    if (d.availability.bms) {
+        d.bms = { available: true };
+        if (has('bmsTempMaxC')) d.bms.tempMaxC = val('bmsTempMaxC');
+        if (has('bmsCellMinMv')) d.bms.cellMinMv = val('bmsCellMinMv');
+        if (has('bmsCellMaxMv')) d.bms.cellMaxMv = val('bmsCellMaxMv');
+        if (has('bmsCellDeltaMv')) d.bms.cellDeltaMv = val('bmsCellDeltaMv');
+    }
+    return d;
+};
+
+const openTelemetryStream = (onFrame, onError, intervalMs) => {
+    let held = null;
+    let pollTimer = null;
+    let socket = null;
+    const accept = (buffer) => {
+        const f = tbDecode(buffer, held);
+        if (!f) {
+            // Polling asks for a keyframe with ack=0; the socket is told
+            held = null;
+            if (socket && socket.readyState === WebSocket.OPEN) socket.send('keyframe');
+            onError(new Error('frame'));
+            return;
+        }
+        held = f;
+        onFrame(tbToTelemetry(f));
+    };
+    const poll = () => fetch(`/api/telemetry.bin?ack=${held ? held.seq : 0}`)
+        .then((r) => {
+            if (!r.ok) throw new Error(`HTTP ${r.status}`);
+            return r.arrayBuffer();
+        })
+        .then(accept)
+        .catch(onError);
+    const startPolling = () => {
+        if (pollTimer) return;
+        poll();
+        pollTimer = setInterval(poll, intervalMs || 1000);
+    };
+    const stopPolling = () => {
+        if (!pollTimer) return;
+        clearInterval(pollTimer);
+        pollTimer = null;
+    };
+    const connect = () => {
+        let ws;
+        try {
+            ws = new WebSocket(`ws://${location.host}/ws/telemetry`);
+        } catch (e) {
+            startPolling();
+            setTimeout(connect, 5000);
+            return;
+        }
+        socket = ws;
+        ws.binaryType = 'arraybuffer';
+        ws.onopen = () => {
+            stopPolling();
+            // A new socket starts from a keyframe; drop the polled base.
+            held = null;
+            ws.send('format:bin');
+            if (intervalMs) ws.send(`interval:${intervalMs}`);
+        };
+        ws.onmessage = (ev) => {
+            // Frames queued before 'format:bin' was processed arrive as JSON.
+            if (typeof ev.data === 'string') {
+                try { onFrame(JSON.parse(ev.data)); } catch (e) { onError(e); }
+                return;
+            }
+            accept(ev.data);
+        };
+        ws.onclose = () => {
+            if (socket === ws) socket = null;
+            startPolling();
+            setTimeout(connect, 5000);
+        };
+    };
+    startPolling();
+    connect();
+};
+)rawliteral";
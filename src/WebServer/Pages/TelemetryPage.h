@@ -118,6 +118,7 @@ static const char TELEMETRY_PAGE_HTML[] PROGMEM = R"rawliteral(
         </div>
     </div>
 
+    <script defer src="/telemetry-codec.js"></script>
     <script defer src="/telemetry.js"></script>
 </body>
 </html>
@@ -934,18 +935,11 @@ const initSessionReset = () => {
     });
 };
 
-const loadTelemetry = () => {
-    fetchJson('/api/telemetry')
-        .then(renderTelemetry)
-        .catch(() => setStatus('nodata'));
-};
-
 document.addEventListener('DOMContentLoaded', () => {
     initTelemetryWake();
     initBuzzerSound();
     initPowerAlert();
     initSessionReset();
-    loadTelemetry();
-    setInterval(loadTelemetry, 1000);
+    openTelemetryStream(renderTelemetry, () => setStatus('nodata'));
 });
 )rawliteral";
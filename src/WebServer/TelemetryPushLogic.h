@@ -0,0 +1,162 @@
+#pragma once
+#include <stdint.h>
+#include <stdbool.h>
+
+// Pure per-client pacing for the telemetry push channel -- no Arduino deps,
+// host-testable.
+//
+// The loop serialises one telemetry frame per push period and offers it to
+// every connected client. This schedule decides, per client, whether that
+// frame is actually queued:
+//
+//   - rate limit: a client that asked for a slower interval (a dashboard that
+//     only shows uptime does not need 2 Hz) is skipped until its own interval
+//     has elapsed since the last frame it was sent;
+//   - backpressure: a client whose send queue still holds older frames (weak
+//     link, phone screen off, browser tab throttled) is skipped rather than
+//     queued further. Telemetry is a latest-value stream, so dropping a stale
+//     frame is always better than growing AsyncTCP's heap backlog.
+//
+// It also remembers, per client, whether it asked for the compact binary
+// encoding and which frame it was last sent, so a binary client can be sent
+// a delta against exactly the frame it already holds (see
+// Telemetry/TelemetryBinaryCodec.h).
+//
+// Time comparisons use unsigned subtraction, so millis() rollover is safe.
+class TelemetryPushSchedule {
+public:
+    static constexpr uint8_t kMaxClients = 4;
+
+    TelemetryPushSchedule() : slots_{}, droppedFrames_(0) {}
+
+    // Returns false when the table is full; the caller should refuse the client.
+    bool addClient(uint32_t id, uint16_t minIntervalMs) {
+        if (findSlot(id) >= 0) return true;
+        for (uint8_t i = 0; i < kMaxClients; i++) {
+            if (!slots_[i].inUse) {
+                slots_[i].inUse = true;
+                slots_[i].id = id;
+                slots_[i].intervalMs = minIntervalMs;
+                slots_[i].hasSent = false;
+                slots_[i].lastSentMs = 0;
+                slots_[i].binary = false;
+                slots_[i].lastFrameSeq = 0;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void removeClient(uint32_t id) {
+        int8_t slot = findSlot(id);
+        if (slot >= 0) slots_[slot].inUse = false;
+    }
+
+    // Clamped to [minIntervalMs, maxIntervalMs] so a client can slow itself
+    // down but never ask for more than the loop produces.
+    void setClientInterval(uint32_t id, uint32_t requestedMs, uint16_t minIntervalMs, uint16_t maxIntervalMs) {
+        int8_t slot = findSlot(id);
+        if (slot < 0) return;
+        if (requestedMs < minIntervalMs) requestedMs = minIntervalMs;
+        if (requestedMs > maxIntervalMs) requestedMs = maxIntervalMs;
+        slots_[slot].intervalMs = (uint16_t)requestedMs;
+    }
+
+    // Decides whether the current frame goes to client `id`. writable is
+    // false while the client's send queue is full (backpressure). Returns
+    // true (and records the send) when the frame should be queued.
+    bool shouldSend(uint32_t id, uint32_t nowMs, bool writable) {
+        int8_t slot = findSlot(id);
+        if (slot < 0) return false;
+        Slot& s = slots_[slot];
+
+        if (s.hasSent && (nowMs - s.lastSentMs) < s.intervalMs) {
+            return false;
+        }
+        if (!writable) {
+            droppedFrames_++;
+            return false;
+        }
+
+        s.hasSent = true;
+        s.lastSentMs = nowMs;
+        return true;
+    }
+
+    // Switching encoding forgets the last frame: the client never decoded it
+    // in the new format, so the next binary frame must be a keyframe.
+    void setClientBinary(uint32_t id, bool binary) {
+        int8_t slot = findSlot(id);
+        if (slot < 0 || slots_[slot].binary == binary) return;
+        slots_[slot].binary = binary;
+        slots_[slot].lastFrameSeq = 0;
+    }
+
+    // The client could not decode a frame (it never arrived whole, or its
+    // base was not the one it holds): the next binary frame is a keyframe.
+    void requestKeyframe(uint32_t id) {
+        int8_t slot = findSlot(id);
+        if (slot >= 0) slots_[slot].lastFrameSeq = 0;
+    }
+
+    bool isClientBinary(uint32_t id) const {
+        int8_t slot = findSlot(id);
+        return slot >= 0 && slots_[slot].binary;
+    }
+
+    // Sequence number of the last frame queued to this client (0 = none).
+    // The socket delivers in order, so this is the frame the client holds.
+    // Only marked once the socket took the frame: a frame that was never
+    // queued must not become the next delta's base.
+    uint32_t getLastFrameSeq(uint32_t id) const {
+        int8_t slot = findSlot(id);
+        return slot >= 0 ? slots_[slot].lastFrameSeq : 0;
+    }
+
+    void markFrameSent(uint32_t id, uint32_t frameSeq) {
+        int8_t slot = findSlot(id);
+        if (slot >= 0) slots_[slot].lastFrameSeq = frameSeq;
+    }
+
+    // Ids of the clients in the table: the loop fans out over these rather
+    // than walking the socket's client list, which the AsyncTCP task edits.
+    // Returns how many were copied.
+    uint8_t copyClientIds(uint32_t* out, uint8_t cap) const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < kMaxClients && n < cap; i++) {
+            if (slots_[i].inUse) out[n++] = slots_[i].id;
+        }
+        return n;
+    }
+
+    uint8_t clientCount() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < kMaxClients; i++) {
+            if (slots_[i].inUse) n++;
+        }
+        return n;
+    }
+
+    uint32_t getDroppedFrames() const { return droppedFrames_; }
+
+private:
+    struct Slot {
+        bool     inUse;
+        bool     hasSent;
+        bool     binary;
+        uint32_t id;
+        uint16_t intervalMs;
+        uint32_t lastSentMs;
+        uint32_t lastFrameSeq;
+    };
+
+    Slot     slots_[kMaxClients];
+    uint32_t droppedFrames_;
+
+    int8_t findSlot(uint32_t id) const {
+        for (uint8_t i = 0; i < kMaxClients; i++) {
+            if (slots_[i].inUse && slots_[i].id == id) return (int8_t)i;
+        }
+        return -1;
+    }
+};
@@ -230,25 +230,22 @@ void Xctod::writeSystemStatus(char* data, size_t size, size_t& used) {
 }
 
 void Xctod::writeBmsInfo(char* data, size_t size, size_t& used) {
-    // Use the BluetoothBms facade so this works with both JBD and Daly BMS types.
-    if (bluetoothBms.hasData() && bluetoothBms.getTempCount() > 0) {
-        int16_t maxTemp = bluetoothBms.getTempCelsius(0);
-        for (uint8_t i = 1; i < bluetoothBms.getTempCount(); i++) {
-            int16_t t = bluetoothBms.getTempCelsius(i);
-            if (t > maxTemp) maxTemp = t;
-        }
-        appendToBuffer(data, size, used, ",%d", maxTemp);
+    // Use the BluetoothBms facade so this works with every BMS type.
+    BmsSnapshot bms;
+    const bool hasData = bluetoothBms.getSnapshot(bms);
+    if (hasData && bms.tempCount > 0) {
+        appendToBuffer(data, size, used, ",%d", bms.tempMaxCelsius);
     } else {
         appendToBuffer(data, size, used, ",");
     }
-    if (bluetoothBms.hasCellData()) {
+    if (bms.hasCellData) {
         appendToBuffer(
             data,
             size,
             used,
             ",%u,%u",
-            bluetoothBms.getCellMinMilliVolts(),
-            bluetoothBms.getCellMaxMilliVolts()
+            bms.cellMinMv,
+            bms.cellMaxMv
         );
     } else {
         appendToBuffer(data, size, used, ",,");
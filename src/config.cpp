@@ -8,6 +8,7 @@
 #include "TelemetryLogger/TelemetryLogger.h"
 #include "JbdBms/JbdBms.h"
 #include "JkBms/JkBms.h"
+#include "BluetoothBms/BmsGattLink.h"
 #include "Settings/Settings.h"
 
 Buzzer buzzer(BUZZER_PIN);
@@ -77,11 +78,17 @@ PowerAlert powerAlert;
 BatteryMonitor batteryMonitor;
 BluetoothBms bluetoothBms;
 DalyBms dalyBms;
+DalyBms dalyBms2;   // second pack flown in parallel, see BluetoothBms
 Xctod xctod;
 TelemetryLogger telemetryLogger;
 JbdBms jbdBms;
+JbdBms jbdBms2;
 JkBms jkBms;
+JkBms jkBms2;
+BmsGattLink bmsGattLink;
 Settings settings;
 HourMeter hourMeter;
+FlightStats flightStats;
+EventJournal eventJournal;
 ADS1115 ads1115;
 RemoteLink remoteLink;
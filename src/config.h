@@ -29,6 +29,8 @@
 #endif
 #include "RemoteLink/RemoteLink.h"
 #include "PowerAlert/PowerAlert.h"
+#include "FlightStats/FlightStats.h"
+#include "EventJournal/EventJournal.h"
 
 // Debug logging - compiles to zero in production
 #ifdef DEBUG
@@ -45,6 +47,7 @@ class Power;
 class Xctod;
 class JbdBms;
 class JkBms;
+class BmsGattLink;
 class TelemetryLogger;
 
 extern Buzzer buzzer;
@@ -70,15 +73,21 @@ extern Power power;
 extern BatteryMonitor batteryMonitor;
 extern BluetoothBms bluetoothBms;
 extern DalyBms dalyBms;
+extern DalyBms dalyBms2;
 extern Xctod xctod;
 extern TelemetryLogger telemetryLogger;
 extern JbdBms jbdBms;
+extern JbdBms jbdBms2;
 extern JkBms jkBms;
+extern JkBms jkBms2;
+extern BmsGattLink bmsGattLink;
 extern Settings settings;
 extern HourMeter hourMeter;
 extern ADS1115 ads1115;
 extern RemoteLink remoteLink;
 extern PowerAlert powerAlert;
+extern FlightStats flightStats;
+extern EventJournal eventJournal;
 #include "Telemetry/Telemetry.h"
 
 // ========== ANALOG INPUTS (ADC1 - legacy, used only when ADS1115 not in use) ==========
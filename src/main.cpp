@@ -51,6 +51,7 @@ void setup()
   settings.init();
 
   hourMeter.init();
+  flightStats.init();
 
 #if IS_XAG || IS_TMOTOR
   batterySensor.setDividerRatio(settings.getVoltageDividerRatio());
@@ -70,6 +71,7 @@ void setup()
   xctod.init();
   bluetoothBms.init();
   logger.init();
+  eventJournal.init();   // LittleFS is mounted by logger.init()
   telemetryLogger.init();
   buzzer.setup();
 
@@ -156,6 +158,8 @@ void loop()
   power.setDisarmScale(button.getPowerScale());
   bluetoothBms.update();
   xctod.write();
+  // Arm/disarm edges and timed flushes; file I/O runs in the writer task.
+  logger.handle();
   telemetryLogger.handle();
 #if USES_CAN_BUS
   checkCanbus();
@@ -207,6 +211,9 @@ void loop()
   extern BatteryMonitor batteryMonitor;
   batteryMonitor.update();
 
+  // Per-flight summary; samples the telemetry and limits updated above.
+  flightStats.handle(throttle.isArmed());
+
   handleEsc();
   updateSoundState();
   powerAlert.handle();
@@ -0,0 +1,159 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsCellTracker.h"
+
+static const uint8_t kMac[6] = {0xA4, 0xC1, 0x38, 0x12, 0x34, 0x56};
+
+// Three cells; cell 2 sags 4 mΩ, the others 2 mΩ (voltages at 0 A of 4000 mV)
+static BmsSnapshot frameAt(int32_t currentMa, uint32_t millis) {
+    BmsSnapshot s;
+    s.clear();
+    s.hasData = true;
+    s.hasCellData = true;
+    s.cellCount = 3;
+    s.packCurrentMilliAmps = currentMa;
+    const int32_t sag2 = currentMa * 2 / 1000;   // mV for 2 mΩ
+    s.cellVoltagesMv[0] = (uint16_t)(4000 + sag2);
+    s.cellVoltagesMv[1] = (uint16_t)(4000 + sag2);
+    s.cellVoltagesMv[2] = (uint16_t)(4000 + sag2 * 2);
+    s.dataMillis = millis;
+    s.cellMillis = millis;
+    s.updateDerived();
+    return s;
+}
+
+void test_sag_from_current_steps() {
+    BmsCellTracker t;
+    assert(!t.observe(frameAt(0, 1000)));            // nothing to pair with yet
+    assert(t.observe(frameAt(-50000, 2000)));
+    assert(t.observe(frameAt(-10000, 3000)));
+    BmsCellTrendReport r;
+    t.report(r);
+    assert(r.cellCount == 3 && r.samples == 2);
+    assert(r.sagUohm[0] == 2000 && r.sagUohm[1] == 2000 && r.sagUohm[2] == 4000);
+    assert(r.weakestCell() == 2);
+    assert(r.minMv[2] == 3800 && r.minMv[0] == 3900);
+    assert(r.maxDeltaMv == 100);
+    cout << "PASS: per-cell sag taken as dV/dI between cell frames\n";
+}
+
+void test_samples_rejected() {
+    BmsCellTracker t;
+    t.observe(frameAt(-20000, 1000));
+    // Step too small
+    assert(!t.observe(frameAt(-22000, 1500)));
+    // Too long after the last frame
+    assert(!t.observe(frameAt(-60000, 1500 + BmsCellTracker::kMaxGapMs + 1)));
+    // Current read too long before the cells, and no pair starts from it
+    BmsSnapshot stale = frameAt(-5000, 20000);
+    stale.dataMillis = 20000 - BmsCellTracker::kMaxSkewMs - 1;
+    assert(!t.observe(stale));
+    assert(!t.observe(frameAt(-40000, 20500)));
+    assert(t.samples() == 0);
+    BmsCellTrendReport r;
+    t.report(r);
+    assert(r.weakestCell() == BmsSnapshot::kNoCell);
+    cout << "PASS: small steps, gaps and out-of-step current give no sample\n";
+}
+
+void test_noise_clamped_and_smoothed() {
+    BmsCellTracker t;
+    t.observe(frameAt(0, 1000));
+    t.observe(frameAt(-50000, 2000));
+    // A cell reading lower as the load drops: counted as 0, not negative
+    BmsSnapshot odd = frameAt(-10000, 3000);
+    odd.cellVoltagesMv[0] = 3850;
+    t.observe(odd);
+    assert(t.sagUohm()[0] == 2000 - 2000 / BmsCellTracker::kSagWeight);
+    cout << "PASS: a negative sample counts as 0 and moves the sag an eighth\n";
+}
+
+void test_cell_count_change_restarts() {
+    BmsCellTracker t;
+    t.observe(frameAt(0, 1000));
+    t.observe(frameAt(-50000, 2000));
+    BmsSnapshot other = frameAt(-50000, 2500);
+    other.cellCount = 4;
+    other.cellVoltagesMv[3] = 3950;
+    other.updateDerived();
+    assert(!t.observe(other));
+    assert(t.cellCount() == 4 && t.samples() == 0);
+    cout << "PASS: another pack starts the session over\n";
+}
+
+void test_reset_starts_the_next_flight() {
+    BmsCellTracker t;
+    t.observe(frameAt(0, 1000));
+    t.observe(frameAt(-50000, 2000));
+    t.reset();
+    // Nothing carried over, not even the frame to pair with
+    assert(!t.observe(frameAt(-10000, 3000)));
+    BmsCellTrendReport r;
+    t.report(r);
+    assert(r.samples == 0 && r.minMv[2] == 3960 && r.maxDeltaMv == 20);
+    cout << "PASS: a reset leaves no sample or minimum of the previous flight\n";
+}
+
+void test_store_baseline_and_roundtrip() {
+    BmsCellTrendStore store;
+    BmsCellTrendReport r;
+    assert(!store.lookup(kMac, 3, r) && r.sessions == 0);
+
+    const uint16_t first[3] = {2000, 2000, 4000};
+    store.record(kMac, 3, first);
+    assert(store.lookup(kMac, 3, r) && r.sessions == 1 && r.baselineUohm[2] == 4000);
+    const uint16_t second[3] = {2000, 2400, 8000};
+    store.record(kMac, 3, second);
+    store.lookup(kMac, 3, r);
+    assert(r.sessions == 2 && r.baselineUohm[1] == 2100 && r.baselineUohm[2] == 5000);
+    // Same MAC, another cell count: another pack
+    assert(!store.lookup(kMac, 4, r));
+
+    uint8_t blob[BmsCellTrendStore::kSerializedMax];
+    const size_t len = store.serialize(blob, sizeof(blob));
+    assert(len == 2 + BmsCellTrendStore::kEntryBytes);
+    BmsCellTrendStore loaded;
+    assert(loaded.deserialize(blob, len));
+    assert(loaded.lookup(kMac, 3, r) && r.sessions == 2 && r.baselineUohm[2] == 5000);
+    assert(!loaded.deserialize(blob, len - 1) && loaded.count() == 0);
+    blob[0] = BmsCellTrendStore::kVersion + 1;
+    assert(!loaded.deserialize(blob, len));
+    cout << "PASS: per-MAC baseline folded per session and persisted\n";
+}
+
+void test_store_replaces_least_recent() {
+    BmsCellTrendStore store;
+    const uint16_t sag[1] = {1000};
+    uint8_t mac[6];
+    memcpy(mac, kMac, 6);
+    for (uint8_t i = 0; i < BmsCellTrendStore::kEntries; i++) {
+        mac[5] = i;
+        store.record(mac, 1, sag);
+    }
+    mac[5] = 0;
+    store.record(mac, 1, sag);              // MAC 0 recorded again
+    mac[5] = 99;
+    store.record(mac, 1, sag);              // takes MAC 1's place
+    assert(store.count() == BmsCellTrendStore::kEntries);
+    BmsCellTrendReport r;
+    mac[5] = 1;
+    assert(!store.lookup(mac, 1, r));
+    mac[5] = 0;
+    assert(store.lookup(mac, 1, r) && r.sessions == 2);
+    cout << "PASS: a full store replaces the least recently recorded pack\n";
+}
+
+int main() {
+    test_sag_from_current_steps();
+    test_samples_rejected();
+    test_noise_clamped_and_smoothed();
+    test_cell_count_change_restarts();
+    test_reset_starts_the_next_flight();
+    test_store_baseline_and_roundtrip();
+    test_store_replaces_least_recent();
+    return 0;
+}
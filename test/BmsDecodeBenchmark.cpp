@@ -0,0 +1,169 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+#include "../src/JbdBms/JbdFrameParser.h"
+#include "../src/JbdBms/JbdBmsParser.h"
+#include "../src/DalyBms/DalyFrameParser.h"
+#include "../src/DalyBms/DalyBmsParser.h"
+#include "../src/JkBms/JkBmsParser.h"
+
+// Host benchmark: frames/s per protocol, from 20-byte notifications to
+// decoded fields -- framing, checksum and the pure decoder, what the loop
+// pays per BMS response. Build with `g++ -O2 -std=c++17`.
+
+static const size_t NOTIFY_LEN = 20;
+static const int FRAMES = 20000;
+
+static void putBE16(uint8_t* b, size_t off, uint16_t v) {
+    b[off] = (uint8_t)(v >> 8);
+    b[off + 1] = (uint8_t)(v & 0xFF);
+}
+
+static void putLE16(uint8_t* b, size_t off, uint16_t v) {
+    b[off] = (uint8_t)(v & 0xFF);
+    b[off + 1] = (uint8_t)(v >> 8);
+}
+
+static void putLE32(uint8_t* b, size_t off, uint32_t v) {
+    for (int i = 0; i < 4; i++) b[off + i] = (uint8_t)(v >> (8 * i));
+}
+
+// 0x03 (27 bytes, 2 NTCs) and 0x04 (16 cells), as a 16S JBD answers them
+static vector<uint8_t> jbdStream() {
+    uint8_t basic[27] = {};
+    putBE16(basic, 0, 5312);
+    putBE16(basic, 2, (uint16_t)(int16_t)-1500);
+    basic[19] = 80;
+    basic[21] = 16;
+    basic[22] = 2;
+    putBE16(basic, 23, 2981);
+    putBE16(basic, 25, 2991);
+    uint8_t cells[32];
+    for (int i = 0; i < 16; i++) putBE16(cells, (size_t)i * 2, (uint16_t)(3300 + i));
+
+    vector<uint8_t> s;
+    for (int k = 0; k < FRAMES; k++) {
+        const uint8_t* data = k % 2 ? cells : basic;
+        const uint8_t len = k % 2 ? sizeof(cells) : sizeof(basic);
+        const uint8_t head[] = {0xDD, (uint8_t)(k % 2 ? 0x04 : 0x03), 0x00, len};
+        s.insert(s.end(), head, head + 4);
+        s.insert(s.end(), data, data + len);
+        uint32_t sum = len;
+        for (uint8_t i = 0; i < len; i++) sum += data[i];
+        const uint16_t chk = (uint16_t)(0x10000 - sum);
+        s.push_back((uint8_t)(chk >> 8));
+        s.push_back((uint8_t)(chk & 0xFF));
+        s.push_back(0x77);
+    }
+    return s;
+}
+
+static vector<uint8_t> dalyStream() {
+    uint8_t f[DALY_STATUS_FRAME_LEN_62] = {};
+    f[0] = 0xD2;
+    f[1] = DALY_READ_FN;
+    f[2] = DALY_STATUS_DATA_LEN_62;
+    for (int i = 0; i < 16; i++) putBE16(f, DALY_CELL_BASE_OFFSET + (size_t)i * 2, (uint16_t)(3300 + i));
+    putBE16(f, DALY_PACK_VOLTAGE_OFFSET, 531);
+    putBE16(f, DALY_PACK_CURRENT_OFFSET, 29850);
+    putBE16(f, DALY_CELL_COUNT_OFFSET, 16);
+    putBE16(f, DALY_TEMP_COUNT_OFFSET, 2);
+    const uint16_t crc = dalyCrc16Modbus(f, sizeof(f) - 2);
+    f[sizeof(f) - 2] = (uint8_t)(crc & 0xFF);
+    f[sizeof(f) - 1] = (uint8_t)(crc >> 8);
+    vector<uint8_t> s;
+    for (int k = 0; k < FRAMES; k++) s.insert(s.end(), f, f + sizeof(f));
+    return s;
+}
+
+static vector<uint8_t> jkStream() {
+    uint8_t f[JK_FRAME_LENGTH] = {};
+    f[0] = 0x55; f[1] = 0xAA; f[2] = 0xEB; f[3] = 0x90;
+    f[4] = JK_FRAME_TYPE_CELL_INFO;
+    uint32_t sum = 0;
+    for (int i = 0; i < 16; i++) {
+        putLE16(f, JK_CELL_BASE_OFFSET + (size_t)i * 2, (uint16_t)(3300 + i));
+        sum += 3300 + i;
+    }
+    const size_t base = JK_PACK_VOLTAGE_OFFSET + 16;
+    putLE32(f, base, sum);
+    putLE32(f, base + JK_CURRENT_DELTA, (uint32_t)-1500);
+    f[base + JK_SOC_DELTA] = 80;
+    f[JK_FRAME_LENGTH - 1] = jkComputeChecksum(f, JK_FRAME_LENGTH - 1);
+    vector<uint8_t> s;
+    for (int k = 0; k < FRAMES; k++) s.insert(s.end(), f, f + sizeof(f));
+    return s;
+}
+
+static void report(const char* name, const vector<uint8_t>& s, int64_t ns, uint32_t frames, uint32_t check) {
+    cout << name << ": " << (double)frames * 1e9 / (double)ns << " frames/s, "
+         << (double)s.size() * 1e3 / (double)ns << " MB/s, " << ns / frames << " ns/frame (check " << check << ")\n";
+}
+
+int main() {
+    {
+        const vector<uint8_t> s = jbdStream();
+        JbdFrameParser parser;
+        uint32_t frames = 0;
+        uint32_t check = 0;
+        const auto start = chrono::steady_clock::now();
+        for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+            const size_t n = s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN;
+            parser.feed(s.data() + at, n, [&](const JbdFrame& f) {
+                frames++;
+                if (f.reg == JBD_REG_BASIC_INFO) {
+                    JbdBasicInfo info;
+                    if (jbdParseBasicInfo(f.data, f.dataLen, &info)) check += info.socPercent;
+                } else {
+                    uint16_t cells[JBD_MAX_CELLS];
+                    check += jbdParseCellVoltages(f.data, f.dataLen, cells, JBD_MAX_CELLS);
+                }
+            });
+        }
+        report("JBD  (0x03 + 0x04)", s, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count(), frames, check);
+    }
+    {
+        const vector<uint8_t> s = dalyStream();
+        DalyFrameParser parser;
+        uint32_t frames = 0;
+        uint32_t check = 0;
+        const auto start = chrono::steady_clock::now();
+        for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+            const size_t n = s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN;
+            parser.feed(s.data() + at, n, [&](const DalyFrame& f) {
+                frames++;
+                DalyStatus status;
+                if (dalyParseStatusFrame(f.raw, f.rawLen, &status)) check += status.cellCount;
+            });
+        }
+        report("Daly (status)     ", s, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count(), frames, check);
+    }
+    {
+        // JK framing as in JkBms: accumulate, find 55 AA EB 90, take 300 bytes
+        const vector<uint8_t> s = jkStream();
+        uint8_t buf[2 * JK_FRAME_LENGTH];
+        size_t len = 0;
+        uint32_t frames = 0;
+        uint32_t check = 0;
+        const auto start = chrono::steady_clock::now();
+        for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+            const size_t n = s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN;
+            memcpy(buf + len, s.data() + at, n);
+            len += n;
+            if (len < JK_FRAME_LENGTH || !jkHasResponseHeader(buf, len)) continue;
+            if (jkValidateChecksum(buf, JK_FRAME_LENGTH)) {
+                JkBmsData data = {};
+                if (jkParseCellInfo(buf, JK_FRAME_LENGTH, JkProtocol_32S, &data)) check += data.cellCount;
+                frames++;
+            }
+            memmove(buf, buf + JK_FRAME_LENGTH, len - JK_FRAME_LENGTH);
+            len -= JK_FRAME_LENGTH;
+        }
+        report("JK   (cell info)  ", s, chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count(), frames, check);
+    }
+    return 0;
+}
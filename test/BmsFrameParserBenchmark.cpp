@@ -0,0 +1,232 @@
+#include <iostream>
+#include <chrono>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+#include "../src/JbdBms/JbdFrameParser.h"
+#include "../src/DalyBms/DalyFrameParser.h"
+
+// Host benchmark: bytes/s through the JBD and Daly framers, byte-wise
+// parsers vs the linear buffer the drivers used before (append each
+// 20-byte notification, memmove to resync and consume). Two streams: clean
+// responses, and the same responses with noise in between (a bad link, a
+// BMS chattering at power-up). Frames found are printed next to the rate:
+// in noise the linear buffer overflows on false starts and loses frames,
+// the byte-wise parsers rescan each false start and keep them.
+//
+// Then two adversarial streams through the byte-wise parsers alone: only
+// sync bytes (each a false start, dropped at its header), and back-to-back
+// headers that fit (each a candidate that fails its check and is replayed
+// from the next one: the worst case, about frame length / header length
+// steps per byte).
+// Build with `g++ -O2 -std=c++17`.
+
+static const size_t NOTIFY_LEN = 20;
+static const int PASSES = 20;
+
+static uint32_t lcg = 777;
+static uint8_t nextByte() {
+    lcg = lcg * 1103515245u + 12345u;
+    return (uint8_t)(lcg >> 16);
+}
+
+static vector<uint8_t> jbdFrame(uint8_t reg, size_t dataLen) {
+    vector<uint8_t> f = {0xDD, reg, 0x00, (uint8_t)dataLen};
+    uint32_t sum = (uint32_t)dataLen;
+    for (size_t i = 0; i < dataLen; i++) {
+        f.push_back(nextByte());
+        sum += f.back();
+    }
+    const uint16_t chk = (uint16_t)(0x10000 - sum);
+    f.push_back((uint8_t)(chk >> 8));
+    f.push_back((uint8_t)(chk & 0xFF));
+    f.push_back(0x77);
+    return f;
+}
+
+static vector<uint8_t> dalyFrame(size_t dataLen) {
+    vector<uint8_t> f = {0xD2, 0x03, (uint8_t)dataLen};
+    for (size_t i = 0; i < dataLen; i++) f.push_back(nextByte());
+    const uint16_t crc = dalyCrc16Modbus(f.data(), f.size());
+    f.push_back((uint8_t)(crc & 0xFF));
+    f.push_back((uint8_t)(crc >> 8));
+    return f;
+}
+
+// Noisy: sync bytes in the noise too, each a false start the framer has
+// to back out of.
+static vector<uint8_t> stream(bool jbd, bool noisy) {
+    vector<uint8_t> s;
+    for (int k = 0; k < 400; k++) {
+        if (noisy) {
+            for (int i = 0; i < 150; i++) s.push_back(i % 16 == 0 ? (jbd ? 0xDD : 0xD2) : nextByte());
+        }
+        const vector<uint8_t> f = jbd ? jbdFrame(k % 2 ? 0x03 : 0x04, k % 2 ? 27 : 32) : dalyFrame(124);
+        s.insert(s.end(), f.begin(), f.end());
+    }
+    return s;
+}
+
+// ---- the linear-buffer framers, as they were ----
+
+struct OldJbd {
+    uint8_t buf[256];
+    size_t len = 0;
+    uint32_t frames = 0;
+
+    void notify(const uint8_t* data, size_t n) {
+        if (len + n > sizeof(buf)) len = 0;
+        memcpy(buf + len, data, n);
+        len += n;
+    }
+    void process() {
+        bool done = false;
+        while (!done && len > 0) {
+            if (len >= 2 && buf[0] == 0xFF && buf[1] == 0xAA) { memmove(buf, buf + 2, len - 2); len -= 2; continue; }
+            if (buf[0] != 0xDD) {
+                size_t skip = 0;
+                while (skip < len && buf[skip] != 0xDD) skip++;
+                if (skip >= len) { len = 0; done = true; continue; }
+                memmove(buf, buf + skip, len - skip);
+                len -= skip;
+                continue;
+            }
+            if (len < 4) { done = true; continue; }
+            const size_t frameLen = (size_t)buf[3] + 7;
+            if (len < frameLen) { done = true; continue; }
+            if (buf[frameLen - 1] != 0x77) { memmove(buf, buf + 1, len - 1); len -= 1; continue; }
+            uint32_t sum = (uint32_t)buf[2] + buf[3];
+            for (size_t i = 0; i < buf[3]; i++) sum += buf[4 + i];
+            const uint16_t chk = ((uint16_t)buf[4 + buf[3]] << 8) | buf[5 + buf[3]];
+            if (((sum + chk) & 0xFFFF) != 0) { memmove(buf, buf + 1, len - 1); len -= 1; continue; }
+            frames++;
+            memmove(buf, buf + frameLen, len - frameLen);
+            len -= frameLen;
+        }
+    }
+};
+
+struct OldDaly {
+    uint8_t buf[192];
+    size_t len = 0;
+    uint32_t frames = 0;
+
+    void notify(const uint8_t* data, size_t n) {
+        if (len + n > sizeof(buf)) len = 0;
+        memcpy(buf + len, data, n);
+        len += n;
+    }
+    void process() {
+        bool done = false;
+        while (!done && len >= 5) {
+            if (buf[0] != 0xD2) {
+                size_t skip = 0;
+                while (skip < len && buf[skip] != 0xD2) skip++;
+                if (skip >= len) { len = 0; done = true; continue; }
+                memmove(buf, buf + skip, len - skip);
+                len -= skip;
+                continue;
+            }
+            const size_t frameLen = (size_t)3 + buf[2] + 2;
+            if (frameLen > sizeof(buf)) { len = 0; done = true; continue; }
+            if (len < frameLen) { done = true; continue; }
+            const uint16_t crc = dalyCrc16Modbus(buf, frameLen - 2);
+            if (crc == ((uint16_t)buf[frameLen - 2] | ((uint16_t)buf[frameLen - 1] << 8))) {
+                frames++;
+                memmove(buf, buf + frameLen, len - frameLen);
+                len -= frameLen;
+                continue;
+            }
+            memmove(buf, buf + 1, len - 1);
+            len -= 1;
+        }
+    }
+};
+
+template <class Fn>
+static double mbPerSecond(const vector<uint8_t>& s, Fn&& run) {
+    const auto start = chrono::steady_clock::now();
+    for (int p = 0; p < PASSES; p++) run();
+    const double ns = (double)chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    return (double)s.size() * PASSES / ns * 1000.0;
+}
+
+static void report(const char* name, const vector<uint8_t>& s, double oldMb, uint32_t oldFrames,
+                   double newMb, uint32_t newFrames) {
+    cout << name << " (" << s.size() << " bytes): linear buffer " << oldMb << " MB/s, "
+         << oldFrames / PASSES << " frames; byte-wise " << newMb << " MB/s, " << newFrames / PASSES << " frames\n";
+}
+
+template <class Parser, class Frame>
+static void reportAdversarial(const char* name, const vector<uint8_t>& s) {
+    Parser parser;
+    uint32_t frames = 0;
+    const double mb = mbPerSecond(s, [&]() {
+        for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+            parser.feed(s.data() + at, s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN,
+                        [&](const Frame&) { frames++; });
+        }
+    });
+    cout << name << " (" << s.size() << " bytes): byte-wise " << mb << " MB/s, " << frames / PASSES << " frames\n";
+}
+
+static vector<uint8_t> repeated(const vector<uint8_t>& pattern, size_t len) {
+    vector<uint8_t> s;
+    while (s.size() < len) s.insert(s.end(), pattern.begin(), pattern.end());
+    s.resize(len);
+    return s;
+}
+
+int main() {
+    for (int noisy = 0; noisy < 2; noisy++) {
+        const vector<uint8_t> s = stream(true, noisy != 0);
+        OldJbd oldJbd;
+        const double oldMb = mbPerSecond(s, [&]() {
+            for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+                oldJbd.notify(s.data() + at, s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN);
+                oldJbd.process();
+            }
+        });
+        JbdFrameParser parser;
+        uint32_t frames = 0;
+        const double newMb = mbPerSecond(s, [&]() {
+            for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+                parser.feed(s.data() + at, s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN,
+                            [&](const JbdFrame&) { frames++; });
+            }
+        });
+        report(noisy ? "JBD, noisy" : "JBD, clean", s, oldMb, oldJbd.frames, newMb, frames);
+    }
+
+    for (int noisy = 0; noisy < 2; noisy++) {
+        const vector<uint8_t> s = stream(false, noisy != 0);
+        OldDaly oldDaly;
+        const double oldMb = mbPerSecond(s, [&]() {
+            for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+                oldDaly.notify(s.data() + at, s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN);
+                oldDaly.process();
+            }
+        });
+        DalyFrameParser parser;
+        uint32_t frames = 0;
+        const double newMb = mbPerSecond(s, [&]() {
+            for (size_t at = 0; at < s.size(); at += NOTIFY_LEN) {
+                parser.feed(s.data() + at, s.size() - at < NOTIFY_LEN ? s.size() - at : NOTIFY_LEN,
+                            [&](const DalyFrame&) { frames++; });
+            }
+        });
+        report(noisy ? "Daly, noisy" : "Daly, clean", s, oldMb, oldDaly.frames, newMb, frames);
+    }
+
+    const size_t ADVERSARIAL_LEN = 65536;
+    reportAdversarial<JbdFrameParser, JbdFrame>("JBD, all DD", repeated({0xDD}, ADVERSARIAL_LEN));
+    reportAdversarial<JbdFrameParser, JbdFrame>("JBD, fitting headers",
+                                                repeated({0xDD, 0x03, 0x00, JBD_BASIC_INFO_MAX_LEN}, ADVERSARIAL_LEN));
+    reportAdversarial<DalyFrameParser, DalyFrame>("Daly, all D2", repeated({0xD2}, ADVERSARIAL_LEN));
+    reportAdversarial<DalyFrameParser, DalyFrame>(
+        "Daly, fitting headers",
+        repeated({0xD2, DalyFrameParser::kFunction, DalyFrameParser::kDataLen}, ADVERSARIAL_LEN));
+    return 0;
+}
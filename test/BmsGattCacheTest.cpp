@@ -0,0 +1,150 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsGattCache.h"
+
+static BmsGattHandles handles(uint16_t rx, uint16_t tx, uint16_t cccd) {
+    BmsGattHandles h = {};
+    h.rxHandle = rx;
+    h.txHandle = tx;
+    h.cccdHandle = cccd;
+    h.mtu = 23;
+    return h;
+}
+
+static void mac(uint8_t out[6], uint8_t last) {
+    const uint8_t base[6] = {0xA4, 0xC1, 0x38, 0x00, 0x10, last};
+    memcpy(out, base, 6);
+}
+
+void test_parse_mac() {
+    uint8_t m[6];
+    assert(BmsGattCache::parseMac("A4:c1:38:0F:9e:01", m));
+    assert(m[0] == 0xA4 && m[1] == 0xC1 && m[3] == 0x0F && m[4] == 0x9E && m[5] == 0x01);
+    assert(!BmsGattCache::parseMac("A4:C1:38:0F:9E", m));
+    assert(!BmsGattCache::parseMac("A4-C1-38-0F-9E-01", m));
+    assert(!BmsGattCache::parseMac("A4:C1:38:0F:9E:0G", m));
+    assert(!BmsGattCache::parseMac(nullptr, m));
+    cout << "PASS: MAC text parsed, malformed rejected\n";
+}
+
+void test_store_and_lookup() {
+    BmsGattCache cache;
+    uint8_t a[6];
+    mac(a, 1);
+    BmsGattHandles h;
+    assert(!cache.lookup(a, 1, h));
+    assert(cache.store(a, 1, handles(0x11, 0x14, 0x12)));
+    assert(!cache.store(a, 1, handles(0x11, 0x14, 0x12)));      // unchanged: nothing to persist
+    assert(cache.lookup(a, 1, h) && h.rxHandle == 0x11 && h.txHandle == 0x14 && h.cccdHandle == 0x12);
+    assert(!cache.lookup(a, 2, h));                             // same MAC as another BMS type
+    assert(cache.store(a, 1, handles(0x21, 0x24, 0x22)));       // changed handles replace
+    assert(cache.lookup(a, 1, h) && h.rxHandle == 0x21 && cache.count() == 1);
+    cout << "PASS: keyed by MAC and type, stores report changes\n";
+}
+
+void test_invalid_handles_not_stored() {
+    BmsGattCache cache;
+    uint8_t a[6];
+    mac(a, 1);
+    assert(!cache.store(a, 1, handles(0, 0x14, 0x12)));
+    assert(!cache.store(a, 1, handles(0x11, 0, 0x12)));
+    assert(cache.store(a, 1, handles(0x11, 0x11, 0)));          // JK: one characteristic, no CCCD
+    assert(cache.count() == 1);
+    cout << "PASS: entries without rx/tx handles refused\n";
+}
+
+void test_least_recently_used_replaced() {
+    BmsGattCache cache;
+    uint8_t m[6];
+    for (uint8_t i = 0; i < BmsGattCache::kEntries; i++) {
+        mac(m, i);
+        assert(cache.store(m, 1, handles((uint16_t)(0x10 + i), 0x40, 0x41)));
+    }
+    BmsGattHandles h;
+    mac(m, 0);
+    assert(cache.lookup(m, 1, h));                              // 0 used again: 1 is now oldest
+    mac(m, 9);
+    assert(cache.store(m, 1, handles(0x99, 0x40, 0x41)));
+    assert(cache.count() == BmsGattCache::kEntries);
+    mac(m, 1);
+    assert(!cache.lookup(m, 1, h));
+    mac(m, 0);
+    assert(cache.lookup(m, 1, h) && h.rxHandle == 0x10);
+    cout << "PASS: full cache replaces the least recently used\n";
+}
+
+void test_forget() {
+    BmsGattCache cache;
+    uint8_t a[6];
+    mac(a, 1);
+    cache.store(a, 1, handles(0x11, 0x14, 0x12));
+    assert(cache.forget(a, 1));
+    assert(!cache.forget(a, 1));
+    BmsGattHandles h;
+    assert(!cache.lookup(a, 1, h) && cache.count() == 0);
+    cout << "PASS: forget drops the entry\n";
+}
+
+void test_serialize_round_trip() {
+    BmsGattCache cache;
+    uint8_t m[6];
+    for (uint8_t i = 0; i < 3; i++) {
+        mac(m, i);
+        BmsGattHandles h = handles((uint16_t)(0x100 + i), (uint16_t)(0x200 + i), (uint16_t)(0x300 + i));
+        h.mtu = 247;
+        h.addrType = i;
+        cache.store(m, (uint8_t)(i + 1), h);
+    }
+    uint8_t blob[BmsGattCache::kSerializedMax];
+    assert(cache.serialize(blob, sizeof(blob) - 1) == 0);
+    const size_t len = cache.serialize(blob, sizeof(blob));
+    assert(len == 2 + 3 * BmsGattCache::kEntryBytes);
+
+    BmsGattCache loaded;
+    assert(loaded.deserialize(blob, len) && loaded.count() == 3);
+    BmsGattHandles h;
+    mac(m, 2);
+    assert(loaded.lookup(m, 3, h));
+    assert(h.rxHandle == 0x102 && h.txHandle == 0x202 && h.cccdHandle == 0x302 && h.mtu == 247 && h.addrType == 2);
+
+    // Recency survives: entry 0 was stored first, so it goes first
+    mac(m, 9);
+    assert(loaded.store(m, 1, handles(0x11, 0x14, 0x12)));
+    assert(loaded.store(m, 2, handles(0x11, 0x14, 0x12)));      // 5th entry evicts the oldest
+    mac(m, 0);
+    assert(!loaded.lookup(m, 1, h));
+    mac(m, 1);
+    assert(loaded.lookup(m, 2, h));
+    cout << "PASS: serialize/deserialize keep handles and recency\n";
+}
+
+void test_bad_blob_rejected() {
+    BmsGattCache cache;
+    uint8_t a[6];
+    mac(a, 1);
+    cache.store(a, 1, handles(0x11, 0x14, 0x12));
+    uint8_t blob[BmsGattCache::kSerializedMax];
+    const size_t len = cache.serialize(blob, sizeof(blob));
+
+    BmsGattCache loaded;
+    assert(!loaded.deserialize(blob, len - 1) && loaded.count() == 0);
+    blob[0] = BmsGattCache::kVersion + 1;
+    assert(!loaded.deserialize(blob, len) && loaded.count() == 0);
+    assert(!loaded.deserialize(blob, 0));
+    cout << "PASS: truncated or other-version blobs load empty\n";
+}
+
+int main() {
+    test_parse_mac();
+    test_store_and_lookup();
+    test_invalid_handles_not_stored();
+    test_least_recently_used_replaced();
+    test_forget();
+    test_serialize_round_trip();
+    test_bad_blob_rejected();
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <cassert>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsPollPolicy.h"
+
+static BmsPollInputs cruiseInputs() {
+    BmsPollInputs in = {};
+    in.armed = true;
+    in.currentMilliAmps = 20000;       // 1 C
+    in.voltageMilliVolts = 46000;
+    in.minVoltageMv = 42000;
+    in.maxVoltageMv = 50400;
+    in.capacityMah = 20000;
+    return in;
+}
+
+void test_level_from_inputs() {
+    BmsPollInputs in = cruiseInputs();
+    assert(BmsPollPolicy::levelFor(in) == BmsPollCruise);
+
+    in.armed = false;
+    in.batteryLimited = true;
+    assert(BmsPollPolicy::levelFor(in) == BmsPollIdle);        // disarmed wins
+
+    in = cruiseInputs();
+    in.currentMilliAmps = 40000;                                // 2 C
+    assert(BmsPollPolicy::levelFor(in) == BmsPollHigh);
+    in.capacityMah = 0;                                         // no capacity: no load criterion
+    assert(BmsPollPolicy::levelFor(in) == BmsPollCruise);
+
+    in = cruiseInputs();
+    in.voltageMilliVolts = 42000 + 1680;                        // 20 % of the range above min
+    assert(BmsPollPolicy::levelFor(in) == BmsPollHigh);
+    in.voltageMilliVolts = 42000 + 1681;
+    assert(BmsPollPolicy::levelFor(in) == BmsPollCruise);
+    in.voltageMilliVolts = 0;                                   // unknown
+    assert(BmsPollPolicy::levelFor(in) == BmsPollCruise);
+
+    in = cruiseInputs();
+    in.batteryLimited = true;
+    assert(BmsPollPolicy::levelFor(in) == BmsPollHigh);
+    cout << "PASS: idle disarmed, high on load, near floor or limiting\n";
+}
+
+void test_high_is_held() {
+    BmsPollPolicy p;
+    BmsPollInputs in = cruiseInputs();
+    assert(p.update(in, 1000) == BmsPollCruise);
+    in.currentMilliAmps = 60000;
+    assert(p.update(in, 2000) == BmsPollHigh);
+    in.currentMilliAmps = 20000;
+    assert(p.update(in, 2000 + BmsPollPolicy::kHoldMs - 1) == BmsPollHigh);
+    assert(p.update(in, 2000 + BmsPollPolicy::kHoldMs) == BmsPollCruise);
+
+    in.currentMilliAmps = 60000;
+    p.update(in, 10000);
+    in.armed = false;
+    assert(p.update(in, 10001) == BmsPollIdle);                 // disarm drops at once
+    cout << "PASS: high held for kHoldMs, disarm drops straight to idle\n";
+}
+
+void test_schedule_first_requests() {
+    BmsPollSchedule s;
+    assert(s.next(BmsPollCruise, 500) == BmsPollSchedule::Pack);
+    s.onRequested(BmsPollSchedule::Pack, 500);
+    assert(s.next(BmsPollCruise, 500 + BmsPollSchedule::kMinGapMs - 1) == -1);
+    assert(s.next(BmsPollCruise, 500 + BmsPollSchedule::kMinGapMs) == BmsPollSchedule::Cells);
+    cout << "PASS: new link asks for pack then cells, min gap kept\n";
+}
+
+void test_schedule_rates_per_level() {
+    const uint8_t levels[] = { BmsPollIdle, BmsPollCruise, BmsPollHigh };
+    for (uint8_t level : levels) {
+        BmsPollSchedule s;
+        uint32_t packs = 0, cells = 0;
+        for (uint32_t now = 0; now < 60000; now += 10) {
+            const int f = s.next(level, now);
+            if (f < 0) continue;
+            s.onRequested((uint8_t)f, now);
+            (f == BmsPollSchedule::Pack ? packs : cells)++;
+        }
+        const uint32_t packMs = BmsPollSchedule::intervalMs(level, BmsPollSchedule::Pack);
+        const uint32_t cellMs = BmsPollSchedule::intervalMs(level, BmsPollSchedule::Cells);
+        assert(packs >= 60000 / packMs - 1 && packs <= 60000 / packMs + 1);
+        assert(cells >= 60000 / cellMs - 1 && cells <= 60000 / cellMs + 1);
+    }
+    assert(BmsPollSchedule::intervalMs(BmsPollHigh, BmsPollSchedule::Cells)
+           < BmsPollSchedule::intervalMs(BmsPollCruise, BmsPollSchedule::Cells));
+    assert(BmsPollSchedule::intervalMs(BmsPollIdle, BmsPollSchedule::Pack)
+           > BmsPollSchedule::intervalMs(BmsPollCruise, BmsPollSchedule::Pack));
+    cout << "PASS: each field requested at its level's rate\n";
+}
+
+void test_schedule_pack_only() {
+    BmsPollSchedule s(false);
+    for (uint32_t now = 0; now < 20000; now += 10) {
+        const int f = s.next(BmsPollHigh, now);
+        assert(f != BmsPollSchedule::Cells);
+        if (f >= 0) s.onRequested((uint8_t)f, now);
+    }
+    cout << "PASS: single-frame BMS never asked for cells\n";
+}
+
+void test_schedule_level_change_applies_at_once() {
+    BmsPollSchedule s;
+    s.onRequested(BmsPollSchedule::Pack, 0);
+    s.onRequested(BmsPollSchedule::Cells, 250);
+    assert(s.next(BmsPollIdle, 1000) == -1);
+    assert(s.next(BmsPollHigh, 1000) == BmsPollSchedule::Pack);  // 500 ms overdue vs cells' -250
+    cout << "PASS: a faster level makes requests due without waiting out the old interval\n";
+}
+
+void test_schedule_millis_wrap() {
+    BmsPollSchedule s;
+    s.onRequested(BmsPollSchedule::Pack, 0xFFFFFF00u);
+    s.onRequested(BmsPollSchedule::Cells, 0xFFFFFF00u);
+    assert(s.next(BmsPollHigh, 0xFFFFFF00u + 499u) == -1);
+    assert(s.next(BmsPollHigh, 0xFFFFFF00u + 500u) == BmsPollSchedule::Pack);
+    cout << "PASS: millis() wrap\n";
+}
+
+int main() {
+    test_level_from_inputs();
+    test_high_is_held();
+    test_schedule_first_requests();
+    test_schedule_rates_per_level();
+    test_schedule_pack_only();
+    test_schedule_level_change_applies_at_once();
+    test_schedule_millis_wrap();
+    return 0;
+}
@@ -0,0 +1,86 @@
+#include <iostream>
+#include <cassert>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsReconnectPolicy.h"
+
+void test_first_attempt_is_immediate() {
+    BmsReconnectPolicy p;
+    assert(p.due(0) && p.due(123456));
+    assert(p.delayMs() == 0);
+    cout << "PASS: no history, connect at once\n";
+}
+
+void test_cold_failures_back_off_to_cap() {
+    BmsReconnectPolicy p;
+    const uint32_t expected[] = {2000, 4000, 8000, 10000, 10000};
+    uint32_t now = 1000;
+    for (uint32_t delay : expected) {
+        p.onAttemptFailed(now);
+        assert(p.delayMs() == delay);
+        assert(!p.due(now + delay - 1) && p.due(now + delay));
+        now += delay;
+    }
+    cout << "PASS: BMS never reached backs off 2 s, 4 s, 8 s, then 10 s\n";
+}
+
+void test_drop_retries_fast() {
+    BmsReconnectPolicy p;
+    p.onAttemptFailed(0);
+    p.onLinkUp();
+    p.onLinkLost(50000);
+    assert(p.due(50000));                                       // straight away
+    const uint32_t expected[] = {250, 500, 1000, 2000, 4000, 8000, 10000, 10000};
+    uint32_t now = 50000;
+    for (uint32_t delay : expected) {
+        p.onAttemptFailed(now);
+        assert(p.delayMs() == delay);
+        assert(!p.due(now + delay - 1) && p.due(now + delay));
+        now += delay;
+    }
+    cout << "PASS: dropped link retried at once, then 250 ms doubling to 10 s\n";
+}
+
+void test_reconnect_rearms_fast_schedule() {
+    BmsReconnectPolicy p;
+    p.onLinkUp();
+    for (int i = 0; i < 10; i++) p.onAttemptFailed(1000);
+    assert(p.delayMs() == BmsReconnectPolicy::kMaxDelayMs);
+    p.onLinkUp();
+    p.onLinkLost(2000);
+    assert(p.due(2000));
+    p.onAttemptFailed(2000);
+    assert(p.delayMs() == BmsReconnectPolicy::kFastFirstDelayMs);
+    cout << "PASS: a new link rearms the fast schedule\n";
+}
+
+void test_reset_forgets_history() {
+    BmsReconnectPolicy p;
+    p.onLinkUp();
+    p.onAttemptFailed(1000);
+    p.reset();
+    assert(p.due(1000) && !p.linkWasUp() && p.failures() == 0);
+    p.onAttemptFailed(1000);
+    assert(p.delayMs() == BmsReconnectPolicy::kColdFirstDelayMs);
+    cout << "PASS: reset (new MAC) starts cold\n";
+}
+
+void test_millis_wrap() {
+    BmsReconnectPolicy p;
+    p.onLinkUp();
+    p.onAttemptFailed(0xFFFFFF00u);
+    assert(!p.due(0xFFFFFFF0u));
+    assert(p.due(0xFFFFFF00u + 250u));                          // wraps past 0
+    cout << "PASS: millis() wrap\n";
+}
+
+int main() {
+    test_first_attempt_is_immediate();
+    test_cold_failures_back_off_to_cap();
+    test_drop_retries_fast();
+    test_reconnect_rearms_fast_schedule();
+    test_reset_forgets_history();
+    test_millis_wrap();
+    return 0;
+}
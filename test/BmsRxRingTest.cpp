@@ -0,0 +1,131 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsRxRing.h"
+
+void test_push_pop_in_order() {
+    BmsRxRing<16> ring;
+    const uint8_t a[] = {1, 2, 3, 4, 5};
+    const uint8_t b[] = {6, 7, 8};
+    assert(ring.empty());
+    assert(ring.push(a, sizeof(a)) && ring.push(b, sizeof(b)));
+    assert(ring.size() == 8);
+
+    uint8_t out[16];
+    assert(ring.pop(out, 3) == 3 && out[0] == 1 && out[2] == 3);
+    assert(ring.pop(out, sizeof(out)) == 5 && out[0] == 4 && out[4] == 8);
+    assert(ring.pop(out, sizeof(out)) == 0 && ring.empty());
+    cout << "PASS: bytes come out in the order they went in\n";
+}
+
+void test_wraps_around() {
+    BmsRxRing<8> ring;
+    uint8_t out[8];
+    uint8_t next = 0;
+    uint8_t expect = 0;
+    // Chunks of 5 through a ring of 8: every other push straddles the end.
+    for (int round = 0; round < 20; round++) {
+        uint8_t chunk[5];
+        for (uint8_t& c : chunk) c = next++;
+        assert(ring.push(chunk, sizeof(chunk)));
+        assert(ring.pop(out, sizeof(out)) == 5);
+        for (int i = 0; i < 5; i++) assert(out[i] == expect++);
+    }
+    cout << "PASS: chunks straddling the end of the buffer\n";
+}
+
+void test_full_ring_drops_whole_notification() {
+    BmsRxRing<8> ring;
+    const uint8_t partial[] = {0xDD, 0x03, 0x00, 0x1B, 0x10};   // start of a frame
+    const uint8_t burst[] = {0xAA, 0xBB, 0xCC, 0xEE};
+    assert(ring.push(partial, sizeof(partial)));
+    assert(!ring.push(burst, sizeof(burst)));
+    assert(ring.dropped() == 1 && ring.size() == 5);
+
+    uint8_t out[8];
+    assert(ring.pop(out, sizeof(out)) == 5 && memcmp(out, partial, 5) == 0);
+    assert(ring.push(burst, sizeof(burst)) && ring.size() == 4);
+
+    const uint8_t tooBig[9] = {0};
+    assert(!ring.push(tooBig, sizeof(tooBig)) && ring.dropped() == 2);
+    cout << "PASS: a notification that does not fit is dropped, queued bytes survive\n";
+}
+
+void test_clear_discards_queued_bytes() {
+    BmsRxRing<16> ring;
+    const uint8_t a[] = {1, 2, 3};
+    ring.push(a, sizeof(a));
+    ring.clear();
+    assert(ring.empty());
+    uint8_t out[4];
+    assert(ring.pop(out, sizeof(out)) == 0);
+    assert(ring.push(a, sizeof(a)) && ring.pop(out, sizeof(out)) == 3 && out[0] == 1);
+    cout << "PASS: clear drops what is queued\n";
+}
+
+// BLE host task and loop on two threads, notifications of 1..20 bytes (the
+// ATT payload of a 23-byte MTU). Every notification not counted as dropped
+// arrives whole and in order: each carries its sequence number and length.
+void test_two_threads_keep_notifications_whole() {
+    static BmsRxRing<64> ring;
+    const uint32_t kNotifications = 50000;
+    std::atomic<bool> done(false);
+    vector<uint8_t> stream;
+    stream.reserve(kNotifications * 12);
+
+    thread consumer([&]() {
+        uint8_t out[7];   // odd size: pops split notifications
+        for (;;) {
+            const bool finished = done.load();
+            const size_t n = ring.pop(out, sizeof(out));
+            stream.insert(stream.end(), out, out + n);
+            if (n == 0 && finished) break;
+            if (n == 0) this_thread::yield();
+        }
+    });
+
+    for (uint32_t i = 0; i < kNotifications; i++) {
+        uint8_t note[20];
+        const uint8_t len = (uint8_t)(6 + i % 15);
+        note[0] = len;
+        memcpy(note + 1, &i, 4);
+        for (uint8_t k = 5; k < len; k++) note[k] = (uint8_t)(i + k);
+        // Half the time wait for the loop, half the time drop: both paths.
+        while ((i / 1024) % 2 == 0 && BmsRxRing<64>::kCapacity - ring.size() < len) this_thread::yield();
+        ring.push(note, len);
+    }
+    done.store(true);
+    consumer.join();
+
+    size_t pos = 0;
+    uint32_t received = 0;
+    uint32_t last = 0;
+    while (pos < stream.size()) {
+        const uint8_t len = stream[pos];
+        assert(len >= 6 && len <= 20 && pos + len <= stream.size());
+        uint32_t seq;
+        memcpy(&seq, &stream[pos + 1], 4);
+        assert(received == 0 || seq > last);
+        assert(len == 6 + seq % 15);
+        for (uint8_t k = 5; k < len; k++) assert(stream[pos + k] == (uint8_t)(seq + k));
+        last = seq;
+        received++;
+        pos += len;
+    }
+    assert(received + ring.dropped() == kNotifications);
+    cout << "PASS: two threads, " << ring.dropped() << " dropped, notifications whole and in order\n";
+}
+
+int main() {
+    test_push_pop_in_order();
+    test_wraps_around();
+    test_full_ring_drops_whole_notification();
+    test_clear_discards_queued_bytes();
+    test_two_threads_keep_notifications_whole();
+    return 0;
+}
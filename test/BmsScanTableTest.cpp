@@ -0,0 +1,138 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsScanTable.h"
+
+// Flags, 16-bit UUID 0xFF00 (JBD), complete name "xiaoxiang BMS"
+static const uint8_t kJbdAdv[] = {
+    0x02, 0x01, 0x06,
+    0x03, 0x03, 0x00, 0xFF,
+    0x0E, 0x09, 'x', 'i', 'a', 'o', 'x', 'i', 'a', 'n', 'g', ' ', 'B', 'M', 'S'
+};
+
+static void addr(uint8_t out[6], uint8_t last) {
+    const uint8_t base[6] = {0xA4, 0xC1, 0x38, 0x00, 0x00, last};
+    memcpy(out, base, 6);
+}
+
+void test_parse_16bit_and_name() {
+    BmsAdvertisement a;
+    BmsAdvertisement::parse(kJbdAdv, sizeof(kJbdAdv), a);
+    assert(a.uuidCount == 1 && a.uuids[0] == 0xFF00 && a.otherUuids == 0);
+    assert(strcmp(a.name, "xiaoxiang BMS") == 0);
+    assert(a.protocol() == BmsScanJbd);
+    cout << "PASS: 16-bit service list and name\n";
+}
+
+void test_parse_128bit_on_base_uuid() {
+    // 0000fff0-0000-1000-8000-00805f9b34fb (Daly), then a vendor UUID
+    uint8_t adv[2 + 32] = {33, 0x07,
+        0xFB, 0x34, 0x9B, 0x5F, 0x80, 0x00, 0x00, 0x80, 0x00, 0x10, 0x00, 0x00, 0xF0, 0xFF, 0x00, 0x00,
+        1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    BmsAdvertisement a;
+    BmsAdvertisement::parse(adv, sizeof(adv), a);
+    assert(a.uuidCount == 1 && a.uuids[0] == 0xFFF0 && a.otherUuids == 1);
+    assert(a.protocol() == BmsScanDaly && a.name[0] == '\0');
+    cout << "PASS: 128-bit UUIDs on the base UUID read as 16-bit\n";
+}
+
+void test_parse_malformed_and_long_name() {
+    // A structure running past the end stops the parse, keeping the UUID
+    const uint8_t cut[] = {0x03, 0x03, 0xE0, 0xFF, 0x09, 0x09, 'J', 'K'};
+    BmsAdvertisement a;
+    BmsAdvertisement::parse(cut, sizeof(cut), a);
+    assert(a.protocol() == BmsScanJk && a.name[0] == '\0');
+
+    uint8_t longName[2 + 40] = {41, 0x09};
+    memset(longName + 2, 'n', 40);
+    BmsAdvertisement::parse(longName, sizeof(longName), a);
+    assert(strlen(a.name) == BmsAdvertisement::kNameMax - 1);
+
+    // A shortened name does not replace a complete one
+    const uint8_t names[] = {0x03, 0x09, 'A', 'B', 0x02, 0x08, 'A'};
+    BmsAdvertisement::parse(names, sizeof(names), a);
+    assert(strcmp(a.name, "AB") == 0);
+
+    BmsAdvertisement::parse(nullptr, 0, a);
+    assert(a.uuidCount == 0 && a.protocol() == BmsScanUnknown);
+    cout << "PASS: malformed structures end the parse, names are cut to fit\n";
+}
+
+void test_dedup_and_rssi_smoothing() {
+    BmsScanTable t;
+    uint8_t a[6];
+    addr(a, 1);
+    assert(t.observe(a, -80, kJbdAdv, sizeof(kJbdAdv), 100));
+    assert(t.count() == 1 && t.entry(0).rssi == -80);
+    assert(strcmp(t.entry(0).mac, "A4:C1:38:00:00:01") == 0);
+    for (int i = 0; i < 40; i++) t.observe(a, -60, nullptr, 0, 200 + i);
+    assert(t.count() == 1);
+    assert(t.entry(0).rssi >= -61 && t.entry(0).rssi <= -59);
+    assert(t.entry(0).reports == 41);
+
+    // One outlier moves it a quarter of the way only
+    t.observe(a, -100, nullptr, 0, 300);
+    assert(t.entry(0).rssi >= -71 && t.entry(0).rssi <= -69);
+
+    // Reports without name or services keep what an earlier one said
+    assert(t.entry(0).protocol == BmsScanJbd && strcmp(t.entry(0).name, "xiaoxiang BMS") == 0);
+    cout << "PASS: one entry per device, RSSI smoothed, earlier name kept\n";
+}
+
+void test_full_table_keeps_bms() {
+    BmsScanTable t;
+    uint8_t a[6];
+    for (uint8_t i = 0; i < BmsScanTable::kEntries; i++) {
+        addr(a, i);
+        assert(t.observe(a, -70, nullptr, 0, 1000));
+    }
+    // A fresh unknown device waits for a place to go stale...
+    addr(a, 200);
+    assert(!t.observe(a, -50, nullptr, 0, 1000 + BmsScanTable::kStaleMs - 1));
+    // ...a BMS takes one at once
+    addr(a, 201);
+    assert(t.observe(a, -90, kJbdAdv, sizeof(kJbdAdv), 1001));
+    assert(t.count() == BmsScanTable::kEntries);
+
+    // Once everything is stale, unknown devices go before the BMS
+    for (uint8_t i = 0; i < BmsScanTable::kEntries; i++) {
+        addr(a, (uint8_t)(100 + i));
+        t.observe(a, -70, nullptr, 0, 20000 + i);
+    }
+    bool bmsKept = false;
+    for (uint8_t i = 0; i < t.count(); i++) {
+        if (t.entry(i).protocol == BmsScanJbd) bmsKept = true;
+    }
+    assert(bmsKept);
+    cout << "PASS: a full table makes room for a BMS, not for a passer-by\n";
+}
+
+void test_format_services() {
+    BmsScanEntry e;
+    memset(&e, 0, sizeof(e));
+    char text[64];
+    assert(e.formatServices(text, sizeof(text)) == 0 && text[0] == '\0');
+    e.uuids[0] = 0xFF00;
+    e.uuids[1] = 0x180F;
+    e.uuidCount = 2;
+    e.otherUuids = 1;
+    e.formatServices(text, sizeof(text));
+    assert(strcmp(text, "0xff00, 0x180f +1") == 0);
+    char small[10];
+    const size_t n = e.formatServices(small, sizeof(small));
+    assert(n == strlen(small) && strcmp(small, "0xff00") == 0);
+    cout << "PASS: services listed as 16-bit UUIDs\n";
+}
+
+int main() {
+    test_parse_16bit_and_name();
+    test_parse_128bit_on_base_uuid();
+    test_parse_malformed_and_long_name();
+    test_dedup_and_rssi_smoothing();
+    test_full_table_keeps_bms();
+    test_format_services();
+    return 0;
+}
@@ -0,0 +1,261 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/BluetoothBms/BmsSnapshot.h"
+
+static BmsSnapshot makeSnapshot(const uint16_t* cells, uint8_t cellCount) {
+    BmsSnapshot s;
+    s.clear();
+    s.hasData = true;
+    s.hasCellData = cellCount > 0;
+    s.cellCount = cellCount;
+    for (uint8_t i = 0; i < cellCount; i++) s.cellVoltagesMv[i] = cells[i];
+    return s;
+}
+
+void test_cleared_snapshot() {
+    BmsSnapshot s;
+    memset(&s, 0xAB, sizeof(s));
+    s.clear();
+    s.updateDerived();
+    assert(!s.hasData && !s.hasCellData);
+    assert(s.cellMinMv == 0 && s.cellMaxMv == 0 && s.cellDeltaMv == 0);
+    assert(s.tempMaxCelsius == 0);
+    assert(s.cellVoltageMv(0) == 0 && s.tempCelsius(0) == 0);
+    cout << "PASS: a cleared snapshot reads as no data\n";
+}
+
+void test_cell_min_max_delta() {
+    const uint16_t cells[] = {3310, 3295, 3342, 3301};
+    BmsSnapshot s = makeSnapshot(cells, 4);
+    s.updateDerived();
+    assert(s.cellMinMv == 3295);
+    assert(s.cellMaxMv == 3342);
+    assert(s.cellDeltaMv == 47);
+    assert(s.cellVoltageMv(2) == 3342);
+    assert(s.cellVoltageMv(4) == 0);
+    assert(s.cellSumMv == 13248 && s.cellAvgMv == 3312);
+    assert(s.cellsReported == 4 && s.cellWeakest == 1);
+    cout << "PASS: cell min/max/delta/sum/average derived from the frame\n";
+}
+
+void test_unreported_cells_are_skipped() {
+    // JBD: 4 cells announced in 0x03, only 3 read back in 0x04.
+    const uint16_t cells[] = {3310, 0, 3342, 3301};
+    BmsSnapshot s = makeSnapshot(cells, 4);
+    s.updateDerived();
+    assert(s.cellMinMv == 3301 && s.cellMaxMv == 3342 && s.cellDeltaMv == 41);
+    assert(s.cellsReported == 3 && s.cellAvgMv == 3317 && s.cellWeakest == 3);
+
+    const uint16_t none[] = {0, 0};
+    BmsSnapshot empty = makeSnapshot(none, 2);
+    empty.updateDerived();
+    assert(empty.cellMinMv == 0 && empty.cellMaxMv == 0 && empty.cellDeltaMv == 0);
+    assert(empty.cellAvgMv == 0 && empty.cellsReported == 0 && empty.cellWeakest == BmsSnapshot::kNoCell);
+    cout << "PASS: 0 mV cell slots do not count as the weakest cell\n";
+}
+
+void test_no_cell_stats_without_cell_data() {
+    const uint16_t cells[] = {3310, 3295};
+    BmsSnapshot s = makeSnapshot(cells, 2);
+    s.hasCellData = false;
+    s.updateDerived();
+    assert(s.cellMinMv == 0 && s.cellMaxMv == 0 && s.cellDeltaMv == 0);
+    assert(s.cellWeakest == BmsSnapshot::kNoCell);
+    cout << "PASS: no cell summary before a cell frame\n";
+}
+
+void test_cell_count_is_clamped() {
+    BmsSnapshot s;
+    s.clear();
+    s.hasCellData = true;
+    s.cellCount = 200;
+    for (uint8_t i = 0; i < BmsSnapshot::kMaxCells; i++) s.cellVoltagesMv[i] = 3000 + i;
+    s.updateDerived();
+    assert(s.cellMinMv == 3000 && s.cellMaxMv == 3000 + BmsSnapshot::kMaxCells - 1);
+    assert(s.cellVoltageMv(BmsSnapshot::kMaxCells) == 0);
+    cout << "PASS: an out-of-range cell count stays inside the array\n";
+}
+
+void test_weakest_cell_ties_keep_the_first() {
+    const uint16_t cells[] = {3400, 3300, 3500, 3300};
+    BmsSnapshot s = makeSnapshot(cells, 4);
+    s.updateDerived();
+    assert(s.cellWeakest == 1 && s.cellMinMv == 3300);
+    cout << "PASS: of two equally low cells the first is the weakest\n";
+}
+
+void test_pack_frame_keeps_cell_stats() {
+    const uint16_t cells[] = {3310, 3295};
+    BmsSnapshot s = makeSnapshot(cells, 2);
+    s.updateDerived();
+    // A pack frame only: the statistics still describe the last cell frame
+    s.cellVoltagesMv[1] = 3100;
+    s.tempCount = 1;
+    s.tempsCelsius[0] = 30;
+    s.updateDerived(false);
+    assert(s.cellMinMv == 3295 && s.cellWeakest == 1 && s.tempMaxCelsius == 30);
+    s.updateDerived();
+    assert(s.cellMinMv == 3100);
+    cout << "PASS: cell statistics only move with a cell frame\n";
+}
+
+void test_load_min_history() {
+    const uint16_t rest[] = {3400, 3390};
+    BmsSnapshot published;
+    published.clear();
+
+    // Resting: nothing recorded
+    BmsSnapshot s = makeSnapshot(rest, 2);
+    s.packCurrentMilliAmps = -2000;
+    s.updateLoadMin(published, true);
+    assert(s.cellLoadMinMv[0] == 0 && s.cellLoadMinMv[1] == 0);
+    published = s;
+
+    // Under load, then deeper on one cell, then lighter
+    const uint16_t sag[] = {3250, 3200};
+    s = makeSnapshot(sag, 2);
+    s.packCurrentMilliAmps = -BmsSnapshot::kLoadMilliAmps;
+    s.updateLoadMin(published, true);
+    assert(s.cellLoadMinMv[0] == 3250 && s.cellLoadMinMv[1] == 3200);
+    published = s;
+
+    const uint16_t deeper[] = {3280, 3150};
+    s = makeSnapshot(deeper, 2);
+    s.packCurrentMilliAmps = -40000;
+    s.updateLoadMin(published, true);
+    assert(s.cellLoadMinMv[0] == 3250 && s.cellLoadMinMv[1] == 3150);
+    published = s;
+
+    // No new cells (pack frame), a charge, a reconnect: kept as is
+    s.updateLoadMin(published, false);
+    assert(s.cellLoadMinMv[1] == 3150);
+    s = makeSnapshot(rest, 2);
+    s.packCurrentMilliAmps = 20000;
+    s.updateLoadMin(published, true);
+    assert(s.cellLoadMinMv[1] == 3150);
+    published = s;
+    BmsSnapshot reset;
+    reset.clear();
+    reset.updateLoadMin(published, false);
+    assert(reset.cellLoadMinMv[1] == 3150);
+    published = reset;
+
+    // Another pack (cell count changed): starts over
+    const uint16_t other[] = {3300, 3300, 3300};
+    s = makeSnapshot(other, 3);
+    s.packCurrentMilliAmps = -15000;
+    s.updateLoadMin(published, true);
+    assert(s.cellLoadMinMv[0] == 3300 && s.cellLoadMinMv[1] == 3300 && s.cellLoadMinCount == 3);
+    cout << "PASS: per-cell minimum under load kept across frames\n";
+}
+
+void test_hottest_sensor() {
+    BmsSnapshot s;
+    s.clear();
+    s.tempCount = 3;
+    s.tempsCelsius[0] = -5;
+    s.tempsCelsius[1] = -2;
+    s.tempsCelsius[2] = -9;
+    s.updateDerived();
+    assert(s.tempMaxCelsius == -2);   // not clamped to 0 below freezing
+
+    s.tempCount = 2;
+    s.tempsCelsius[1] = 41;
+    s.updateDerived();
+    assert(s.tempMaxCelsius == 41);
+    assert(s.tempCelsius(2) == 0);
+    cout << "PASS: hottest sensor derived, below zero included\n";
+}
+
+void test_parallel_packs_combined() {
+    const uint16_t cellsA[] = {3900, 3850, 3880};
+    const uint16_t cellsB[] = {3920, 3700, 3950};
+    BmsSnapshot packs[2] = { makeSnapshot(cellsA, 3), makeSnapshot(cellsB, 3) };
+    packs[0].packVoltageMilliVolts = 11630;
+    packs[0].packCurrentMilliAmps = 30000;
+    packs[0].socPercent = 71;
+    packs[0].dataMillis = 1000;
+    packs[0].cellMillis = 900;
+    packs[0].tempCount = 1;
+    packs[0].tempsCelsius[0] = 35;
+    packs[1].packVoltageMilliVolts = 11570;
+    packs[1].packCurrentMilliAmps = 28000;
+    packs[1].socPercent = 68;
+    packs[1].dataMillis = 1200;
+    packs[1].cellMillis = 800;
+    packs[1].tempCount = 2;
+    packs[1].tempsCelsius[0] = 31;
+    packs[1].tempsCelsius[1] = 38;
+    packs[0].updateDerived();
+    packs[1].updateDerived();
+
+    BmsSnapshot all;
+    BmsSnapshot::combineParallel(packs, 2, all);
+    assert(all.hasData && all.hasCellData);
+    assert(all.packCurrentMilliAmps == 58000);
+    assert(all.packVoltageMilliVolts == 11570 && all.socPercent == 68);
+    assert(all.dataMillis == 1000 && all.cellMillis == 800);        // oldest
+    assert(all.cellCount == 6 && all.cellVoltageMv(4) == 3700);
+    assert(all.cellMinMv == 3700 && all.cellMaxMv == 3950 && all.cellDeltaMv == 250);
+    assert(all.tempCount == 3 && all.tempMaxCelsius == 38);
+    assert(all.cellWeakest == 4 && all.cellsReported == 6);
+    assert(all.cellSumMv == 23200 && all.cellAvgMv == 3866);
+    cout << "PASS: parallel packs: current summed, lowest voltage/SoC, worst cells\n";
+}
+
+void test_parallel_pack_without_data_skipped() {
+    const uint16_t cells[] = {3800, 3810};
+    BmsSnapshot packs[2] = { makeSnapshot(cells, 2), BmsSnapshot() };
+    packs[0].packVoltageMilliVolts = 7610;
+    packs[0].packCurrentMilliAmps = -1500;
+    packs[0].socPercent = 55;
+    packs[0].updateDerived();
+    packs[1].clear();
+
+    BmsSnapshot all;
+    BmsSnapshot::combineParallel(packs, 2, all);
+    assert(all.packVoltageMilliVolts == 7610 && all.packCurrentMilliAmps == -1500);
+    assert(all.socPercent == 55 && all.cellCount == 2);
+    assert(all.cellMinMv == 3800 && all.cellMaxMv == 3810);
+
+    BmsSnapshot none;
+    BmsSnapshot::combineParallel(packs + 1, 1, none);
+    assert(!none.hasData && !none.hasCellData && none.cellDeltaMv == 0);
+    cout << "PASS: a pack without data does not drag the others down\n";
+}
+
+void test_parallel_cells_beyond_capacity() {
+    uint16_t cells[BmsSnapshot::kMaxCells];
+    for (uint8_t i = 0; i < BmsSnapshot::kMaxCells; i++) cells[i] = 3600 + i;
+    BmsSnapshot packs[2] = { makeSnapshot(cells, 20), makeSnapshot(cells, 20) };
+    packs[1].cellVoltagesMv[19] = 3100;       // weakest cell does not fit the list
+    packs[0].updateDerived();
+    packs[1].updateDerived();
+
+    BmsSnapshot all;
+    BmsSnapshot::combineParallel(packs, 2, all);
+    assert(all.cellCount == BmsSnapshot::kMaxCells);
+    assert(all.cellMinMv == 3100 && all.cellMaxMv == 3619);
+    assert(all.cellWeakest == BmsSnapshot::kNoCell && all.cellsReported == 40);
+    cout << "PASS: extremes cover cells that do not fit the combined list\n";
+}
+
+int main() {
+    test_cleared_snapshot();
+    test_cell_min_max_delta();
+    test_unreported_cells_are_skipped();
+    test_no_cell_stats_without_cell_data();
+    test_cell_count_is_clamped();
+    test_weakest_cell_ties_keep_the_first();
+    test_pack_frame_keeps_cell_stats();
+    test_load_min_history();
+    test_hottest_sensor();
+    test_parallel_packs_combined();
+    test_parallel_pack_without_data_skipped();
+    test_parallel_cells_beyond_capacity();
+    return 0;
+}
@@ -0,0 +1,31 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Clock/ClockAnchor.h"
+
+void test_unset_anchor() {
+    ClockAnchor a;
+    uint64_t epochUs = 123;
+    assert(!a.epochUsAt(1000, epochUs) && epochUs == 123);
+    cout << "PASS: no wall clock before the anchor is set\n";
+}
+
+void test_before_and_after_the_anchor() {
+    ClockAnchor a;
+    a.set(5000000, 1745060096000000ULL);   // set 5 s after boot
+    uint64_t epochUs = 0;
+    assert(a.epochUsAt(5000000, epochUs) && epochUs == 1745060096000000ULL);
+    assert(a.epochUsAt(5000250, epochUs) && epochUs == 1745060096000250ULL);
+    // A file that started (pre-arm ring) before the clock was set.
+    assert(a.epochUsAt(1000000, epochUs) && epochUs == 1745060092000000ULL);
+    cout << "PASS: wall clock either side of the anchor\n";
+}
+
+int main() {
+    test_unset_anchor();
+    test_before_and_after_the_anchor();
+    return 0;
+}
@@ -0,0 +1,106 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <stddef.h>
+using namespace std;
+
+#include "../src/DalyBms/DalyBmsParser.h"
+
+static void putBE16(uint8_t* buf, size_t off, uint16_t v) {
+    buf[off]     = (uint8_t)(v >> 8);
+    buf[off + 1] = (uint8_t)(v & 0xFF);
+}
+
+// 16S pack: 53.2 V, -25.0 A, 76.4 %, 2 sensors at 24 / 27 °C
+static size_t makeStatusFrame(uint8_t* f, uint16_t cellCount, uint16_t tempCount) {
+    memset(f, 0, DALY_STATUS_FRAME_LEN_62);
+    f[0] = 0xD2;
+    f[1] = DALY_READ_FN;
+    f[2] = DALY_STATUS_DATA_LEN_62;
+    for (uint16_t i = 0; i < 16; i++) putBE16(f, DALY_CELL_BASE_OFFSET + i * 2, (uint16_t)(3320 + i));
+    putBE16(f, DALY_TEMP_BASE_OFFSET, 24 + 40);
+    putBE16(f, DALY_TEMP_BASE_OFFSET + 2, 27 + 40);
+    putBE16(f, DALY_PACK_VOLTAGE_OFFSET, 532);
+    putBE16(f, DALY_PACK_CURRENT_OFFSET, 30000 - 250);
+    putBE16(f, DALY_SOC_OFFSET, 764);
+    putBE16(f, DALY_REMAINING_OFFSET, 305);
+    putBE16(f, DALY_CELL_COUNT_OFFSET, cellCount);
+    putBE16(f, DALY_TEMP_COUNT_OFFSET, tempCount);
+    putBE16(f, DALY_CYCLES_OFFSET, 118);
+    putBE16(f, DALY_BALANCE_OFFSET, 0x0001);
+    putBE16(f, DALY_CHARGE_FET_OFFSET, 0x0001);
+    putBE16(f, DALY_DISCHARGE_FET_OFFSET, 0x0000);
+    const uint16_t crc = dalyCrc16Modbus(f, DALY_STATUS_FRAME_LEN_62 - 2);
+    f[DALY_STATUS_FRAME_LEN_62 - 2] = (uint8_t)(crc & 0xFF);
+    f[DALY_STATUS_FRAME_LEN_62 - 1] = (uint8_t)(crc >> 8);
+    return DALY_STATUS_FRAME_LEN_62;
+}
+
+void test_status_request() {
+    uint8_t req[DALY_STATUS_REQUEST_LEN];
+    dalyBuildStatusRequest(req);
+    const uint8_t head[] = {0xD2, 0x03, 0x00, 0x00, 0x00, 0x3E};
+    assert(memcmp(req, head, sizeof(head)) == 0);
+    const uint16_t crc = dalyCrc16Modbus(req, 6);
+    assert(req[6] == (crc & 0xFF) && req[7] == (crc >> 8));
+    cout << "PASS: status request, 62 registers from 0\n";
+}
+
+void test_status_frame_decodes_every_field() {
+    uint8_t f[DALY_STATUS_FRAME_LEN_62];
+    const size_t len = makeStatusFrame(f, 16, 2);
+    DalyStatus s;
+    assert(dalyParseStatusFrame(f, len, &s));
+    assert(s.packVoltageMilliVolts == 53200);
+    assert(s.packCurrentMilliAmps == -25000);
+    assert(s.socPercent == 76);
+    assert(s.remainingCapacityMilliAh == 30500);
+    assert(s.cycleCount == 118);
+    assert(s.cellCount == 16 && s.tempCount == 2);
+    assert(s.cellVoltagesMv[0] == 3320 && s.cellVoltagesMv[15] == 3335 && s.cellVoltagesMv[16] == 0);
+    assert(s.tempsCelsius[0] == 24 && s.tempsCelsius[1] == 27);
+    assert(s.balanceEnabled && s.chargeEnabled && !s.dischargeEnabled);
+    cout << "PASS: status frame decodes every field\n";
+}
+
+void test_sub_zero_sensor() {
+    uint8_t f[DALY_STATUS_FRAME_LEN_62];
+    const size_t len = makeStatusFrame(f, 16, 1);
+    putBE16(f, DALY_TEMP_BASE_OFFSET, 40 - 8);
+    DalyStatus s;
+    assert(dalyParseStatusFrame(f, len, &s));
+    assert(s.tempsCelsius[0] == -8);
+    cout << "PASS: sensor below 0 °C\n";
+}
+
+void test_counts_are_clamped() {
+    uint8_t f[DALY_STATUS_FRAME_LEN_62];
+    const size_t len = makeStatusFrame(f, 300, 99);
+    DalyStatus s;
+    assert(dalyParseStatusFrame(f, len, &s));
+    assert(s.cellCount == DALY_MAX_CELLS && s.tempCount == DALY_MAX_TEMPS);
+    cout << "PASS: cell and sensor counts clamped to the arrays\n";
+}
+
+void test_other_frames_are_rejected() {
+    uint8_t f[DALY_STATUS_FRAME_LEN_62];
+    size_t len = makeStatusFrame(f, 16, 2);
+    DalyStatus s;
+    assert(!dalyParseStatusFrame(f, len - 1, &s));
+    f[1] = 0x10;                                   // write echo, not a read
+    assert(!dalyParseStatusFrame(f, len, &s));
+    len = makeStatusFrame(f, 16, 2);
+    f[2] = DALY_STATUS_DATA_LEN_62 - 2;            // 61 registers
+    assert(!dalyParseStatusFrame(f, len, &s));
+    cout << "PASS: short frames and other functions rejected\n";
+}
+
+int main() {
+    test_status_request();
+    test_status_frame_decodes_every_field();
+    test_sub_zero_sensor();
+    test_counts_are_clamped();
+    test_other_frames_are_rejected();
+    return 0;
+}
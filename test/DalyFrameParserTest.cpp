@@ -0,0 +1,179 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+#include "../src/DalyBms/DalyFrameParser.h"
+
+static vector<uint8_t> makeFrame(uint8_t function, const vector<uint8_t>& data) {
+    vector<uint8_t> f = {0xD2, function, (uint8_t)data.size()};
+    f.insert(f.end(), data.begin(), data.end());
+    const uint16_t crc = dalyCrc16Modbus(f.data(), f.size());
+    f.push_back((uint8_t)(crc & 0xFF));
+    f.push_back((uint8_t)(crc >> 8));
+    return f;
+}
+
+// Bitwise reference CRC, independent of the parser's per-byte fold.
+static uint16_t referenceCrc(const uint8_t* data, size_t len) {
+    uint16_t crc = 0xFFFF;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++) crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+    return crc;
+}
+
+static bool frameIsValid(const vector<uint8_t>& f) {
+    if (f.size() < 5 || f[0] != 0xD2 || f.size() != 5u + f[2]) return false;
+    const uint16_t crc = referenceCrc(f.data(), f.size() - 2);
+    return f[f.size() - 2] == (crc & 0xFF) && f[f.size() - 1] == (crc >> 8);
+}
+
+static vector<vector<uint8_t>> parse(DalyFrameParser& parser, const vector<uint8_t>& stream, size_t chunk) {
+    vector<vector<uint8_t>> out;
+    for (size_t at = 0; at < stream.size(); at += chunk) {
+        const size_t n = stream.size() - at < chunk ? stream.size() - at : chunk;
+        parser.feed(stream.data() + at, n, [&](const DalyFrame& f) {
+            assert(f.raw[0] == 0xD2 && f.data == f.raw + 3 && f.rawLen == 5u + f.dataLen);
+            out.push_back(vector<uint8_t>(f.raw, f.raw + f.rawLen));
+        });
+    }
+    return out;
+}
+
+static vector<vector<uint8_t>> parse(const vector<uint8_t>& stream, size_t chunk) {
+    DalyFrameParser parser;
+    return parse(parser, stream, chunk);
+}
+
+static uint32_t lcg = 54321;
+static uint8_t nextByte() {
+    lcg = lcg * 1103515245u + 12345u;
+    return (uint8_t)(lcg >> 16);
+}
+
+// A reply to the status read, the only frame the parser takes
+static vector<uint8_t> statusFrame() {
+    vector<uint8_t> regs(DalyFrameParser::kDataLen);
+    for (auto& b : regs) b = nextByte();
+    return makeFrame(DalyFrameParser::kFunction, regs);
+}
+
+void test_crc_matches_modbus() {
+    // Modbus reference vector: 01 03 00 00 00 0A -> C5 CD
+    const uint8_t req[] = {0x01, 0x03, 0x00, 0x00, 0x00, 0x0A};
+    assert(dalyCrc16Modbus(req, sizeof(req)) == 0xCDC5);
+    // The status request the driver sends
+    const uint8_t status[] = {0xD2, 0x03, 0x00, 0x00, 0x00, 0x3E};
+    assert(dalyCrc16Modbus(status, sizeof(status)) == referenceCrc(status, sizeof(status)));
+    cout << "PASS: CRC-16/Modbus\n";
+}
+
+void test_status_frame_in_any_chunking() {
+    vector<uint8_t> regs(124);
+    for (size_t i = 0; i < regs.size(); i++) regs[i] = (uint8_t)(i * 3);
+    const vector<uint8_t> frame = makeFrame(0x03, regs);
+    assert(frame.size() == 129);
+    for (size_t chunk = 1; chunk <= 40; chunk++) {
+        DalyFrameParser parser;
+        const auto frames = parse(parser, frame, chunk);
+        assert(frames.size() == 1 && frames[0] == frame);
+        assert(parser.frames() == 1 && parser.rejected() == 0);
+    }
+    DalyFrameParser parser;
+    int seen = 0;
+    parser.feed(frame.data(), frame.size(), [&](const DalyFrame& f) {
+        assert(f.function == 0x03 && f.dataLen == 124 && f.data[1] == 3 && f.data[123] == (uint8_t)(123 * 3));
+        seen++;
+    });
+    assert(seen == 1);
+    cout << "PASS: 62-register status frame, split at every chunk size\n";
+}
+
+void test_bad_crc_rejected_and_rescanned() {
+    vector<uint8_t> bad = statusFrame();
+    bad[4] ^= 0x40;
+    const vector<uint8_t> good = statusFrame();
+    vector<uint8_t> stream = bad;
+    stream.insert(stream.end(), good.begin(), good.end());
+    DalyFrameParser parser;
+    const auto frames = parse(parser, stream, 9);
+    assert(frames.size() == 1 && frames[0] == good && parser.rejected() == 1);
+    cout << "PASS: CRC mismatch never emitted, the next frame still is\n";
+}
+
+void test_frame_inside_rejected_candidate_is_found() {
+    const vector<uint8_t> real = statusFrame();
+    vector<uint8_t> stream = {0x00, 0xD2, 0x03, 0x7C};   // stray header claiming 124 bytes
+    stream.insert(stream.end(), real.begin(), real.end());
+    stream.insert(stream.end(), 0x80, 0x55);
+    DalyFrameParser parser;
+    const auto frames = parse(parser, stream, 20);
+    assert(frames.size() == 1 && frames[0] == real && parser.rejected() == 1);
+    cout << "PASS: a frame inside a rejected candidate is still found\n";
+}
+
+void test_false_starts_dropped_at_the_header() {
+    // A D2 run, another function (a Modbus error reply), another length:
+    // each dropped at the byte that does not fit, the frame behind not
+    // held back.
+    const vector<uint8_t> real = statusFrame();
+    vector<uint8_t> stream = {0xD2, 0xD2, 0xD2, 0x83, 0x02, 0xD2, 0x03, 0x7B, 0x00};
+    stream.insert(stream.end(), real.begin(), real.end());
+    DalyFrameParser parser;
+    const auto frames = parse(parser, stream, 5);
+    assert(frames.size() == 1 && frames[0] == real && parser.rejected() == 0);
+    cout << "PASS: false starts dropped at the header, no frame held back\n";
+}
+
+void test_fuzz_frames_in_noise() {
+    for (int round = 0; round < 200; round++) {
+        vector<uint8_t> stream;
+        vector<vector<uint8_t>> sent;
+        const int frameCount = 1 + nextByte() % 8;
+        for (int k = 0; k < frameCount; k++) {
+            const size_t noise = nextByte() % 40;
+            for (size_t i = 0; i < noise; i++) stream.push_back(nextByte());
+            sent.push_back(statusFrame());
+            stream.insert(stream.end(), sent.back().begin(), sent.back().end());
+        }
+        for (size_t i = 0; i < DalyFrameParser::kMaxFrameLen; i++) stream.push_back(nextByte());
+
+        const auto whole = parse(stream, stream.size());
+        const auto chunked = parse(stream, 1 + nextByte() % 24);
+        assert(whole == chunked);
+        assert(whole == sent);
+    }
+    cout << "PASS: fuzz, frames in noise, any chunking\n";
+}
+
+void test_fuzz_noise_only() {
+    vector<uint8_t> noise(200000);
+    for (auto& b : noise) b = nextByte();
+    for (size_t i = 0; i < noise.size(); i += 7) noise[i] = 0xD2;
+    // and now and then a whole fitting header, so candidates fail their CRC
+    for (size_t i = 3; i + 3 < noise.size(); i += 50) {
+        noise[i] = 0xD2;
+        noise[i + 1] = DalyFrameParser::kFunction;
+        noise[i + 2] = DalyFrameParser::kDataLen;
+    }
+    DalyFrameParser parser;
+    const auto frames = parse(parser, noise, 61);
+    for (const auto& f : frames) assert(frameIsValid(f));
+    assert(parser.rejected() > 0);
+    cout << "PASS: fuzz, noise only, " << frames.size() << " accidental valid frames\n";
+}
+
+int main() {
+    test_crc_matches_modbus();
+    test_status_frame_in_any_chunking();
+    test_bad_crc_rejected_and_rescanned();
+    test_frame_inside_rejected_candidate_is_found();
+    test_false_starts_dropped_at_the_header();
+    test_fuzz_frames_in_noise();
+    test_fuzz_noise_only();
+    return 0;
+}
@@ -0,0 +1,57 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/WebServer/ETagLogic.h"
+
+void test_format() {
+    char tag[ETag::kMaxLength];
+    assert(ETag::format(tag, sizeof(tag), 0x1a2b3c4d, 42) == strlen("\"1a2b3c4d-42\""));
+    assert(strcmp(tag, "\"1a2b3c4d-42\"") == 0);
+    assert(ETag::format(tag, sizeof(tag), 0xFFFFFFFF, 0xFFFFFFFF) == ETag::kMaxLength - 1);
+    cout << "PASS: format\n";
+}
+
+void test_format_rejects_short_buffer() {
+    char tag[8];
+    assert(ETag::format(tag, sizeof(tag), 0x1a2b3c4d, 42) == 0);
+    cout << "PASS: format rejects a short buffer\n";
+}
+
+void test_match_exact_and_weak() {
+    const char* tag = "\"0000beef-7\"";
+    assert(ETag::matches("\"0000beef-7\"", tag));
+    assert(ETag::matches("W/\"0000beef-7\"", tag));
+    assert(!ETag::matches("\"0000beef-8\"", tag));
+    assert(!ETag::matches("\"0000beef-7", tag));
+    cout << "PASS: exact and weak tags match\n";
+}
+
+void test_match_list_and_wildcard() {
+    const char* tag = "\"0000beef-7\"";
+    assert(ETag::matches("\"0000beef-6\", \"0000beef-7\"", tag));
+    assert(ETag::matches("\"x\",W/\"0000beef-7\" ", tag));
+    assert(!ETag::matches("\"0000beef-6\", \"0000beef-70\"", tag));
+    assert(ETag::matches("*", tag));
+    cout << "PASS: lists and wildcard\n";
+}
+
+void test_match_rejects_empty_and_other_boot() {
+    const char* tag = "\"0000beef-7\"";
+    assert(!ETag::matches("", tag));
+    assert(!ETag::matches(" , ", tag));
+    assert(!ETag::matches(nullptr, tag));
+    assert(!ETag::matches("\"0000cafe-7\"", tag));   // same generation, previous boot
+    cout << "PASS: empty headers and other boots never match\n";
+}
+
+int main() {
+    test_format();
+    test_format_rejects_short_buffer();
+    test_match_exact_and_weak();
+    test_match_list_and_wildcard();
+    test_match_rejects_empty_and_other_boot();
+    return 0;
+}
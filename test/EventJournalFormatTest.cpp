@@ -0,0 +1,85 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/EventJournal/EventJournalFormat.h"
+
+void test_event_round_trip() {
+    EventJournalFormat::Event e = {0x1122DEADBEEFULL, 1745060096, EventJournalFormat::EventDisarmed, 4, 0xA55A};
+    uint8_t buf[EventJournalFormat::kRecordSize];
+    EventJournalFormat::encodeEvent(e, buf);
+    EventJournalFormat::Event back;
+    EventJournalFormat::decodeEvent(buf, back);
+    assert(back.uptimeUs == e.uptimeUs && back.epochS == e.epochS);
+    assert(back.id == e.id && back.arg == e.arg && back.value == e.value);
+    assert(buf[0] == 0xEF && buf[15] == 0xA5);   // little-endian
+    cout << "PASS: event round-trips\n";
+}
+
+void test_version_1_records() {
+    const uint8_t v1[EventJournalFormat::kRecordSizeV1] = {0x10, 0x27, 0, 0, 0, 0, 0, 0,
+                                                            EventJournalFormat::EventArmed, 0, 7, 0};
+    EventJournalFormat::Event e;
+    EventJournalFormat::decodeEvent(v1, e, 1);
+    assert(e.uptimeUs == 10000000ULL && e.epochS == 0);
+    assert(e.id == EventJournalFormat::EventArmed && e.value == 7);
+    cout << "PASS: version 1 records still decode\n";
+}
+
+void test_header() {
+    uint8_t head[EventJournalFormat::kHeaderSize];
+    uint8_t version = 0;
+    EventJournalFormat::encodeHeader(head);
+    assert(EventJournalFormat::decodeHeader(head, sizeof(head), version) == EventJournalFormat::kRecordSize);
+    assert(version == EventJournalFormat::kVersion);
+    assert(EventJournalFormat::decodeHeader(head, sizeof(head) - 1, version) == 0);
+
+    // A newer version with longer records is still readable.
+    head[4] = EventJournalFormat::kVersion + 1;
+    head[5] = EventJournalFormat::kRecordSize + 4;
+    assert(EventJournalFormat::decodeHeader(head, sizeof(head), version) == EventJournalFormat::kRecordSize + 4);
+    head[5] = EventJournalFormat::kRecordSize - 1;
+    assert(EventJournalFormat::decodeHeader(head, sizeof(head), version) == 0);
+
+    // Version 1 had shorter records.
+    head[4] = 1;
+    head[5] = EventJournalFormat::kRecordSizeV1;
+    assert(EventJournalFormat::decodeHeader(head, sizeof(head), version) == EventJournalFormat::kRecordSizeV1);
+    assert(version == 1);
+
+    const uint8_t flog[8] = {'F', 'L', 'O', 'G', 2, 1, 29, 0};
+    assert(EventJournalFormat::decodeHeader(flog, sizeof(flog), version) == 0);
+    cout << "PASS: journal header\n";
+}
+
+void test_rotation() {
+    const uint32_t batch = 3 * EventJournalFormat::kRecordSize;
+    assert(!EventJournalFormat::shouldRotate(0, batch));
+    assert(!EventJournalFormat::shouldRotate(EventJournalFormat::kHeaderSize, EventJournalFormat::kMaxFileBytes));
+    assert(!EventJournalFormat::shouldRotate(EventJournalFormat::kMaxFileBytes - batch, batch));
+    assert(EventJournalFormat::shouldRotate(EventJournalFormat::kMaxFileBytes - batch + 1, batch));
+    cout << "PASS: rotation at the size limit\n";
+}
+
+void test_codes_are_distinct() {
+    for (uint8_t a = EventJournalFormat::EventBoot; a <= EventJournalFormat::EventPowerLimit; a++) {
+        assert(strcmp(EventJournalFormat::eventCode(a), "UNKNOWN") != 0);
+        for (uint8_t b = a + 1; b <= EventJournalFormat::EventPowerLimit; b++) {
+            assert(strcmp(EventJournalFormat::eventCode(a), EventJournalFormat::eventCode(b)) != 0);
+        }
+    }
+    assert(strcmp(EventJournalFormat::eventCode(0), "UNKNOWN") == 0);
+    assert(strcmp(EventJournalFormat::eventCode(200), "UNKNOWN") == 0);
+    cout << "PASS: every event id has its own code\n";
+}
+
+int main() {
+    test_event_round_trip();
+    test_version_1_records();
+    test_header();
+    test_rotation();
+    test_codes_are_distinct();
+    return 0;
+}
@@ -0,0 +1,108 @@
+#include <iostream>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/FlightLogFormat.h"
+
+// Host benchmark: CPU time and bytes per log record, packed binary vs the
+// text path TelemetryLogger used before (appendToBuffer/vsnprintf per field
+// plus the timestamp). Build with `g++ -O2 -std=c++17`.
+
+static const int ITERATIONS = 500000;
+
+static bool appendToBuffer(char* data, size_t size, size_t& used, const char* format, ...) {
+    if (used >= size) return false;
+    va_list args;
+    va_start(args, format);
+    const int written = vsnprintf(data + used, size - used, format, args);
+    va_end(args);
+    if (written < 0 || (size_t)written >= size - used) return false;
+    used += (size_t)written;
+    return true;
+}
+
+static size_t textRecord(int i, char* data, size_t size) {
+    size_t used = 0;
+    appendToBuffer(data, size, used, "%02d:%02d:%02d,", (i / 3600) % 24, (i / 60) % 60, i % 60);
+    appendToBuffer(data, size, used, "%u,%u,%u.", 87u, 85u, 50u);
+    appendToBuffer(data, size, used, "%u,", 50u + (unsigned)(i % 900));
+    appendToBuffer(data, size, used, "%lu.%lu", 3ul, 2ul);
+    appendToBuffer(data, size, used, ",");
+    appendToBuffer(data, size, used, "%u,%u,%u,", 45u, 1234u + (unsigned)(i % 100), 100u);
+    appendToBuffer(data, size, used, "%ld", (long)(56 + i % 3));
+    appendToBuffer(data, size, used, ",");
+    appendToBuffer(data, size, used, "%lu,%lu", 5000ul, 64ul);
+    appendToBuffer(data, size, used, ",");
+    appendToBuffer(data, size, used, "%ld", 48l);
+    appendToBuffer(data, size, used, ",%d", 31);
+    appendToBuffer(data, size, used, ",%u,%u", 3712u, 3731u);
+    appendToBuffer(data, size, used, "\r\n");
+    return used;
+}
+
+// Encodes ITERATIONS full records; the writer stores the first
+// fullRecordSize(withPacks) bytes of each, so that is what gets counted.
+static long long binaryRecords(bool withPacks, uint32_t& checksum) {
+    const size_t size = FlightLog::fullRecordSize(withPacks);
+    uint8_t rec[FlightLog::kRecordSize];
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        FlightLog::Record r;
+        r.offset = (uint32_t)i * 1000;
+        r.flags = FlightLog::RecordHasTelemetry | FlightLog::RecordHasPowerKw | FlightLog::RecordHasCurrent
+                | FlightLog::RecordHasBmsTemp | FlightLog::RecordHasCells;
+        r.batteryPercentCc = 87;
+        r.batteryPercentVoltage = 85;
+        r.batteryVoltageMv = (uint16_t)(50050 + i % 900);
+        r.powerKwX10 = 32;
+        r.throttlePercent = 45;
+        r.throttleRaw = (uint16_t)(1234 + i % 100);
+        r.powerPercent = 100;
+        r.motorTempDc = FlightLog::milliToDeci(56000 + i % 3000);
+        r.rpm = 5000;
+        r.escCurrentDa = FlightLog::milliToDeciU(64000);
+        r.escTempDc = FlightLog::milliToDeci(48000);
+        r.bmsTempMaxC = 31;
+        r.cellMinMv = 3712;
+        r.cellMaxMv = 3731;
+        if (withPacks) {
+            const uint8_t packFlags = FlightLog::PackHasData | FlightLog::PackHasCells | FlightLog::PackHasTemp;
+            r.packFlags = (uint8_t)(packFlags << FlightLog::packFlagShift(0) | packFlags << FlightLog::packFlagShift(1));
+            r.packs[0] = {88, (int16_t)(320 + i % 10), 3712, 3731, 31};
+            r.packs[1] = {86, (int16_t)(318 + i % 10), 3715, 3729, 30};
+        }
+        FlightLog::encodeRecord(r, rec);
+        checksum += rec[i % size];
+    }
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+}
+
+static void report(const char* name, long long ns, size_t bytesPerRecord) {
+    cout << name << ns / ITERATIONS << " ns/record, " << bytesPerRecord << " bytes/record, "
+         << (double)bytesPerRecord * ITERATIONS * 1000.0 / (double)ns << " MB/s\n";
+}
+
+int main() {
+    uint32_t checksum = 0;
+    size_t textBytes = 0;
+    char line[224];
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        textBytes = textRecord(i, line, sizeof(line));
+        checksum += (uint8_t)line[textBytes / 2];
+    }
+    const auto textNs = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+
+    const long long singleNs = binaryRecords(false, checksum);
+    const long long packsNs = binaryRecords(true, checksum);
+
+    report("text CSV:                  ", textNs, textBytes);
+    report("packed binary, one pack:   ", singleNs, FlightLog::fullRecordSize(false));
+    report("packed binary, two packs:  ", packsNs, FlightLog::fullRecordSize(true));
+    cout << "checksum " << checksum << "\n";
+    return 0;
+}
@@ -0,0 +1,471 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/FlightLogFormat.h"
+
+static FlightLog::Header makeHeader(uint8_t flags, uint64_t epochMs, uint32_t startMillis) {
+    FlightLog::Header h;
+    h.version = FlightLog::kVersion;
+    h.schema = FlightLog::kSchemaTelemetryV1;
+    h.recordSize = FlightLog::kRecordSize;
+    h.flags = flags;
+    h.fastRecordSize = FlightLog::kFastRecordSize;
+    h.startEpochMs = epochMs;
+    h.startMillis = startMillis;
+    h.startMonoUs = (uint64_t)startMillis * 1000;
+    return h;
+}
+
+static FlightLog::Record fullRecord(uint32_t offset) {
+    FlightLog::Record r;
+    memset(&r, 0, sizeof(r));
+    r.offset = offset;
+    r.flags = FlightLog::RecordHasTelemetry | FlightLog::RecordHasPowerKw | FlightLog::RecordHasCurrent
+            | FlightLog::RecordHasBmsTemp | FlightLog::RecordHasCells;
+    r.batteryPercentCc = 87;
+    r.batteryPercentVoltage = 85;
+    r.batteryVoltageMv = 50050;
+    r.powerKwX10 = 32;
+    r.throttlePercent = 45;
+    r.throttleRaw = 1234;
+    r.powerPercent = 100;
+    r.motorTempDc = FlightLog::milliToDeci(56789);
+    r.rpm = 5000;
+    r.escCurrentDa = FlightLog::milliToDeciU(64999);
+    r.escTempDc = FlightLog::milliToDeci(-1500);
+    r.bmsTempMaxC = 31;
+    r.cellMinMv = 3712;
+    r.cellMaxMv = 3731;
+    return r;
+}
+
+static FlightLog::FastRecord fastRecord(uint32_t offset) {
+    FlightLog::FastRecord r;
+    memset(&r, 0, sizeof(r));
+    r.offset = offset;
+    r.flags = FlightLog::RecordHasTelemetry | FlightLog::RecordHasPowerKw | FlightLog::RecordHasCurrent;
+    r.throttlePercent = 62;
+    r.powerPercent = 100;
+    r.throttleRaw = 1900;
+    r.rpm = 6100;
+    r.escCurrentDa = 1234;
+    r.batteryVoltageMv = 48007;
+    r.powerKwX10 = 59;
+    return r;
+}
+
+static string csvLine(const FlightLog::Header& h, const FlightLog::Record& r) {
+    char line[FlightLog::kMaxCsvLine];
+    FlightLog::RecordClock clock;
+    clock.reset(h);
+    const size_t n = FlightLog::formatCsvLine(h, r, clock.offsetUs(r.offset), line, sizeof(line));
+    assert(n > 0);
+    return string(line, n);
+}
+
+void test_header_round_trip() {
+    const FlightLog::Header in = makeHeader(FlightLog::HeaderEpochValid, 1745060096123ULL, 98765);
+    uint8_t buf[FlightLog::kHeaderSize];
+    FlightLog::encodeHeader(in, buf);
+    FlightLog::Header out;
+    assert(FlightLog::decodeHeader(buf, sizeof(buf), out));
+    assert(out.flags == in.flags && out.startEpochMs == in.startEpochMs && out.startMillis == in.startMillis);
+    assert(out.startMonoUs == in.startMonoUs);
+    assert(out.recordSize == FlightLog::kRecordSize && out.fastRecordSize == FlightLog::kFastRecordSize);
+
+    buf[0] = 'X';
+    assert(!FlightLog::decodeHeader(buf, sizeof(buf), out));
+    FlightLog::encodeHeader(in, buf);
+    buf[4] = FlightLog::kVersion + 1;
+    assert(!FlightLog::decodeHeader(buf, sizeof(buf), out));
+    FlightLog::encodeHeader(in, buf);
+    assert(!FlightLog::decodeHeader(buf, sizeof(buf) - 1, out));
+    cout << "PASS: header round-trips and rejects unknown files\n";
+}
+
+void test_version_1_header_has_no_fast_records() {
+    uint8_t buf[FlightLog::kHeaderSize];
+    FlightLog::encodeHeader(makeHeader(0, 0, 0), buf);
+    buf[4] = 1;
+    buf[9] = 0;   // reserved in version 1
+    FlightLog::Header out;
+    assert(FlightLog::decodeHeader(buf, sizeof(buf), out));
+    assert(out.version == 1 && out.fastRecordSize == 0);
+    assert(FlightLog::decodeHeader(buf, FlightLog::kLegacyHeaderSize, out));
+    assert(out.startMonoUs == 0);
+
+    FlightLog::encodeHeader(makeHeader(0, 0, 0), buf);
+    buf[9] = FlightLog::kFastRecordSize - 1;
+    assert(!FlightLog::decodeHeader(buf, sizeof(buf), out));
+    cout << "PASS: version 1 headers still decode\n";
+}
+
+void test_record_round_trip() {
+    const FlightLog::Record in = fullRecord(123456);
+    uint8_t buf[FlightLog::kRecordSize];
+    FlightLog::encodeRecord(in, buf);
+    FlightLog::Record out;
+    memset(&out, 0, sizeof(out));   // padding, so memcmp compares fields only
+    FlightLog::decodeRecord(buf, out);
+    assert(memcmp(&in, &out, sizeof(in)) == 0);
+    cout << "PASS: record round-trips\n";
+}
+
+void test_csv_line_matches_text_logger() {
+    // 2025-04-19T10:54:56Z, file named by date -> time only.
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid | FlightLog::HeaderNameHasDate,
+                                           1745060096000ULL, 0);
+    assert(csvLine(h, fullRecord(0)) == "10:54:56,87,85,50.050,3.2,45,1234,100,56,5000,64,-1,31,3712,3731,armed,0,,,,,,,,,,\r\n");
+    assert(csvLine(h, fullRecord(61500000)).compare(0, 9, "10:55:57,") == 0);
+    cout << "PASS: CSV line matches the text logger\n";
+}
+
+void test_fast_record_csv_leaves_slow_columns_empty() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid | FlightLog::HeaderNameHasDate
+                                           | FlightLog::HeaderMillis, 1745060096000ULL, 0);
+    uint8_t buf[FlightLog::kFastRecordSize];
+    FlightLog::encodeFastRecord(fastRecord(20000), buf);
+    assert(buf[4] & FlightLog::RecordFast);
+    FlightLog::Record r;
+    FlightLog::decodeFastRecord(buf, r);
+    assert(csvLine(h, r) == "10:54:56.020,,,48.007,5.9,62,1900,100,,6100,123,,,,,armed,20000,,,,,,,,,,\r\n");
+
+    FlightLog::FastRecord pre = fastRecord(0);
+    pre.flags |= FlightLog::RecordPreArm;
+    FlightLog::encodeFastRecord(pre, buf);
+    FlightLog::decodeFastRecord(buf, r);
+    assert(csvLine(h, r).find(",pre,0,,,,,,,,,,\r\n") != string::npos);
+
+    // The full record of a high-rate file carries milliseconds too.
+    assert(csvLine(h, fullRecord(1000000)).compare(0, 13, "10:54:57.000,") == 0);
+    cout << "PASS: fast record CSV line\n";
+}
+
+void test_csv_empty_cells() {
+    const FlightLog::Header h = makeHeader(0, 0, 1000);
+    FlightLog::Record r = fullRecord(234567);
+    r.flags = FlightLog::RecordPostDisarm;
+    assert(csvLine(h, r) == "ms:1234,,,,,45,1234,100,,,,,,,,post,1234567,,,,,,,,,,\r\n");
+
+    r.flags = FlightLog::RecordHasTelemetry;
+    assert(csvLine(h, r) == "ms:1234,87,85,50.050,,45,1234,100,56,,,-1,,,,armed,1234567,,,,,,,,,,\r\n");
+    cout << "PASS: unavailable groups become empty cells\n";
+}
+
+void test_csv_pack_columns() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid | FlightLog::HeaderNameHasDate,
+                                           1745060096000ULL, 0);
+    FlightLog::Record r = fullRecord(0);
+    r.packFlags = (uint8_t)((FlightLog::PackHasData | FlightLog::PackHasCells | FlightLog::PackHasTemp)
+                                << FlightLog::packFlagShift(0)
+                            | (FlightLog::PackHasData | FlightLog::PackHasTemp) << FlightLog::packFlagShift(1));
+    r.packs[0] = {88, 423, 3731, 3745, 29};
+    r.packs[1] = {85, -12, 3712, 3731, 31};
+    const string line = csvLine(h, r);
+    assert(line.find(",armed,0,88,42,3731,3745,29,85,-1,,,31\r\n") != string::npos);
+
+    // A pack without temperature sensors leaves its cell empty, not 0
+    r.packFlags &= (uint8_t)~(FlightLog::PackHasTemp << FlightLog::packFlagShift(1));
+    r.packs[1].tempMaxC = 0;
+    assert(csvLine(h, r).find(",armed,0,88,42,3731,3745,29,85,-1,,,\r\n") != string::npos);
+
+    uint8_t buf[FlightLog::kRecordSize];
+    FlightLog::encodeRecord(r, buf);
+    FlightLog::Record out;
+    FlightLog::decodeRecord(buf, out, FlightLog::kRecordSizeV1);
+    assert(out.packFlags == 0 && out.packs[0].soc == 0 && out.cellMaxMv == r.cellMaxMv);
+    cout << "PASS: per-pack columns, empty for packs without data or sensors\n";
+}
+
+void test_csv_full_timestamp_without_dated_name() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid, 1745060096000ULL, 0);
+    assert(csvLine(h, fullRecord(0)).compare(0, 20, "2025-04-19T10:54:56,") == 0);
+    cout << "PASS: full timestamp when the file name has no date\n";
+}
+
+static vector<uint8_t> buildFile(const FlightLog::Header& h, int records, size_t extraPerRecord) {
+    vector<uint8_t> file(FlightLog::kHeaderSize);
+    FlightLog::encodeHeader(h, file.data());
+    for (int i = 0; i < records; i++) {
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(fullRecord((uint32_t)i * 1000), rec);
+        file.insert(file.end(), rec, rec + sizeof(rec));
+        file.insert(file.end(), extraPerRecord, 0xAB);
+    }
+    return file;
+}
+
+static string convert(const vector<uint8_t>& file, size_t inChunk, size_t outChunk, bool* failed) {
+    FlightLog::CsvConverter conv;
+    string csv;
+    size_t pos = 0;
+    uint8_t out[256];
+    while (true) {
+        size_t n = conv.read(out, outChunk);
+        csv.append(reinterpret_cast<char*>(out), n);
+        if (n > 0) continue;
+        if (conv.failed() || pos == file.size()) break;
+        size_t len = min(inChunk, file.size() - pos);
+        len = min(len, conv.wants());
+        pos += conv.push(file.data() + pos, len);
+    }
+    *failed = conv.failed();
+    return csv;
+}
+
+void test_converter_any_chunking() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid | FlightLog::HeaderNameHasDate,
+                                           1745060096000ULL, 0);
+    const vector<uint8_t> file = buildFile(h, 5, 0);
+    bool failed = false;
+    const string reference = convert(file, 4096, 256, &failed);
+    assert(!failed);
+    assert(reference.compare(0, sizeof(FlightLog::kCsvHeader) - 1, FlightLog::kCsvHeader) == 0);
+    size_t lines = 0;
+    for (char c : reference) if (c == '\n') lines++;
+    assert(lines == 6);
+
+    for (size_t inChunk : {1, 7, 29, 100}) {
+        for (size_t outChunk : {1, 13, 64}) {
+            assert(convert(file, inChunk, outChunk, &failed) == reference);
+            assert(!failed);
+        }
+    }
+    cout << "PASS: converter output is independent of chunking\n";
+}
+
+void test_converter_skips_newer_record_tail() {
+    FlightLog::Header h = makeHeader(0, 0, 0);
+    h.recordSize = FlightLog::kRecordSize + 6;   // a later schema appended fields
+    bool failed = false;
+    const string csv = convert(buildFile(h, 3, 6), 5, 64, &failed);
+    assert(!failed);
+    FlightLog::Header plain = makeHeader(0, 0, 0);
+    assert(csv == convert(buildFile(plain, 3, 0), 5, 64, &failed));
+    cout << "PASS: converter skips fields appended by newer schemas\n";
+}
+
+void test_converter_reads_records_without_packs() {
+    FlightLog::Header h = makeHeader(0, 0, 0);
+    h.recordSize = (uint16_t)FlightLog::fullRecordSize(false);   // a single pack
+    assert(h.recordSize == FlightLog::kRecordSizeV1);
+    assert(FlightLog::fullRecordSize(true) == FlightLog::kRecordSize);
+    vector<uint8_t> file(FlightLog::kHeaderSize);
+    FlightLog::encodeHeader(h, file.data());
+    for (int i = 0; i < 3; i++) {
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(fullRecord((uint32_t)i * 1000), rec);
+        file.insert(file.end(), rec, rec + h.recordSize);   // as the logger cuts it
+    }
+    bool failed = false;
+    const string csv = convert(file, 5, 64, &failed);
+    assert(!failed);
+    assert(csv == convert(buildFile(makeHeader(0, 0, 0), 3, 0), 5, 64, &failed));
+    cout << "PASS: converter reads single-pack records, without the per-pack fields\n";
+}
+
+void test_converter_mixed_rates() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderMillis, 0, 0);
+    vector<uint8_t> file(FlightLog::kHeaderSize);
+    FlightLog::encodeHeader(h, file.data());
+    for (uint32_t t = 0; t < 2000; t += 20) {
+        if (t % 1000 == 0) {
+            uint8_t rec[FlightLog::kRecordSize];
+            FlightLog::encodeRecord(fullRecord(t * 1000), rec);
+            file.insert(file.end(), rec, rec + sizeof(rec));
+        } else {
+            uint8_t rec[FlightLog::kFastRecordSize];
+            FlightLog::encodeFastRecord(fastRecord(t * 1000), rec);
+            file.insert(file.end(), rec, rec + sizeof(rec));
+        }
+    }
+    bool failed = false;
+    const string reference = convert(file, 4096, 256, &failed);
+    assert(!failed);
+    size_t lines = 0;
+    for (char c : reference) if (c == '\n') lines++;
+    assert(lines == 1 + 100);
+    assert(reference.find("ms:20,,,48.007,") != string::npos);
+    for (size_t inChunk : {1, 3, 17, 64}) {
+        assert(convert(file, inChunk, 13, &failed) == reference && !failed);
+    }
+
+    // A fast record in a version 1 file is corruption, not data.
+    uint8_t hdr[FlightLog::kHeaderSize];
+    FlightLog::encodeHeader(h, hdr);
+    hdr[4] = 1;
+    vector<uint8_t> v1(hdr, hdr + FlightLog::kLegacyHeaderSize);
+    uint8_t rec[FlightLog::kFastRecordSize];
+    FlightLog::encodeFastRecord(fastRecord(0), rec);
+    v1.insert(v1.end(), rec, rec + sizeof(rec));
+    v1.resize(v1.size() + FlightLog::kRecordSize, 0);
+    convert(v1, 64, 64, &failed);
+    assert(failed);
+    cout << "PASS: converter handles interleaved full and fast records\n";
+}
+
+// Converts through a window; returns the data lines (header line dropped).
+static string convertWindow(const vector<uint8_t>& file, uint32_t fromMs, uint32_t toMs, size_t* consumed,
+                            uint32_t* lastMs = nullptr) {
+    FlightLog::CsvConverter conv;
+    conv.setWindow(fromMs, toMs);
+    string csv;
+    size_t pos = 0;
+    uint8_t out[64];
+    while (true) {
+        size_t n = conv.read(out, sizeof(out));
+        csv.append(reinterpret_cast<char*>(out), n);
+        if (n > 0) continue;
+        if (conv.failed() || conv.done() || pos == file.size()) break;
+        pos += conv.push(file.data() + pos, min((size_t)7, file.size() - pos));
+    }
+    assert(!conv.failed());
+    *consumed = pos;
+    if (lastMs) *lastMs = conv.lastOffsetMs();
+    return csv.substr(sizeof(FlightLog::kCsvHeader) - 1);
+}
+
+void test_converter_time_window() {
+    const FlightLog::Header h = makeHeader(0, 0, 100000);
+    vector<uint8_t> file(FlightLog::kHeaderSize);
+    FlightLog::encodeHeader(h, file.data());
+    // Two pre-arm records, then one per second.
+    for (uint32_t t = 0; t <= 7000; t += 1000) {
+        FlightLog::Record r = fullRecord(t * 1000);
+        if (t < 2000) r.flags |= FlightLog::RecordPreArm;
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(r, rec);
+        file.insert(file.end(), rec, rec + sizeof(rec));
+    }
+    size_t consumed = 0;
+
+    string csv = convertWindow(file, 4000, 5000, &consumed);
+    assert(count(csv.begin(), csv.end(), '\n') == 2);
+    assert(csv.find("ms:104000,") == 0 && csv.find("ms:105000,") != string::npos);
+    // Stops at the first record past the window instead of reading on.
+    assert(consumed == FlightLog::kHeaderSize + 7 * FlightLog::kRecordSize);
+
+    csv = convertWindow(file, 500, 2000, &consumed);
+    assert(count(csv.begin(), csv.end(), '\n') == 2);
+    assert(csv.find("ms:101000,") == 0 && csv.find(",pre,101000000,,,,,,,,,,\r\n") != string::npos);
+
+    // An empty window still reads to the end, which finds the last offset.
+    uint32_t lastMs = 0;
+    csv = convertWindow(file, UINT32_MAX, UINT32_MAX, &consumed, &lastMs);
+    assert(csv.empty() && consumed == file.size() && lastMs == 7000);
+    cout << "PASS: converter keeps only records inside the time window\n";
+}
+
+// Version 2 files: millisecond offsets from startMillis, 22-byte header.
+void test_converter_reads_version_2() {
+    FlightLog::Header h = makeHeader(0, 0, 5000);
+    h.version = 2;
+    uint8_t hdr[FlightLog::kHeaderSize];
+    FlightLog::encodeHeader(h, hdr);
+    vector<uint8_t> file(hdr, hdr + FlightLog::kLegacyHeaderSize);
+    for (uint32_t t = 0; t < 3000; t += 1000) {
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(fullRecord(t), rec);
+        file.insert(file.end(), rec, rec + sizeof(rec));
+    }
+    size_t consumed = 0;
+    uint32_t lastMs = 0;
+    const string csv = convertWindow(file, 0, UINT32_MAX, &consumed, &lastMs);
+    assert(count(csv.begin(), csv.end(), '\n') == 3 && lastMs == 2000);
+    assert(csv.find("ms:7000,") != string::npos && csv.find(",armed,7000000,,,,,,,,,,\r\n") != string::npos);
+    cout << "PASS: converter still reads version 2 files\n";
+}
+
+// Microsecond offsets wrap every 2^32 us (~71.6 min); a long flight keeps
+// counting up.
+void test_converter_unwraps_microsecond_offsets() {
+    const FlightLog::Header h = makeHeader(0, 0, 0);
+    vector<uint8_t> file(FlightLog::kHeaderSize);
+    FlightLog::encodeHeader(h, file.data());
+    const uint64_t start = 4294000000ULL;   // ~1 s before the first wrap
+    for (uint64_t t = start; t < start + 3000000; t += 500000) {
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(fullRecord((uint32_t)t), rec);
+        file.insert(file.end(), rec, rec + sizeof(rec));
+    }
+    size_t consumed = 0;
+    uint32_t lastMs = 0;
+    const string csv = convertWindow(file, 0, UINT32_MAX, &consumed, &lastMs);
+    assert(count(csv.begin(), csv.end(), '\n') == 6);
+    assert(lastMs == (uint32_t)((start + 2500000) / 1000));
+    assert(csv.find(",4296500000,,,,,,,,,,\r\n") != string::npos);
+
+    // Resuming mid-file from a sync point's time lands on the right lap.
+    FlightLog::RecordClock clock;
+    clock.reset(h, 4296000000ULL);
+    assert(clock.offsetUs((uint32_t)4296000250ULL) == 4296000250ULL);
+    cout << "PASS: microsecond offsets unwrap across the 32-bit wrap\n";
+}
+
+void test_timestamp_cache_matches_uncached() {
+    const FlightLog::Header h = makeHeader(FlightLog::HeaderEpochValid | FlightLog::HeaderMillis,
+                                           1745060096000ULL, 0);
+    FlightLog::TimestampCache cache;
+    char cached[32];
+    char plain[32];
+    for (uint64_t us = 0; us < 3000000; us += 333333) {
+        const int a = FlightLog::formatTimestamp(h, us, cached, sizeof(cached), &cache);
+        const int b = FlightLog::formatTimestamp(h, us, plain, sizeof(plain));
+        assert(a > 0 && a == b && strcmp(cached, plain) == 0);
+    }
+    assert(strcmp(cached, "2025-04-19T10:54:58.999") == 0);
+    assert(FlightLog::formatTimestamp(h, 0, plain, 10, &cache) >= 10);
+    cout << "PASS: cached timestamps match freshly formatted ones\n";
+}
+
+void test_supported_log_rates() {
+    assert(FlightLog::isSupportedLogRate(1) && FlightLog::isSupportedLogRate(50));
+    assert(!FlightLog::isSupportedLogRate(0) && !FlightLog::isSupportedLogRate(100));
+    assert(FlightLog::isSupportedLogRate(FlightLog::kDefaultLogRateHz));
+    cout << "PASS: supported log rates\n";
+}
+
+void test_converter_rejects_garbage() {
+    vector<uint8_t> garbage(64, 0x42);
+    bool failed = false;
+    const string csv = convert(garbage, 16, 64, &failed);
+    assert(failed && csv.empty());
+    cout << "PASS: converter rejects a non-log file\n";
+}
+
+void test_saturating_conversions() {
+    assert(FlightLog::milliToDeci(10000000) == INT16_MAX);
+    assert(FlightLog::milliToDeci(-10000000) == INT16_MIN);
+    assert(FlightLog::milliToDeciU(4000000000u) == UINT16_MAX);
+    assert(FlightLog::milliToDeci(-1599) == -15);
+    cout << "PASS: unit conversions saturate\n";
+}
+
+int main() {
+    test_header_round_trip();
+    test_version_1_header_has_no_fast_records();
+    test_record_round_trip();
+    test_csv_line_matches_text_logger();
+    test_fast_record_csv_leaves_slow_columns_empty();
+    test_csv_empty_cells();
+    test_csv_pack_columns();
+    test_csv_full_timestamp_without_dated_name();
+    test_converter_any_chunking();
+    test_converter_skips_newer_record_tail();
+    test_converter_reads_records_without_packs();
+    test_converter_mixed_rates();
+    test_converter_time_window();
+    test_converter_reads_version_2();
+    test_converter_unwraps_microsecond_offsets();
+    test_timestamp_cache_matches_uncached();
+    test_converter_rejects_garbage();
+    test_supported_log_rates();
+    test_saturating_conversions();
+    return 0;
+}
@@ -0,0 +1,215 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/FlightStats/FlightStatsLogic.h"
+
+static FlightStatsSample sampleAt(uint32_t nowMs) {
+    FlightStatsSample s;
+    memset(&s, 0, sizeof(s));
+    s.nowMs = nowMs;
+    return s;
+}
+
+static FlightStatsSample powered(uint32_t nowMs, uint16_t voltageMv, uint32_t currentMa) {
+    FlightStatsSample s = sampleAt(nowMs);
+    s.hasBatteryVoltage = true;
+    s.batteryVoltageMv = voltageMv;
+    s.hasCurrent = true;
+    s.currentMa = currentMa;
+    return s;
+}
+
+void test_empty_flight() {
+    FlightStatsAccumulator acc;
+    acc.reset(1000);
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.flags == 0);
+    assert(s.durationMs == 0 && s.usedMah == 0 && s.meanCurrentMa == 0);
+    cout << "PASS: empty flight has no data\n";
+}
+
+void test_peaks_and_minima() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    acc.addSample(powered(0, 50000, 10000));
+    acc.addSample(powered(100, 48000, 60000));
+    acc.addSample(powered(200, 49000, 20000));
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.has(FlightSummaryHasCurrent) && s.has(FlightSummaryHasBatteryVoltage));
+    assert(!s.has(FlightSummaryHasMotorTemp));
+    assert(s.maxCurrentMa == 60000);
+    assert(s.minBatteryVoltageMv == 48000);
+    assert(s.maxPowerW == 2880);     // 48 V * 60 A
+    cout << "PASS: peaks and minima\n";
+}
+
+void test_time_weighted_mean_and_energy() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    // 10 A held for 900 ms, then 100 A held for 100 ms: mean 19 A, not 55 A.
+    acc.addSample(powered(0, 50000, 10000));
+    acc.addSample(powered(900, 50000, 100000));
+    acc.addSample(powered(1000, 50000, 100000));
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.durationMs == 1000);
+    assert(s.meanCurrentMa == 19000);
+    assert(s.meanPowerW == 950);
+
+    // One hour at 36 A / 50 V, sampled every 500 ms: 36000 mAh, 1800 Wh.
+    acc.reset(0);
+    for (uint32_t t = 0; t <= 3600000; t += 500) {
+        acc.addSample(powered(t, 50000, 36000));
+    }
+    acc.getSummary(s);
+    assert(s.usedMah == 36000);
+    assert(s.usedWhX10 == 18000);
+    cout << "PASS: time-weighted mean, mAh and Wh\n";
+}
+
+void test_long_gap_is_clipped() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    acc.addSample(powered(0, 50000, 100000));
+    acc.addSample(powered(60000, 50000, 100000));   // loop stalled for a minute
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.durationMs == FlightStatsAccumulator::kMaxSampleGapMs);
+    cout << "PASS: long sample gaps are clipped\n";
+}
+
+void test_temperatures_ignore_invalid_samples() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    FlightStatsSample a = sampleAt(0);
+    a.hasMotorTemp = true;  a.motorTempMc = -5000;    // cold morning: negative max is still a max
+    a.hasEscTemp = true;    a.escTempMc = 30000;
+    acc.addSample(a);
+    FlightStatsSample b = sampleAt(500);
+    b.hasMotorTemp = false; b.motorTempMc = 250000;   // sensor glitch, flagged invalid
+    b.hasEscTemp = true;    b.escTempMc = 40000;
+    acc.addSample(b);
+    FlightStatsSample c = sampleAt(1000);
+    acc.addSample(c);
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.has(FlightSummaryHasMotorTemp) && s.maxMotorTempMc == -5000);
+    assert(s.meanMotorTempMc == -5000);
+    assert(s.maxEscTempMc == 40000);
+    assert(s.meanEscTempMc == 35000);
+    cout << "PASS: temperatures skip invalid samples\n";
+}
+
+void test_cells() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    FlightStatsSample a = sampleAt(0);
+    a.hasCells = true; a.cellMinMv = 3900; a.cellMaxMv = 3920;
+    acc.addSample(a);
+    FlightStatsSample b = sampleAt(500);
+    b.hasCells = true; b.cellMinMv = 3600; b.cellMaxMv = 3680;
+    acc.addSample(b);
+    FlightStatsSample c = sampleAt(1000);
+    c.hasCells = true; c.cellMinMv = 0; c.cellMaxMv = 0;   // frame not yet parsed
+    acc.addSample(c);
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.minCellMv == 3600);
+    assert(s.maxCellDeltaMv == 80);
+    cout << "PASS: cell minimum and delta\n";
+}
+
+void test_limit_cause_time() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    FlightStatsSample a = sampleAt(0);
+    a.limitCauses = 1 | 4;          // battery + escTemp
+    acc.addSample(a);
+    FlightStatsSample b = sampleAt(300);
+    b.limitCauses = 2;              // motorTemp
+    acc.addSample(b);
+    acc.addSample(sampleAt(500));
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.limitMs[FlightLimitBattery] == 300);
+    assert(s.limitMs[FlightLimitEscTemp] == 300);
+    assert(s.limitMs[FlightLimitMotorTemp] == 200);
+    cout << "PASS: time in each power-limit cause\n";
+}
+
+void test_reset_starts_a_new_flight() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    acc.addSample(powered(0, 50000, 90000));
+    acc.addSample(powered(1000, 50000, 90000));
+    acc.reset(5000);
+    acc.addSample(powered(5000, 51000, 1000));
+    acc.addSample(powered(5500, 51000, 1000));
+    FlightSummary s;
+    acc.getSummary(s);
+    assert(s.maxCurrentMa == 1000);
+    assert(s.durationMs == 500);
+    assert(s.meanCurrentMa == 1000);
+    assert(acc.getStartMs() == 5000);
+    cout << "PASS: reset starts a new flight\n";
+}
+
+void test_codec_round_trip() {
+    FlightStatsAccumulator acc;
+    acc.reset(0);
+    FlightStatsSample a = powered(0, 50000, 42000);
+    a.hasMotorTemp = true; a.motorTempMc = -1234;
+    a.hasCells = true; a.cellMinMv = 3700; a.cellMaxMv = 3710;
+    a.limitCauses = 2;
+    acc.addSample(a);
+    a.nowMs = 800;
+    acc.addSample(a);
+    FlightSummary in;
+    acc.getSummary(in);
+
+    uint8_t buf[FlightSummaryCodec::kEncodedSize];
+    assert(FlightSummaryCodec::encode(in, buf, sizeof(buf) - 1) == 0);
+    assert(FlightSummaryCodec::encode(in, buf, sizeof(buf)) == FlightSummaryCodec::kEncodedSize);
+    FlightSummary out;
+    assert(FlightSummaryCodec::decode(buf, sizeof(buf), out));
+    assert(out.flags == in.flags && out.durationMs == in.durationMs);
+    assert(out.maxMotorTempMc == -1234 && out.meanMotorTempMc == -1234);
+    assert(out.usedMah == in.usedMah && out.maxCurrentMa == 42000);
+    assert(out.minCellMv == 3700 && out.maxCellDeltaMv == 10);
+    assert(out.limitMs[FlightLimitMotorTemp] == 800);
+
+    buf[2] = FlightSummaryCodec::kVersion + 1;
+    assert(!FlightSummaryCodec::decode(buf, sizeof(buf), out));
+    assert(!FlightSummaryCodec::decode(buf, sizeof(buf) - 1, out));
+    cout << "PASS: summary record round-trips and rejects unknown versions\n";
+}
+
+void test_summary_path() {
+    char path[32];
+    assert(FlightSummaryCodec::summaryPathFor("/20250419_003.csv", path, sizeof(path)));
+    assert(strcmp(path, "/20250419_003.sum") == 0);
+    assert(FlightSummaryCodec::summaryPathFor("/00012.csv", path, sizeof(path)));
+    assert(strcmp(path, "/00012.sum") == 0);
+    assert(!FlightSummaryCodec::summaryPathFor("/noext", path, sizeof(path)));
+    assert(!FlightSummaryCodec::summaryPathFor("/20250419_003.csv", path, 8));
+    cout << "PASS: summary path sits next to the log file\n";
+}
+
+int main() {
+    test_empty_flight();
+    test_peaks_and_minima();
+    test_time_weighted_mean_and_energy();
+    test_long_gap_is_clipped();
+    test_temperatures_ignore_invalid_samples();
+    test_cells();
+    test_limit_cause_time();
+    test_reset_starts_a_new_flight();
+    test_codec_round_trip();
+    test_summary_path();
+    return 0;
+}
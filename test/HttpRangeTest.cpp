@@ -0,0 +1,70 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/WebServer/HttpRange.h"
+
+void test_closed_and_open_ranges() {
+    uint32_t start = 0, len = 0;
+    assert(HttpRange::parse("bytes=0-99", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 0 && len == 100);
+    assert(HttpRange::parse("bytes=500-", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 500 && len == 500);
+    // An end past the file is clipped.
+    assert(HttpRange::parse("bytes=900-5000", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 900 && len == 100);
+    assert(HttpRange::parse(" bytes= 999-999 ", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 999 && len == 1);
+    cout << "PASS: closed and open ranges\n";
+}
+
+void test_suffix_ranges() {
+    uint32_t start = 0, len = 0;
+    assert(HttpRange::parse("bytes=-100", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 900 && len == 100);
+    assert(HttpRange::parse("bytes=-5000", 1000, start, len) == HttpRange::Satisfiable);
+    assert(start == 0 && len == 1000);
+    assert(HttpRange::parse("bytes=-0", 1000, start, len) == HttpRange::Unsatisfiable);
+    assert(HttpRange::parse("bytes=-10", 0, start, len) == HttpRange::Unsatisfiable);
+    cout << "PASS: suffix ranges\n";
+}
+
+void test_unsatisfiable() {
+    uint32_t start = 0, len = 0;
+    assert(HttpRange::parse("bytes=1000-", 1000, start, len) == HttpRange::Unsatisfiable);
+    assert(HttpRange::parse("bytes=0-0", 0, start, len) == HttpRange::Unsatisfiable);
+    cout << "PASS: ranges past the end are unsatisfiable\n";
+}
+
+void test_ignored_headers() {
+    uint32_t start = 0, len = 0;
+    assert(HttpRange::parse(nullptr, 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("items=0-9", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("bytes=0-9,20-29", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("bytes=9-0", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("bytes=-", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("bytes=abc", 1000, start, len) == HttpRange::None);
+    assert(HttpRange::parse("bytes=99999999999-", 1000, start, len) == HttpRange::None);
+    cout << "PASS: lists, other units and bad syntax fall back to the whole file\n";
+}
+
+void test_content_range() {
+    char buf[HttpRange::kMaxContentRange];
+    assert(HttpRange::formatContentRange(buf, sizeof(buf), 900, 100, 1000) > 0);
+    assert(strcmp(buf, "bytes 900-999/1000") == 0);
+    assert(HttpRange::formatContentRange(buf, sizeof(buf), 4000000000u, 1, UINT32_MAX) == sizeof(buf) - 1);
+    assert(HttpRange::formatContentRange(buf, 8, 900, 100, 1000) == 0);
+    cout << "PASS: Content-Range formatting\n";
+}
+
+int main() {
+    test_closed_and_open_ranges();
+    test_suffix_ranges();
+    test_unsatisfiable();
+    test_ignored_headers();
+    test_content_range();
+    return 0;
+}
@@ -0,0 +1,104 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <stddef.h>
+using namespace std;
+
+#include "../src/JbdBms/JbdBmsParser.h"
+
+// ── Register 0x03 DATA, JBD standard layout ───────────────────────────────────
+
+static void putBE16(uint8_t* buf, size_t off, uint16_t v) {
+    buf[off]     = (uint8_t)(v >> 8);
+    buf[off + 1] = (uint8_t)(v & 0xFF);
+}
+
+// 14S pack: 52.31 V, -12.40 A (discharge), 87 %, two NTCs at 25.0 / 31.2 °C
+static size_t makeBasicInfo(uint8_t* d, uint8_t ntcCount) {
+    memset(d, 0, 64);
+    putBE16(d, 0, 5231);                  // 10 mV
+    putBE16(d, 2, (uint16_t)(int16_t)-1240);  // 10 mA, signed
+    putBE16(d, 4, 8120);                  // remaining, 10 mAh
+    putBE16(d, 6, 10000);                 // nominal, 10 mAh
+    putBE16(d, 8, 42);                    // cycles
+    putBE16(d, 16, 0x0004);               // protection flags
+    d[19] = 87;
+    d[20] = 0x03;                         // CHG + DSG FETs on
+    d[21] = 14;
+    d[22] = ntcCount;
+    putBE16(d, 23, 2731 + 250);
+    putBE16(d, 25, 2731 + 312);
+    return 23 + (size_t)ntcCount * 2;
+}
+
+void test_basic_info_decodes_every_field() {
+    uint8_t d[64];
+    const size_t len = makeBasicInfo(d, 2);
+    JbdBasicInfo info;
+    assert(jbdParseBasicInfo(d, len, &info));
+    assert(info.packVoltageMilliVolts == 52310);
+    assert(info.packCurrentMilliAmps == -12400);
+    assert(info.balanceCapacityMahl == 81200);
+    assert(info.designCapacityMahl == 100000);
+    assert(info.cycleCount == 42);
+    assert(info.currentErrors == 0x0004);
+    assert(info.socPercent == 87);
+    assert(info.chgFetEnabled == 1 && info.dsgFetEnabled == 1);
+    assert(info.cellCount == 14 && info.tempCount == 2);
+    assert(info.tempsCelsius[0] == 25 && info.tempsCelsius[1] == 31);
+    cout << "PASS: register 0x03 decodes every field\n";
+}
+
+void test_basic_info_below_freezing() {
+    uint8_t d[64];
+    const size_t len = makeBasicInfo(d, 1);
+    putBE16(d, 23, 2731 - 55);            // -5.5 °C
+    JbdBasicInfo info;
+    assert(jbdParseBasicInfo(d, len, &info));
+    assert(info.tempsCelsius[0] == -5);
+    cout << "PASS: NTC below 0 °C stays negative\n";
+}
+
+void test_basic_info_too_short_is_rejected() {
+    uint8_t d[64];
+    makeBasicInfo(d, 2);
+    JbdBasicInfo info;
+    assert(!jbdParseBasicInfo(d, JBD_BASIC_INFO_MIN_LEN - 1, &info));
+    assert(jbdParseBasicInfo(d, JBD_BASIC_INFO_MIN_LEN, &info));
+    assert(info.tempCount == 2 && info.tempsCelsius[0] == 0);   // announced, cut off
+    cout << "PASS: short payload rejected, cut-off NTCs read 0\n";
+}
+
+void test_basic_info_ntc_count_is_bounded() {
+    uint8_t d[64];
+    makeBasicInfo(d, 2);
+    d[22] = 200;
+    JbdBasicInfo info;
+    assert(jbdParseBasicInfo(d, sizeof(d), &info));
+    assert(info.tempCount == 200 && info.tempsCelsius[0] == 25);
+    cout << "PASS: absurd NTC count stays inside the array\n";
+}
+
+void test_cell_voltages() {
+    uint8_t d[8];
+    putBE16(d, 0, 3310);
+    putBE16(d, 2, 3295);
+    putBE16(d, 4, 3342);
+    putBE16(d, 6, 3301);
+    uint16_t cells[JBD_MAX_CELLS] = {};
+    assert(jbdParseCellVoltages(d, sizeof(d), cells, JBD_MAX_CELLS) == 4);
+    assert(cells[0] == 3310 && cells[1] == 3295 && cells[2] == 3342 && cells[3] == 3301);
+    assert(jbdParseCellVoltages(d, 7, cells, JBD_MAX_CELLS) == 3);   // odd byte ignored
+    assert(jbdParseCellVoltages(d, sizeof(d), cells, 2) == 2);
+    cout << "PASS: register 0x04 cell voltages, clamped to the caller's array\n";
+}
+
+int main() {
+    test_basic_info_decodes_every_field();
+    test_basic_info_below_freezing();
+    test_basic_info_too_short_is_rejected();
+    test_basic_info_ntc_count_is_bounded();
+    test_cell_voltages();
+    return 0;
+}
@@ -0,0 +1,206 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+using namespace std;
+
+#include "../src/JbdBms/JbdFrameParser.h"
+
+static vector<uint8_t> makeFrame(uint8_t reg, uint8_t status, const vector<uint8_t>& data) {
+    vector<uint8_t> f = {0xDD, reg, status, (uint8_t)data.size()};
+    uint32_t sum = status + (uint32_t)data.size();
+    for (uint8_t b : data) {
+        f.push_back(b);
+        sum += b;
+    }
+    const uint16_t chk = (uint16_t)(0x10000 - sum);
+    f.push_back((uint8_t)(chk >> 8));
+    f.push_back((uint8_t)(chk & 0xFF));
+    f.push_back(0x77);
+    return f;
+}
+
+// Checked independently of the parser: what it emits must be a real frame.
+static bool frameIsValid(const vector<uint8_t>& f) {
+    if (f.size() < 7 || f[0] != 0xDD || f.back() != 0x77 || f.size() != 7u + f[3]) return false;
+    uint32_t sum = f[2] + f[3];
+    for (size_t i = 4; i < 4u + f[3]; i++) sum += f[i];
+    const uint16_t chk = (uint16_t)((f[f.size() - 3] << 8) | f[f.size() - 2]);
+    return ((sum + chk) & 0xFFFF) == 0;
+}
+
+static vector<vector<uint8_t>> parse(JbdFrameParser& parser, const vector<uint8_t>& stream, size_t chunk) {
+    vector<vector<uint8_t>> out;
+    for (size_t at = 0; at < stream.size(); at += chunk) {
+        const size_t n = stream.size() - at < chunk ? stream.size() - at : chunk;
+        parser.feed(stream.data() + at, n, [&](const JbdFrame& f) {
+            assert(f.raw[0] == 0xDD && f.data == f.raw + 4 && f.rawLen == 7u + f.dataLen);
+            out.push_back(vector<uint8_t>(f.raw, f.raw + f.rawLen));
+        });
+    }
+    return out;
+}
+
+static vector<vector<uint8_t>> parse(const vector<uint8_t>& stream, size_t chunk) {
+    JbdFrameParser parser;
+    return parse(parser, stream, chunk);
+}
+
+static uint32_t lcg = 12345;
+static uint8_t nextByte() {
+    lcg = lcg * 1103515245u + 12345u;
+    return (uint8_t)(lcg >> 16);
+}
+
+void test_frame_in_any_chunking() {
+    const vector<uint8_t> frame = makeFrame(0x03, 0x00, {0x14, 0xB4, 0x00, 0x00, 0x27, 0x10});
+    for (size_t chunk = 1; chunk <= frame.size(); chunk++) {
+        JbdFrameParser parser;
+        int seen = 0;
+        for (size_t at = 0; at < frame.size(); at += chunk) {
+            const size_t n = frame.size() - at < chunk ? frame.size() - at : chunk;
+            parser.feed(frame.data() + at, n, [&](const JbdFrame& f) {
+                assert(f.reg == 0x03 && f.status == 0x00 && f.dataLen == 6);
+                assert(f.data[0] == 0x14 && f.data[1] == 0xB4 && f.data[5] == 0x10);
+                seen++;
+            });
+        }
+        assert(seen == 1 && parser.frames() == 1 && parser.rejected() == 0);
+    }
+    cout << "PASS: one frame, split at every chunk size\n";
+}
+
+void test_wrapper_and_noise_between_frames() {
+    const vector<uint8_t> a = makeFrame(0x03, 0x00, {1, 2, 3});
+    const vector<uint8_t> b = makeFrame(0x04, 0x00, {0x0C, 0xE4, 0x0C, 0xE6});
+    vector<uint8_t> stream = {0xFF, 0xAA};
+    stream.insert(stream.end(), a.begin(), a.end());
+    stream.insert(stream.end(), {0x00, 0x77, 0x13, 0xFF, 0xAA});
+    stream.insert(stream.end(), b.begin(), b.end());
+    const auto frames = parse(stream, 20);
+    assert(frames.size() == 2 && frames[0] == a && frames[1] == b);
+    cout << "PASS: FF AA wrapper and noise skipped\n";
+}
+
+void test_bad_checksum_and_end_byte_rejected() {
+    vector<uint8_t> badChk = makeFrame(0x03, 0x00, {1, 2, 3});
+    badChk[5] ^= 0x01;
+    vector<uint8_t> badEnd = makeFrame(0x04, 0x00, {4, 5});
+    badEnd.back() = 0x78;
+    vector<uint8_t> stream = badChk;
+    stream.insert(stream.end(), badEnd.begin(), badEnd.end());
+    JbdFrameParser parser;
+    assert(parse(parser, stream, 7).empty());
+    assert(parser.rejected() == 2 && parser.frames() == 0);
+    cout << "PASS: checksum or end-byte mismatch is never emitted\n";
+}
+
+void test_frame_inside_rejected_candidate_is_found() {
+    // A stray DD whose LEN claims 0x40 bytes swallows the real frame that
+    // follows; when the candidate fails, the real frame is found in it.
+    const vector<uint8_t> real = makeFrame(0x04, 0x00, {0x0C, 0xE4, 0x0C, 0xE6, 0x0C, 0xE1});
+    vector<uint8_t> stream = {0xDD, 0x03, 0x00, 0x40};
+    stream.insert(stream.end(), real.begin(), real.end());
+    stream.insert(stream.end(), 0x40, 0x11);
+    JbdFrameParser parser;
+    const auto frames = parse(parser, stream, 20);
+    assert(frames.size() == 1 && frames[0] == real);
+    assert(parser.rejected() == 1);
+    cout << "PASS: a frame inside a rejected candidate is still found\n";
+}
+
+void test_false_starts_dropped_at_the_header() {
+    // A DD run, a register the driver never reads, a status that is
+    // neither ok nor error, a LEN past the register's: each dropped at the
+    // byte that does not fit, and the frame right behind is not held back.
+    const vector<uint8_t> real = makeFrame(0x04, 0x00, {0x0C, 0xE4});
+    vector<uint8_t> stream = {0xDD, 0xDD, 0xDD, 0xDD, 0x10, 0x00, 0x02,
+                              0xDD, 0x03, 0x01, 0x02,
+                              0xDD, 0x04, 0x00, (uint8_t)(2 * JBD_MAX_CELLS + 1)};
+    stream.insert(stream.end(), real.begin(), real.end());
+    JbdFrameParser parser;
+    const auto frames = parse(parser, stream, 4);
+    assert(frames.size() == 1 && frames[0] == real);
+    assert(parser.rejected() == 0);
+    assert(JbdFrameParser::maxDataLen(0x03) == JBD_BASIC_INFO_MAX_LEN && JbdFrameParser::maxDataLen(0xA5) < 0);
+    cout << "PASS: false starts dropped at the header, no frame held back\n";
+}
+
+void test_bms_error_status_is_emitted() {
+    const vector<uint8_t> err = makeFrame(0x05, 0x80, {});
+    const auto frames = parse(err, 3);
+    assert(frames.size() == 1 && frames[0][2] == 0x80 && frames[0][3] == 0);
+    cout << "PASS: error-status frames reach the driver\n";
+}
+
+void test_reset_drops_partial_frame() {
+    const vector<uint8_t> f = makeFrame(0x03, 0x00, {9, 9, 9, 9});
+    JbdFrameParser parser;
+    int seen = 0;
+    parser.feed(f.data(), 5, [&](const JbdFrame&) { seen++; });
+    parser.reset();
+    parser.feed(f.data() + 5, f.size() - 5, [&](const JbdFrame&) { seen++; });
+    parser.feed(f.data(), f.size(), [&](const JbdFrame&) { seen++; });
+    assert(seen == 1 && parser.rejected() == 0);
+    cout << "PASS: reset drops the partial frame\n";
+}
+
+// Frames between runs of random noise (DD included), fed in random chunks:
+// every frame comes out, in order, and nothing else does.
+void test_fuzz_frames_in_noise() {
+    for (int round = 0; round < 200; round++) {
+        vector<uint8_t> stream;
+        vector<vector<uint8_t>> sent;
+        const int frameCount = 1 + nextByte() % 8;
+        for (int k = 0; k < frameCount; k++) {
+            const size_t noise = nextByte() % 40;
+            for (size_t i = 0; i < noise; i++) stream.push_back(nextByte());
+            vector<uint8_t> data(nextByte() % (2 * JBD_MAX_CELLS + 1));
+            for (auto& b : data) b = nextByte();
+            sent.push_back(makeFrame(nextByte() % 2 ? 0x03 : 0x04, 0x00, data));
+            stream.insert(stream.end(), sent.back().begin(), sent.back().end());
+        }
+        // Enough trailing noise to close any stray candidate still open
+        for (size_t i = 0; i < JbdFrameParser::kMaxFrameLen; i++) stream.push_back(nextByte());
+
+        const auto whole = parse(stream, stream.size());
+        const auto chunked = parse(stream, 1 + nextByte() % 24);
+        assert(whole == chunked);
+        assert(whole == sent);
+    }
+    cout << "PASS: fuzz, frames in noise, any chunking\n";
+}
+
+void test_fuzz_noise_only() {
+    vector<uint8_t> noise(200000);
+    for (auto& b : noise) b = nextByte();
+    // Bias toward the sync byte so most bytes start or sit inside a candidate
+    for (size_t i = 0; i < noise.size(); i += 7) noise[i] = 0xDD;
+    // and now and then a whole fitting header, so candidates fail their end
+    // byte or checksum
+    for (size_t i = 3; i + 4 < noise.size(); i += 50) {
+        noise[i] = 0xDD;
+        noise[i + 1] = 0x04;
+        noise[i + 2] = 0x00;
+        noise[i + 3] = (uint8_t)(noise[i + 3] % (2 * JBD_MAX_CELLS + 1));
+    }
+    JbdFrameParser parser;
+    const auto frames = parse(parser, noise, 61);
+    for (const auto& f : frames) assert(frameIsValid(f));
+    assert(parser.rejected() > 0);
+    cout << "PASS: fuzz, noise only, " << frames.size() << " accidental valid frames\n";
+}
+
+int main() {
+    test_frame_in_any_chunking();
+    test_wrapper_and_noise_between_frames();
+    test_bad_checksum_and_end_byte_rejected();
+    test_frame_inside_rejected_candidate_is_found();
+    test_false_starts_dropped_at_the_header();
+    test_bms_error_status_is_emitted();
+    test_reset_drops_partial_frame();
+    test_fuzz_frames_in_noise();
+    test_fuzz_noise_only();
+    return 0;
+}
@@ -0,0 +1,154 @@
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/WebServer/JsonStreamWriter.h"
+
+// Host benchmark: time and heap allocations per /api/telemetry-shaped
+// document. Build with `g++ -O2 -std=c++17`; add `-I<ArduinoJson>/src` to
+// also measure ArduinoJson's DOM + serializeJson path for comparison.
+#if __has_include(<ArduinoJson.h>)
+#include <ArduinoJson.h>
+#define BENCH_ARDUINOJSON 1
+#else
+#define BENCH_ARDUINOJSON 0
+#endif
+
+static const int ITERATIONS = 200000;
+
+static size_t allocationCount = 0;
+static size_t allocatedBytes = 0;
+
+void* operator new(size_t size) {
+    allocationCount++;
+    allocatedBytes += size;
+    void* p = malloc(size);
+    if (p == nullptr) throw bad_alloc();
+    return p;
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// Discards output but keeps a running checksum so nothing is optimised away.
+struct NullSink {
+    uint32_t checksum = 0;
+    size_t write(const uint8_t* data, size_t len) {
+        for (size_t i = 0; i < len; i++) checksum = checksum * 31 + data[i];
+        return len;
+    }
+};
+
+template <typename Sink>
+static void writeTelemetryLike(JsonStreamWriter<Sink>& w, int i) {
+    w.beginObject();
+    w.member("hasTelemetry", true);
+    w.member("armed", (i & 1) != 0);
+    w.member("batteryPercentCc", (uint8_t)(i % 100));
+    w.member("batteryVoltageMv", (uint16_t)(52000 + i % 500));
+    w.member("powerKwX10", (int32_t)(i % 300));
+    w.member("throttlePercent", (uint8_t)(i % 100));
+    w.member("throttleRaw", (uint16_t)(i % 4096));
+    w.member("motorTempMc", (int32_t)(45000 + i % 1000));
+    w.member("rpm", (int32_t)(i % 9000));
+    w.member("escCurrentMa", (uint32_t)(i * 7));
+    w.member("escTempMc", (int32_t)(38000 - i % 1000));
+    w.member("disarmReason", "");
+    w.member("uptimeMs", (uint32_t)(i * 500));
+    w.member("bmsState", "connected");
+    w.beginObject("availability");
+    w.member("current", true);
+    w.member("rpm", true);
+    w.member("powerKw", true);
+    w.member("bms", true);
+    w.endObject();
+    w.beginObject("bms");
+    w.member("cellMinMv", (uint16_t)3712);
+    w.member("cellMaxMv", (uint16_t)3731);
+    w.endObject();
+    w.beginArray("buzzer");
+    for (int b = 0; b < 4; b++) {
+        w.beginObject();
+        w.member("seq", (uint32_t)(i + b));
+        w.member("freq", (uint16_t)2000);
+        w.member("onMs", (uint16_t)80);
+        w.endObject();
+    }
+    w.endArray();
+    w.endObject();
+    w.flush();
+}
+
+#if BENCH_ARDUINOJSON
+static void fillTelemetryLike(JsonDocument& doc, int i) {
+    doc["hasTelemetry"] = true;
+    doc["armed"] = (i & 1) != 0;
+    doc["batteryPercentCc"] = (uint8_t)(i % 100);
+    doc["batteryVoltageMv"] = (uint16_t)(52000 + i % 500);
+    doc["powerKwX10"] = (int32_t)(i % 300);
+    doc["throttlePercent"] = (uint8_t)(i % 100);
+    doc["throttleRaw"] = (uint16_t)(i % 4096);
+    doc["motorTempMc"] = (int32_t)(45000 + i % 1000);
+    doc["rpm"] = (int32_t)(i % 9000);
+    doc["escCurrentMa"] = (uint32_t)(i * 7);
+    doc["escTempMc"] = (int32_t)(38000 - i % 1000);
+    doc["disarmReason"] = "";
+    doc["uptimeMs"] = (uint32_t)(i * 500);
+    doc["bmsState"] = "connected";
+    JsonObject av = doc.createNestedObject("availability");
+    av["current"] = true;
+    av["rpm"] = true;
+    av["powerKw"] = true;
+    av["bms"] = true;
+    JsonObject bms = doc.createNestedObject("bms");
+    bms["cellMinMv"] = (uint16_t)3712;
+    bms["cellMaxMv"] = (uint16_t)3731;
+    JsonArray buzzer = doc.createNestedArray("buzzer");
+    for (int b = 0; b < 4; b++) {
+        JsonObject e = buzzer.createNestedObject();
+        e["seq"] = (uint32_t)(i + b);
+        e["freq"] = (uint16_t)2000;
+        e["onMs"] = (uint16_t)80;
+    }
+}
+#endif
+
+template <typename Fn>
+static void report(const char* name, Fn fn) {
+    const size_t allocsBefore = allocationCount;
+    const size_t bytesBefore = allocatedBytes;
+    const auto start = chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) fn(i);
+    const auto elapsed = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+    cout << name << ": " << (elapsed / ITERATIONS) << " ns/doc, "
+         << (double)(allocationCount - allocsBefore) / ITERATIONS << " allocs/doc, "
+         << (double)(allocatedBytes - bytesBefore) / ITERATIONS << " heap bytes/doc\n";
+}
+
+int main() {
+    NullSink sink;
+    size_t docBytes = 0;
+    report("JsonStreamWriter", [&](int i) {
+        JsonStreamWriter<NullSink> w(sink);
+        writeTelemetryLike(w, i);
+        docBytes = w.bytesWritten();
+    });
+    cout << "  document size: " << docBytes << " bytes\n";
+
+#if BENCH_ARDUINOJSON
+    report("ArduinoJson StaticJsonDocument<2048> + String", [&](int i) {
+        StaticJsonDocument<2048> doc;
+        fillTelemetryLike(doc, i);
+        std::string out;
+        serializeJson(doc, out);
+        sink.write(reinterpret_cast<const uint8_t*>(out.data()), out.size());
+    });
+#else
+    cout << "ArduinoJson not on the include path; comparison skipped\n";
+#endif
+    cout << "checksum " << sink.checksum << "\n";
+    return 0;
+}
@@ -0,0 +1,170 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/WebServer/JsonStreamWriter.h"
+
+// Host sink that records every write, so tests can also check that the
+// writer batches output instead of writing token by token.
+struct StringSink {
+    string out;
+    int writes = 0;
+    size_t write(const uint8_t* data, size_t len) {
+        out.append(reinterpret_cast<const char*>(data), len);
+        writes++;
+        return len;
+    }
+};
+
+void test_flat_object() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginObject();
+    w.member("armed", true);
+    w.member("throttlePercent", (uint8_t)42);
+    w.member("motorTempMc", (int32_t)-1500);
+    w.member("state", "connected");
+    w.endObject();
+    w.flush();
+    assert(sink.out == "{\"armed\":true,\"throttlePercent\":42,\"motorTempMc\":-1500,\"state\":\"connected\"}");
+    assert(w.bytesWritten() == sink.out.size());
+    cout << "PASS: flat object\n";
+}
+
+void test_nesting_and_arrays() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginObject();
+    w.beginObject("availability");
+    w.member("current", false);
+    w.member("rpm", true);
+    w.endObject();
+    w.beginArray("causes");
+    w.value("battery");
+    w.value("escTemp");
+    w.endArray();
+    w.beginArray("buzzer");
+    for (int i = 1; i <= 2; i++) {
+        w.beginObject();
+        w.member("seq", i);
+        w.endObject();
+    }
+    w.endArray();
+    w.beginArray("empty");
+    w.endArray();
+    w.member("after", 1);
+    w.endObject();
+    w.flush();
+    assert(sink.out == "{\"availability\":{\"current\":false,\"rpm\":true},"
+                       "\"causes\":[\"battery\",\"escTemp\"],"
+                       "\"buzzer\":[{\"seq\":1},{\"seq\":2}],\"empty\":[],\"after\":1}");
+    cout << "PASS: nested objects and arrays\n";
+}
+
+void test_integer_limits() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginArray();
+    w.value((int32_t)0);
+    w.value((int32_t)INT32_MIN);
+    w.value((uint32_t)UINT32_MAX);
+    w.value((int64_t)INT64_MIN);
+    w.value((uint64_t)UINT64_MAX);
+    w.value((int16_t)-7);
+    w.endArray();
+    w.flush();
+    assert(sink.out == "[0,-2147483648,4294967295,-9223372036854775808,18446744073709551615,-7]");
+    cout << "PASS: integer limits\n";
+}
+
+void test_fixed_point() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginArray();
+    w.valueFixed(2313, 2);
+    w.valueFixed(5, 2);
+    w.valueFixed(-105, 1);
+    w.valueFixed(-5, 2);
+    w.valueFixed(42, 0);
+    w.endArray();
+    w.flush();
+    assert(sink.out == "[23.13,0.05,-10.5,-0.05,42]");
+    cout << "PASS: fixed-point numbers\n";
+}
+
+void test_string_escaping() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginObject();
+    w.member("name", "JBD \"SP\\04\"\n\x01");
+    w.member("null", (const char*)nullptr);
+    w.endObject();
+    w.flush();
+    assert(sink.out == "{\"name\":\"JBD \\\"SP\\\\04\\\"\\n\\u0001\",\"null\":\"\"}");
+    cout << "PASS: string values are escaped\n";
+}
+
+void test_output_is_batched() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    w.beginObject();
+    for (int i = 0; i < 50; i++) {
+        w.member("batteryVoltageMv", 52340);
+    }
+    w.endObject();
+    w.flush();
+    // ~1.4 KB of output in 64-byte stages: far fewer writes than tokens.
+    assert(sink.writes <= (int)(sink.out.size() / JsonStreamWriter<StringSink>::kStageSize) + 2);
+    assert(w.bytesWritten() == sink.out.size());
+    cout << "PASS: output reaches the sink in batched writes\n";
+}
+
+void test_long_string_bypasses_stage() {
+    StringSink sink;
+    JsonStreamWriter<StringSink> w(sink);
+    string longValue(300, 'x');
+    w.beginObject();
+    w.member("advertisedServices", longValue.c_str());
+    w.endObject();
+    w.flush();
+    assert(sink.out == "{\"advertisedServices\":\"" + longValue + "\"}");
+    cout << "PASS: long values survive stage boundaries\n";
+}
+
+void test_buffer_sink_overflow() {
+    uint8_t buf[16];
+    JsonBufferSink sink(buf, sizeof(buf));
+    JsonStreamWriter<JsonBufferSink> w(sink);
+    w.beginObject();
+    w.member("batteryVoltageMv", 52340);
+    w.endObject();
+    w.flush();
+    assert(sink.overflowed());
+    assert(sink.len == sizeof(buf));
+
+    uint8_t big[64];
+    JsonBufferSink ok(big, sizeof(big));
+    JsonStreamWriter<JsonBufferSink> w2(ok);
+    w2.beginObject();
+    w2.member("ok", true);
+    w2.endObject();
+    w2.flush();
+    assert(!ok.overflowed());
+    assert(ok.len == 11 && memcmp(big, "{\"ok\":true}", 11) == 0);
+    cout << "PASS: buffer sink latches overflow\n";
+}
+
+int main() {
+    test_flat_object();
+    test_nesting_and_arrays();
+    test_integer_limits();
+    test_fixed_point();
+    test_string_escaping();
+    test_output_is_batched();
+    test_long_string_bypasses_stage();
+    test_buffer_sink_overflow();
+    return 0;
+}
@@ -0,0 +1,193 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/LogBuffer.h"
+
+static void fill(uint8_t* rec, size_t len, uint8_t v) { memset(rec, v, len); }
+
+void test_append_until_full() {
+    LogDoubleBuffer<10> buf;
+    uint8_t rec[4];
+    fill(rec, sizeof(rec), 1);
+    assert(buf.append(rec, 4) && buf.append(rec, 4));
+    assert(!buf.fits(4) && buf.fits(2));
+    assert(!buf.append(rec, 4));
+    assert(buf.dropped() == 1 && buf.pending() == 8);
+    cout << "PASS: append stops at capacity and counts the drop\n";
+}
+
+void test_seal_hands_off_and_swaps() {
+    LogDoubleBuffer<16> buf;
+    uint8_t rec[4];
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    assert(!buf.seal());                       // nothing to hand off
+    assert(!buf.peekSealed(data, len));
+
+    fill(rec, sizeof(rec), 7);
+    buf.append(rec, 4);
+    assert(buf.seal());
+    assert(buf.pending() == 0);
+    assert(buf.peekSealed(data, len) && len == 4 && data[0] == 7);
+
+    // Writer still busy: the producer keeps filling, a second seal fails.
+    fill(rec, sizeof(rec), 8);
+    buf.append(rec, 4);
+    assert(!buf.seal());
+    assert(buf.pending() == 4);
+
+    buf.release();
+    assert(buf.seal());
+    assert(buf.peekSealed(data, len) && len == 4 && data[0] == 8);
+    cout << "PASS: seal hands one buffer to the writer at a time\n";
+}
+
+void test_unseal_restores_the_buffer() {
+    LogDoubleBuffer<16> buf;
+    uint8_t rec[4];
+    fill(rec, sizeof(rec), 3);
+    buf.append(rec, 4);
+    assert(buf.seal());
+    buf.unseal();
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+    assert(!buf.peekSealed(data, len));
+    assert(buf.pending() == 4);
+    buf.append(rec, 4);
+    assert(buf.seal());
+    assert(buf.peekSealed(data, len) && len == 8);
+    cout << "PASS: unseal takes back a buffer the writer never saw\n";
+}
+
+void test_flush_policy() {
+    assert(!logFlushDue(0, 10000, 0, 5000));       // nothing buffered
+    assert(!logFlushDue(29, 4999, 0, 5000));
+    assert(logFlushDue(29, 5000, 0, 5000));
+    assert(logFlushDue(29, 1000, 0xFFFFF000u, 5000));   // millis() wrap
+    cout << "PASS: timed flush policy\n";
+}
+
+// Producer and consumer on two threads: every record that was not counted
+// as dropped arrives exactly once and in order.
+void test_two_threads_preserve_order() {
+    static LogDoubleBuffer<64> buf;
+    const uint32_t kRecords = 100000;
+    vector<uint32_t> received;
+    received.reserve(kRecords);
+    std::atomic<bool> done(false);
+
+    thread consumer([&]() {
+        const uint8_t* data = nullptr;
+        size_t len = 0;
+        for (;;) {
+            const bool finished = done.load();
+            if (buf.peekSealed(data, len)) {
+                for (size_t i = 0; i < len; i += 4) {
+                    uint32_t v;
+                    memcpy(&v, data + i, 4);
+                    received.push_back(v);
+                }
+                buf.release();
+            } else if (finished) {
+                break;
+            }
+        }
+    });
+
+    for (uint32_t i = 0; i < kRecords; i++) {
+        uint8_t rec[4];
+        memcpy(rec, &i, 4);
+        // Half the time wait for the writer, half the time drop: both paths.
+        if (!buf.fits(4) && !buf.seal() && (i / 1024) % 2 == 0) {
+            while (!buf.seal()) this_thread::yield();
+        }
+        buf.append(rec, 4);
+    }
+    while (buf.pending() > 0) buf.seal();
+    done.store(true);
+    consumer.join();
+
+    assert(received.size() + buf.dropped() == kRecords);
+    for (size_t i = 1; i < received.size(); i++) assert(received[i] > received[i - 1]);
+    cout << "PASS: two threads, " << buf.dropped() << " dropped, order preserved\n";
+}
+
+static void timedRecord(uint8_t* rec, size_t len, uint32_t ms, uint8_t tag) {
+    memset(rec, tag, len);
+    for (int i = 0; i < 4; i++) rec[i] = (uint8_t)(ms >> (8 * i));
+}
+
+void test_ring_keeps_newest_records() {
+    LogRing<64> ring;
+    uint8_t rec[29];
+    for (uint32_t i = 0; i < 10; i++) {
+        timedRecord(rec, sizeof(rec), i * 100, (uint8_t)i);
+        assert(ring.push(rec, sizeof(rec)));
+    }
+    // 30 bytes per entry: two fit in 64.
+    assert(ring.count() == 2 && ring.oldestTime() == 800);
+    uint8_t out[29];
+    assert(ring.pop(out, sizeof(out)) == 29 && out[4] == 8);
+    assert(ring.pop(out, sizeof(out)) == 29 && out[4] == 9);
+    assert(ring.pop(out, sizeof(out)) == 0 && ring.empty());
+    cout << "PASS: ring evicts the oldest records\n";
+}
+
+void test_ring_mixed_sizes_wrap() {
+    LogRing<100> ring;
+    uint8_t rec[29];
+    uint32_t t = 0;
+    for (int i = 0; i < 50; i++, t += 20) {
+        const size_t len = (i % 5 == 0) ? 29 : 17;
+        timedRecord(rec, len, t, (uint8_t)i);
+        assert(ring.push(rec, len));
+        assert(ring.bytesUsed() <= 100);
+    }
+    uint8_t out[29];
+    uint32_t last = 0;
+    size_t n = 0;
+    bool first = true;
+    while (size_t len = ring.pop(out, sizeof(out))) {
+        const uint32_t ms = out[0] | (out[1] << 8) | (out[2] << 16) | ((uint32_t)out[3] << 24);
+        assert(first || ms == last + 20);
+        assert(len == ((ms / 20) % 5 == 0 ? 29u : 17u));
+        last = ms;
+        first = false;
+        n++;
+    }
+    assert(last == t - 20 && n >= 4);
+    cout << "PASS: ring wraps with mixed record sizes\n";
+}
+
+void test_ring_expires_by_age() {
+    LogRing<1024> ring;
+    uint8_t rec[17];
+    for (uint32_t t = 0; t <= 40000; t += 1000) {
+        timedRecord(rec, sizeof(rec), t, 0);
+        ring.push(rec, sizeof(rec));
+        ring.expire(t, 30000);
+    }
+    assert(ring.oldestTime() == 10000 && ring.count() == 31);
+    ring.expire(100000, 30000);
+    assert(ring.empty());
+    assert(!ring.push(rec, 3));
+    cout << "PASS: ring expires records older than the window\n";
+}
+
+int main() {
+    test_append_until_full();
+    test_seal_hands_off_and_swaps();
+    test_unseal_restores_the_buffer();
+    test_flush_policy();
+    test_two_threads_preserve_order();
+    test_ring_keeps_newest_records();
+    test_ring_mixed_sizes_wrap();
+    test_ring_expires_by_age();
+    return 0;
+}
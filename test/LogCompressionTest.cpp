@@ -0,0 +1,244 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/LogCompression.h"
+#include "../src/Logger/FlightLogFormat.h"
+
+// Pushes `in` through an encoder in chunks of `chunk` bytes, reading the
+// output through a buffer of `readCap` bytes.
+static vector<uint8_t> compress(const vector<uint8_t>& in, size_t chunk, size_t readCap) {
+    LogCompression::Encoder enc;
+    vector<uint8_t> out;
+    vector<uint8_t> buf(readCap);
+    size_t pos = 0;
+    while (pos < in.size()) {
+        const size_t n = (in.size() - pos) < chunk ? (in.size() - pos) : chunk;
+        const size_t taken = enc.push(in.data() + pos, n);
+        pos += taken;
+        size_t got;
+        while ((got = enc.read(buf.data(), buf.size())) > 0) out.insert(out.end(), buf.begin(), buf.begin() + got);
+    }
+    enc.finish();
+    size_t got;
+    while ((got = enc.read(buf.data(), buf.size())) > 0) out.insert(out.end(), buf.begin(), buf.begin() + got);
+    return out;
+}
+
+static vector<uint8_t> decompress(const vector<uint8_t>& in, size_t chunk, size_t readCap) {
+    LogCompression::Decoder dec;
+    vector<uint8_t> out;
+    vector<uint8_t> buf(readCap);
+    size_t pos = 0;
+    for (;;) {
+        size_t got;
+        while ((got = dec.read(buf.data(), buf.size())) > 0) out.insert(out.end(), buf.begin(), buf.begin() + got);
+        if (pos == in.size()) break;
+        const size_t n = (in.size() - pos) < chunk ? (in.size() - pos) : chunk;
+        pos += dec.push(in.data() + pos, n);
+    }
+    return out;
+}
+
+static vector<uint8_t> flightLog(int records) {
+    vector<uint8_t> log(FlightLog::kHeaderSize);
+    FlightLog::Header h;
+    memset(&h, 0, sizeof(h));
+    h.version = FlightLog::kVersion;
+    h.schema = FlightLog::kSchemaTelemetryV1;
+    h.recordSize = FlightLog::kRecordSize;
+    h.fastRecordSize = FlightLog::kFastRecordSize;
+    FlightLog::encodeHeader(h, log.data());
+    for (int i = 0; i < records; i++) {
+        FlightLog::Record r;
+        memset(&r, 0, sizeof(r));
+        r.offset = (uint32_t)i * 1000;
+        r.flags = FlightLog::RecordHasTelemetry | FlightLog::RecordHasPowerKw | FlightLog::RecordHasCurrent;
+        r.throttlePercent = (uint8_t)(60 + (i / 30) % 20);
+        r.powerPercent = 100;
+        r.throttleRaw = (uint16_t)(1500 + (i / 30) % 200);
+        r.rpm = (uint16_t)(4000 + (i % 7) * 10);
+        r.escCurrentDa = (uint16_t)(550 + (i % 5));
+        r.batteryVoltageMv = (uint16_t)(50000 - i);
+        r.motorTempDc = 452;
+        r.escTempDc = 401;
+        r.batteryPercentCc = (uint8_t)(90 - i / 120);
+        r.batteryPercentVoltage = r.batteryPercentCc;
+        uint8_t rec[FlightLog::kRecordSize];
+        FlightLog::encodeRecord(r, rec);
+        log.insert(log.end(), rec, rec + sizeof(rec));
+    }
+    return log;
+}
+
+void test_round_trip_shapes() {
+    vector<uint8_t> empty;
+    assert(compress(empty, 64, 64).empty());
+    assert(decompress(compress(empty, 64, 64), 64, 64).empty());
+
+    vector<uint8_t> one(1, 0x5A);
+    assert(decompress(compress(one, 64, 64), 64, 64) == one);
+
+    vector<uint8_t> same(5000, 0x00);
+    vector<uint8_t> packed = compress(same, 64, 64);
+    assert(packed.size() < same.size() / 8);
+    assert(decompress(packed, 64, 64) == same);
+
+    // Pseudo-random bytes: no gain, but must survive (9/8 worst case).
+    vector<uint8_t> noise(4000);
+    uint32_t x = 12345;
+    for (auto& b : noise) { x = x * 1103515245u + 12345u; b = (uint8_t)(x >> 16); }
+    packed = compress(noise, 64, 64);
+    assert(packed.size() <= noise.size() * 9 / 8 + 1);
+    assert(decompress(packed, 64, 64) == noise);
+    cout << "PASS: empty, single byte, runs and noise round-trip\n";
+}
+
+void test_chunking_does_not_matter() {
+    const vector<uint8_t> log = flightLog(300);
+    const vector<uint8_t> whole = compress(log, log.size(), 4096);
+    assert(compress(log, 1, 1) == whole);
+    assert(compress(log, 7, 3) == whole);
+    assert(decompress(whole, 1, 1) == log);
+    assert(decompress(whole, 5, 13) == log);
+    cout << "PASS: output does not depend on buffer sizes\n";
+}
+
+void test_matches_beyond_window() {
+    // A pattern repeating every 1000 bytes: every copy reaches back
+    // almost the whole window.
+    vector<uint8_t> data(6000);
+    for (size_t i = 0; i < data.size(); i++) data[i] = (uint8_t)((i % 1000) * 7 + (i % 1000) / 3);
+    const vector<uint8_t> packed = compress(data, 100, 100);
+    assert(decompress(packed, 100, 100) == data);
+    assert(packed.size() < data.size() / 2);
+    cout << "PASS: copies reach back a whole window\n";
+}
+
+void test_flight_log_ratio() {
+    const vector<uint8_t> log = flightLog(1200);   // 20 min at 1 Hz
+    const vector<uint8_t> packed = compress(log, 64, 64);
+    assert(decompress(packed, 64, 64) == log);
+    cout << "  binary log " << log.size() << " -> " << packed.size() << " bytes\n";
+    assert(packed.size() * 2 < log.size());
+
+    // The CSV a download would produce compresses much further.
+    FlightLog::CsvConverter conv;
+    vector<uint8_t> csv;
+    uint8_t buf[128];
+    size_t pos = 0;
+    for (;;) {
+        const size_t got = conv.read(buf, sizeof(buf));
+        csv.insert(csv.end(), buf, buf + got);
+        if (got > 0) continue;
+        if (pos == log.size() || conv.wants() == 0) break;
+        pos += conv.push(log.data() + pos, log.size() - pos);
+    }
+    const vector<uint8_t> csvPacked = compress(csv, 64, 64);
+    assert(decompress(csvPacked, 64, 64) == csv);
+    cout << "  CSV " << csv.size() << " -> " << csvPacked.size() << " bytes\n";
+    assert(csvPacked.size() * 3 < csv.size());
+    cout << "PASS: flight logs compress\n";
+}
+
+void test_file_header() {
+    uint8_t h[LogCompression::kFileHeaderSize];
+    LogCompression::encodeFileHeader(123456, h);
+    uint32_t raw = 0;
+    assert(LogCompression::isCompressed(h, sizeof(h)));
+    assert(LogCompression::decodeFileHeader(h, sizeof(h), raw) && raw == 123456);
+    assert(!LogCompression::decodeFileHeader(h, sizeof(h) - 1, raw));
+    const vector<uint8_t> log = flightLog(1);
+    assert(!LogCompression::isCompressed(log.data(), log.size()));
+    cout << "PASS: compressed file header\n";
+}
+
+// Compresses with a block boundary before each offset in `cuts`, the way
+// Logger::compressLog() does; returns the bit offset of each block.
+static vector<uint8_t> compressBlocks(const vector<uint8_t>& in, const vector<size_t>& cuts,
+                                      vector<uint32_t>& bitOffsets) {
+    LogCompression::Encoder enc;
+    vector<uint8_t> out;
+    uint8_t buf[16];
+    size_t pos = 0;
+    size_t got;
+    for (size_t c = 0; c <= cuts.size(); c++) {
+        const size_t end = c < cuts.size() ? cuts[c] : in.size();
+        while (pos < end) {
+            pos += enc.push(in.data() + pos, end - pos);
+            while ((got = enc.read(buf, sizeof(buf))) > 0) out.insert(out.end(), buf, buf + got);
+        }
+        if (c == cuts.size()) break;
+        enc.endBlock();
+        while ((got = enc.read(buf, sizeof(buf))) > 0) out.insert(out.end(), buf, buf + got);
+        bitOffsets.push_back(enc.bitsOut());
+    }
+    enc.finish();
+    while ((got = enc.read(buf, sizeof(buf))) > 0) out.insert(out.end(), buf, buf + got);
+    return out;
+}
+
+void test_blocks_decode_on_their_own() {
+    const vector<uint8_t> log = flightLog(600);
+    vector<size_t> cuts;
+    for (size_t at = FlightLog::kHeaderSize; at < log.size(); at += 100 * FlightLog::kRecordSize) cuts.push_back(at);
+    vector<uint32_t> bits;
+    const vector<uint8_t> packed = compressBlocks(log, cuts, bits);
+    assert(bits.size() == cuts.size());
+    assert(decompress(packed, 64, 64) == log);
+    // Blocks cost a little ratio, not much.
+    assert(packed.size() < compress(log, 64, 64).size() * 11 / 10);
+
+    for (size_t b = 0; b < cuts.size(); b++) {
+        LogCompression::Decoder dec;
+        dec.reset((uint32_t)cuts[b], (uint8_t)(bits[b] % 8));
+        vector<uint8_t> out;
+        uint8_t buf[32];
+        size_t pos = bits[b] / 8;
+        for (;;) {
+            size_t got;
+            while ((got = dec.read(buf, sizeof(buf))) > 0) out.insert(out.end(), buf, buf + got);
+            if (pos == packed.size()) break;
+            pos += dec.push(packed.data() + pos, min((size_t)5, packed.size() - pos));
+        }
+        assert(dec.produced() == log.size());
+        assert(vector<uint8_t>(log.begin() + cuts[b], log.end()) == out);
+    }
+    cout << "PASS: each block decodes from its own bit offset\n";
+}
+
+void test_footer() {
+    uint8_t entry[LogCompression::kSyncPointSize];
+    LogCompression::SyncPoint s = {120000, 3502, 9001}, back;
+    LogCompression::encodeSyncPoint(s, entry);
+    LogCompression::decodeSyncPoint(entry, back);
+    assert(back.firstMs == 120000 && back.rawOffset == 3502 && back.bitOffset == 9001);
+
+    uint8_t trailer[LogCompression::kTrailerSize];
+    LogCompression::encodeTrailer(600000, 3, trailer);
+    uint32_t endMs = 0, count = 0;
+    const uint32_t fileSize = 1000;
+    assert(LogCompression::decodeTrailer(trailer, fileSize, endMs, count) && endMs == 600000 && count == 3);
+    assert(LogCompression::syncPointOffset(fileSize, count, 0) == fileSize - 12 - 36);
+    assert(LogCompression::syncPointOffset(fileSize, count, 2) == fileSize - 12 - 12);
+    // Too many entries for the file, or no magic: no footer.
+    assert(!LogCompression::decodeTrailer(trailer, 50, endMs, count));
+    trailer[11] = 'Y';
+    assert(!LogCompression::decodeTrailer(trailer, fileSize, endMs, count));
+    cout << "PASS: sync point footer\n";
+}
+
+int main() {
+    test_round_trip_shapes();
+    test_chunking_does_not_matter();
+    test_matches_beyond_window();
+    test_flight_log_ratio();
+    test_file_header();
+    test_blocks_decode_on_their_own();
+    test_footer();
+    return 0;
+}
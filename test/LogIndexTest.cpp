@@ -0,0 +1,183 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/LogIndex.h"
+
+// Encodes the whole index the way Logger::saveIndex() streams it.
+static size_t persist(const LogIndex& index, uint8_t* out) {
+    uint8_t* p = out;
+    index.encodeHeader(p);
+    p += LogIndex::kHeaderSize;
+    for (size_t i = 0; i < index.count(); i++) {
+        index.encodeEntry(i, p);
+        p += LogIndex::kEntrySize;
+    }
+    const uint32_t sum = LogIndex::checksum(LogIndex::checksumInit(), out, (size_t)(p - out));
+    FlightLog::putU32(p, sum);
+    return (size_t)(p - out);
+}
+
+// Mirrors Logger::loadIndex(): false for anything that must trigger a rebuild.
+static bool load(LogIndex& index, const uint8_t* in, size_t len) {
+    if (len < LogIndex::kHeaderSize + LogIndex::kChecksumSize) return false;
+    const int count = index.decodeHeader(in);
+    if (count < 0) return false;
+    const size_t body = LogIndex::kHeaderSize + (size_t)count * LogIndex::kEntrySize;
+    if (len != body + LogIndex::kChecksumSize) return false;
+    for (int i = 0; i < count; i++) {
+        if (!index.decodeEntry(in + LogIndex::kHeaderSize + (size_t)i * LogIndex::kEntrySize)) return false;
+    }
+    const uint8_t* p = in + body;
+    return FlightLog::getU32(p) == LogIndex::checksum(LogIndex::checksumInit(), in, body);
+}
+
+void test_parse_path_and_seq() {
+    char stem[LogIndex::kStemSize];
+    uint8_t kind;
+    assert(LogIndex::parsePath("/20250419_003.flog", stem, kind));
+    assert(strcmp(stem, "20250419_003") == 0 && kind == LogIndex::KindFlog);
+    assert(LogIndex::parsePath("00012.csv", stem, kind) && kind == LogIndex::KindCsv);
+    assert(LogIndex::parsePath("/flight.txt", stem, kind) && kind == LogIndex::KindTxt);
+    assert(!LogIndex::parsePath("/20250419_003.sum", stem, kind));
+    assert(!LogIndex::parsePath("/logs.idx", stem, kind));
+    assert(!LogIndex::parsePath("/a_very_long_log_name_from_elsewhere.csv", stem, kind));
+
+    uint32_t date, seq;
+    assert(LogIndex::parseSeq("20250419_003", date, seq) && date == 20250419 && seq == 3);
+    assert(LogIndex::parseSeq("00012", date, seq) && date == 0 && seq == 12);
+    assert(!LogIndex::parseSeq("flight", date, seq));
+    assert(!LogIndex::parseSeq("2025_003", date, seq));
+    assert(!LogIndex::parseSeq("20250419_", date, seq));
+    cout << "PASS: log names parse to stem, kind and sequence\n";
+}
+
+void test_next_seq() {
+    LogIndex index;
+    assert(index.nextSeq(20250419) == 1);
+    assert(index.nextSeq(0) == 1);
+    index.add("20250419_001", LogIndex::KindFlog, 500, 0);
+    index.add("20250419_002", LogIndex::KindFlog, 500, 0);
+    index.add("00007", LogIndex::KindCsv, 500, 0);
+    assert(index.nextSeq(20250419) == 3);
+    assert(index.nextSeq(20250420) == 1);
+    assert(index.nextSeq(0) == 8);
+
+    // Counters survive the files: deleting logs does not reuse names.
+    index.clearEntries();
+    assert(index.count() == 0);
+    assert(index.nextSeq(20250419) == 3);
+
+    // A clock set back to a day already logged finds that day's highest.
+    index.add("20250420_001", LogIndex::KindFlog, 500, 0);
+    index.add("20250419_005", LogIndex::KindFlog, 500, 0);
+    assert(index.nextSeq(20250420) == 2);
+    assert(index.nextSeq(20250419) == 6);
+    cout << "PASS: next sequence number from the counters\n";
+}
+
+void test_reuse_header_only_log() {
+    LogIndex index;
+    index.add("20250419_001", LogIndex::KindFlog, 4000, 0);
+    index.add("20250419_002", LogIndex::KindFlog, FlightLog::kHeaderSize, 0);
+    index.add("20250418_001", LogIndex::KindFlog, FlightLog::kHeaderSize, 0);
+    assert(index.findReusable(20250419) == 1);
+    assert(index.findReusable(20250420) < 0);
+    assert(index.addBytes("/20250419_002.flog", FlightLog::kRecordSize));
+    assert(index.findReusable(20250419) < 0);
+    cout << "PASS: header-only logs are reused\n";
+}
+
+void test_add_remove_and_summary() {
+    LogIndex index;
+    assert(index.add("00003", LogIndex::KindCsv, 100, 0) == 0);
+    // The binary log of the same name replaces the text one, not the reverse.
+    assert(index.add("00003", LogIndex::KindFlog, 22, 1700000000000ULL) == 0);
+    assert(index.add("00003", LogIndex::KindCsv, 100, 0) == 0);
+    assert(index.count() == 1 && index.at(0).kind == LogIndex::KindFlog);
+    assert(index.findPath("/00003.flog") == 0 && index.findPath("/00003.csv") < 0);
+
+    uint8_t summary[FlightSummaryCodec::kEncodedSize];
+    memset(summary, 0xAB, sizeof(summary));
+    assert(!index.setSummary("/00003.flog", summary, sizeof(summary) - 1));
+    assert(index.setSummary("/00003.flog", summary, sizeof(summary)));
+    assert(index.at(0).hasSummary && index.at(0).summary[5] == 0xAB);
+
+    index.add("00004", LogIndex::KindFlog, 22, 0);
+    assert(index.remove("/00003.flog"));
+    assert(!index.remove("/00003.flog"));
+    assert(index.count() == 1 && strcmp(index.at(0).stem, "00004") == 0);
+
+    char path[32];
+    assert(LogIndex::pathFor(index.at(0), path, sizeof(path)) && strcmp(path, "/00004.flog") == 0);
+    cout << "PASS: add, replace, remove and summaries\n";
+}
+
+void test_full_index_is_incomplete() {
+    LogIndex index;
+    char stem[16];
+    for (size_t i = 0; i < LogIndex::kMaxEntries; i++) {
+        snprintf(stem, sizeof(stem), "%05u", (unsigned)(i + 1));
+        assert(index.add(stem, LogIndex::KindFlog, 100, 0) >= 0);
+    }
+    assert(index.complete());
+    assert(index.add("99999", LogIndex::KindFlog, 100, 0) < 0);
+    assert(!index.complete());
+    // The counter still moves past the file that did not fit.
+    assert(index.nextSeq(0) == 100000);
+    cout << "PASS: a full index is marked incomplete\n";
+}
+
+void test_persist_round_trip() {
+    LogIndex index;
+    index.add("20250419_001", LogIndex::KindFlog, 12345, 1745020800123ULL);
+    index.add("00002", LogIndex::KindTxt, 77, 0);
+    uint8_t summary[FlightSummaryCodec::kEncodedSize];
+    for (size_t i = 0; i < sizeof(summary); i++) summary[i] = (uint8_t)i;
+    index.setSummary("/20250419_001.flog", summary, sizeof(summary));
+
+    static uint8_t buf[LogIndex::kHeaderSize + LogIndex::kMaxEntries * LogIndex::kEntrySize + LogIndex::kChecksumSize];
+    const size_t len = persist(index, buf);
+    assert(len == index.encodedSize());
+
+    static LogIndex loaded;
+    assert(load(loaded, buf, len));
+    assert(loaded.count() == 2 && loaded.complete());
+    assert(strcmp(loaded.at(0).stem, "20250419_001") == 0);
+    assert(loaded.at(0).size == 12345 && loaded.at(0).startEpochMs == 1745020800123ULL);
+    assert(loaded.at(0).hasSummary && memcmp(loaded.at(0).summary, summary, sizeof(summary)) == 0);
+    assert(loaded.at(1).kind == LogIndex::KindTxt && !loaded.at(1).hasSummary);
+    assert(loaded.nextSeq(20250419) == 2 && loaded.nextSeq(0) == 3);
+    cout << "PASS: index persists and loads back\n";
+}
+
+void test_corrupt_index_is_rejected() {
+    LogIndex index;
+    index.add("20250419_001", LogIndex::KindFlog, 12345, 0);
+    static uint8_t buf[LogIndex::kHeaderSize + 2 * LogIndex::kEntrySize + LogIndex::kChecksumSize];
+    const size_t len = persist(index, buf);
+    static LogIndex loaded;
+
+    buf[LogIndex::kHeaderSize + 3] ^= 1;                 // flipped bit in a name
+    assert(!load(loaded, buf, len));
+    buf[LogIndex::kHeaderSize + 3] ^= 1;
+    assert(load(loaded, buf, len));
+
+    assert(!load(loaded, buf, len - 1));                 // torn write
+    buf[2] = LogIndex::kVersion + 1;                     // unknown layout
+    assert(!load(loaded, buf, len));
+    cout << "PASS: corrupt, torn or unknown indexes are rejected\n";
+}
+
+int main() {
+    test_parse_path_and_seq();
+    test_next_seq();
+    test_reuse_header_only_log();
+    test_add_remove_and_summary();
+    test_full_index_is_incomplete();
+    test_persist_round_trip();
+    test_corrupt_index_is_rejected();
+    return 0;
+}
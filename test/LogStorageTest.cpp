@@ -0,0 +1,80 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+using namespace std;
+
+#include "../src/Logger/LogStorage.h"
+
+static const uint32_t kBlock = 4096;
+
+void test_footprint_rounds_to_blocks() {
+    assert(LogStorage::footprint(0, false, kBlock) == kBlock);
+    assert(LogStorage::footprint(22, false, kBlock) == kBlock);
+    assert(LogStorage::footprint(4096, false, kBlock) == kBlock);
+    assert(LogStorage::footprint(4097, false, kBlock) == 2 * kBlock);
+    assert(LogStorage::footprint(4097, true, kBlock) == 3 * kBlock);
+    cout << "PASS: footprint counts whole blocks and the .sum file\n";
+}
+
+void test_nothing_to_rotate_with_room() {
+    LogIndex index;
+    index.add("00001", LogIndex::KindFlog, 9000, 0);
+    assert(LogStorage::planRotation(index, 40000, 24 * 1024, kBlock, -1, 1) == 0);
+    cout << "PASS: no rotation while the reserve is free\n";
+}
+
+void test_oldest_first_until_reserve() {
+    LogIndex index;
+    index.add("00001", LogIndex::KindFlog, 4000, 0);    // 1 block
+    index.add("00002", LogIndex::KindFlog, 9000, 0);    // 3 blocks
+    index.add("00003", LogIndex::KindFlog, 4000, 0);
+    // 2 blocks free, 4 wanted: the two oldest go.
+    assert(LogStorage::planRotation(index, 2 * kBlock, 4 * kBlock, kBlock, -1, 1) == 2);
+    // 3 blocks free: the oldest alone is enough.
+    assert(LogStorage::planRotation(index, 3 * kBlock, 4 * kBlock, kBlock, -1, 1) == 1);
+    cout << "PASS: oldest logs rotate out until the reserve is free\n";
+}
+
+void test_current_log_is_kept() {
+    LogIndex index;
+    index.add("00001", LogIndex::KindFlog, 40000, 0);   // being written
+    index.add("00002", LogIndex::KindFlog, 4000, 0);
+    // Only 00002 may go, and that is still not enough: stop there.
+    assert(LogStorage::planRotation(index, 0, 8 * kBlock, kBlock, 0, 0) == 1);
+    // A lone current log is never a candidate.
+    LogIndex single;
+    single.add("00001", LogIndex::KindFlog, 40000, 0);
+    assert(LogStorage::planRotation(single, 0, 8 * kBlock, kBlock, 0, 0) == 0);
+    cout << "PASS: the log being written is never rotated\n";
+}
+
+void test_keeps_index_room() {
+    static LogIndex index;
+    char stem[16];
+    for (size_t i = 0; i < LogIndex::kMaxEntries; i++) {
+        snprintf(stem, sizeof(stem), "%05u", (unsigned)(i + 1));
+        index.add(stem, LogIndex::KindFlog, 100, 0);
+    }
+    // Plenty of space, but a new flight needs an index slot.
+    assert(LogStorage::planRotation(index, 1000000, kBlock, kBlock, -1, 1) == 1);
+    assert(LogStorage::planRotation(index, 1000000, kBlock, kBlock, -1, 0) == 0);
+    cout << "PASS: rotation keeps a free index slot for the next flight\n";
+}
+
+void test_reserve_range() {
+    assert(LogStorage::isValidReserveKb(LogStorage::kDefaultReserveKb));
+    assert(LogStorage::isValidReserveKb(8) && LogStorage::isValidReserveKb(64));
+    assert(!LogStorage::isValidReserveKb(7) && !LogStorage::isValidReserveKb(65));
+    cout << "PASS: reserve range\n";
+}
+
+int main() {
+    test_footprint_rounds_to_blocks();
+    test_nothing_to_rotate_with_room();
+    test_oldest_first_until_reserve();
+    test_current_log_is_kept();
+    test_keeps_index_room();
+    test_reserve_range();
+    return 0;
+}
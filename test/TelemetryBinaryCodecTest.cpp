@@ -0,0 +1,189 @@
+#include <iostream>
+#include <cassert>
+#include <cstring>
+#include <stdint.h>
+#include <stddef.h>
+using namespace std;
+
+#include "../src/Telemetry/TelemetryBinaryCodec.h"
+
+// ── Helpers ───────────────────────────────────────────────────────────────────
+
+static TelemetryFrame makeFrame(uint32_t seq) {
+    TelemetryFrame f;
+    f.clear();
+    f.seq = seq;
+    f.set(TelemetryFieldFlags, TelemetryFlagHasTelemetry | TelemetryFlagArmed | TelemetryFlagAvRpm);
+    f.set(TelemetryFieldBatteryPercentCc, 87);
+    f.set(TelemetryFieldBatteryVoltageMv, 52340);
+    f.set(TelemetryFieldThrottlePercent, 42);
+    f.set(TelemetryFieldThrottleRaw, 17123);
+    f.set(TelemetryFieldMotorTempMc, 45250);
+    f.set(TelemetryFieldEscTempMc, -1500);
+    f.set(TelemetryFieldRpm, 3200);
+    f.set(TelemetryFieldUptimeMs, 1234567);
+    return f;
+}
+
+static void addBeep(TelemetryFrame& f, uint32_t seq, uint16_t freq, uint8_t layer, bool active) {
+    TelemetryBeep b = { seq, freq, 100, 50, 2, layer, active };
+    if (f.beepCount == TelemetryFrame::kMaxBeeps) {
+        for (uint8_t j = 1; j < TelemetryFrame::kMaxBeeps; j++) f.beeps[j - 1] = f.beeps[j];
+        f.beepCount--;
+    }
+    f.beeps[f.beepCount++] = b;
+}
+
+static bool framesEqual(const TelemetryFrame& a, const TelemetryFrame& b) {
+    if (a.seq != b.seq || a.presentMask != b.presentMask || a.beepCount != b.beepCount) return false;
+    for (uint8_t i = 0; i < TelemetryFieldCount; i++) {
+        if ((a.presentMask & (1UL << i)) && a.values[i] != b.values[i]) return false;
+    }
+    for (uint8_t i = 0; i < a.beepCount; i++) {
+        const TelemetryBeep& x = a.beeps[i];
+        const TelemetryBeep& y = b.beeps[i];
+        if (x.seq != y.seq || x.frequency != y.frequency || x.onMs != y.onMs || x.offMs != y.offMs
+            || x.reps != y.reps || x.layer != y.layer || x.active != y.active) return false;
+    }
+    return true;
+}
+
+// ── Tests ─────────────────────────────────────────────────────────────────────
+
+void test_zigzag_roundtrip() {
+    const int32_t samples[] = { 0, 1, -1, 63, -64, 64, 1000000, -1000000, INT32_MAX, INT32_MIN };
+    for (int32_t v : samples) {
+        assert(TelemetryBinary::unzigzag(TelemetryBinary::zigzag(v)) == v);
+    }
+    assert(TelemetryBinary::zigzag(-1) == 1);
+    assert(TelemetryBinary::zigzag(1) == 2);
+    cout << "PASS: zig-zag round trip\n";
+}
+
+void test_keyframe_roundtrip() {
+    TelemetryFrame f = makeFrame(5);
+    addBeep(f, 10, 2000, 0, true);
+    addBeep(f, 11, 2500, 1, false);
+
+    uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+    size_t len = TelemetryBinary::encode(f, nullptr, buf, sizeof(buf));
+    assert(len > 0);
+    assert(buf[0] == TELEMETRY_BIN_MAGIC && buf[1] == TELEMETRY_BIN_VERSION);
+    assert(buf[2] & TELEMETRY_BIN_FLAG_KEYFRAME);
+
+    TelemetryFrame out;
+    assert(TelemetryBinary::decode(buf, len, nullptr, out));
+    assert(framesEqual(f, out));
+    assert(!out.has(TelemetryFieldEscCurrentMa));
+    cout << "PASS: keyframe round trip (" << len << " bytes)\n";
+}
+
+void test_delta_carries_only_changes() {
+    TelemetryFrame base = makeFrame(1);
+    TelemetryFrame cur = base;
+    cur.seq = 2;
+    cur.values[TelemetryFieldThrottlePercent] = 43;
+    cur.values[TelemetryFieldUptimeMs] += 500;
+
+    uint8_t key[TelemetryBinary::kMaxEncodedSize];
+    uint8_t delta[TelemetryBinary::kMaxEncodedSize];
+    size_t keyLen = TelemetryBinary::encode(cur, nullptr, key, sizeof(key));
+    size_t deltaLen = TelemetryBinary::encode(cur, &base, delta, sizeof(delta));
+    assert(deltaLen > 0 && deltaLen < keyLen);
+    // header(3) + seq + baseSeq + presentMask(2) + changedMask(3) + 2 small deltas + beepCount
+    assert(deltaLen <= 16);
+
+    TelemetryFrame out;
+    assert(TelemetryBinary::decode(delta, deltaLen, &base, out));
+    assert(framesEqual(cur, out));
+    cout << "PASS: delta carries only changed fields (" << deltaLen << " vs " << keyLen << " bytes)\n";
+}
+
+void test_delta_handles_appearing_and_vanishing_fields() {
+    TelemetryFrame base = makeFrame(1);
+    TelemetryFrame cur = base;
+    cur.seq = 2;
+    cur.presentMask &= ~(1UL << TelemetryFieldRpm);        // RPM lost
+    cur.set(TelemetryFieldEscCurrentMa, 85000);             // current appears
+
+    uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+    size_t len = TelemetryBinary::encode(cur, &base, buf, sizeof(buf));
+    TelemetryFrame out;
+    assert(TelemetryBinary::decode(buf, len, &base, out));
+    assert(!out.has(TelemetryFieldRpm));
+    assert(out.has(TelemetryFieldEscCurrentMa) && out.values[TelemetryFieldEscCurrentMa] == 85000);
+    assert(framesEqual(cur, out));
+    cout << "PASS: delta handles fields appearing and vanishing\n";
+}
+
+void test_delta_sends_only_new_beeps() {
+    TelemetryFrame base = makeFrame(1);
+    for (uint32_t s = 1; s <= 8; s++) addBeep(base, s, 2000, 0, true);
+    TelemetryFrame cur = base;
+    cur.seq = 2;
+    addBeep(cur, 9, 2200, 1, true);
+    addBeep(cur, 10, 2200, 1, false);
+
+    uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+    size_t len = TelemetryBinary::encode(cur, &base, buf, sizeof(buf));
+    TelemetryFrame out;
+    assert(TelemetryBinary::decode(buf, len, &base, out));
+    assert(framesEqual(cur, out));
+    assert(out.beeps[0].seq == 3 && out.newestBeepSeq() == 10);
+
+    // Unchanged ring: zero beeps on the wire.
+    TelemetryFrame next = cur;
+    next.seq = 3;
+    len = TelemetryBinary::encode(next, &cur, buf, sizeof(buf));
+    assert(buf[len - 1] == 0);
+    cout << "PASS: delta sends only beeps newer than the base\n";
+}
+
+void test_decode_rejects_bad_input() {
+    TelemetryFrame base = makeFrame(1);
+    TelemetryFrame cur = makeFrame(2);
+    uint8_t buf[TelemetryBinary::kMaxEncodedSize];
+    size_t len = TelemetryBinary::encode(cur, &base, buf, sizeof(buf));
+    TelemetryFrame out;
+
+    assert(!TelemetryBinary::decode(buf, len, nullptr, out));       // delta without base
+    TelemetryFrame wrongBase = makeFrame(7);
+    assert(!TelemetryBinary::decode(buf, len, &wrongBase, out));     // base seq mismatch
+    assert(!TelemetryBinary::decode(buf, len - 1, &base, out));      // truncated
+
+    uint8_t bad[TelemetryBinary::kMaxEncodedSize];
+    memcpy(bad, buf, len);
+    bad[1] = TELEMETRY_BIN_VERSION + 1;
+    assert(!TelemetryBinary::decode(bad, len, &base, out));          // unknown version
+    cout << "PASS: decode rejects malformed, mismatched or unknown frames\n";
+}
+
+void test_encode_reports_small_buffer() {
+    TelemetryFrame f = makeFrame(1);
+    uint8_t buf[8];
+    assert(TelemetryBinary::encode(f, nullptr, buf, sizeof(buf)) == 0);
+    cout << "PASS: encode reports a buffer that is too small\n";
+}
+
+void test_history_lookup() {
+    TelemetryFrameHistory<3> history;
+    assert(history.latest() == nullptr);
+    for (uint32_t s = 1; s <= 4; s++) history.push(makeFrame(s));
+    assert(history.find(1) == nullptr);   // aged out
+    assert(history.find(2) != nullptr && history.find(2)->seq == 2);
+    assert(history.latest()->seq == 4);
+    assert(history.find(0) == nullptr);
+    cout << "PASS: history keeps the last N frames\n";
+}
+
+int main() {
+    test_zigzag_roundtrip();
+    test_keyframe_roundtrip();
+    test_delta_carries_only_changes();
+    test_delta_handles_appearing_and_vanishing_fields();
+    test_delta_sends_only_new_beeps();
+    test_decode_rejects_bad_input();
+    test_encode_reports_small_buffer();
+    test_history_lookup();
+    return 0;
+}
@@ -0,0 +1,132 @@
+#include <iostream>
+#include <cassert>
+#include <stdint.h>
+#include <stdbool.h>
+using namespace std;
+
+#include "../src/WebServer/TelemetryPushLogic.h"
+
+static const uint16_t MIN_INTERVAL_MS = 500;
+static const uint16_t MAX_INTERVAL_MS = 5000;
+
+void test_first_frame_is_sent_immediately() {
+    TelemetryPushSchedule sched;
+    assert(sched.addClient(7, MIN_INTERVAL_MS));
+    assert(sched.shouldSend(7, 1234, true));
+    cout << "PASS: first frame is sent immediately\n";
+}
+
+void test_unknown_client_is_never_sent() {
+    TelemetryPushSchedule sched;
+    assert(!sched.shouldSend(42, 0, true));
+    cout << "PASS: unknown client is never sent\n";
+}
+
+void test_client_interval_is_respected() {
+    TelemetryPushSchedule sched;
+    sched.addClient(1, MIN_INTERVAL_MS);
+    sched.setClientInterval(1, 1000, MIN_INTERVAL_MS, MAX_INTERVAL_MS);
+    assert(sched.shouldSend(1, 0, true));
+    assert(!sched.shouldSend(1, 500, true));   // push period, but client wants 1 s
+    assert(sched.shouldSend(1, 1000, true));
+    assert(!sched.shouldSend(1, 1500, true));
+    assert(sched.shouldSend(1, 2000, true));
+    cout << "PASS: per-client interval is respected\n";
+}
+
+void test_interval_is_clamped() {
+    TelemetryPushSchedule sched;
+    sched.addClient(1, MIN_INTERVAL_MS);
+    sched.setClientInterval(1, 10, MIN_INTERVAL_MS, MAX_INTERVAL_MS);
+    assert(sched.shouldSend(1, 0, true));
+    assert(!sched.shouldSend(1, 100, true));   // cannot go faster than the floor
+    assert(sched.shouldSend(1, 500, true));
+
+    sched.setClientInterval(1, 600000, MIN_INTERVAL_MS, MAX_INTERVAL_MS);
+    assert(!sched.shouldSend(1, 5499, true));
+    assert(sched.shouldSend(1, 5500, true));   // ceiling keeps the client alive
+    cout << "PASS: requested interval is clamped\n";
+}
+
+void test_backpressure_skips_and_counts() {
+    TelemetryPushSchedule sched;
+    sched.addClient(1, MIN_INTERVAL_MS);
+    sched.addClient(2, MIN_INTERVAL_MS);
+
+    assert(sched.shouldSend(1, 0, true));
+    assert(!sched.shouldSend(2, 0, false));     // slow client skipped
+    assert(sched.getDroppedFrames() == 1);
+
+    // The slow client gets the very next frame once its queue drains, without
+    // waiting a full interval -- it never received the skipped one.
+    assert(sched.shouldSend(2, 500, true));
+    assert(sched.getDroppedFrames() == 1);
+    cout << "PASS: backpressure skips a congested client and counts the drop\n";
+}
+
+void test_table_capacity_and_removal() {
+    TelemetryPushSchedule sched;
+    for (uint32_t id = 0; id < TelemetryPushSchedule::kMaxClients; id++) {
+        assert(sched.addClient(id, MIN_INTERVAL_MS));
+    }
+    assert(!sched.addClient(99, MIN_INTERVAL_MS));
+    assert(sched.clientCount() == TelemetryPushSchedule::kMaxClients);
+
+    sched.removeClient(0);
+    assert(sched.clientCount() == TelemetryPushSchedule::kMaxClients - 1);
+    uint32_t ids[TelemetryPushSchedule::kMaxClients];
+    assert(sched.copyClientIds(ids, TelemetryPushSchedule::kMaxClients) == TelemetryPushSchedule::kMaxClients - 1);
+    for (uint8_t i = 0; i < TelemetryPushSchedule::kMaxClients - 1; i++) assert(ids[i] != 0);
+    assert(sched.copyClientIds(ids, 1) == 1);
+    assert(!sched.shouldSend(0, 0, true));
+    assert(sched.addClient(99, MIN_INTERVAL_MS));
+    assert(sched.shouldSend(99, 0, true));
+    cout << "PASS: table capacity is bounded and slots are reused\n";
+}
+
+void test_survives_millis_rollover() {
+    TelemetryPushSchedule sched;
+    sched.addClient(1, MIN_INTERVAL_MS);
+    assert(sched.shouldSend(1, 0xFFFFFF00u, true));
+    assert(!sched.shouldSend(1, 0x00000010u, true)); // 272 ms elapsed
+    assert(sched.shouldSend(1, 0x00000200u, true));  // 768 ms elapsed
+    cout << "PASS: survives millis() rollover\n";
+}
+
+void test_binary_client_tracks_last_frame() {
+    TelemetryPushSchedule sched;
+    sched.addClient(1, MIN_INTERVAL_MS);
+    assert(!sched.isClientBinary(1));
+    assert(sched.getLastFrameSeq(1) == 0);   // nothing sent yet -> keyframe
+
+    sched.markFrameSent(1, 16);               // a JSON frame went out first
+    sched.setClientBinary(1, true);
+    assert(sched.isClientBinary(1));
+    assert(sched.getLastFrameSeq(1) == 0);   // never decoded as binary -> keyframe
+    sched.markFrameSent(1, 17);
+    assert(sched.getLastFrameSeq(1) == 17);
+    sched.setClientBinary(1, true);           // repeated request keeps the base
+    assert(sched.getLastFrameSeq(1) == 17);
+    sched.requestKeyframe(1);                 // client failed to decode: resync
+    assert(sched.getLastFrameSeq(1) == 0 && sched.isClientBinary(1));
+    sched.markFrameSent(1, 18);
+
+    // A reconnect is a new client: binary flag and base are not inherited.
+    sched.removeClient(1);
+    sched.addClient(1, MIN_INTERVAL_MS);
+    assert(!sched.isClientBinary(1));
+    assert(sched.getLastFrameSeq(1) == 0);
+    cout << "PASS: binary clients track the last frame they were sent\n";
+}
+
+int main() {
+    test_first_frame_is_sent_immediately();
+    test_unknown_client_is_never_sent();
+    test_client_interval_is_respected();
+    test_interval_is_clamped();
+    test_backpressure_skips_and_counts();
+    test_table_capacity_and_removal();
+    test_survives_millis_rollover();
+    test_binary_client_tracks_last_frame();
+    return 0;
+}
@@ -0,0 +1,243 @@
+// Host tool: replays a capture of BMS BLE notifications through the same
+// framing and decoding the controller runs, and prints what it decodes.
+//
+//   g++ -std=c++17 -O2 -o bmsreplay tools/bmsreplay.cpp
+//   ./bmsreplay jbd capture.txt
+//   ./bmsreplay daly --quiet --repeat 1000 capture.txt   (frames/s only)
+//
+// A capture is text, one notification per line, as hex bytes with any
+// separators ("DD 03 00 1B ...", "dd-03-00-1b", "dd03001b"). In nRF Connect
+// and similar log exports only what follows "(0x)" or "value:" is read, so
+// a saved log can be replayed as is. Empty lines and lines starting with
+// '#' are skipped.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <stdint.h>
+#include <vector>
+
+#include "../src/JbdBms/JbdFrameParser.h"
+#include "../src/JbdBms/JbdBmsParser.h"
+#include "../src/DalyBms/DalyFrameParser.h"
+#include "../src/DalyBms/DalyBmsParser.h"
+#include "../src/JkBms/JkBmsParser.h"
+
+typedef std::vector<uint8_t> Notification;
+
+static int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+static bool parseLine(const char* line, Notification& out) {
+    out.clear();
+    const char* p = line;
+    while (*p == ' ' || *p == '\t') p++;
+    if (*p == '#' || *p == '\0' || *p == '\n' || *p == '\r') return false;
+    const char* marker = strstr(line, "(0x)");
+    if (marker != nullptr) {
+        p = marker + 4;
+    } else if ((marker = strstr(line, "value:")) != nullptr) {
+        p = marker + 6;
+    }
+    int high = -1;
+    for (; *p != '\0'; p++) {
+        const int v = hexValue(*p);
+        if (v < 0) {
+            high = -1;   // a separator ends a byte
+            continue;
+        }
+        if (high < 0) {
+            high = v;
+        } else {
+            out.push_back((uint8_t)(high << 4 | v));
+            high = -1;
+        }
+    }
+    return !out.empty();
+}
+
+// ── JK: the driver's framing (JkBms::parseRxBufferLocked), on a flat buffer ─
+
+class JkReplay {
+public:
+    JkReplay() : protocol_(JkProtocol_32S) {}
+
+    template <class OnFrame>
+    void feed(const uint8_t* data, size_t len, OnFrame&& onFrame) {
+        buf_.insert(buf_.end(), data, data + len);
+        size_t at = 0;
+        for (;;) {
+            while (at + 4 <= buf_.size() && !jkHasResponseHeader(buf_.data() + at, buf_.size() - at)) at++;
+            if (at + JK_FRAME_LENGTH > buf_.size()) break;
+            if (!jkValidateChecksum(buf_.data() + at, JK_FRAME_LENGTH)) {
+                rejected++;
+                at++;
+                continue;
+            }
+            onFrame(buf_.data() + at);
+            at += JK_FRAME_LENGTH;
+        }
+        buf_.erase(buf_.begin(), buf_.begin() + (at < buf_.size() ? at : buf_.size()));
+    }
+
+    JkProtocol protocol_;
+    uint32_t rejected = 0;
+
+private:
+    std::vector<uint8_t> buf_;
+};
+
+// ── Printing ──────────────────────────────────────────────────────────────────
+
+static void printMilli(const char* label, int32_t milli, const char* unit) {
+    const char* sign = milli < 0 ? "-" : "";
+    const uint32_t a = (uint32_t)(milli < 0 ? -(int64_t)milli : milli);
+    printf("  %s %s%u.%02u %s", label, sign, a / 1000, (a % 1000) / 10, unit);
+}
+
+static void printCells(const uint16_t* mv, uint8_t count) {
+    printf("  cells");
+    for (uint8_t i = 0; i < count; i++) printf(" %u", mv[i]);
+}
+
+static void printTemps(const int16_t* c, uint8_t count, uint8_t max) {
+    printf("  temps");
+    for (uint8_t i = 0; i < count && i < max; i++) printf(" %d", c[i]);
+}
+
+int main(int argc, char** argv) {
+    const char* protocol = nullptr;
+    const char* path = nullptr;
+    bool quiet = false;
+    long repeat = 1;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--quiet") == 0) quiet = true;
+        else if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc) repeat = strtol(argv[++i], nullptr, 10);
+        else if (protocol == nullptr) protocol = argv[i];
+        else path = argv[i];
+    }
+    const bool jbd = protocol != nullptr && strcmp(protocol, "jbd") == 0;
+    const bool daly = protocol != nullptr && strcmp(protocol, "daly") == 0;
+    const bool jk = protocol != nullptr && strcmp(protocol, "jk") == 0;
+    if (!(jbd || daly || jk) || path == nullptr || repeat < 1) {
+        fprintf(stderr, "usage: %s <jbd|daly|jk> [--quiet] [--repeat N] <capture.txt>\n", argv[0]);
+        return 2;
+    }
+    FILE* in = fopen(path, "r");
+    if (in == nullptr) {
+        perror(path);
+        return 1;
+    }
+    std::vector<Notification> capture;
+    size_t bytes = 0;
+    char line[4096];
+    Notification n;
+    while (fgets(line, sizeof(line), in) != nullptr) {
+        if (!parseLine(line, n)) continue;
+        bytes += n.size();
+        capture.push_back(n);
+    }
+    fclose(in);
+
+    JbdFrameParser jbdParser;
+    DalyFrameParser dalyParser;
+    JkReplay jkReplay;
+    uint32_t frames = 0;
+    uint32_t undecoded = 0;
+
+    const auto start = std::chrono::steady_clock::now();
+    for (long pass = 0; pass < repeat; pass++) {
+        const bool print = !quiet && pass == 0;
+        for (const Notification& note : capture) {
+            if (jbd) {
+                jbdParser.feed(note.data(), note.size(), [&](const JbdFrame& f) {
+                    frames++;
+                    JbdBasicInfo info;
+                    uint16_t cells[JBD_MAX_CELLS];
+                    if (f.status != 0x00) {
+                        undecoded++;
+                        if (print) printf("#%u JBD reg 0x%02X: BMS error status 0x%02X\n", frames, f.reg, f.status);
+                    } else if (f.reg == JBD_REG_BASIC_INFO && jbdParseBasicInfo(f.data, f.dataLen, &info)) {
+                        if (!print) return;
+                        printf("#%u JBD basic", frames);
+                        printMilli("V", (int32_t)info.packVoltageMilliVolts, "V");
+                        printMilli("I", info.packCurrentMilliAmps, "A");
+                        printf("  SoC %u%%  cycles %u  cells %u  errors 0x%04X  FET chg %u dsg %u",
+                               info.socPercent, info.cycleCount, info.cellCount, info.currentErrors,
+                               info.chgFetEnabled, info.dsgFetEnabled);
+                        printTemps(info.tempsCelsius, info.tempCount, JBD_MAX_NTC);
+                        printf("\n");
+                    } else if (f.reg == JBD_REG_CELL_VOLTAGES) {
+                        const uint8_t count = jbdParseCellVoltages(f.data, f.dataLen, cells, JBD_MAX_CELLS);
+                        if (!print) return;
+                        printf("#%u JBD", frames);
+                        printCells(cells, count);
+                        printf("\n");
+                    } else {
+                        undecoded++;
+                        if (print) printf("#%u JBD reg 0x%02X, %u bytes: not decoded\n", frames, f.reg, f.dataLen);
+                    }
+                });
+            } else if (daly) {
+                dalyParser.feed(note.data(), note.size(), [&](const DalyFrame& f) {
+                    frames++;
+                    DalyStatus s;
+                    if (!dalyParseStatusFrame(f.raw, f.rawLen, &s)) {
+                        undecoded++;
+                        if (print) printf("#%u Daly fn 0x%02X, %u bytes: not a status frame\n", frames, f.function, f.dataLen);
+                        return;
+                    }
+                    if (!print) return;
+                    printf("#%u Daly status", frames);
+                    printMilli("V", (int32_t)s.packVoltageMilliVolts, "V");
+                    printMilli("I", s.packCurrentMilliAmps, "A");
+                    printf("  SoC %u%%  cycles %u  remaining %u mAh  bal %u chg %u dsg %u",
+                           s.socPercent, s.cycleCount, s.remainingCapacityMilliAh,
+                           s.balanceEnabled, s.chargeEnabled, s.dischargeEnabled);
+                    printCells(s.cellVoltagesMv, s.cellCount);
+                    printTemps(s.tempsCelsius, s.tempCount, DALY_MAX_TEMPS);
+                    printf("\n");
+                });
+            } else {
+                jkReplay.feed(note.data(), note.size(), [&](const uint8_t* f) {
+                    frames++;
+                    char hw[16] = {};
+                    JkBmsData data = {};
+                    if (f[4] == JK_FRAME_TYPE_DEVICE_INFO && jkParseDeviceInfo(f, JK_FRAME_LENGTH, hw, sizeof(hw))) {
+                        jkReplay.protocol_ = jkDetectProtocol(hw);
+                        if (print) printf("#%u JK device info  hw %s  protocol %s\n", frames, hw,
+                                          jkReplay.protocol_ == JkProtocol_32S ? "32S" : "24S");
+                    } else if (f[4] == JK_FRAME_TYPE_CELL_INFO && jkParseCellInfo(f, JK_FRAME_LENGTH, jkReplay.protocol_, &data)) {
+                        if (!print) return;
+                        printf("#%u JK cell info", frames);
+                        printMilli("V", (int32_t)data.packVoltageMilliVolts, "V");
+                        printMilli("I", data.packCurrentMilliAmps, "A");
+                        printf("  SoC %u%%", data.socPercent);
+                        printCells(data.cellVoltagesMv, data.cellCount);
+                        printTemps(data.tempsCelsius, data.tempCount, JK_MAX_TEMPS);
+                        printf("\n");
+                    } else {
+                        undecoded++;
+                        if (print) printf("#%u JK type 0x%02X: not decoded\n", frames, f[4]);
+                    }
+                });
+            }
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const uint32_t rejected = jbd ? jbdParser.rejected() : daly ? dalyParser.rejected() : jkReplay.rejected;
+    fprintf(stderr, "%zu notifications, %zu bytes: %u frames (%u not decoded), %u rejected",
+            capture.size(), bytes, frames / (uint32_t)repeat, undecoded / (uint32_t)repeat, rejected / (uint32_t)repeat);
+    if (repeat > 1 && seconds > 0) {
+        fprintf(stderr, "; %.0f frames/s, %.1f MB/s over %ld passes", frames / seconds,
+                (double)bytes * repeat / seconds / 1e6, repeat);
+    }
+    fprintf(stderr, "\n");
+    return 0;
+}
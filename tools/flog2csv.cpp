@@ -0,0 +1,119 @@
+// Host tool: converts a flight log downloaded with /logs/<name>.csv?format=flog
+// (binary, compressed or not) to the same CSV the controller serves.
+//
+//   g++ -std=c++17 -O2 -o flog2csv tools/flog2csv.cpp
+//   ./flog2csv 20250419_003.flog > 20250419_003.csv
+//   ./flog2csv --raw 20250419_003.flog > plain.flog   (decompress only)
+
+#include <cstdio>
+#include <cstring>
+#include <stdint.h>
+
+#include "../src/Logger/FlightLogFormat.h"
+#include "../src/Logger/LogCompression.h"
+
+// Reads the log's .flog bytes, decompressing on the way when needed.
+class LogReader {
+public:
+    explicit LogReader(FILE* in) : in_(in), compressed_(false), rawSize_(0), bufLen_(0), bufPos_(0) {}
+
+    bool open() {
+        uint8_t head[LogCompression::kFileHeaderSize];
+        bufLen_ = fread(head, 1, sizeof(head), in_);
+        compressed_ = LogCompression::decodeFileHeader(head, bufLen_, rawSize_);
+        if (compressed_) {
+            bufLen_ = 0;
+        } else {
+            memcpy(buf_, head, bufLen_);   // plain .flog: replay what was read
+        }
+        return bufLen_ > 0 || compressed_;
+    }
+
+    size_t read(uint8_t* out, size_t want) {
+        if (!compressed_) {
+            if (bufPos_ < bufLen_) {
+                const size_t n = (bufLen_ - bufPos_) < want ? (bufLen_ - bufPos_) : want;
+                memcpy(out, buf_ + bufPos_, n);
+                bufPos_ += n;
+                return n;
+            }
+            return fread(out, 1, want, in_);
+        }
+        const uint32_t left = rawSize_ - decoder_.produced();
+        if (want > left) want = left;
+        while (want > 0) {
+            const size_t n = decoder_.read(out, want);
+            if (n > 0) return n;
+            if (bufPos_ == bufLen_) {
+                bufLen_ = fread(buf_, 1, sizeof(buf_), in_);
+                bufPos_ = 0;
+                if (bufLen_ == 0) break;
+            }
+            bufPos_ += decoder_.push(buf_ + bufPos_, bufLen_ - bufPos_);
+        }
+        return 0;
+    }
+
+private:
+    FILE* in_;
+    bool compressed_;
+    uint32_t rawSize_;
+    LogCompression::Decoder decoder_;
+    uint8_t buf_[4096];
+    size_t bufLen_;
+    size_t bufPos_;
+};
+
+int main(int argc, char** argv) {
+    bool raw = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--raw") == 0) raw = true;
+        else path = argv[i];
+    }
+    if (path == nullptr) {
+        fprintf(stderr, "usage: %s [--raw] <log.flog>\n", argv[0]);
+        return 2;
+    }
+    FILE* in = fopen(path, "rb");
+    if (in == nullptr) {
+        perror(path);
+        return 1;
+    }
+    LogReader reader(in);
+    if (!reader.open()) {
+        fprintf(stderr, "%s: empty file\n", path);
+        fclose(in);
+        return 1;
+    }
+
+    uint8_t chunk[4096];
+    if (raw) {
+        size_t n;
+        while ((n = reader.read(chunk, sizeof(chunk))) > 0) fwrite(chunk, 1, n, stdout);
+        fclose(in);
+        return 0;
+    }
+
+    FlightLog::CsvConverter converter;
+    uint8_t line[256];
+    for (;;) {
+        const size_t n = converter.read(line, sizeof(line));
+        if (n > 0) {
+            fwrite(line, 1, n, stdout);
+            continue;
+        }
+        size_t want = converter.wants();
+        if (want == 0) break;
+        if (want > sizeof(chunk)) want = sizeof(chunk);
+        const size_t got = reader.read(chunk, want);
+        if (got == 0) break;
+        converter.push(chunk, got);
+    }
+    fclose(in);
+    if (converter.failed()) {
+        fprintf(stderr, "%s: not a flight log\n", path);
+        return 1;
+    }
+    return 0;
+}